@@ -259,11 +259,25 @@ int main(int argc, char* argv[]) {
     printSystemInfo();
 
     std::cerr << "\n=== Stdio MCP Performance Benchmark ===" << std::endl;
-    std::cerr << "This benchmark requires a running MCP server on stdin/stdout" << std::endl;
-    std::cerr << "Run with: ./B1-StdioPerformance [iterations] | ./T2-StdioServer" << std::endl;
+    std::cerr << "This benchmark requires a running MCP server on stdin/stdout," << std::endl;
+    std::cerr << "or a server binary to spawn as a child process" << std::endl;
+    std::cerr << "Run with: ./B1-stdio_performance [iterations] [server-binary]" << std::endl;
 
     McpStdioClient client;
 
+    // 托管子进程模式：经由专用管道驱动服务端，无需手工创建 FIFO
+    if (argc > 2) {
+        McpStdioProcessOptions options;
+        options.executable = argv[2];
+        options.stderrHandler = [](std::string_view) {};
+        auto spawnResult = client.spawn(std::move(options));
+        if (!spawnResult) {
+            std::cerr << "Failed to spawn server: " << spawnResult.error().toString() << std::endl;
+            return 1;
+        }
+        std::cerr << "Spawned server process: " << argv[2] << std::endl;
+    }
+
     // 初始化
     std::cerr << "\nInitializing client..." << std::endl;
     auto initResult = client.initialize("benchmark-client", "1.0.0");
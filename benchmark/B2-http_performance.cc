@@ -2,6 +2,8 @@
  * @file B2-HttpPerformance.cc
  * @brief HTTP MCP performance benchmark (concurrent, wrk-like)
  * @details Use multiple connections and concurrent requests to measure throughput and latency.
+ *          With --compare-url, every operation is also run against a second endpoint
+ *          (e.g. unix:/tmp/mcp.sock vs http://127.0.0.1:8080/mcp) and the QPS ratio is printed.
  */
 
 #include "galay-mcp/client/McpHttpClient.h"
@@ -57,9 +59,9 @@ public:
         m_errorCount++;
     }
 
-    void printReport(const std::string& testName,
-                     double totalTestTimeMs,
-                     size_t expectedRequests) {
+    double printReport(const std::string& testName,
+                       double totalTestTimeMs,
+                       size_t expectedRequests) {
         std::lock_guard<std::mutex> lock(m_mutex);
 
         size_t totalCompleted = m_successCount + m_errorCount;
@@ -104,10 +106,12 @@ public:
             std::cout << "Std Dev:           " << stdDev << " ms" << std::endl;
         }
 
+        double qps = 0.0;
         if (totalTestTimeMs > 0) {
-            double qps = totalCompleted * 1000.0 / totalTestTimeMs;
+            qps = totalCompleted * 1000.0 / totalTestTimeMs;
             std::cout << "QPS:               " << qps << " req/s" << std::endl;
         }
+        return qps;
     }
 
 private:
@@ -148,8 +152,14 @@ Coroutine workerCoroutine(McpHttpClient& client,
                           std::atomic<bool>& benchmarkStarted,
                           std::atomic<bool>& benchmarkAborted,
                           size_t workerId) {
-    auto connectResult = co_await client.connect(url);
-    if (!connectResult) {
+    bool connected = false;
+    if (McpUnixSocket::isUnixAddress(url)) {
+        connected = client.connectUnix(url).has_value();
+    } else {
+        auto connectResult = co_await client.connect(url);
+        connected = connectResult.has_value();
+    }
+    if (!connected) {
         stats.addError();
         startupFailures++;
         finishedWorkers++;
@@ -246,16 +256,17 @@ Coroutine workerCoroutine(McpHttpClient& client,
     co_return;
 }
 
-static void runConcurrentTest(Runtime& runtime,
-                              std::vector<std::unique_ptr<McpHttpClient>>& clients,
-                              const std::string& url,
-                              Operation op,
-                              size_t requestsPerWorker) {
+static double runConcurrentTest(Runtime& runtime,
+                                std::vector<std::unique_ptr<McpHttpClient>>& clients,
+                                const std::string& url,
+                                Operation op,
+                                size_t requestsPerWorker) {
     size_t numWorkers = clients.size();
     size_t totalRequests = numWorkers * requestsPerWorker;
 
     std::cout << "\n=== Concurrent Test ===" << std::endl;
     std::cout << "Operation:         " << operationName(op) << std::endl;
+    std::cout << "Endpoint:          " << url << std::endl;
     std::cout << "Connections:       " << numWorkers << std::endl;
     std::cout << "Requests/Conn:     " << requestsPerWorker << std::endl;
     std::cout << "Total Requests:    " << totalRequests << std::endl;
@@ -309,7 +320,7 @@ static void runConcurrentTest(Runtime& runtime,
             std::this_thread::sleep_for(std::chrono::milliseconds(1));
         }
         std::cerr << "Benchmark startup failed for " << operationName(op) << std::endl;
-        return;
+        return 0.0;
     }
 
     benchmarkStarted.store(true, std::memory_order_release);
@@ -329,22 +340,40 @@ static void runConcurrentTest(Runtime& runtime,
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
-    stats.printReport(operationName(op), totalTestTimeMs, totalRequests);
+    return stats.printReport(operationName(op), totalTestTimeMs, totalRequests);
+}
+
+static void printComparison(Operation op,
+                            const std::string& url,
+                            double qps,
+                            const std::string& compareUrl,
+                            double compareQps) {
+    std::cout << "\n=== " << operationName(op) << " Endpoint Comparison ===" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << url << ": " << qps << " req/s" << std::endl;
+    std::cout << compareUrl << ": " << compareQps << " req/s" << std::endl;
+    if (qps > 0) {
+        std::cout << "Ratio:             " << (compareQps / qps) << "x" << std::endl;
+    }
 }
 
 static void printUsage(const char* prog) {
     std::cout << "Usage: " << prog << " [options]\n";
     std::cout << "Options:\n";
-    std::cout << "  --url <url>           Server URL (default: http://127.0.0.1:8080/mcp)\n";
+    std::cout << "  --url <url>           Server URL, http://... or unix:/path (default: http://127.0.0.1:8080/mcp)\n";
+    std::cout << "  --compare-url <url>   Run every test against a second endpoint and print the QPS ratio\n";
     std::cout << "  --connections <n>     Number of concurrent connections (default: 8)\n";
     std::cout << "  --requests <n>        Requests per connection per test (default: 2000)\n";
     std::cout << "  --io <n>              IO scheduler count (default: 2)\n";
+    std::cout << "                        unix: endpoints do blocking I/O on the worker's scheduler;\n";
+    std::cout << "                        use --io >= --connections when comparing against TCP\n";
     std::cout << "  --compute <n>         Compute scheduler count (default: 0)\n";
     std::cout << "  --help                Show this help message\n";
 }
 
 int main(int argc, char* argv[]) {
     std::string url = "http://127.0.0.1:8080/mcp";
+    std::string compareUrl;
     size_t connections = 8;
     size_t requestsPerConn = 2000;
     size_t ioSchedulers = 2;
@@ -354,6 +383,8 @@ int main(int argc, char* argv[]) {
         std::string arg = argv[i];
         if (arg == "--url" && i + 1 < argc) {
             url = argv[++i];
+        } else if (arg == "--compare-url" && i + 1 < argc) {
+            compareUrl = argv[++i];
         } else if ((arg == "--connections" || arg == "--workers") && i + 1 < argc) {
             connections = std::stoul(argv[++i]);
         } else if (arg == "--requests" && i + 1 < argc) {
@@ -372,6 +403,9 @@ int main(int argc, char* argv[]) {
 
     std::cout << "\n=== HTTP MCP Performance Benchmark (Concurrent) ===" << std::endl;
     std::cout << "Server URL:        " << url << std::endl;
+    if (!compareUrl.empty()) {
+        std::cout << "Compare URL:       " << compareUrl << std::endl;
+    }
     std::cout << "Connections:       " << connections << std::endl;
     std::cout << "Requests/Conn:     " << requestsPerConn << std::endl;
     std::cout << "IO Schedulers:     " << ioSchedulers << std::endl;
@@ -387,12 +421,21 @@ int main(int argc, char* argv[]) {
         clients.push_back(std::make_unique<McpHttpClient>(runtime));
     }
 
-    runConcurrentTest(runtime, clients, url, Operation::Ping, requestsPerConn);
-    runConcurrentTest(runtime, clients, url, Operation::ToolCall, requestsPerConn);
-    runConcurrentTest(runtime, clients, url, Operation::ResourceRead, requestsPerConn);
-    runConcurrentTest(runtime, clients, url, Operation::ToolsList, requestsPerConn);
-    runConcurrentTest(runtime, clients, url, Operation::ResourcesList, requestsPerConn);
-    runConcurrentTest(runtime, clients, url, Operation::PromptsList, requestsPerConn);
+    const Operation operations[] = {
+        Operation::Ping,
+        Operation::ToolCall,
+        Operation::ResourceRead,
+        Operation::ToolsList,
+        Operation::ResourcesList,
+        Operation::PromptsList
+    };
+    for (Operation op : operations) {
+        const double qps = runConcurrentTest(runtime, clients, url, op, requestsPerConn);
+        if (!compareUrl.empty()) {
+            const double compareQps = runConcurrentTest(runtime, clients, compareUrl, op, requestsPerConn);
+            printComparison(op, url, qps, compareUrl, compareQps);
+        }
+    }
 
     runtime.stop();
 
@@ -0,0 +1,157 @@
+/**
+ * @file B4-ShmPerformance.cc
+ * @brief 同机共享内存 MCP 传输性能测试
+ * @details fork 出服务端进程，经由 McpShmChannel 驱动 McpStdioServer，
+ *          测量 ping 与小 tools/call 的往返延迟（微秒级）。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+using namespace std::chrono;
+
+namespace {
+
+void printReport(const std::string& name, std::vector<double>& latenciesUs) {
+    if (latenciesUs.empty()) {
+        std::cerr << "\n=== " << name << ": no samples ===" << std::endl;
+        return;
+    }
+    std::sort(latenciesUs.begin(), latenciesUs.end());
+    double total = 0.0;
+    for (double v : latenciesUs) {
+        total += v;
+    }
+    auto pct = [&](double p) {
+        size_t idx = static_cast<size_t>(latenciesUs.size() * p);
+        return latenciesUs[std::min(idx, latenciesUs.size() - 1)];
+    };
+
+    std::cerr << "\n=== " << name << " Performance Report ===" << std::endl;
+    std::cerr << std::fixed << std::setprecision(2);
+    std::cerr << "Total Requests:  " << latenciesUs.size() << std::endl;
+    std::cerr << "Avg Latency:     " << total / latenciesUs.size() << " us" << std::endl;
+    std::cerr << "P50 Latency:     " << pct(0.50) << " us" << std::endl;
+    std::cerr << "P99 Latency:     " << pct(0.99) << " us" << std::endl;
+    std::cerr << "P99.9 Latency:   " << pct(0.999) << " us" << std::endl;
+    std::cerr << "Max Latency:     " << latenciesUs.back() << " us" << std::endl;
+    std::cerr << "Throughput:      " << (latenciesUs.size() * 1e6 / total) << " req/s" << std::endl;
+}
+
+int runServer(const std::string& name) {
+    auto channel = McpShmChannel::create(name);
+    if (!channel) {
+        std::cerr << "Server: " << channel.error().toString() << std::endl;
+        return 1;
+    }
+
+    McpStdioServer server;
+    server.setServerInfo("benchmark-shm-server", "1.0.0");
+    server.addTool("echo", "Echo the message argument", "{}",
+        [](const JsonElement& args) -> std::expected<JsonString, McpError> {
+            JsonObject obj;
+            std::string message;
+            if (!JsonHelper::GetObject(args, obj) || !JsonHelper::GetString(obj, "message", message)) {
+                return std::unexpected(McpError::invalidParams("Missing message"));
+            }
+            return message;
+        });
+    server.setChannel(std::move(channel.value()));
+    server.run();
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t iterations = 100000;
+    if (argc > 1) {
+        iterations = static_cast<size_t>(std::stoul(argv[1]));
+    }
+
+    const std::string name = "/galay-mcp-b4-" + std::to_string(::getpid());
+
+    pid_t child = ::fork();
+    if (child < 0) {
+        std::cerr << "fork failed" << std::endl;
+        return 1;
+    }
+    if (child == 0) {
+        _exit(runServer(name));
+    }
+
+    // 等待服务端创建共享内存段
+    std::unique_ptr<McpShmChannel> channel;
+    const auto deadline = steady_clock::now() + seconds(5);
+    while (!channel && steady_clock::now() < deadline) {
+        auto opened = McpShmChannel::open(name);
+        if (opened) {
+            channel = std::move(opened.value());
+        } else {
+            std::this_thread::sleep_for(milliseconds(1));
+        }
+    }
+    if (!channel) {
+        std::cerr << "Failed to open shared memory channel " << name << std::endl;
+        ::kill(child, SIGKILL);
+        return 1;
+    }
+
+    McpStdioClient client;
+    client.attach(std::move(channel));
+    auto initResult = client.initialize("benchmark-shm-client", "1.0.0");
+    if (!initResult) {
+        std::cerr << "Failed to initialize: " << initResult.error().toString() << std::endl;
+        ::kill(child, SIGKILL);
+        return 1;
+    }
+
+    std::cerr << "=== Shared Memory MCP Performance Benchmark ===" << std::endl;
+    std::cerr << "Iterations: " << iterations << std::endl;
+
+    // 预热
+    for (size_t i = 0; i < 1000; ++i) {
+        client.ping();
+    }
+
+    std::vector<double> pingLatencies;
+    pingLatencies.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        auto start = steady_clock::now();
+        auto result = client.ping();
+        auto end = steady_clock::now();
+        if (result) {
+            pingLatencies.push_back(duration_cast<nanoseconds>(end - start).count() / 1000.0);
+        }
+    }
+    printReport("Ping", pingLatencies);
+
+    const JsonString args = R"({"message":"benchmark"})";
+    std::vector<double> callLatencies;
+    callLatencies.reserve(iterations);
+    for (size_t i = 0; i < iterations; ++i) {
+        auto start = steady_clock::now();
+        auto result = client.callTool("echo", args);
+        auto end = steady_clock::now();
+        if (result) {
+            callLatencies.push_back(duration_cast<nanoseconds>(end - start).count() / 1000.0);
+        }
+    }
+    printReport("Tool Call", callLatencies);
+
+    client.disconnect();
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file B5-RegistryStartup.cc
+ * @brief 工具注册表启动性能测试
+ * @details 分别以逐个 addTool、一次 registerTools 与从清单文件 loadManifest 向 McpStdioServer
+ *          注册 100 / 10k / 100k 个工具，测量注册总耗时（清单包含映射与解析），
+ *          以及注册完成后再追加单个工具的耗时。
+ *          逐个注册每次都复制整张注册表，默认只在不超过 10k 个工具时运行，可用第一个参数调整上限。
+ */
+
+#include "galay-mcp/common/McpManifest.h"
+#include "galay-mcp/server/McpStdioServer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+using namespace std::chrono;
+
+namespace {
+
+constexpr const char* kSchema = R"({"type":"object","properties":{"text":{"type":"string"}}})";
+
+std::expected<JsonString, McpError> EchoTool(const JsonElement&, const McpToolContext&) {
+    return JsonString(R"({"content":[]})");
+}
+
+std::string ToolName(size_t index) {
+    return "tool-" + std::to_string(index);
+}
+
+double measureOneByOne(size_t count) {
+    McpStdioServer server;
+    auto start = steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        server.addTool(ToolName(i), "Benchmark tool", kSchema, McpStdioServer::ContextToolHandler(EchoTool));
+    }
+    return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+double measureBulk(McpStdioServer& server, size_t count) {
+    std::vector<McpStdioServer::ToolDefinition> tools;
+    tools.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        tools.push_back({ToolName(i), "Benchmark tool", kSchema, EchoTool});
+    }
+    auto start = steady_clock::now();
+    server.registerTools(std::move(tools));
+    return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+double measureManifest(size_t count) {
+    const std::string path = "/tmp/galay-mcp-b5-" + std::to_string(::getpid()) + ".json";
+    {
+        std::ofstream out(path, std::ios::trunc);
+        out << "{\"tools\":[";
+        for (size_t i = 0; i < count; ++i) {
+            out << (i > 0 ? "," : "") << "{\"name\":\"" << ToolName(i)
+                << "\",\"description\":\"Benchmark tool\",\"inputSchema\":" << kSchema << "}";
+        }
+        out << "]}";
+    }
+
+    McpStdioServer server;
+    auto start = steady_clock::now();
+    auto manifest = McpManifest::load(path);
+    if (manifest) {
+        server.loadManifest(manifest.value(), [](const McpManifestTool&) {
+            return McpStdioServer::ContextToolHandler(EchoTool);
+        });
+    }
+    const double elapsed = duration<double, std::milli>(steady_clock::now() - start).count();
+    std::remove(path.c_str());
+    if (!manifest || server.localListTools().size() != count) {
+        std::cerr << "manifest load failed" << std::endl;
+        return -1;
+    }
+    return elapsed;
+}
+
+double measureAppend(McpStdioServer& server, size_t count) {
+    auto start = steady_clock::now();
+    server.addTool(ToolName(count), "Benchmark tool", kSchema, McpStdioServer::ContextToolHandler(EchoTool));
+    return duration<double, std::micro>(steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const size_t oneByOneLimit = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000;
+    const std::vector<size_t> sizes = {100, 10000, 100000};
+
+    std::cerr << "=== Registry Startup Benchmark ===" << std::endl;
+    std::cerr << "One-by-one limit: " << oneByOneLimit << std::endl;
+    std::cerr << std::fixed << std::setprecision(2);
+
+    for (size_t count : sizes) {
+        std::cerr << "\n=== " << count << " tools ===" << std::endl;
+        if (count <= oneByOneLimit) {
+            std::cerr << "addTool x N:       " << measureOneByOne(count) << " ms" << std::endl;
+        } else {
+            std::cerr << "addTool x N:       skipped" << std::endl;
+        }
+
+        McpStdioServer server;
+        std::cerr << "registerTools:     " << measureBulk(server, count) << " ms" << std::endl;
+        std::cerr << "loadManifest:      " << measureManifest(count) << " ms" << std::endl;
+        std::cerr << "append one tool:   " << measureAppend(server, count) << " us" << std::endl;
+        if (server.localListTools().size() != count + 1) {
+            std::cerr << "unexpected tool count" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
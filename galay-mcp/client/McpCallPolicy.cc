@@ -0,0 +1,78 @@
+#include "galay-mcp/client/McpCallPolicy.h"
+#include "galay-mcp/common/McpBase.h"
+#include <algorithm>
+#include <cmath>
+
+namespace galay {
+namespace mcp {
+
+bool isIdempotentMethod(std::string_view method) {
+    return method == Methods::PING ||
+           method == Methods::TOOLS_LIST ||
+           method == Methods::RESOURCES_LIST ||
+           method == Methods::RESOURCES_READ ||
+           method == Methods::PROMPTS_LIST;
+}
+
+bool isRetryableError(const McpError& error) {
+    switch (error.code()) {
+        case McpErrorCode::ConnectionFailed:
+        case McpErrorCode::ConnectionClosed:
+        case McpErrorCode::ServerOverloaded:
+        case McpErrorCode::ReadError:
+        case McpErrorCode::WriteError:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::chrono::milliseconds retryBackoff(const McpRetryPolicy& policy, size_t retry, std::mt19937_64& rng) {
+    const double scaled = static_cast<double>(policy.initialBackoff.count()) *
+                          std::pow(std::max(policy.multiplier, 1.0), static_cast<double>(retry));
+    const double cap = std::min(scaled, static_cast<double>(policy.maxBackoff.count()));
+    if (!(cap > 0.0)) {
+        return std::chrono::milliseconds(0);
+    }
+    std::uniform_int_distribution<int64_t> jitter(0, static_cast<int64_t>(cap));
+    return std::chrono::milliseconds(jitter(rng));
+}
+
+McpLatencyTracker::McpLatencyTracker(size_t capacity) {
+    m_samples.reserve(capacity == 0 ? 1 : capacity);
+}
+
+void McpLatencyTracker::record(Clock::duration latency) {
+    const auto sample = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_samples.size() < m_samples.capacity()) {
+        m_samples.push_back(sample);
+        return;
+    }
+    m_samples[m_next] = sample;
+    m_next = (m_next + 1) % m_samples.size();
+}
+
+std::optional<std::chrono::microseconds> McpLatencyTracker::quantile(double q, size_t minSamples) const {
+    std::vector<std::chrono::microseconds> samples;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_samples.empty() || m_samples.size() < minSamples) {
+            return std::nullopt;
+        }
+        samples = m_samples;
+    }
+    q = std::clamp(q, 0.0, 1.0);
+    const size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(samples.size())));
+    const size_t index = rank == 0 ? 0 : rank - 1;
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
+
+size_t McpLatencyTracker::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_samples.size();
+}
+
+} // namespace mcp
+} // namespace galay
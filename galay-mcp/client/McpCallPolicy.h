@@ -0,0 +1,124 @@
+#ifndef GALAY_MCP_CLIENT_MCPCALLPOLICY_H
+#define GALAY_MCP_CLIENT_MCPCALLPOLICY_H
+
+#include "galay-mcp/common/McpError.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 重试策略：仅作用于幂等请求
+ *
+ * 第 n 次重试前等待 [0, min(maxBackoff, initialBackoff * multiplier^n)] 内的随机时长（full jitter），
+ * 避免大量客户端在服务端重启后同时重连。
+ */
+struct McpRetryPolicy {
+    // 总尝试次数（含首次），1 表示不重试
+    size_t maxAttempts = 1;
+    std::chrono::milliseconds initialBackoff{50};
+    std::chrono::milliseconds maxBackoff{2000};
+    double multiplier = 2.0;
+};
+
+/**
+ * @brief 对冲请求策略：仅作用于幂等请求
+ *
+ * 首个副本发出 delay 后仍未返回时，在连接池的另一条连接上发出同一请求，取先返回的成功结果。
+ * delay 取最近成功请求耗时的 quantile 分位数，样本不足 minSamples 时使用 fallbackDelay。
+ */
+struct McpHedgePolicy {
+    bool enabled = false;
+    double quantile = 0.95;
+    size_t minSamples = 20;
+    std::chrono::milliseconds minDelay{1};
+    std::chrono::milliseconds fallbackDelay{50};
+};
+
+/**
+ * @brief McpHttpClient 的调用策略
+ */
+struct McpHttpClientOptions {
+    // 未单独指定时每次调用的超时，0 表示不限
+    std::chrono::milliseconds defaultTimeout{0};
+    McpRetryPolicy retry;
+    McpHedgePolicy hedge;
+    // 带超时或对冲的请求使用的连接池上限
+    size_t maxConnections = 4;
+};
+
+/**
+ * @brief 单次调用选项
+ */
+struct McpCallOptions {
+    // 本次调用的超时（含重试与对冲），0 表示使用 McpHttpClientOptions::defaultTimeout
+    std::chrono::milliseconds timeout{0};
+    // 声明本次 tools/call 可以安全地重复执行，从而允许重试与对冲
+    bool idempotent = false;
+    // 非空时写入 params._meta.progressToken，服务端的进度通知交给 McpHttpClient 的通知处理函数
+    std::string progressToken;
+};
+
+/**
+ * @brief McpHttpClient 调用计数快照
+ */
+struct McpClientCallStats {
+    uint64_t attempts = 0;   // 发出的请求副本数（含重试与对冲）
+    uint64_t retries = 0;
+    uint64_t hedged = 0;     // 发出对冲副本的请求数
+    uint64_t hedgeWins = 0;  // 对冲副本先返回的请求数
+    uint64_t timeouts = 0;
+};
+
+/**
+ * @brief 重复执行无副作用的方法（ping、各 list 方法、resources/read）
+ */
+bool isIdempotentMethod(std::string_view method);
+
+/**
+ * @brief 可重试的错误：连接失败/断开、读写失败、服务端过载
+ */
+bool isRetryableError(const McpError& error);
+
+/**
+ * @brief 第 retry 次重试（从 0 开始）前的等待时长，取值范围见 McpRetryPolicy
+ */
+std::chrono::milliseconds retryBackoff(const McpRetryPolicy& policy, size_t retry, std::mt19937_64& rng);
+
+/**
+ * @brief 最近若干次请求耗时的滑动窗口，用于计算对冲延迟。线程安全
+ */
+class McpLatencyTracker {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit McpLatencyTracker(size_t capacity = 256);
+
+    void record(Clock::duration latency);
+
+    /**
+     * @brief 窗口内耗时的 q 分位数（0 < q <= 1）
+     * @return 样本数少于 minSamples 时返回 std::nullopt
+     */
+    std::optional<std::chrono::microseconds> quantile(double q, size_t minSamples = 1) const;
+
+    size_t size() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<std::chrono::microseconds> m_samples;
+    size_t m_next{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_CLIENT_MCPCALLPOLICY_H
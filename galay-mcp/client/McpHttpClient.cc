@@ -1,21 +1,37 @@
 #include "galay-mcp/client/McpHttpClient.h"
+#include "galay-kernel/common/Sleep.hpp"
 #include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpEncoding.h"
 #include "galay-mcp/common/McpProtocolUtils.h"
+#include "galay-mcp/common/McpSchedulerExecutor.h"
+#include "galay-mcp/common/McpSse.h"
+#include <algorithm>
+#include <sys/socket.h>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace galay {
 namespace mcp {
 
 namespace {
 
+// 等待池化请求完成的轮询间隔
+
+// 会话事件流断开后的重连间隔（服务端给出 retry 时以其为准）
+constexpr std::chrono::milliseconds kEventStreamRetry{100};
+
+// 请求同时接受 JSON 与 SSE 响应
+constexpr const char* kAcceptHeader = "application/json, text/event-stream";
+
 const JsonString& EmptyObjectString() {
     static const JsonString kEmptyObject = "{}";
     return kEmptyObject;
 }
 
 template <typename T, typename ParseFn>
-std::expected<std::vector<T>, McpError> parseListField(std::string_view body,
-                                                       const char* fieldName,
-                                                       ParseFn&& parseFn) {
+std::expected<ListPage<T>, McpError> parseListPage(std::string_view body,
+                                                   const char* fieldName,
+                                                   ParseFn&& parseFn) {
     auto docExp = JsonDocument::Parse(body);
     if (!docExp) {
         return std::unexpected(McpError::parseError(docExp.error().details()));
@@ -26,10 +42,26 @@ std::expected<std::vector<T>, McpError> parseListField(std::string_view body,
         return std::unexpected(McpError::parseError("Expected JSON object"));
     }
 
-    std::vector<T> values;
+    ListPage<T> page;
+    JsonHelper::GetString(obj, "nextCursor", page.nextCursor);
+    JsonObject metaObj;
+    if (JsonHelper::GetObject(obj, "_meta", metaObj)) {
+        JsonHelper::GetString(metaObj, "listVersion", page.version);
+        JsonHelper::GetBool(metaObj, "notModified", page.notModified);
+        JsonHelper::GetBool(metaObj, "delta", page.delta);
+        JsonArray removed;
+        if (JsonHelper::GetArray(metaObj, "removed", removed)) {
+            for (auto item : removed) {
+                std::string key;
+                if (JsonHelper::GetStringValue(item, key)) {
+                    page.removed.push_back(std::move(key));
+                }
+            }
+        }
+    }
     JsonArray arr;
     if (!JsonHelper::GetArray(obj, fieldName, arr)) {
-        return values;
+        return page;
     }
 
     for (auto item : arr) {
@@ -37,10 +69,78 @@ std::expected<std::vector<T>, McpError> parseListField(std::string_view body,
         if (!parsed) {
             return std::unexpected(McpError::parseError(parsed.error().message()));
         }
-        values.emplace_back(std::move(parsed.value()));
+        page.items.emplace_back(std::move(parsed.value()));
+    }
+
+    return page;
+}
+
+// list 请求的 params：第一页为空对象，之后带上 cursor；有缓存时带上缓存的版本
+JsonString listParams(const std::string& cursor, const std::string& ifChangedSince = "") {
+    if (cursor.empty() && ifChangedSince.empty()) {
+        return EmptyObjectString();
     }
+    JsonWriter writer;
+    writer.StartObject();
+    if (!cursor.empty()) {
+        writer.Key("cursor");
+        writer.String(cursor);
+    }
+    if (!ifChangedSince.empty()) {
+        writer.Key("_meta");
+        writer.StartObject();
+        writer.Key("ifChangedSince");
+        writer.String(ifChangedSince);
+        writer.EndObject();
+    }
+    writer.EndObject();
+    return writer.TakeString();
+}
 
-    return values;
+const std::string& ListKey(const Tool& tool) { return tool.name; }
+const std::string& ListKey(const Resource& resource) { return resource.uri; }
+const std::string& ListKey(const Prompt& prompt) { return prompt.name; }
+
+// 把增量合并进缓存的列表：替换的条目保持原位置，新增的条目追加在末尾
+template <typename T>
+std::vector<T> ApplyListDelta(std::vector<T> items, ListPage<T>& delta) {
+    std::unordered_map<std::string, size_t> index;
+    index.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        index.emplace(ListKey(items[i]), i);
+    }
+    for (auto& item : delta.items) {
+        auto it = index.find(ListKey(item));
+        if (it != index.end()) {
+            items[it->second] = std::move(item);
+        } else {
+            index.emplace(ListKey(item), items.size());
+            items.push_back(std::move(item));
+        }
+    }
+    if (!delta.removed.empty()) {
+        std::unordered_set<std::string> removed(delta.removed.begin(), delta.removed.end());
+        std::erase_if(items, [&removed](const T& item) { return removed.contains(ListKey(item)); });
+    }
+    return items;
+}
+
+// 把一页追加到已取得的条目之后，返回下一页的 cursor
+template <typename T>
+std::expected<std::string, McpError> appendPage(std::vector<T>& values,
+                                                ListPage<T>& page,
+                                                const std::string& cursor) {
+    if (!page.nextCursor.empty() && page.nextCursor == cursor) {
+        return std::unexpected(McpError::parseError("nextCursor did not advance"));
+    }
+    if (values.empty()) {
+        values = std::move(page.items);
+    } else {
+        values.insert(values.end(),
+                      std::make_move_iterator(page.items.begin()),
+                      std::make_move_iterator(page.items.end()));
+    }
+    return std::move(page.nextCursor);
 }
 
 std::expected<std::string, McpError> parseFirstTextContent(std::string_view body,
@@ -55,12 +155,33 @@ std::expected<std::string, McpError> parseFirstTextContent(std::string_view body
         return std::unexpected(McpError::parseError("Expected JSON object"));
     }
 
+    // 流式资源在部分内容写出后失败时置 isError，错误说明在 _meta.error 中
+    bool isError = false;
+    if (JsonHelper::GetBool(obj, "isError", isError) && isError) {
+        std::string details;
+        JsonObject meta;
+        if (JsonHelper::GetObject(obj, "_meta", meta)) {
+            JsonHelper::GetString(meta, "error", details);
+        }
+        return std::unexpected(McpError::internalError(details));
+    }
+
     JsonArray arr;
     if (!JsonHelper::GetArray(obj, fieldName, arr)) {
         return std::string();
     }
 
     for (auto item : arr) {
+        // 二进制资源内容：{"uri","mimeType","blob"}，返回解码后的字节
+        JsonObject itemObj;
+        std::string blob;
+        if (JsonHelper::GetObject(item, itemObj) && JsonHelper::GetString(itemObj, "blob", blob)) {
+            auto bytes = encoding::base64Decode(blob);
+            if (!bytes) {
+                return std::unexpected(McpError::parseError("Invalid base64 blob"));
+            }
+            return std::move(bytes.value());
+        }
         auto contentExp = Content::fromJson(item);
         if (!contentExp) {
             return std::unexpected(McpError::parseError(contentExp.error().message()));
@@ -73,21 +194,317 @@ std::expected<std::string, McpError> parseFirstTextContent(std::string_view body
     return std::string();
 }
 
+// 解析 JSON-RPC 响应体，返回 result 原始 JSON 或映射后的错误
+std::expected<JsonString, McpError> parseRpcResult(int64_t requestId, const std::string& responseBody) {
+    auto parsed = parseJsonRpcResponse(responseBody);
+    if (!parsed) {
+        return std::unexpected(McpError::parseError(parsed.error().details()));
+    }
+
+    const auto& view = parsed.value().response;
+    if (view.id != requestId) {
+        return std::unexpected(McpError::invalidResponse("Mismatched response id"));
+    }
+    if (view.hasError) {
+        auto errorExp = JsonRpcError::fromJson(view.error);
+        if (!errorExp) {
+            return std::unexpected(McpError::parseError(errorExp.error().message()));
+        }
+        const auto& error = errorExp.value();
+        std::string details;
+        if (error.data.has_value()) {
+            details = error.data.value();
+        }
+        return std::unexpected(McpError::fromJsonRpcError(error.code, error.message, details));
+    }
+
+    if (view.hasResult) {
+        std::string raw;
+        if (JsonHelper::GetRawJson(view.result, raw)) {
+            return raw;
+        }
+        return std::unexpected(McpError::parseError("Failed to parse result"));
+    }
+    return EmptyObjectString();
+}
+
+// 会话 id 与通知处理函数；池化请求的任务在其他 IO 线程上读写
+struct ClientSession {
+    std::mutex mutex;
+    std::string sessionId;
+    McpHttpClient::NotificationHandler onNotification;
+
+    std::string id() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return sessionId;
+    }
+
+    void setId(std::string id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sessionId = std::move(id);
+    }
+
+    void notify(const std::string& method, const JsonString& params) {
+        McpHttpClient::NotificationHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            handler = onNotification;
+        }
+        if (handler) {
+            handler(method, params);
+        }
+    }
+};
+
+// 不带 id 的消息按通知交给处理函数；其他消息返回 false
+bool DispatchNotification(std::string_view message, ClientSession& session) {
+    if (peekJsonRpcId(message).has_value()) {
+        return false;
+    }
+    auto parsed = parseJsonRpcRequest(message);
+    if (!parsed || parsed.value().request.method.empty()) {
+        return false;
+    }
+    const JsonRpcRequestView& notification = parsed.value().request;
+    JsonString params;
+    if (notification.hasParams) {
+        JsonHelper::GetRawJson(notification.params, params);
+    }
+    session.notify(notification.method, params);
+    return true;
+}
+
+// SSE 响应：通知交给处理函数，返回 id 匹配的最终响应
+std::expected<JsonString, McpError> parseEventStreamResult(int64_t requestId,
+                                                           std::string_view body,
+                                                           ClientSession& session) {
+    McpSseParser parser;
+    std::vector<McpSseEvent> events;
+    parser.feed(body, events);
+
+    std::optional<std::expected<JsonString, McpError>> result;
+    for (const McpSseEvent& event : events) {
+        if (DispatchNotification(event.data, session)) {
+            continue;
+        }
+        if (!result.has_value() && peekJsonRpcId(event.data) == requestId) {
+            result = parseRpcResult(requestId, event.data);
+        }
+    }
+    if (!result.has_value()) {
+        return std::unexpected(McpError::invalidResponse("Missing response in event stream"));
+    }
+    return std::move(result.value());
+}
+
+// 按 Content-Type 解析响应正文
+std::expected<JsonString, McpError> parseResponseBody(int64_t requestId,
+                                                      std::string_view contentType,
+                                                      const std::string& body,
+                                                      ClientSession& session) {
+    if (sse::isEventStream(contentType)) {
+        return parseEventStreamResult(requestId, body, session);
+    }
+    return parseRpcResult(requestId, body);
+}
+
+// 状态行形如 "HTTP/1.1 200 OK"，返回其中的状态码
+std::string StatusCode(const std::string& statusLine) {
+    const size_t codeStart = statusLine.find(' ');
+    return codeStart == std::string::npos ? std::string() : statusLine.substr(codeStart + 1, 3);
+}
+
+// 截止时间前剩余的毫秒数，向上取整；已过期返回 0
+int64_t RemainingMs(std::chrono::steady_clock::time_point deadline) {
+    const auto remaining = deadline - std::chrono::steady_clock::now();
+    if (remaining <= std::chrono::steady_clock::duration::zero()) {
+        return 0;
+    }
+    return std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+}
+
+// 在一条 HTTP 连接上发送 POST 并解析响应；连接断开时先重连
+Coroutine PostJsonRpc(http::HttpClient& client,
+                      const std::string& serverUrl,
+                      std::atomic<bool>& connected,
+                      int64_t requestId,
+                      const std::string& requestBody,
+                      ClientSession& session,
+                      std::expected<JsonString, McpError>& result) {
+    // 如果连接断开，重新连接
+    if (!connected.load()) {
+        auto connectResult = co_await client.connect(serverUrl);
+        if (!connectResult) {
+            result = std::unexpected(McpError::connectionError(connectResult.error().message()));
+            co_return;
+        }
+        connected = true;
+    }
+
+    // 发送POST请求
+    std::map<std::string, std::string> headers{
+        {"Host", client.url().host + ":" + std::to_string(client.url().port)},
+        {"Content-Type", "application/json"},
+        {"Accept", kAcceptHeader}
+    };
+    const std::string sessionId = session.id();
+    if (!sessionId.empty()) {
+        headers.emplace("Mcp-Session-Id", sessionId);
+    }
+    auto httpSession = client.getSession();
+    auto awaitable = httpSession.post(
+        client.url().path,
+        requestBody,
+        "application/json",
+        std::move(headers)
+    );
+
+    // 循环等待直到完成
+    while (true) {
+        auto httpResult = co_await awaitable;
+
+        if (!httpResult) {
+            connected = false;
+            result = std::unexpected(McpError::connectionError(httpResult.error().message()));
+            co_return;
+        }
+
+        if (!httpResult.value()) {
+            continue;
+        }
+
+        auto response = httpResult.value().value();
+
+        // 根据响应头判断是否需要关闭连接
+        if (response.header().isConnectionClose() || !response.header().isKeepAlive()) {
+            connected = false;
+        }
+
+        // 检查HTTP状态码
+        const int statusCode = static_cast<int>(response.header().code());
+        if (statusCode == 404 && !sessionId.empty()) {
+            // 会话已被服务端结束，需要重新 initialize
+            session.setId({});
+            result = std::unexpected(McpError::connectionError("Session not found"));
+            co_return;
+        }
+        if (response.header().code() != http::HttpStatusCode::OK_200) {
+            result = std::unexpected(McpError::connectionError("HTTP error: " + std::to_string(statusCode)));
+            co_return;
+        }
+
+        std::string issuedSessionId = response.header().headerPairsValue("Mcp-Session-Id");
+        if (!issuedSessionId.empty()) {
+            session.setId(std::move(issuedSessionId));
+        }
+
+        // 解析响应（JSON 或 SSE）
+        result = parseResponseBody(requestId, response.header().headerPairsValue("Content-Type"),
+                                   response.getBodyStr(), session);
+        co_return;
+    }
+}
+
 } // namespace
 
+// 池满时等待空闲连接的请求：连接释放时通知全部登记的唤醒点，醒来后重新争抢
+struct McpHttpClient::PoolIdle {
+    std::mutex mutex;
+    std::vector<std::weak_ptr<McpWakeSignal>> waiters;
+
+    void wait(const std::shared_ptr<McpWakeSignal>& wake) {
+        std::lock_guard<std::mutex> lock(mutex);
+        waiters.push_back(wake);
+    }
+
+    void notifyAll() {
+        std::vector<std::weak_ptr<McpWakeSignal>> woken;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            woken.swap(waiters);
+        }
+        for (const auto& waiter : woken) {
+            if (auto wake = waiter.lock()) {
+                wake->notify();
+            }
+        }
+    }
+};
+
+// 池化连接固定在创建它的 IO 调度器上收发
+struct McpHttpClient::PooledConnection {
+    std::unique_ptr<http::HttpClient> client = std::make_unique<http::HttpClient>();
+    kernel::IOScheduler* scheduler = nullptr;
+    std::shared_ptr<PoolIdle> idle;
+    std::atomic<bool> connected{false};
+    std::atomic<bool> busy{false};
+};
+
+struct McpHttpClient::SessionState : ClientSession {
+};
+
+// 一个请求副本的结果；done 置位后 result 可读，并通知 wake（为空时不通知）
+struct McpHttpClient::Attempt {
+    std::atomic<bool> done{false};
+    std::expected<JsonString, McpError> result;
+    std::shared_ptr<McpWakeSignal> wake;
+};
+
 McpHttpClient::McpHttpClient(kernel::Runtime& runtime)
-    : m_runtime(runtime) {
+    : m_runtime(runtime)
+    , m_listCache(std::make_shared<McpListCache>())
+    , m_poolIdle(std::make_shared<PoolIdle>())
+    , m_latency(std::make_shared<McpLatencyTracker>())
+    , m_rng(std::random_device{}())
+    , m_session(std::make_shared<SessionState>()) {
     m_httpClient = std::make_unique<http::HttpClient>();
 }
 
 McpHttpClient::~McpHttpClient() {
+    closeEventStream();
+}
+
+void McpHttpClient::setNotificationHandler(NotificationHandler handler) {
+    std::lock_guard<std::mutex> lock(m_session->mutex);
+    m_session->onNotification = std::move(handler);
+}
+
+std::string McpHttpClient::sessionId() const {
+    return m_session->id();
 }
 
 McpHttpClient::ConnectAwaitable McpHttpClient::connect(const std::string& url) {
     m_serverUrl = url;
+    m_unixPath.clear();
+    if (m_unixWorker) {
+        m_unixWorker->submit([this]() { m_unixSocket.close(); });
+    }
     return m_httpClient->connect(url);
 }
 
+std::expected<void, McpError> McpHttpClient::connectUnix(const std::string& address) {
+    m_serverUrl = address;
+    m_unixPath = McpUnixSocket::socketPath(address);
+    if (!m_unixWorker) {
+        m_unixWorker = std::make_unique<McpComputePool>(1);
+    }
+    bindSchedulers();
+
+    auto socket = McpUnixSocket::connect(m_unixPath);
+    if (!socket) {
+        return std::unexpected(socket.error());
+    }
+    // 套接字归 Unix 域套接字线程所有，等之前提交的收发结束后再替换
+    auto replaced = McpWakeSignal::create();
+    m_unixWorker->submit([this, &socket]() {
+        m_unixSocket = std::move(socket.value());
+        m_unixReadTimeoutSet = false;
+    }, replaced);
+    replaced->block();
+    m_connected = true;
+    return {};
+}
+
 Coroutine McpHttpClient::initialize(std::string clientName,
                                     std::string clientVersion,
                                     std::expected<void, McpError>& result) {
@@ -101,6 +518,10 @@ Coroutine McpHttpClient::initialize(std::string clientName,
     params.clientInfo.version = m_clientVersion;
     params.capabilities = EmptyObjectString();
 
+    // 新会话的 id 由本次响应分配
+    m_session->setId({});
+    m_lastEventId = 0;
+
     std::expected<JsonString, McpError> response;
     co_await sendRequest(Methods::INITIALIZE, params.toJson(), response);
 
@@ -134,6 +555,13 @@ Coroutine McpHttpClient::initialize(std::string clientName,
 Coroutine McpHttpClient::callTool(std::string toolName,
                                   JsonString arguments,
                                   std::expected<JsonString, McpError>& result) {
+    co_await callTool(std::move(toolName), std::move(arguments), McpCallOptions{}, result);
+}
+
+Coroutine McpHttpClient::callTool(std::string toolName,
+                                  JsonString arguments,
+                                  McpCallOptions options,
+                                  std::expected<JsonString, McpError>& result) {
     if (!m_initialized) {
         result = std::unexpected(McpError::notInitialized());
         co_return;
@@ -144,7 +572,7 @@ Coroutine McpHttpClient::callTool(std::string toolName,
     params.arguments = arguments.empty() ? EmptyObjectString() : std::move(arguments);
 
     std::expected<JsonString, McpError> response;
-    co_await sendRequest(Methods::TOOLS_CALL, params.toJson(), response);
+    co_await sendRequest(Methods::TOOLS_CALL, params.toJson(), response, options);
 
     if (!response) {
         result = std::unexpected(response.error());
@@ -169,7 +597,7 @@ Coroutine McpHttpClient::callTool(std::string toolName,
         co_return;
     }
     if (callResult.content.empty()) {
-        result = EmptyObjectString();
+        result = callResult.structuredContent.empty() ? EmptyObjectString() : callResult.structuredContent;
         co_return;
     }
     if (callResult.content[0].type == ContentType::Text) {
@@ -181,48 +609,120 @@ Coroutine McpHttpClient::callTool(std::string toolName,
     co_return;
 }
 
-Coroutine McpHttpClient::listTools(std::expected<std::vector<Tool>, McpError>& result) {
+Coroutine McpHttpClient::callToolStructured(std::string toolName,
+                                            JsonString arguments,
+                                            McpCallOptions options,
+                                            std::expected<StructuredToolResult, McpError>& result) {
     if (!m_initialized) {
         result = std::unexpected(McpError::notInitialized());
         co_return;
     }
 
-    std::expected<JsonString, McpError> response;
-    co_await sendRequest(Methods::TOOLS_LIST, EmptyObjectString(), response);
+    ToolCallParams params;
+    params.name = std::move(toolName);
+    params.arguments = arguments.empty() ? EmptyObjectString() : std::move(arguments);
 
+    std::expected<JsonString, McpError> response;
+    co_await sendRequest(Methods::TOOLS_CALL, params.toJson(), response, options);
     if (!response) {
         result = std::unexpected(response.error());
         co_return;
     }
-
-    result = parseListField<Tool>(
-        response.value(),
-        "tools",
-        [](const JsonElement& item) { return Tool::fromJson(item); });
+    result = StructuredToolResult::parse(response.value());
     co_return;
 }
 
-Coroutine McpHttpClient::listResources(std::expected<std::vector<Resource>, McpError>& result) {
+template <typename T>
+Coroutine McpHttpClient::requestListPage(std::string_view method,
+                                         const char* field,
+                                         std::string cursor,
+                                         std::string ifChangedSince,
+                                         std::expected<ListPage<T>, McpError>& result) {
     if (!m_initialized) {
         result = std::unexpected(McpError::notInitialized());
         co_return;
     }
 
     std::expected<JsonString, McpError> response;
-    co_await sendRequest(Methods::RESOURCES_LIST, EmptyObjectString(), response);
+    co_await sendRequest(method, listParams(cursor, ifChangedSince), response);
 
     if (!response) {
         result = std::unexpected(response.error());
         co_return;
     }
 
-    result = parseListField<Resource>(
+    result = parseListPage<T>(
         response.value(),
-        "resources",
-        [](const JsonElement& item) { return Resource::fromJson(item); });
+        field,
+        [](const JsonElement& item) { return T::fromJson(item); });
     co_return;
 }
 
+template <typename T>
+Coroutine McpHttpClient::syncList(std::string_view method,
+                                  const char* field,
+                                  std::expected<std::vector<T>, McpError>& result) {
+    const std::string server = m_unixPath.empty() ? m_serverUrl : "unix:" + m_unixPath;
+    std::optional<McpCachedList<T>> cached = m_listCache->find<T>(server);
+
+    std::expected<ListPage<T>, McpError> page;
+    co_await requestListPage<T>(method, field, "", cached ? cached->version : "", page);
+    if (!page) {
+        result = std::unexpected(page.error());
+        co_return;
+    }
+
+    std::vector<T> values;
+    const std::string version = page->version;
+    if (cached && page->notModified) {
+        values = std::move(cached->items);
+    } else if (cached && page->delta) {
+        values = ApplyListDelta(std::move(cached->items), page.value());
+    } else {
+        // 完整结果：服务端分页时沿 nextCursor 取完
+        std::string cursor;
+        while (true) {
+            auto next = appendPage(values, page.value(), cursor);
+            if (!next) {
+                result = std::unexpected(next.error());
+                co_return;
+            }
+            cursor = std::move(next.value());
+            if (cursor.empty()) {
+                break;
+            }
+            co_await requestListPage<T>(method, field, cursor, "", page);
+            if (!page) {
+                result = std::unexpected(page.error());
+                co_return;
+            }
+        }
+    }
+
+    // 翻页期间列表若有变化，以第一页的版本保存：下次的增量会补上这之后的全部改动
+    if (!version.empty()) {
+        m_listCache->store<T>(server, McpCachedList<T>{version, values});
+    }
+    result = std::move(values);
+    co_return;
+}
+
+Coroutine McpHttpClient::listTools(std::expected<std::vector<Tool>, McpError>& result) {
+    co_await syncList<Tool>(Methods::TOOLS_LIST, "tools", result);
+}
+
+Coroutine McpHttpClient::listToolsPage(std::string cursor, std::expected<ListPage<Tool>, McpError>& result) {
+    co_await requestListPage<Tool>(Methods::TOOLS_LIST, "tools", std::move(cursor), "", result);
+}
+
+Coroutine McpHttpClient::listResources(std::expected<std::vector<Resource>, McpError>& result) {
+    co_await syncList<Resource>(Methods::RESOURCES_LIST, "resources", result);
+}
+
+Coroutine McpHttpClient::listResourcesPage(std::string cursor, std::expected<ListPage<Resource>, McpError>& result) {
+    co_await requestListPage<Resource>(Methods::RESOURCES_LIST, "resources", std::move(cursor), "", result);
+}
+
 Coroutine McpHttpClient::readResource(std::string uri,
                                       std::expected<std::string, McpError>& result) {
     if (!m_initialized) {
@@ -249,24 +749,11 @@ Coroutine McpHttpClient::readResource(std::string uri,
 }
 
 Coroutine McpHttpClient::listPrompts(std::expected<std::vector<Prompt>, McpError>& result) {
-    if (!m_initialized) {
-        result = std::unexpected(McpError::notInitialized());
-        co_return;
-    }
-
-    std::expected<JsonString, McpError> response;
-    co_await sendRequest(Methods::PROMPTS_LIST, EmptyObjectString(), response);
-
-    if (!response) {
-        result = std::unexpected(response.error());
-        co_return;
-    }
+    co_await syncList<Prompt>(Methods::PROMPTS_LIST, "prompts", result);
+}
 
-    result = parseListField<Prompt>(
-        response.value(),
-        "prompts",
-        [](const JsonElement& item) { return Prompt::fromJson(item); });
-    co_return;
+Coroutine McpHttpClient::listPromptsPage(std::string cursor, std::expected<ListPage<Prompt>, McpError>& result) {
+    co_await requestListPage<Prompt>(Methods::PROMPTS_LIST, "prompts", std::move(cursor), "", result);
 }
 
 Coroutine McpHttpClient::getPrompt(std::string name,
@@ -318,110 +805,527 @@ Coroutine McpHttpClient::ping(std::expected<void, McpError>& result) {
 }
 
 McpHttpClient::CloseAwaitable McpHttpClient::disconnect() {
+    closeEventStream();
+    m_session->setId({});
     m_initialized = false;
     m_connected = false;
+    if (m_unixWorker) {
+        m_unixWorker->submit([this]() { m_unixSocket.close(); });
+    }
+    {
+        // 仍在收发的池化连接由对应任务持有，完成后随任务释放
+        std::lock_guard<std::mutex> lock(m_poolMutex);
+        m_pool.clear();
+    }
     return m_httpClient->close();
 }
 
+McpClientCallStats McpHttpClient::callStats() const {
+    McpClientCallStats stats;
+    stats.attempts = m_attempts.load(std::memory_order_relaxed);
+    stats.retries = m_retries.load(std::memory_order_relaxed);
+    stats.hedged = m_hedged.load(std::memory_order_relaxed);
+    stats.hedgeWins = m_hedgeWins.load(std::memory_order_relaxed);
+    stats.timeouts = m_timeouts.load(std::memory_order_relaxed);
+    return stats;
+}
+
 Coroutine McpHttpClient::sendRequest(std::string_view method,
                                      std::optional<JsonString> params,
-                                     std::expected<JsonString, McpError>& result) {
+                                     std::expected<JsonString, McpError>& result,
+                                     McpCallOptions options) {
     const int64_t requestId = generateRequestId();
-    const std::optional<std::string_view> params_view =
-        params.has_value() ? std::optional<std::string_view>(*params) : std::nullopt;
-    std::string requestBody = protocol::makeJsonRpcRequestBody(requestId, method, params_view);
+    const std::chrono::milliseconds timeout =
+        options.timeout.count() > 0 ? options.timeout : m_options.defaultTimeout;
+    std::optional<Clock::time_point> deadline;
+    if (timeout.count() > 0) {
+        deadline = Clock::now() + timeout;
+    }
+    const bool idempotent = options.idempotent || isIdempotentMethod(method);
+    const size_t maxAttempts = idempotent ? std::max<size_t>(m_options.retry.maxAttempts, 1) : 1;
+    const bool hedge = idempotent && m_options.hedge.enabled && m_unixPath.empty();
+
+    for (size_t attempt = 0;; ++attempt) {
+        std::string requestBody;
+        if (deadline.has_value() || !options.progressToken.empty()) {
+            // 每次尝试按剩余时间告知服务端
+            std::optional<std::chrono::milliseconds> remaining;
+            if (deadline.has_value()) {
+                const int64_t remainingMs = RemainingMs(*deadline);
+                if (remainingMs == 0) {
+                    m_timeouts.fetch_add(1, std::memory_order_relaxed);
+                    result = std::unexpected(McpError::timeout(std::string(method)));
+                    co_return;
+                }
+                remaining = std::chrono::milliseconds(remainingMs);
+            }
+            const JsonString metaParams = protocol::withRequestMeta(
+                params.has_value() ? std::string_view(*params) : std::string_view(),
+                remaining, options.progressToken);
+            requestBody = protocol::makeJsonRpcRequestBody(requestId, method, metaParams);
+        } else {
+            const std::optional<std::string_view> params_view =
+                params.has_value() ? std::optional<std::string_view>(*params) : std::nullopt;
+            requestBody = protocol::makeJsonRpcRequestBody(requestId, method, params_view);
+        }
 
-    // 如果连接断开，重新连接
-    if (!m_connected.load()) {
-        auto connectResult = co_await m_httpClient->connect(m_serverUrl);
-        if (!connectResult) {
-            result = std::unexpected(McpError::connectionError(connectResult.error().message()));
+        m_attempts.fetch_add(1, std::memory_order_relaxed);
+        if (!m_unixPath.empty()) {
+            co_await exchangeUnixAsync(requestId, std::move(requestBody), deadline, result);
+        } else if (deadline.has_value() || hedge) {
+            co_await exchangePooled(requestId, std::move(requestBody), deadline, hedge, result);
+        } else {
+            const Clock::time_point start = Clock::now();
+            co_await PostJsonRpc(*m_httpClient, m_serverUrl, m_connected, requestId, requestBody, *m_session, result);
+            if (result) {
+                m_latency->record(Clock::now() - start);
+            }
+        }
+
+        if (result || attempt + 1 >= maxAttempts || !isRetryableError(result.error())) {
             co_return;
         }
-        m_connected = true;
+        const std::chrono::milliseconds backoff = retryBackoff(m_options.retry, attempt, m_rng);
+        if (deadline.has_value() && Clock::now() + backoff >= *deadline) {
+            co_return;
+        }
+        m_retries.fetch_add(1, std::memory_order_relaxed);
+        if (backoff.count() > 0) {
+            co_await kernel::sleep(backoff);
+        }
     }
+}
 
-    // 发送POST请求
-    auto session = m_httpClient->getSession();
-    auto awaitable = session.post(
-        m_httpClient->url().path,
-        requestBody,
-        "application/json",
-        {
-            {"Host", m_httpClient->url().host + ":" + std::to_string(m_httpClient->url().port)},
-            {"Content-Type", "application/json"}
+Coroutine McpHttpClient::exchangePooled(int64_t requestId,
+                                        std::string requestBody,
+                                        std::optional<Clock::time_point> deadline,
+                                        bool hedge,
+                                        std::expected<JsonString, McpError>& result) {
+    auto timedOut = [&]() {
+        return deadline.has_value() && Clock::now() >= *deadline;
+    };
+    bindSchedulers();
+
+    // 副本完成、连接空闲、对冲时刻与截止时间都通知同一个唤醒点，醒来后重新检查
+    auto wake = McpWakeSignal::create();
+    if (deadline.has_value()) {
+        McpWakeSignal::notifyAt(wake, *deadline);
+    }
+
+    // 池满且全部忙（例如上一请求超时后仍在等待服务端应答）时等待空闲连接
+    std::shared_ptr<PooledConnection> connection = acquireConnection();
+    while (!connection) {
+        if (timedOut()) {
+            m_timeouts.fetch_add(1, std::memory_order_relaxed);
+            result = std::unexpected(McpError::timeout("No idle connection"));
+            co_return;
         }
-    );
+        // 先登记再重试，两者之间释放的连接也会通知
+        m_poolIdle->wait(wake);
+        connection = acquireConnection();
+        if (!connection) {
+            co_await McpSchedulerExecutor::wait(wake);
+            connection = acquireConnection();
+        }
+    }
+
+    auto primary = std::make_shared<Attempt>();
+    primary->wake = wake;
+    if (!launchAttempt(connection, requestId, requestBody, primary)) {
+        result = std::unexpected(McpError::connectionError("Failed to schedule request"));
+        co_return;
+    }
+
+    std::shared_ptr<Attempt> hedged;
+    std::optional<Clock::time_point> hedgeAt;
+    if (hedge) {
+        hedgeAt = Clock::now() + hedgeDelay();
+        McpWakeSignal::notifyAt(wake, *hedgeAt);
+    }
 
-    // 循环等待直到完成
     while (true) {
-        auto httpResult = co_await awaitable;
+        const bool primaryDone = primary->done.load(std::memory_order_acquire);
+        const bool hedgedDone = hedged && hedged->done.load(std::memory_order_acquire);
+        // 取先返回的成功结果；一个副本失败时继续等待另一个。仍在执行的落选副本经取消通知结束
+        if (primaryDone && (primary->result || !hedged || hedgedDone)) {
+            if (!primary->result && hedgedDone && hedged->result) {
+                m_hedgeWins.fetch_add(1, std::memory_order_relaxed);
+                result = std::move(hedged->result);
+            } else {
+                result = std::move(primary->result);
+            }
+            if (hedged && !hedgedDone) {
+                cancelAttempt(requestId);
+            }
+            co_return;
+        }
+        if (hedgedDone && (hedged->result || primaryDone)) {
+            if (hedged->result) {
+                m_hedgeWins.fetch_add(1, std::memory_order_relaxed);
+                result = std::move(hedged->result);
+            } else {
+                result = std::move(primary->result);
+            }
+            if (!primaryDone) {
+                cancelAttempt(requestId);
+            }
+            co_return;
+        }
 
-        if (!httpResult) {
-            m_connected = false;
-            result = std::unexpected(McpError::connectionError(httpResult.error().message()));
+        if (timedOut()) {
+            // 未完成的副本继续占用各自的连接，直到服务端按 timeoutMs 应答
+            m_timeouts.fetch_add(1, std::memory_order_relaxed);
+            result = std::unexpected(McpError::timeout());
             co_return;
         }
 
-        if (!httpResult.value()) {
-            continue;
+        if (hedgeAt.has_value() && !hedged && Clock::now() >= *hedgeAt) {
+            hedgeAt.reset();
+            std::shared_ptr<PooledConnection> second = acquireConnection();
+            if (second) {
+                auto attempt = std::make_shared<Attempt>();
+                attempt->wake = wake;
+                if (launchAttempt(second, requestId, requestBody, attempt)) {
+                    hedged = std::move(attempt);
+                    m_attempts.fetch_add(1, std::memory_order_relaxed);
+                    m_hedged.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
         }
 
-        auto response = httpResult.value().value();
+        co_await McpSchedulerExecutor::wait(wake);
+    }
+}
 
-        // 根据响应头判断是否需要关闭连接
-        if (response.header().isConnectionClose() || !response.header().isKeepAlive()) {
-            m_connected = false;
+std::shared_ptr<McpHttpClient::PooledConnection> McpHttpClient::acquireConnection() {
+    std::lock_guard<std::mutex> lock(m_poolMutex);
+    for (const auto& connection : m_pool) {
+        bool expected = false;
+        if (connection->busy.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+            return connection;
         }
+    }
+    if (m_pool.size() >= std::max<size_t>(m_options.maxConnections, 1)) {
+        return nullptr;
+    }
+    auto* scheduler = m_runtime.getNextIOScheduler();
+    if (!scheduler) {
+        return nullptr;
+    }
+    auto connection = std::make_shared<PooledConnection>();
+    connection->scheduler = scheduler;
+    connection->idle = m_poolIdle;
+    connection->busy = true;
+    m_pool.push_back(connection);
+    return connection;
+}
 
-        // 检查HTTP状态码
-        if (response.header().code() != http::HttpStatusCode::OK_200) {
-            result = std::unexpected(McpError::connectionError(
-                "HTTP error: " + std::to_string(static_cast<int>(response.header().code()))));
-            co_return;
+bool McpHttpClient::launchAttempt(const std::shared_ptr<PooledConnection>& connection,
+                                  int64_t requestId,
+                                  const std::string& requestBody,
+                                  const std::shared_ptr<Attempt>& attempt) {
+    if (!scheduleTask(connection->scheduler,
+                      runAttempt(connection, m_serverUrl, requestId, requestBody, attempt, m_latency, m_session))) {
+        connection->busy.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+Coroutine McpHttpClient::runAttempt(std::shared_ptr<PooledConnection> connection,
+                                    std::string serverUrl,
+                                    int64_t requestId,
+                                    std::string requestBody,
+                                    std::shared_ptr<Attempt> attempt,
+                                    std::shared_ptr<McpLatencyTracker> latency,
+                                    std::shared_ptr<SessionState> session) {
+    const Clock::time_point start = Clock::now();
+    std::expected<JsonString, McpError> result;
+    co_await PostJsonRpc(*connection->client, serverUrl, connection->connected, requestId, requestBody,
+                         *session, result);
+    if (result) {
+        latency->record(Clock::now() - start);
+    }
+    attempt->result = std::move(result);
+    connection->busy.store(false, std::memory_order_release);
+    attempt->done.store(true, std::memory_order_release);
+    connection->idle->notifyAll();
+    if (attempt->wake) {
+        attempt->wake->notify();
+    }
+}
+
+void McpHttpClient::bindSchedulers() {
+    std::call_once(m_bindOnce, [this]() { McpSchedulerExecutor::bindRuntime(m_runtime); });
+}
+
+void McpHttpClient::cancelAttempt(int64_t requestId) {
+    // 服务端按 (会话, id) 匹配取消，胜出的副本已应答，仍在执行的只有落选副本。
+    // 没有会话时调用按连接登记，而落选副本的连接正在等待应答，通知无法送达，只能等服务端按 timeoutMs 结束
+    if (m_session->id().empty()) {
+        return;
+    }
+    std::shared_ptr<PooledConnection> connection = acquireConnection();
+    if (!connection) {
+        return;
+    }
+    JsonWriter params;
+    params.StartObject();
+    params.Key("requestId");
+    params.Number(requestId);
+    params.Key("reason");
+    params.String("hedged request lost");
+    params.EndObject();
+    JsonRpcNotification notification;
+    notification.method = Methods::CANCELLED;
+    notification.params = params.TakeString();
+    // 通知没有 JSON-RPC 应答，副本结果无人读取
+    launchAttempt(connection, requestId, notification.toJson(), std::make_shared<Attempt>());
+}
+
+McpHttpClient::Clock::duration McpHttpClient::hedgeDelay() const {
+    const McpHedgePolicy& policy = m_options.hedge;
+    Clock::duration delay = policy.fallbackDelay;
+    if (auto observed = m_latency->quantile(policy.quantile, policy.minSamples)) {
+        delay = *observed;
+    }
+    return std::max<Clock::duration>(delay, policy.minDelay);
+}
+
+Coroutine McpHttpClient::exchangeUnixAsync(int64_t requestId,
+                                           std::string requestBody,
+                                           std::optional<Clock::time_point> deadline,
+                                           std::expected<JsonString, McpError>& result) {
+    // 阻塞的写出与读取在 Unix 域套接字线程上执行，完成时唤醒本协程回到原 IO 调度器
+    auto exchanged = std::make_shared<Attempt>();
+    auto wake = McpWakeSignal::create();
+    m_unixWorker->submit([this, exchanged, requestId, body = std::move(requestBody), deadline]() {
+        try {
+            exchanged->result = exchangeUnix(requestId, body, deadline);
+        } catch (const std::exception& e) {
+            exchanged->result = std::unexpected(McpError::connectionError(e.what()));
         }
+        exchanged->done.store(true, std::memory_order_release);
+    }, wake);
+    while (!exchanged->done.load(std::memory_order_acquire)) {
+        co_await McpSchedulerExecutor::wait(wake);
+    }
+    result = std::move(exchanged->result);
+    co_return;
+}
 
-        // 解析响应
-        std::string responseBody = response.getBodyStr();
-        auto parsed = parseJsonRpcResponse(responseBody);
-        if (!parsed) {
-            result = std::unexpected(McpError::parseError(parsed.error().details()));
-            co_return;
+std::expected<JsonString, McpError> McpHttpClient::exchangeUnix(int64_t requestId,
+                                                                const std::string& requestBody,
+                                                                std::optional<Clock::time_point> deadline) {
+    // 如果连接断开，重新连接
+    if (!m_unixSocket.isOpen()) {
+        auto socket = McpUnixSocket::connect(m_unixPath);
+        if (!socket) {
+            return std::unexpected(McpError::connectionError(socket.error().details()));
         }
+        m_unixSocket = std::move(socket.value());
+        m_unixReadTimeoutSet = false;
+        m_connected = true;
+    }
 
-        const auto& view = parsed.value().response;
-        if (view.id != requestId) {
-            result = std::unexpected(McpError::invalidResponse("Mismatched response id"));
-            co_return;
+    // 本机往返不做对冲，截止时间通过读超时实现
+    if (deadline.has_value()) {
+        const int64_t remainingMs = RemainingMs(*deadline);
+        if (remainingMs == 0) {
+            m_timeouts.fetch_add(1, std::memory_order_relaxed);
+            return std::unexpected(McpError::timeout());
         }
-        if (view.hasError) {
-            auto errorExp = JsonRpcError::fromJson(view.error);
-            if (!errorExp) {
-                result = std::unexpected(McpError::parseError(errorExp.error().message()));
-                co_return;
-            }
-            const auto& error = errorExp.value();
-            std::string details;
-            if (error.data.has_value()) {
-                details = error.data.value();
-            }
-            result = std::unexpected(McpError::fromJsonRpcError(
-                error.code, error.message, details));
-            co_return;
+        auto timeoutSet = m_unixSocket.setReadTimeout(std::chrono::milliseconds(remainingMs));
+        if (!timeoutSet) {
+            return std::unexpected(timeoutSet.error());
+        }
+        m_unixReadTimeoutSet = true;
+    } else if (m_unixReadTimeoutSet) {
+        auto timeoutCleared = m_unixSocket.setReadTimeout(std::chrono::milliseconds(0));
+        if (!timeoutCleared) {
+            return std::unexpected(timeoutCleared.error());
         }
+        m_unixReadTimeoutSet = false;
+    }
 
-        if (view.hasResult) {
-            std::string raw;
-            if (JsonHelper::GetRawJson(view.result, raw)) {
-                result = std::move(raw);
-            } else {
-                result = std::unexpected(McpError::parseError("Failed to parse result"));
+    const std::string contentLength = std::to_string(requestBody.size());
+    const std::string sessionId = m_session->id();
+    std::string wireBytes;
+    wireBytes.reserve(requestBody.size() + contentLength.size() + sessionId.size() + 160);
+    wireBytes += "POST /mcp HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nAccept: ";
+    wireBytes += kAcceptHeader;
+    if (!sessionId.empty()) {
+        wireBytes += "\r\nMcp-Session-Id: ";
+        wireBytes += sessionId;
+    }
+    wireBytes += "\r\nContent-Length: ";
+    wireBytes += contentLength;
+    wireBytes += "\r\n\r\n";
+    wireBytes += requestBody;
+
+    auto written = m_unixSocket.writeAll(wireBytes);
+    if (!written) {
+        m_unixSocket.close();
+        m_connected = false;
+        return std::unexpected(McpError::connectionError(written.error().details()));
+    }
+
+    auto response = m_unixSocket.readHttpMessage();
+    if (!response) {
+        m_unixSocket.close();
+        m_connected = false;
+        if (response.error().code() == McpErrorCode::ConnectionTimeout) {
+            m_timeouts.fetch_add(1, std::memory_order_relaxed);
+            return std::unexpected(response.error());
+        }
+        return std::unexpected(McpError::connectionError(response.error().details()));
+    }
+    if (!response.value().keepAlive) {
+        m_unixSocket.close();
+        m_connected = false;
+    }
+
+    const std::string code = StatusCode(response.value().startLine);
+    if (code == "404" && !sessionId.empty()) {
+        m_session->setId({});
+        return std::unexpected(McpError::connectionError("Session not found"));
+    }
+    if (code != "200") {
+        return std::unexpected(McpError::connectionError("HTTP error: " + code));
+    }
+
+    const std::string_view issuedSessionId = response.value().header("Mcp-Session-Id");
+    if (!issuedSessionId.empty()) {
+        m_session->setId(std::string(issuedSessionId));
+    }
+    return parseResponseBody(requestId, response.value().header("Content-Type"), response.value().body, *m_session);
+}
+
+std::expected<void, McpError> McpHttpClient::openEventStream() {
+    if (m_eventThread.joinable()) {
+        return {};
+    }
+    if (m_session->id().empty()) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    EventStreamTarget target;
+    if (!m_unixPath.empty()) {
+        target.unixPath = m_unixPath;
+    } else {
+        const auto& url = m_httpClient->url();
+        target.host = url.host;
+        target.port = url.port;
+        target.path = url.path;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        m_eventStop = false;
+    }
+    m_eventThread = std::thread(&McpHttpClient::runEventStream, this, std::move(target));
+    return {};
+}
+
+void McpHttpClient::closeEventStream() {
+    {
+        // 唤醒阻塞在读取上的事件流线程
+        std::lock_guard<std::mutex> lock(m_eventMutex);
+        m_eventStop = true;
+        if (m_eventFd >= 0) {
+            ::shutdown(m_eventFd, SHUT_RDWR);
+        }
+    }
+    m_eventWake.notify_all();
+    if (m_eventThread.joinable()) {
+        m_eventThread.join();
+    }
+}
+
+void McpHttpClient::runEventStream(EventStreamTarget target) {
+    std::chrono::milliseconds retryDelay = kEventStreamRetry;
+    while (true) {
+        auto socket = target.unixPath.empty() ? McpUnixSocket::connectTcp(target.host, target.port)
+                                              : McpUnixSocket::connect(target.unixPath);
+        bool sessionEnded = false;
+        if (socket) {
+            {
+                std::lock_guard<std::mutex> lock(m_eventMutex);
+                if (m_eventStop) {
+                    return;
+                }
+                m_eventFd = socket.value().fd();
             }
-        } else {
-            result = EmptyObjectString();
+            sessionEnded = readEventStream(socket.value(), target, retryDelay);
+            std::lock_guard<std::mutex> lock(m_eventMutex);
+            m_eventFd = -1;
+        }
+        if (sessionEnded) {
+            return;
         }
 
-        co_return;
+        std::unique_lock<std::mutex> lock(m_eventMutex);
+        if (m_eventWake.wait_for(lock, retryDelay, [this]() { return m_eventStop; })) {
+            return;
+        }
+    }
+}
+
+bool McpHttpClient::readEventStream(McpUnixSocket& socket,
+                                    const EventStreamTarget& target,
+                                    std::chrono::milliseconds& retryDelay) {
+    const std::string sessionId = m_session->id();
+    if (sessionId.empty()) {
+        return true;
+    }
+
+    std::string request = "GET ";
+    request += target.path.empty() ? std::string("/mcp") : target.path;
+    request += " HTTP/1.1\r\nHost: ";
+    request += target.unixPath.empty() ? target.host + ":" + std::to_string(target.port) : std::string("localhost");
+    request += "\r\nAccept: text/event-stream\r\nMcp-Session-Id: ";
+    request += sessionId;
+    // 续传：服务端从回放缓冲中补发该 id 之后的事件
+    const uint64_t lastEventId = m_lastEventId.load(std::memory_order_relaxed);
+    if (lastEventId > 0) {
+        request += "\r\nLast-Event-ID: ";
+        request += std::to_string(lastEventId);
+    }
+    request += "\r\n\r\n";
+    if (!socket.writeAll(request)) {
+        return false;
+    }
+
+    auto head = socket.readHttpHead();
+    if (!head) {
+        return false;
+    }
+    const std::string code = StatusCode(head.value().startLine);
+    if (code == "404" || code == "400") {
+        return true;
+    }
+    if (code != "200" || !head.value().chunked) {
+        return false;
+    }
+
+    McpSseParser parser;
+    std::vector<McpSseEvent> events;
+    while (true) {
+        auto chunk = socket.readChunk();
+        if (!chunk || chunk.value().empty()) {
+            return false;
+        }
+        events.clear();
+        parser.feed(chunk.value(), events);
+        for (const McpSseEvent& event : events) {
+            if (auto id = sse::parseEventId(event.id)) {
+                m_lastEventId.store(*id, std::memory_order_relaxed);
+            }
+            DispatchNotification(event.data, *m_session);
+        }
+        if (auto retry = parser.retry()) {
+            retryDelay = std::chrono::milliseconds(*retry);
+        }
     }
 }
 
@@ -1,15 +1,26 @@
 #ifndef GALAY_MCP_CLIENT_MCPHTTPCLIENT_H
 #define GALAY_MCP_CLIENT_MCPHTTPCLIENT_H
 
+#include "galay-mcp/client/McpCallPolicy.h"
+#include "galay-mcp/client/McpListCache.h"
 #include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpComputePool.h"
 #include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpUnixSocket.h"
 #include "galay-http/kernel/http/HttpClient.h"
 #include "galay-kernel/kernel/Runtime.h"
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <random>
 #include <string>
 #include <string_view>
 #include <memory>
+#include <thread>
 #include <utility>
+#include <vector>
 
 namespace galay {
 namespace mcp {
@@ -19,12 +30,24 @@ namespace mcp {
  *
  * 该类实现了MCP协议的客户端，通过HTTP POST请求发送JSON-RPC消息。
  * 需要co_await的接口返回Coroutine，简单接口直接返回结果。
+ * 本机 sidecar 可改用 connectUnix() 走 Unix 域套接字，其余接口用法不变。
+ *
+ * setOptions() 可配置调用超时、幂等请求的重试与对冲。带超时或对冲的 HTTP 请求
+ * 在内部连接池上执行，调用协程以 1ms 间隔等待结果，超时后立即返回 ConnectionTimeout；
+ * 超时信息同时通过 params._meta.timeoutMs 发给服务端，使服务端在同一时刻取消。
+ *
+ * Streamable HTTP：请求声明 Accept: application/json, text/event-stream，服务端以 SSE 响应时
+ * 其中的通知（例如进度）交给 setNotificationHandler() 设置的处理函数，最终响应照常返回。
+ * initialize 响应中的 Mcp-Session-Id 随之后的请求发送；openEventStream() 在后台线程上
+ * 打开 GET 会话事件流接收服务端主动发送的通知，断线后带 Last-Event-ID 自动重连续传。
  */
 class McpHttpClient {
 public:
     using ConnectAwaitable =
         decltype(std::declval<http::HttpClient&>().connect(std::declval<const std::string&>()));
     using CloseAwaitable = decltype(std::declval<http::HttpClient&>().close());
+    // 收到服务端通知：method 与 params 原始 JSON（没有 params 时为空串）
+    using NotificationHandler = std::function<void(const std::string& method, const JsonString& params)>;
 
     explicit McpHttpClient(kernel::Runtime& runtime);
     ~McpHttpClient();
@@ -40,6 +63,48 @@ public:
      */
     ConnectAwaitable connect(const std::string& url);
 
+    /**
+     * @brief 连接 Unix 域套接字上的服务器（同步完成）
+     * @param address "unix:/run/mcp.sock" 或套接字路径
+     * @note 之后的请求由客户端的 Unix 域套接字线程阻塞收发，调用协程挂起等待、不占用 IO 调度器，
+     *       同一连接上的请求依次收发；disconnect() 仍按原方式 co_await
+     */
+    std::expected<void, McpError> connectUnix(const std::string& address);
+
+    /**
+     * @brief 设置超时、重试与对冲策略
+     * @note 在发出请求之前调用
+     */
+    void setOptions(const McpHttpClientOptions& options) { m_options = options; }
+    const McpHttpClientOptions& options() const { return m_options; }
+
+    /**
+     * @brief 使用共享的列表缓存（默认每个客户端各有一个）
+     * @note 缓存按服务端地址区分；同一进程内重建客户端后重新连接时，list*() 沿用缓存的版本
+     */
+    void setListCache(std::shared_ptr<McpListCache> cache) { m_listCache = std::move(cache); }
+    const std::shared_ptr<McpListCache>& listCache() const { return m_listCache; }
+
+    /**
+     * @brief 设置服务端通知的处理函数
+     * @note SSE 响应中的通知在发起请求的线程上调用，会话事件流中的通知在事件流线程上调用
+     */
+    void setNotificationHandler(NotificationHandler handler);
+
+    /**
+     * @brief 打开 GET /mcp 会话事件流（后台线程，同步返回）
+     * @return 服务端没有在 initialize 时分配会话返回 NotInitialized
+     * @note 会话被服务端结束（404）后事件流线程退出；disconnect() 与析构时自动关闭
+     */
+    std::expected<void, McpError> openEventStream();
+    void closeEventStream();
+
+    // initialize 时服务端分配的会话 id；服务端未分配时为空
+    std::string sessionId() const;
+
+    // 会话事件流已收到的最后一个事件 id
+    uint64_t lastEventId() const { return m_lastEventId.load(std::memory_order_relaxed); }
+
     /**
      * @brief 初始化连接（协程，内部需要co_await发送请求）
      */
@@ -55,15 +120,44 @@ public:
                        std::expected<JsonString, McpError>& result);
 
     /**
-     * @brief 获取工具列表（协程）
+     * @brief 调用工具（协程），单独指定超时或声明幂等
+     */
+    Coroutine callTool(std::string toolName,
+                       JsonString arguments,
+                       McpCallOptions options,
+                       std::expected<JsonString, McpError>& result);
+
+    /**
+     * @brief 调用声明了 outputSchema 的工具（协程）
+     * @note 结果中的 structuredContent 随响应只解析一次，StructuredToolResult 直接指向它
+     */
+    Coroutine callToolStructured(std::string toolName,
+                                 JsonString arguments,
+                                 McpCallOptions options,
+                                 std::expected<StructuredToolResult, McpError>& result);
+
+    /**
+     * @brief 获取工具列表（协程）；服务端分页时依次取完所有页
+     * @note 带上列表缓存中的版本请求，服务端未变化或只返回增量时由缓存补全
      */
     Coroutine listTools(std::expected<std::vector<Tool>, McpError>& result);
 
     /**
-     * @brief 获取资源列表（协程）
+     * @brief 获取工具列表的一页（协程）；cursor 为上一页的 nextCursor，第一页为空
+     */
+    Coroutine listToolsPage(std::string cursor, std::expected<ListPage<Tool>, McpError>& result);
+
+    /**
+     * @brief 获取资源列表（协程）；服务端分页时依次取完所有页
+     * @note 带上列表缓存中的版本请求，服务端未变化或只返回增量时由缓存补全
      */
     Coroutine listResources(std::expected<std::vector<Resource>, McpError>& result);
 
+    /**
+     * @brief 获取资源列表的一页（协程）；cursor 为上一页的 nextCursor，第一页为空
+     */
+    Coroutine listResourcesPage(std::string cursor, std::expected<ListPage<Resource>, McpError>& result);
+
     /**
      * @brief 读取资源（协程）
      */
@@ -71,10 +165,16 @@ public:
                            std::expected<std::string, McpError>& result);
 
     /**
-     * @brief 获取提示列表（协程）
+     * @brief 获取提示列表（协程）；服务端分页时依次取完所有页
+     * @note 带上列表缓存中的版本请求，服务端未变化或只返回增量时由缓存补全
      */
     Coroutine listPrompts(std::expected<std::vector<Prompt>, McpError>& result);
 
+    /**
+     * @brief 获取提示列表的一页（协程）；cursor 为上一页的 nextCursor，第一页为空
+     */
+    Coroutine listPromptsPage(std::string cursor, std::expected<ListPage<Prompt>, McpError>& result);
+
     /**
      * @brief 获取提示（协程）
      */
@@ -97,12 +197,86 @@ public:
     bool isInitialized() const { return m_initialized.load(); }
     const ServerInfo& getServerInfo() const { return m_serverInfo; }
     const ServerCapabilities& getServerCapabilities() const { return m_serverCapabilities; }
+    McpClientCallStats callStats() const;
 
 private:
-    // 发送请求（协程）
+    using Clock = std::chrono::steady_clock;
+    struct PooledConnection;
+    struct PoolIdle;
+    struct Attempt;
+    struct SessionState;
+
+    // GET 事件流的连接目标：Unix 域套接字路径，或 TCP 主机、端口与路径
+    struct EventStreamTarget {
+        std::string unixPath;
+        std::string host;
+        int port = 0;
+        std::string path;
+    };
+
+    // 发送请求（协程），按 options 与 m_options 处理超时、重试与对冲
     Coroutine sendRequest(std::string_view method,
                           std::optional<JsonString> params,
-                          std::expected<JsonString, McpError>& result);
+                          std::expected<JsonString, McpError>& result,
+                          McpCallOptions options = {});
+
+    // 发送一次 list 请求并解析一页结果
+    template <typename T>
+    Coroutine requestListPage(std::string_view method,
+                              const char* field,
+                              std::string cursor,
+                              std::string ifChangedSince,
+                              std::expected<ListPage<T>, McpError>& result);
+
+    // 按列表缓存中的版本同步整张列表
+    template <typename T>
+    Coroutine syncList(std::string_view method,
+                       const char* field,
+                       std::expected<std::vector<T>, McpError>& result);
+
+    // 在连接池上完成一次请求/响应，支持截止时间与对冲副本
+    Coroutine exchangePooled(int64_t requestId,
+                             std::string requestBody,
+                             std::optional<Clock::time_point> deadline,
+                             bool hedge,
+                             std::expected<JsonString, McpError>& result);
+
+    // 在 Unix 域套接字线程上完成一次请求/响应，调用协程挂起等待
+    Coroutine exchangeUnixAsync(int64_t requestId,
+                                std::string requestBody,
+                                std::optional<Clock::time_point> deadline,
+                                std::expected<JsonString, McpError>& result);
+
+    // 经 Unix 域套接字同步完成一次请求/响应（只在 Unix 域套接字线程上调用）
+    std::expected<JsonString, McpError> exchangeUnix(int64_t requestId,
+                                                    const std::string& requestBody,
+                                                    std::optional<Clock::time_point> deadline);
+
+    // 取一条空闲的池化连接，池满且全部忙时返回 nullptr
+    std::shared_ptr<PooledConnection> acquireConnection();
+    // 把 m_runtime 的 IO 调度器线程绑定到各自的执行器（只做一次），使等待的协程由完成方投递回来恢复
+    void bindSchedulers();
+    // 对冲中落选的副本：经会话发送 notifications/cancelled，让服务端结束它并尽快释放其连接
+    void cancelAttempt(int64_t requestId);
+    bool launchAttempt(const std::shared_ptr<PooledConnection>& connection,
+                       int64_t requestId,
+                       const std::string& requestBody,
+                       const std::shared_ptr<Attempt>& attempt);
+    static Coroutine runAttempt(std::shared_ptr<PooledConnection> connection,
+                                std::string serverUrl,
+                                int64_t requestId,
+                                std::string requestBody,
+                                std::shared_ptr<Attempt> attempt,
+                                std::shared_ptr<McpLatencyTracker> latency,
+                                std::shared_ptr<SessionState> session);
+    Clock::duration hedgeDelay() const;
+
+    // 事件流线程：连接、读取事件并在断线后续传
+    void runEventStream(EventStreamTarget target);
+    // 在一条连接上读取事件流直到断开；会话已被服务端结束时返回 true
+    bool readEventStream(McpUnixSocket& socket,
+                         const EventStreamTarget& target,
+                         std::chrono::milliseconds& retryDelay);
 
     int64_t generateRequestId();
 
@@ -110,6 +284,9 @@ private:
     kernel::Runtime& m_runtime;
     std::unique_ptr<http::HttpClient> m_httpClient;
     std::string m_serverUrl;
+    std::string m_unixPath;
+    McpUnixSocket m_unixSocket;
+    bool m_unixReadTimeoutSet{false};
     std::string m_clientName;
     std::string m_clientVersion;
     ServerInfo m_serverInfo;
@@ -117,6 +294,35 @@ private:
     std::atomic<bool> m_connected{false};
     std::atomic<bool> m_initialized{false};
     std::atomic<int64_t> m_requestIdCounter{0};
+
+    McpHttpClientOptions m_options;
+    std::shared_ptr<McpListCache> m_listCache;
+    std::mutex m_poolMutex;
+    std::once_flag m_bindOnce;
+    std::vector<std::shared_ptr<PooledConnection>> m_pool;
+    std::shared_ptr<PoolIdle> m_poolIdle;
+    std::shared_ptr<McpLatencyTracker> m_latency;
+    std::mt19937_64 m_rng;
+
+    std::atomic<uint64_t> m_attempts{0};
+    std::atomic<uint64_t> m_retries{0};
+    std::atomic<uint64_t> m_hedged{0};
+    std::atomic<uint64_t> m_hedgeWins{0};
+    std::atomic<uint64_t> m_timeouts{0};
+
+    // 会话 id 与通知处理函数，池化请求所在的线程同样读取
+    std::shared_ptr<SessionState> m_session;
+
+    std::thread m_eventThread;
+    std::mutex m_eventMutex;
+    std::condition_variable m_eventWake;
+    bool m_eventStop{false};
+    int m_eventFd{-1};
+    std::atomic<uint64_t> m_lastEventId{0};
+
+    // Unix 域套接字线程：m_unixSocket 的收发与关闭都在这里串行执行；
+    // 首次 connectUnix() 时创建，最后声明以便析构时先执行完已提交的收发
+    std::unique_ptr<McpComputePool> m_unixWorker;
 };
 
 } // namespace mcp
@@ -0,0 +1,139 @@
+#include "galay-mcp/client/McpInProcessClient.h"
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+// 解析 JSON 文本参数；空串按空对象处理，与线路传输时的默认参数一致
+std::expected<JsonDocument, McpError> ParseArguments(const JsonString& arguments) {
+    auto docExp = JsonDocument::Parse(arguments.empty() ? std::string_view("{}") : std::string_view(arguments));
+    if (!docExp) {
+        return std::unexpected(McpError::parseError(docExp.error().details()));
+    }
+    return docExp;
+}
+
+} // namespace
+
+McpInProcessClient::McpInProcessClient(McpInProcessEndpoint& endpoint)
+    : m_initialized(false)
+    , m_endpoint(endpoint) {
+}
+
+McpInProcessClient::~McpInProcessClient() {
+    disconnect();
+}
+
+std::expected<void, McpError> McpInProcessClient::initialize(const std::string& clientName,
+                                                             const std::string& clientVersion) {
+    if (m_initialized) {
+        return std::unexpected(McpError::alreadyInitialized());
+    }
+
+    m_clientName = clientName;
+    m_clientVersion = clientVersion;
+
+    InitializeResult result = m_endpoint.localInitialize();
+    m_serverInfo = std::move(result.serverInfo);
+    m_serverCapabilities = std::move(result.capabilities);
+
+    m_initialized = true;
+    return {};
+}
+
+std::expected<JsonString, McpError> McpInProcessClient::callTool(const std::string& toolName,
+                                                                 const JsonString& arguments) {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    auto docExp = ParseArguments(arguments);
+    if (!docExp) {
+        return std::unexpected(docExp.error());
+    }
+
+    return m_endpoint.localCallTool(toolName, docExp.value().Root());
+}
+
+std::expected<JsonString, McpError> McpInProcessClient::callTool(const std::string& toolName,
+                                                                 const JsonElement& arguments) {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    return m_endpoint.localCallTool(toolName, arguments);
+}
+
+std::expected<std::vector<Tool>, McpError> McpInProcessClient::listTools() {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    return m_endpoint.localListTools();
+}
+
+std::expected<std::vector<Resource>, McpError> McpInProcessClient::listResources() {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    return m_endpoint.localListResources();
+}
+
+std::expected<std::string, McpError> McpInProcessClient::readResource(const std::string& uri) {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    return m_endpoint.localReadResource(uri);
+}
+
+std::expected<std::vector<Prompt>, McpError> McpInProcessClient::listPrompts() {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    return m_endpoint.localListPrompts();
+}
+
+std::expected<JsonString, McpError> McpInProcessClient::getPrompt(const std::string& name,
+                                                                  const JsonString& arguments) {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    auto docExp = ParseArguments(arguments);
+    if (!docExp) {
+        return std::unexpected(docExp.error());
+    }
+
+    return m_endpoint.localGetPrompt(name, docExp.value().Root());
+}
+
+std::expected<void, McpError> McpInProcessClient::ping() {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    return {};
+}
+
+void McpInProcessClient::disconnect() {
+    m_initialized = false;
+}
+
+bool McpInProcessClient::isInitialized() const {
+    return m_initialized;
+}
+
+const ServerInfo& McpInProcessClient::getServerInfo() const {
+    return m_serverInfo;
+}
+
+const ServerCapabilities& McpInProcessClient::getServerCapabilities() const {
+    return m_serverCapabilities;
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,145 @@
+#ifndef GALAY_MCP_CLIENT_MCPINPROCESSCLIENT_H
+#define GALAY_MCP_CLIENT_MCPINPROCESSCLIENT_H
+
+#include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpInProcessEndpoint.h"
+#include "galay-mcp/common/McpJson.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 同进程内直接绑定服务端注册表的MCP客户端
+ *
+ * 绑定 McpStdioServer 或 McpHttpServer（均实现 McpInProcessEndpoint）后，
+ * 调用不再构造 JSON-RPC 请求、不经过分帧与套接字：参数文档直接交给处理函数，
+ * 处理函数返回的字符串原样作为结果。
+ * initialize 前调用返回 NotInitialized，重复 initialize 返回 AlreadyInitialized；
+ * 工具 / 资源 / 提示不存在或处理函数失败时，返回与线路传输完全一致的 McpError。
+ *
+ * @note 绑定的服务端必须比客户端存活更久。
+ */
+class McpInProcessClient {
+public:
+    /**
+     * @param endpoint 要绑定的服务端，例如 McpStdioServer 或 McpHttpServer
+     */
+    explicit McpInProcessClient(McpInProcessEndpoint& endpoint);
+    ~McpInProcessClient();
+
+    // 禁止拷贝和移动
+    McpInProcessClient(const McpInProcessClient&) = delete;
+    McpInProcessClient& operator=(const McpInProcessClient&) = delete;
+    McpInProcessClient(McpInProcessClient&&) = delete;
+    McpInProcessClient& operator=(McpInProcessClient&&) = delete;
+
+    /**
+     * @brief 初始化连接（读取服务端信息与能力）
+     * @param clientName 客户端名称
+     * @param clientVersion 客户端版本
+     * @return 成功返回void，失败返回错误信息
+     */
+    std::expected<void, McpError> initialize(const std::string& clientName,
+                                             const std::string& clientVersion);
+
+    /**
+     * @brief 调用工具
+     * @param toolName 工具名称
+     * @param arguments 工具参数（JSON 文本，只解析一次；为空时传入空对象）
+     * @return 成功返回工具执行结果，失败返回错误信息
+     */
+    std::expected<JsonString, McpError> callTool(const std::string& toolName,
+                                                 const JsonString& arguments);
+
+    /**
+     * @brief 调用工具，参数文档原样交给处理函数
+     * @param toolName 工具名称
+     * @param arguments 调用方已持有的参数文档
+     * @return 成功返回工具执行结果，失败返回错误信息
+     */
+    std::expected<JsonString, McpError> callTool(const std::string& toolName,
+                                                 const JsonElement& arguments);
+
+    /**
+     * @brief 获取工具列表
+     * @return 成功返回工具列表，失败返回错误信息
+     */
+    std::expected<std::vector<Tool>, McpError> listTools();
+
+    /**
+     * @brief 获取资源列表
+     * @return 成功返回资源列表，失败返回错误信息
+     */
+    std::expected<std::vector<Resource>, McpError> listResources();
+
+    /**
+     * @brief 读取资源
+     * @param uri 资源URI
+     * @return 成功返回资源内容，失败返回错误信息
+     */
+    std::expected<std::string, McpError> readResource(const std::string& uri);
+
+    /**
+     * @brief 获取提示列表
+     * @return 成功返回提示列表，失败返回错误信息
+     */
+    std::expected<std::vector<Prompt>, McpError> listPrompts();
+
+    /**
+     * @brief 获取提示
+     * @param name 提示名称
+     * @param arguments 提示参数（JSON 文本；为空时传入空对象）
+     * @return 成功返回提示内容，失败返回错误信息
+     */
+    std::expected<JsonString, McpError> getPrompt(const std::string& name,
+                                                  const JsonString& arguments);
+
+    /**
+     * @brief 发送ping请求
+     * @return 成功返回void，失败返回错误信息
+     */
+    std::expected<void, McpError> ping();
+
+    /**
+     * @brief 断开连接（解除初始化状态，之后可以重新 initialize）
+     */
+    void disconnect();
+
+    /**
+     * @brief 检查是否已初始化
+     */
+    bool isInitialized() const;
+
+    /**
+     * @brief 获取服务器信息
+     */
+    const ServerInfo& getServerInfo() const;
+
+    /**
+     * @brief 获取服务器能力
+     */
+    const ServerCapabilities& getServerCapabilities() const;
+
+private:
+    // 客户端信息
+    std::string m_clientName;
+    std::string m_clientVersion;
+
+    // 服务器信息
+    ServerInfo m_serverInfo;
+    ServerCapabilities m_serverCapabilities;
+
+    // 初始化状态
+    std::atomic<bool> m_initialized;
+
+    McpInProcessEndpoint& m_endpoint;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_CLIENT_MCPINPROCESSCLIENT_H
@@ -0,0 +1,81 @@
+#ifndef GALAY_MCP_CLIENT_MCPLISTCACHE_H
+#define GALAY_MCP_CLIENT_MCPLISTCACHE_H
+
+#include "galay-mcp/common/McpBase.h"
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 缓存的一份列表：服务端的列表版本（_meta.listVersion）与全部条目
+ */
+template <typename T>
+struct McpCachedList {
+    std::string version;
+    std::vector<T> items;
+};
+
+/**
+ * @brief 客户端列表缓存，按服务端地址保存 tools / resources / prompts 列表及其版本
+ *
+ * list*() 带上缓存的版本（params._meta.ifChangedSince）请求：服务端未变化时只回 notModified，
+ * 变化不多时只回增量，缓存据此更新。多个客户端实例可共享同一个缓存，
+ * 重新连接同一服务端后第一次 list*() 只是一次很小的往返。线程安全。
+ */
+class McpListCache {
+public:
+    template <typename T>
+    std::optional<McpCachedList<T>> find(const std::string& server) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto& lists = listsOf<T>(*this);
+        auto it = lists.find(server);
+        if (it == lists.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    template <typename T>
+    void store(const std::string& server, McpCachedList<T> list) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        listsOf<T>(*this)[server] = std::move(list);
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tools.clear();
+        m_resources.clear();
+        m_prompts.clear();
+    }
+
+private:
+    // 按条目类型选择对应的表；self 的常量性决定返回引用的常量性
+    template <typename T, typename Self>
+    static auto& listsOf(Self& self) {
+        if constexpr (std::is_same_v<T, Tool>) {
+            return self.m_tools;
+        } else if constexpr (std::is_same_v<T, Resource>) {
+            return self.m_resources;
+        } else {
+            static_assert(std::is_same_v<T, Prompt>, "McpListCache holds Tool, Resource or Prompt");
+            return self.m_prompts;
+        }
+    }
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, McpCachedList<Tool>> m_tools;
+    std::unordered_map<std::string, McpCachedList<Resource>> m_resources;
+    std::unordered_map<std::string, McpCachedList<Prompt>> m_prompts;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_CLIENT_MCPLISTCACHE_H
@@ -1,4 +1,7 @@
 #include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpProtocolUtils.h"
+#include <algorithm>
+#include <chrono>
 
 namespace galay {
 namespace mcp {
@@ -10,10 +13,21 @@ const JsonString& EmptyObjectString() {
     return kEmptyObject;
 }
 
+// 子进程关闭管道后等待其退出的时长，超过后视为仍在运行、不重启
+constexpr std::chrono::milliseconds kCrashExitGrace{500};
+
+// 重复执行不产生副作用、崩溃重启后可以安全重放的方法
+bool IsIdempotentMethod(std::string_view method) {
+    return method == Methods::INITIALIZE || method == Methods::PING ||
+           method == Methods::TOOLS_LIST || method == Methods::RESOURCES_LIST ||
+           method == Methods::RESOURCES_READ || method == Methods::PROMPTS_LIST ||
+           method == Methods::PROMPTS_GET;
+}
+
 template <typename T, typename ParseFn>
-std::expected<std::vector<T>, McpError> parseListField(std::string_view body,
-                                                       const char* fieldName,
-                                                       ParseFn&& parseFn) {
+std::expected<ListPage<T>, McpError> parseListPage(std::string_view body,
+                                                   const char* fieldName,
+                                                   ParseFn&& parseFn) {
     auto docExp = JsonDocument::Parse(body);
     if (!docExp) {
         return std::unexpected(McpError::parseError(docExp.error().details()));
@@ -24,10 +38,26 @@ std::expected<std::vector<T>, McpError> parseListField(std::string_view body,
         return std::unexpected(McpError::parseError("Expected JSON object"));
     }
 
-    std::vector<T> values;
+    ListPage<T> page;
+    JsonHelper::GetString(obj, "nextCursor", page.nextCursor);
+    JsonObject metaObj;
+    if (JsonHelper::GetObject(obj, "_meta", metaObj)) {
+        JsonHelper::GetString(metaObj, "listVersion", page.version);
+        JsonHelper::GetBool(metaObj, "notModified", page.notModified);
+        JsonHelper::GetBool(metaObj, "delta", page.delta);
+        JsonArray removed;
+        if (JsonHelper::GetArray(metaObj, "removed", removed)) {
+            for (auto item : removed) {
+                std::string key;
+                if (JsonHelper::GetStringValue(item, key)) {
+                    page.removed.push_back(std::move(key));
+                }
+            }
+        }
+    }
     JsonArray arr;
     if (!JsonHelper::GetArray(obj, fieldName, arr)) {
-        return values;
+        return page;
     }
 
     for (auto item : arr) {
@@ -35,10 +65,41 @@ std::expected<std::vector<T>, McpError> parseListField(std::string_view body,
         if (!parsed) {
             return std::unexpected(McpError::parseError(parsed.error().message()));
         }
-        values.emplace_back(std::move(parsed.value()));
+        page.items.emplace_back(std::move(parsed.value()));
     }
 
-    return values;
+    return page;
+}
+
+// list 请求的 params：第一页为空对象，之后带上 cursor
+JsonString listParams(const std::string& cursor) {
+    if (cursor.empty()) {
+        return EmptyObjectString();
+    }
+    JsonWriter writer;
+    writer.StartObject();
+    writer.Key("cursor");
+    writer.String(cursor);
+    writer.EndObject();
+    return writer.TakeString();
+}
+
+// 把一页追加到已取得的条目之后，返回下一页的 cursor
+template <typename T>
+std::expected<std::string, McpError> appendPage(std::vector<T>& values,
+                                                ListPage<T>& page,
+                                                const std::string& cursor) {
+    if (!page.nextCursor.empty() && page.nextCursor == cursor) {
+        return std::unexpected(McpError::parseError("nextCursor did not advance"));
+    }
+    if (values.empty()) {
+        values = std::move(page.items);
+    } else {
+        values.insert(values.end(),
+                      std::make_move_iterator(page.items.begin()),
+                      std::make_move_iterator(page.items.end()));
+    }
+    return std::move(page.nextCursor);
 }
 
 std::expected<std::string, McpError> parseFirstTextContent(std::string_view body,
@@ -53,12 +114,33 @@ std::expected<std::string, McpError> parseFirstTextContent(std::string_view body
         return std::unexpected(McpError::parseError("Expected JSON object"));
     }
 
+    // 流式资源在部分内容写出后失败时置 isError，错误说明在 _meta.error 中
+    bool isError = false;
+    if (JsonHelper::GetBool(obj, "isError", isError) && isError) {
+        std::string details;
+        JsonObject meta;
+        if (JsonHelper::GetObject(obj, "_meta", meta)) {
+            JsonHelper::GetString(meta, "error", details);
+        }
+        return std::unexpected(McpError::internalError(details));
+    }
+
     JsonArray arr;
     if (!JsonHelper::GetArray(obj, fieldName, arr)) {
         return std::string();
     }
 
     for (auto item : arr) {
+        // 二进制资源内容：{"uri","mimeType","blob"}，返回解码后的字节
+        JsonObject itemObj;
+        std::string blob;
+        if (JsonHelper::GetObject(item, itemObj) && JsonHelper::GetString(itemObj, "blob", blob)) {
+            auto bytes = encoding::base64Decode(blob);
+            if (!bytes) {
+                return std::unexpected(McpError::parseError("Invalid base64 blob"));
+            }
+            return std::move(bytes.value());
+        }
         auto contentExp = Content::fromJson(item);
         if (!contentExp) {
             return std::unexpected(McpError::parseError(contentExp.error().message()));
@@ -73,60 +155,55 @@ std::expected<std::string, McpError> parseFirstTextContent(std::string_view body
 
 } // namespace
 
-McpStdioClient::McpStdioClient()
+McpStdioClient::McpStdioClient(McpStdioFraming framing, McpWireEncoding wireEncoding)
     : m_initialized(false)
     , m_requestIdCounter(0)
     , m_input(&std::cin)
-    , m_output(&std::cout) {
+    , m_output(&std::cout)
+    , m_preferredFraming(framing)
+    , m_preferredEncoding(wireEncoding) {
 }
 
 McpStdioClient::~McpStdioClient() {
     disconnect();
 }
 
-std::expected<void, McpError> McpStdioClient::initialize(const std::string& clientName,
-                                                         const std::string& clientVersion) {
+std::expected<void, McpError> McpStdioClient::spawn(McpStdioProcessOptions options) {
     if (m_initialized) {
         return std::unexpected(McpError::alreadyInitialized());
     }
 
-    m_clientName = clientName;
-    m_clientVersion = clientVersion;
-
-    // 构建初始化请求
-    InitializeParams params;
-    params.protocolVersion = MCP_VERSION;
-    params.clientInfo.name = clientName;
-    params.clientInfo.version = clientVersion;
-    params.capabilities = EmptyObjectString();
-
-    auto result = sendRequest(Methods::INITIALIZE, params.toJson());
-    if (!result) {
-        return std::unexpected(result.error());
+    auto process = std::make_unique<McpStdioProcess>(std::move(options));
+    auto started = process->start();
+    if (!started) {
+        return std::unexpected(started.error());
     }
 
-    auto docExp = JsonDocument::Parse(result.value());
-    if (!docExp) {
-        return std::unexpected(McpError::initializationFailed(docExp.error().details()));
-    }
+    m_process = process.get();
+    m_channel = std::move(process);
+    return {};
+}
 
-    auto initExp = InitializeResult::fromJson(docExp.value().Root());
-    if (!initExp) {
-        return std::unexpected(McpError::initializationFailed(initExp.error().message()));
+std::expected<void, McpError> McpStdioClient::attach(std::unique_ptr<McpMessageChannel> channel) {
+    if (m_initialized) {
+        return std::unexpected(McpError::alreadyInitialized());
     }
 
-    auto initResult = std::move(initExp.value());
-    m_serverInfo = std::move(initResult.serverInfo);
-    m_serverCapabilities = std::move(initResult.capabilities);
-    m_initialized = true;
+    m_process = nullptr;
+    m_channel = std::move(channel);
+    return {};
+}
 
-    // 发送initialized通知
-    auto notifyResult = sendNotification(Methods::INITIALIZED, EmptyObjectString());
-    if (!notifyResult) {
-        return std::unexpected(notifyResult.error());
+std::expected<void, McpError> McpStdioClient::initialize(const std::string& clientName,
+                                                         const std::string& clientVersion) {
+    if (m_initialized) {
+        return std::unexpected(McpError::alreadyInitialized());
     }
 
-    return {};
+    m_clientName = clientName;
+    m_clientVersion = clientVersion;
+
+    return handshake();
 }
 
 std::expected<JsonString, McpError> McpStdioClient::callTool(const std::string& toolName,
@@ -139,7 +216,7 @@ std::expected<JsonString, McpError> McpStdioClient::callTool(const std::string&
     params.name = toolName;
     params.arguments = arguments.empty() ? EmptyObjectString() : arguments;
 
-    auto result = sendRequest(Methods::TOOLS_CALL, params.toJson());
+    auto result = sendRequest(Methods::TOOLS_CALL, params.toJson(), isReplayableTool(toolName));
     if (!result) {
         return std::unexpected(result.error());
     }
@@ -160,7 +237,7 @@ std::expected<JsonString, McpError> McpStdioClient::callTool(const std::string&
     }
 
     if (callResult.content.empty()) {
-        return EmptyObjectString();
+        return callResult.structuredContent.empty() ? EmptyObjectString() : callResult.structuredContent;
     }
 
     if (callResult.content[0].type == ContentType::Text) {
@@ -170,33 +247,84 @@ std::expected<JsonString, McpError> McpStdioClient::callTool(const std::string&
     return EmptyObjectString();
 }
 
+std::expected<StructuredToolResult, McpError> McpStdioClient::callToolStructured(const std::string& toolName,
+                                                                                 const JsonString& arguments) {
+    if (!m_initialized) {
+        return std::unexpected(McpError::notInitialized());
+    }
+
+    ToolCallParams params;
+    params.name = toolName;
+    params.arguments = arguments.empty() ? EmptyObjectString() : arguments;
+
+    auto result = sendRequest(Methods::TOOLS_CALL, params.toJson(), isReplayableTool(toolName));
+    if (!result) {
+        return std::unexpected(result.error());
+    }
+    return StructuredToolResult::parse(result.value());
+}
+
 std::expected<std::vector<Tool>, McpError> McpStdioClient::listTools() {
+    std::vector<Tool> values;
+    std::string cursor;
+    do {
+        auto page = listToolsPage(cursor);
+        if (!page) {
+            return std::unexpected(page.error());
+        }
+        auto next = appendPage(values, page.value(), cursor);
+        if (!next) {
+            return std::unexpected(next.error());
+        }
+        cursor = std::move(next.value());
+    } while (!cursor.empty());
+    return values;
+}
+
+std::expected<ListPage<Tool>, McpError> McpStdioClient::listToolsPage(const std::string& cursor) {
     if (!m_initialized) {
         return std::unexpected(McpError::notInitialized());
     }
 
-    auto result = sendRequest(Methods::TOOLS_LIST, EmptyObjectString());
+    auto result = sendRequest(Methods::TOOLS_LIST, listParams(cursor));
     if (!result) {
         return std::unexpected(result.error());
     }
 
-    return parseListField<Tool>(
+    return parseListPage<Tool>(
         result.value(),
         "tools",
         [](const JsonElement& item) { return Tool::fromJson(item); });
 }
 
 std::expected<std::vector<Resource>, McpError> McpStdioClient::listResources() {
+    std::vector<Resource> values;
+    std::string cursor;
+    do {
+        auto page = listResourcesPage(cursor);
+        if (!page) {
+            return std::unexpected(page.error());
+        }
+        auto next = appendPage(values, page.value(), cursor);
+        if (!next) {
+            return std::unexpected(next.error());
+        }
+        cursor = std::move(next.value());
+    } while (!cursor.empty());
+    return values;
+}
+
+std::expected<ListPage<Resource>, McpError> McpStdioClient::listResourcesPage(const std::string& cursor) {
     if (!m_initialized) {
         return std::unexpected(McpError::notInitialized());
     }
 
-    auto result = sendRequest(Methods::RESOURCES_LIST, EmptyObjectString());
+    auto result = sendRequest(Methods::RESOURCES_LIST, listParams(cursor));
     if (!result) {
         return std::unexpected(result.error());
     }
 
-    return parseListField<Resource>(
+    return parseListPage<Resource>(
         result.value(),
         "resources",
         [](const JsonElement& item) { return Resource::fromJson(item); });
@@ -222,16 +350,33 @@ std::expected<std::string, McpError> McpStdioClient::readResource(const std::str
 }
 
 std::expected<std::vector<Prompt>, McpError> McpStdioClient::listPrompts() {
+    std::vector<Prompt> values;
+    std::string cursor;
+    do {
+        auto page = listPromptsPage(cursor);
+        if (!page) {
+            return std::unexpected(page.error());
+        }
+        auto next = appendPage(values, page.value(), cursor);
+        if (!next) {
+            return std::unexpected(next.error());
+        }
+        cursor = std::move(next.value());
+    } while (!cursor.empty());
+    return values;
+}
+
+std::expected<ListPage<Prompt>, McpError> McpStdioClient::listPromptsPage(const std::string& cursor) {
     if (!m_initialized) {
         return std::unexpected(McpError::notInitialized());
     }
 
-    auto result = sendRequest(Methods::PROMPTS_LIST, EmptyObjectString());
+    auto result = sendRequest(Methods::PROMPTS_LIST, listParams(cursor));
     if (!result) {
         return std::unexpected(result.error());
     }
 
-    return parseListField<Prompt>(
+    return parseListPage<Prompt>(
         result.value(),
         "prompts",
         [](const JsonElement& item) { return Prompt::fromJson(item); });
@@ -276,6 +421,11 @@ std::expected<void, McpError> McpStdioClient::ping() {
 
 void McpStdioClient::disconnect() {
     m_initialized = false;
+    if (m_process) {
+        m_process->stop();
+        m_process = nullptr;
+    }
+    m_channel.reset();
 }
 
 bool McpStdioClient::isInitialized() const {
@@ -290,15 +440,134 @@ const ServerCapabilities& McpStdioClient::getServerCapabilities() const {
     return m_serverCapabilities;
 }
 
+McpStdioFraming McpStdioClient::framing() const {
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    return m_framing;
+}
+
+McpWireEncoding McpStdioClient::wireEncoding() const {
+    return m_encoding.load(std::memory_order_acquire);
+}
+
 std::expected<JsonString, McpError> McpStdioClient::sendRequest(std::string_view method,
-                                                                const std::optional<JsonString>& params) {
+                                                                const std::optional<JsonString>& params,
+                                                                bool replayable) {
+    auto result = exchange(method, params);
+    if (result || !m_process || result.error().code() != McpErrorCode::ConnectionClosed ||
+        !m_process->waitForExit(kCrashExitGrace)) {
+        return result;
+    }
+
+    auto recovered = recoverProcess();
+    if (!recovered) {
+        return std::unexpected(recovered.error());
+    }
+    // 崩溃前请求可能已被执行，非幂等请求重放会产生重复副作用
+    if (!replayable && !IsIdempotentMethod(method)) {
+        return result;
+    }
+    return exchange(method, params);
+}
+
+bool McpStdioClient::isReplayableTool(std::string_view toolName) const {
+    if (!m_process) {
+        return false;
+    }
+    const auto& tools = m_process->options().replayableTools;
+    return std::find(tools.begin(), tools.end(), toolName) != tools.end();
+}
+
+std::expected<void, McpError> McpStdioClient::handshake() {
+    // 构建初始化请求
+    InitializeParams params;
+    params.protocolVersion = MCP_VERSION;
+    params.clientInfo.name = m_clientName;
+    params.clientInfo.version = m_clientVersion;
+    params.capabilities = EmptyObjectString();
+    std::vector<std::pair<std::string, std::string>> extensions;
+    const bool contentLength = m_preferredFraming == McpStdioFraming::ContentLength;
+    if (contentLength) {
+        extensions.emplace_back("framing", std::string(framing::CONTENT_LENGTH));
+    }
+    // MessagePack 含任意字节，只在 Content-Length 分帧或自带消息边界的通道上请求
+    if (m_preferredEncoding == McpWireEncoding::MsgPack && (contentLength || (m_channel && !m_process))) {
+        extensions.emplace_back("encoding", std::string(encoding::MSGPACK));
+    }
+    if (!extensions.empty()) {
+        params.capabilities = "{\"experimental\":" + protocol::makeGalayExperimental(extensions) + "}";
+    }
+
+    // initialize 始终按换行分帧、JSON 编码发送（重启后的子进程也从默认值开始）
+    applyFraming(McpStdioFraming::Newline);
+    m_encoding.store(McpWireEncoding::Json, std::memory_order_release);
+
+    auto result = exchange(Methods::INITIALIZE, params.toJson());
+    if (!result) {
+        return std::unexpected(result.error());
+    }
+
+    auto docExp = JsonDocument::Parse(result.value());
+    if (!docExp) {
+        return std::unexpected(McpError::initializationFailed(docExp.error().details()));
+    }
+
+    auto initExp = InitializeResult::fromJson(docExp.value().Root());
+    if (!initExp) {
+        return std::unexpected(McpError::initializationFailed(initExp.error().message()));
+    }
+
+    // 服务端确认后，从 initialized 通知起改用协商结果
+    JsonObject resultObj;
+    JsonElement capsElement;
+    if (!extensions.empty() &&
+        JsonHelper::GetObject(docExp.value().Root(), resultObj) &&
+        JsonHelper::GetElement(resultObj, "capabilities", capsElement)) {
+        if (protocol::getGalayExtension(capsElement, "framing") == framing::CONTENT_LENGTH) {
+            applyFraming(McpStdioFraming::ContentLength);
+        }
+        if (protocol::getGalayExtension(capsElement, "encoding") == encoding::MSGPACK) {
+            m_encoding.store(McpWireEncoding::MsgPack, std::memory_order_release);
+        }
+    }
+
+    auto initResult = std::move(initExp.value());
+    m_serverInfo = std::move(initResult.serverInfo);
+    m_serverCapabilities = std::move(initResult.capabilities);
+    m_initialized = true;
+
+    // 发送initialized通知
+    auto notifyResult = sendNotification(Methods::INITIALIZED, EmptyObjectString());
+    if (!notifyResult) {
+        return std::unexpected(notifyResult.error());
+    }
+
+    return {};
+}
+
+std::expected<void, McpError> McpStdioClient::recoverProcess() {
+    const bool wasInitialized = m_initialized.exchange(false);
+
+    auto restarted = m_process->restart();
+    if (!restarted) {
+        return std::unexpected(restarted.error());
+    }
+
+    // 新进程没有会话状态，需要重新握手后才能重放请求
+    if (wasInitialized) {
+        return handshake();
+    }
+    return {};
+}
+
+std::expected<JsonString, McpError> McpStdioClient::exchange(std::string_view method,
+                                                             const std::optional<JsonString>& params) {
     const int64_t requestId = generateRequestId();
     JsonRpcRequest request;
     request.id = requestId;
     request.method = std::string(method);
     request.params = params;
 
-    auto writeResult = writeMessage(request.toJson());
+    auto writeResult = writeMessage(encoding::encodeMessage(request, m_encoding.load(std::memory_order_acquire)));
     if (!writeResult) {
         return std::unexpected(writeResult.error());
     }
@@ -310,33 +579,26 @@ std::expected<JsonString, McpError> McpStdioClient::sendRequest(std::string_view
             return std::unexpected(readResult.error());
         }
 
-        auto docExp = JsonDocument::Parse(readResult.value());
-        if (!docExp) {
-            return std::unexpected(McpError::parseError(docExp.error().details()));
+        auto responseExp = parseResponse(readResult.value());
+        if (!responseExp) {
+            return std::unexpected(responseExp.error());
         }
-
-        JsonObject obj;
-        if (!JsonHelper::GetObject(docExp.value().Root(), obj)) {
-            return std::unexpected(McpError::invalidResponse("Invalid response object"));
-        }
-
-        auto idVal = obj["id"];
-        if (idVal.error() || idVal.is_null()) {
+        if (!responseExp.value().has_value()) {
             // 通知消息，忽略
             continue;
         }
-        if (!idVal.is_int64()) {
-            return std::unexpected(McpError::invalidResponse("Invalid response id"));
-        }
-        const int64_t responseId = idVal.get_int64().value();
-        if (responseId != requestId) {
+        JsonRpcResponse& response = responseExp.value().value();
+        if (response.id != requestId) {
             // 忽略其他请求的响应，继续等待当前 request id。
             continue;
         }
 
-        auto errorVal = obj["error"];
-        if (!errorVal.error() && !errorVal.is_null()) {
-            auto errExp = JsonRpcError::fromJson(errorVal.value());
+        if (response.error.has_value()) {
+            auto errorDoc = JsonDocument::Parse(response.error.value());
+            if (!errorDoc) {
+                return std::unexpected(McpError::parseError(errorDoc.error().details()));
+            }
+            auto errExp = JsonRpcError::fromJson(errorDoc.value().Root());
             if (!errExp) {
                 return std::unexpected(McpError::parseError(errExp.error().message()));
             }
@@ -348,50 +610,103 @@ std::expected<JsonString, McpError> McpStdioClient::sendRequest(std::string_view
                 errExp.value().code, errExp.value().message, details));
         }
 
-        auto resultVal = obj["result"];
-        if (!resultVal.error() && !resultVal.is_null()) {
-            std::string raw;
-            if (!JsonHelper::GetRawJson(resultVal.value(), raw)) {
-                return std::unexpected(McpError::parseError("Failed to parse result"));
-            }
-            return raw;
+        if (response.result.has_value()) {
+            return std::move(response.result.value());
         }
 
         return EmptyObjectString();
     }
 }
 
+std::expected<std::optional<JsonRpcResponse>, McpError>
+McpStdioClient::parseResponse(std::string_view message) {
+    // MessagePack 响应直接取字段，只把 result / error 转写为 JSON
+    if (encoding::isMsgPack(message)) {
+        return encoding::msgPackToResponse(message);
+    }
+
+    auto docExp = JsonDocument::Parse(message);
+    if (!docExp) {
+        return std::unexpected(McpError::parseError(docExp.error().details()));
+    }
+
+    JsonObject obj;
+    if (!JsonHelper::GetObject(docExp.value().Root(), obj)) {
+        return std::unexpected(McpError::invalidResponse("Invalid response object"));
+    }
+
+    auto idVal = obj["id"];
+    if (idVal.error() || idVal.is_null()) {
+        return std::optional<JsonRpcResponse>();
+    }
+    if (!idVal.is_int64()) {
+        return std::unexpected(McpError::invalidResponse("Invalid response id"));
+    }
+
+    JsonRpcResponse response;
+    response.id = idVal.get_int64().value();
+
+    auto errorVal = obj["error"];
+    if (!errorVal.error() && !errorVal.is_null()) {
+        std::string raw;
+        if (!JsonHelper::GetRawJson(errorVal.value(), raw)) {
+            return std::unexpected(McpError::parseError("Failed to parse error"));
+        }
+        response.error = std::move(raw);
+        return std::optional<JsonRpcResponse>(std::move(response));
+    }
+
+    auto resultVal = obj["result"];
+    if (!resultVal.error() && !resultVal.is_null()) {
+        std::string raw;
+        if (!JsonHelper::GetRawJson(resultVal.value(), raw)) {
+            return std::unexpected(McpError::parseError("Failed to parse result"));
+        }
+        response.result = std::move(raw);
+    }
+    return std::optional<JsonRpcResponse>(std::move(response));
+}
+
 std::expected<void, McpError> McpStdioClient::sendNotification(std::string_view method,
                                                                const std::optional<JsonString>& params) {
     JsonRpcNotification notification;
     notification.method = std::string(method);
     notification.params = params;
 
-    return writeMessage(notification.toJson());
+    return writeMessage(encoding::encodeMessage(notification, m_encoding.load(std::memory_order_acquire)));
 }
 
 std::expected<std::string, McpError> McpStdioClient::readMessage() {
+    if (m_channel) {
+        return m_channel->readMessage();
+    }
+
     std::lock_guard<std::mutex> lock(m_inputMutex);
 
-    std::string line;
-    while (std::getline(*m_input, line)) {
-        if (!line.empty()) {
-            return line;
+    while (true) {
+        auto message = framing::readFrame(*m_input);
+        if (!message || !message.value().empty()) {
+            return message;
         }
     }
-
-    return std::unexpected(McpError::readError("Failed to read from stdin"));
 }
 
 std::expected<void, McpError> McpStdioClient::writeMessage(const JsonString& message) {
+    if (m_channel) {
+        return m_channel->writeMessage(message);
+    }
+
     std::lock_guard<std::mutex> lock(m_outputMutex);
+    return framing::writeFrame(*m_output, message, m_framing);
+}
 
-    try {
-        *m_output << message << '\n';
-        m_output->flush();
-        return {};
-    } catch (const std::exception& e) {
-        return std::unexpected(McpError::writeError(e.what()));
+void McpStdioClient::applyFraming(McpStdioFraming framing) {
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        m_framing = framing;
+    }
+    if (m_channel) {
+        m_channel->setFraming(framing);
     }
 }
 
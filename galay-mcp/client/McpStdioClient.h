@@ -2,12 +2,15 @@
 #define GALAY_MCP_CLIENT_MCPSTDIOCLIENT_H
 
 #include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpEncoding.h"
 #include "galay-mcp/common/McpError.h"
 #include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/client/McpStdioProcess.h"
 #include <atomic>
 #include <mutex>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <string_view>
 
 namespace galay {
@@ -17,11 +20,21 @@ namespace mcp {
  * @brief 基于标准输入输出的MCP客户端
  *
  * 该类实现了MCP协议的客户端，通过stdout发送请求，通过stdin接收响应。
- * 每条消息以换行符分隔，使用JSON-RPC 2.0格式。
+ * 默认每条消息以换行符分隔，使用JSON-RPC 2.0格式；构造时指定 ContentLength 分帧时，
+ * 会在 initialize 中向服务端协商 Content-Length 分帧，服务端确认后改用该分帧传输大消息。
+ * 指定 MsgPack 编码且传输可承载二进制（Content-Length 分帧或 attach() 的通道）时，
+ * 同样经协商改用 MessagePack 编码；对端不是 galay-mcp 时保持 JSON。
+ * 也可以通过 spawn() 启动并托管一个服务端子进程，或通过 attach() 接入任意消息通道
+ * （例如 McpShmChannel），改为经由该通道收发消息。
  */
 class McpStdioClient {
 public:
-    McpStdioClient();
+    /**
+     * @param framing 期望的分帧方式；ContentLength 仅在服务端于 initialize 响应中确认后生效
+     * @param wireEncoding 期望的线路编码；MsgPack 同样需服务端确认后生效
+     */
+    explicit McpStdioClient(McpStdioFraming framing = McpStdioFraming::Newline,
+                            McpWireEncoding wireEncoding = McpWireEncoding::Json);
     ~McpStdioClient();
 
     // 禁止拷贝和移动
@@ -30,6 +43,25 @@ public:
     McpStdioClient(McpStdioClient&&) = delete;
     McpStdioClient& operator=(McpStdioClient&&) = delete;
 
+    /**
+     * @brief 启动并托管一个stdio服务端子进程
+     * @param options 子进程配置（可执行文件、参数、管道大小、崩溃重启策略）
+     * @return 成功返回void，失败返回错误信息
+     * @note 需在 initialize() 之前调用；子进程崩溃后，下一次请求会按策略重启子进程并重新握手。
+     *       只有幂等请求（initialize、各 list、resources/read、prompts/get、ping，以及
+     *       replayableTools 中的工具）会在重启后重试一次；其余 tools/call 可能已经执行，
+     *       不会重放，而是返回 ConnectionClosed 由调用方决定是否重试
+     */
+    std::expected<void, McpError> spawn(McpStdioProcessOptions options);
+
+    /**
+     * @brief 改为经由指定消息通道收发请求（例如共享内存通道）
+     * @param channel 已连接的消息通道
+     * @return 成功返回void；已初始化时返回 AlreadyInitialized
+     * @note 需在 initialize() 之前调用
+     */
+    std::expected<void, McpError> attach(std::unique_ptr<McpMessageChannel> channel);
+
     /**
      * @brief 初始化连接
      * @param clientName 客户端名称
@@ -43,23 +75,45 @@ public:
      * @brief 调用工具
      * @param toolName 工具名称
      * @param arguments 工具参数
-     * @return 成功返回工具执行结果，失败返回错误信息
+     * @return 成功返回第一个文本内容；结构化结果返回 structuredContent 的 JSON 文本；失败返回错误信息
      */
     std::expected<JsonString, McpError> callTool(const std::string& toolName,
                                                  const JsonString& arguments);
 
     /**
-     * @brief 获取工具列表
+     * @brief 调用声明了 outputSchema 的工具
+     * @return 成功返回持有解析结果的 StructuredToolResult，structuredContent 直接指向响应中的对象；
+     *         工具返回错误或结果中没有 structuredContent 时返回错误
+     */
+    std::expected<StructuredToolResult, McpError> callToolStructured(const std::string& toolName,
+                                                                     const JsonString& arguments);
+
+    /**
+     * @brief 获取工具列表；服务端分页时依次取完所有页
      * @return 成功返回工具列表，失败返回错误信息
      */
     std::expected<std::vector<Tool>, McpError> listTools();
 
     /**
-     * @brief 获取资源列表
+     * @brief 获取工具列表的一页
+     * @param cursor 上一页的 nextCursor，第一页为空
+     * @return 成功返回本页条目与 nextCursor（为空表示最后一页），失败返回错误信息
+     */
+    std::expected<ListPage<Tool>, McpError> listToolsPage(const std::string& cursor = "");
+
+    /**
+     * @brief 获取资源列表；服务端分页时依次取完所有页
      * @return 成功返回资源列表，失败返回错误信息
      */
     std::expected<std::vector<Resource>, McpError> listResources();
 
+    /**
+     * @brief 获取资源列表的一页
+     * @param cursor 上一页的 nextCursor，第一页为空
+     * @return 成功返回本页条目与 nextCursor（为空表示最后一页），失败返回错误信息
+     */
+    std::expected<ListPage<Resource>, McpError> listResourcesPage(const std::string& cursor = "");
+
     /**
      * @brief 读取资源
      * @param uri 资源URI
@@ -68,11 +122,18 @@ public:
     std::expected<std::string, McpError> readResource(const std::string& uri);
 
     /**
-     * @brief 获取提示列表
+     * @brief 获取提示列表；服务端分页时依次取完所有页
      * @return 成功返回提示列表，失败返回错误信息
      */
     std::expected<std::vector<Prompt>, McpError> listPrompts();
 
+    /**
+     * @brief 获取提示列表的一页
+     * @param cursor 上一页的 nextCursor，第一页为空
+     * @return 成功返回本页条目与 nextCursor（为空表示最后一页），失败返回错误信息
+     */
+    std::expected<ListPage<Prompt>, McpError> listPromptsPage(const std::string& cursor = "");
+
     /**
      * @brief 获取提示
      * @param name 提示名称
@@ -108,21 +169,51 @@ public:
      */
     const ServerCapabilities& getServerCapabilities() const;
 
+    /**
+     * @brief 获取当前生效的分帧方式（initialize 协商后确定）
+     */
+    McpStdioFraming framing() const;
+
+    /**
+     * @brief 获取当前生效的线路编码（initialize 协商后确定）
+     */
+    McpWireEncoding wireEncoding() const;
+
 private:
-    // 发送请求并等待响应
+    // 发送请求并等待响应；托管子进程崩溃时重启，仅幂等请求（或 replayable 为 true）重试一次
     std::expected<JsonString, McpError> sendRequest(std::string_view method,
-                                                    const std::optional<JsonString>& params);
+                                                    const std::optional<JsonString>& params,
+                                                    bool replayable = false);
+
+    // 该工具是否声明为可在重启后重放
+    bool isReplayableTool(std::string_view toolName) const;
+
+    // 发送请求并等待响应（单次往返）
+    std::expected<JsonString, McpError> exchange(std::string_view method,
+                                                 const std::optional<JsonString>& params);
+
+    // 执行 initialize 握手并发送 initialized 通知
+    std::expected<void, McpError> handshake();
+
+    // 重启崩溃的子进程并重新握手
+    std::expected<void, McpError> recoverProcess();
 
     // 发送通知（不等待响应）
     std::expected<void, McpError> sendNotification(std::string_view method,
                                                    const std::optional<JsonString>& params);
 
-    // 读取一行JSON消息
+    // 读取一条消息（自动识别换行 / Content-Length 分帧）
     std::expected<std::string, McpError> readMessage();
 
-    // 写入一行JSON消息
+    // 解析一条 JSON 或 MessagePack 响应；通知消息返回 std::nullopt
+    std::expected<std::optional<JsonRpcResponse>, McpError> parseResponse(std::string_view message);
+
+    // 按当前分帧方式写入一条JSON消息
     std::expected<void, McpError> writeMessage(const JsonString& message);
 
+    // 切换分帧方式（同时作用于消息通道）
+    void applyFraming(McpStdioFraming framing);
+
     // 生成请求ID
     int64_t generateRequestId();
 
@@ -144,8 +235,20 @@ private:
     // 输入输出流
     std::istream* m_input;
     std::ostream* m_output;
-    std::mutex m_outputMutex;
+    mutable std::mutex m_outputMutex;
     std::mutex m_inputMutex;
+
+    // 分帧方式：期望值与协商后的生效值（受 m_outputMutex 保护）
+    McpStdioFraming m_preferredFraming;
+    McpStdioFraming m_framing{McpStdioFraming::Newline};
+
+    // 线路编码：期望值与协商后的生效值
+    McpWireEncoding m_preferredEncoding;
+    std::atomic<McpWireEncoding> m_encoding{McpWireEncoding::Json};
+
+    // 消息通道（为空时使用 stdin/stdout）；spawn() 时指向托管的子进程
+    std::unique_ptr<McpMessageChannel> m_channel;
+    McpStdioProcess* m_process{nullptr};
 };
 
 } // namespace mcp
@@ -0,0 +1,467 @@
+#include "galay-mcp/client/McpStdioProcess.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+constexpr size_t kReadChunkSize = 64 * 1024;
+
+bool MakePipe(int fds[2]) {
+    if (::pipe(fds) != 0) {
+        return false;
+    }
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return true;
+}
+
+void ClosePipe(int fds[2]) {
+    for (int i = 0; i < 2; ++i) {
+        if (fds[i] >= 0) {
+            ::close(fds[i]);
+            fds[i] = -1;
+        }
+    }
+}
+
+void ResizePipe(int fd, size_t size) {
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+    if (size > 0) {
+        // 失败（例如超过 /proc/sys/fs/pipe-max-size）时保持系统默认大小
+        ::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(size));
+    }
+#else
+    (void)fd;
+    (void)size;
+#endif
+}
+
+void IgnoreSigpipeOnce() {
+    static const bool installed = []() {
+        struct sigaction current {};
+        if (::sigaction(SIGPIPE, nullptr, &current) == 0 && current.sa_handler == SIG_DFL) {
+            ::signal(SIGPIPE, SIG_IGN);
+        }
+        return true;
+    }();
+    (void)installed;
+}
+
+std::string ErrnoMessage(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+McpStdioProcess::McpStdioProcess(McpStdioProcessOptions options)
+    : m_options(std::move(options)) {
+}
+
+McpStdioProcess::~McpStdioProcess() {
+    stop();
+}
+
+std::expected<void, McpError> McpStdioProcess::start() {
+    if (m_pid > 0) {
+        return {};
+    }
+    if (m_options.executable.empty()) {
+        return std::unexpected(McpError::connectionFailed("Empty executable path"));
+    }
+    IgnoreSigpipeOnce();
+    return spawn();
+}
+
+void McpStdioProcess::stop() {
+    reap();
+    closePipes();
+}
+
+std::expected<void, McpError> McpStdioProcess::restart() {
+    if (!m_options.restartOnCrash || m_restartCount >= m_options.maxRestarts) {
+        return std::unexpected(McpError::connectionClosed(
+            "Server process exited with status " + std::to_string(m_exitStatus)));
+    }
+
+    reap();
+    closePipes();
+    ++m_restartCount;
+    return spawn();
+}
+
+bool McpStdioProcess::isAlive() {
+    if (m_pid <= 0) {
+        return false;
+    }
+
+    int status = 0;
+    pid_t ret = ::waitpid(m_pid, &status, WNOHANG);
+    if (ret == 0) {
+        return true;
+    }
+    if (ret == m_pid) {
+        m_exitStatus = status;
+    }
+    m_pid = -1;
+    return false;
+}
+
+bool McpStdioProcess::waitForExit(std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (!isAlive()) {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return !isAlive();
+}
+
+std::expected<void, McpError> McpStdioProcess::writeMessage(std::string_view message) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+
+    if (m_stdinFd < 0) {
+        return std::unexpected(McpError::connectionClosed("Server process not running"));
+    }
+
+    static const char kNewline = '\n';
+    struct iovec iov[2];
+    std::string header;
+    if (m_framing == McpStdioFraming::ContentLength) {
+        header = framing::makeContentLengthHeader(message.size());
+        iov[0].iov_base = header.data();
+        iov[0].iov_len = header.size();
+        iov[1].iov_base = const_cast<char*>(message.data());
+        iov[1].iov_len = message.size();
+    } else {
+        iov[0].iov_base = const_cast<char*>(message.data());
+        iov[0].iov_len = message.size();
+        iov[1].iov_base = const_cast<char*>(&kNewline);
+        iov[1].iov_len = 1;
+    }
+
+    int iovIndex = 0;
+    while (iovIndex < 2) {
+        ssize_t written = ::writev(m_stdinFd, iov + iovIndex, 2 - iovIndex);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EPIPE) {
+                return std::unexpected(McpError::connectionClosed("Server process closed stdin"));
+            }
+            return std::unexpected(McpError::writeError(ErrnoMessage("writev")));
+        }
+
+        size_t remaining = static_cast<size_t>(written);
+        while (iovIndex < 2 && remaining >= iov[iovIndex].iov_len) {
+            remaining -= iov[iovIndex].iov_len;
+            ++iovIndex;
+        }
+        if (iovIndex < 2) {
+            iov[iovIndex].iov_base = static_cast<char*>(iov[iovIndex].iov_base) + remaining;
+            iov[iovIndex].iov_len -= remaining;
+        }
+    }
+
+    return {};
+}
+
+void McpStdioProcess::setFraming(McpStdioFraming framing) {
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_framing = framing;
+}
+
+std::expected<std::string, McpError> McpStdioProcess::readMessage() {
+    std::lock_guard<std::mutex> lock(m_readMutex);
+
+    while (true) {
+        auto line = readLine();
+        if (!line) {
+            return std::unexpected(line.error());
+        }
+        if (line.value().empty()) {
+            continue;
+        }
+
+        auto length = framing::parseContentLength(line.value());
+        if (!length) {
+            return line;
+        }
+
+        // 跳过其余头部直到空行，再按长度一次性读取正文
+        while (true) {
+            auto header = readLine();
+            if (!header) {
+                return std::unexpected(header.error());
+            }
+            if (header.value().empty() || header.value() == "\r") {
+                break;
+            }
+        }
+        return readExact(length.value());
+    }
+}
+
+std::expected<std::string, McpError> McpStdioProcess::readLine() {
+    size_t scanFrom = m_readPos;
+    while (true) {
+        const char* begin = m_readBuffer.data() + scanFrom;
+        const size_t available = m_readBuffer.size() - scanFrom;
+        const void* newline = available > 0 ? std::memchr(begin, '\n', available) : nullptr;
+
+        if (newline != nullptr) {
+            const size_t lineEnd = static_cast<size_t>(static_cast<const char*>(newline) - m_readBuffer.data());
+            std::string line(m_readBuffer.data() + m_readPos, lineEnd - m_readPos);
+            m_readPos = lineEnd + 1;
+            return line;
+        }
+
+        scanFrom = m_readBuffer.size();
+        const size_t consumed = m_readPos;
+        auto filled = fill();
+        if (!filled) {
+            return std::unexpected(filled.error());
+        }
+        scanFrom -= consumed - m_readPos;
+    }
+}
+
+std::expected<std::string, McpError> McpStdioProcess::readExact(size_t length) {
+    std::string body(length, '\0');
+
+    // 先取走缓冲区中已有的部分，剩余字节直接读入目标缓冲区，不再经过行缓冲
+    const size_t buffered = std::min(length, m_readBuffer.size() - m_readPos);
+    std::memcpy(body.data(), m_readBuffer.data() + m_readPos, buffered);
+    m_readPos += buffered;
+
+    size_t done = buffered;
+    while (done < length) {
+        if (m_stdoutFd < 0) {
+            return std::unexpected(McpError::connectionClosed("Server process not running"));
+        }
+        ssize_t n = ::read(m_stdoutFd, body.data() + done, length - done);
+        if (n > 0) {
+            done += static_cast<size_t>(n);
+            continue;
+        }
+        if (n == 0) {
+            return std::unexpected(McpError::connectionClosed("Server process closed stdout"));
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return std::unexpected(McpError::readError(ErrnoMessage("read")));
+    }
+    return body;
+}
+
+std::expected<void, McpError> McpStdioProcess::spawn() {
+    int stdinPipe[2] = {-1, -1};
+    int stdoutPipe[2] = {-1, -1};
+    int stderrPipe[2] = {-1, -1};
+
+    if (!MakePipe(stdinPipe) || !MakePipe(stdoutPipe) || !MakePipe(stderrPipe)) {
+        std::string message = ErrnoMessage("pipe");
+        ClosePipe(stdinPipe);
+        ClosePipe(stdoutPipe);
+        ClosePipe(stderrPipe);
+        return std::unexpected(McpError::connectionFailed(message));
+    }
+
+    ResizePipe(stdinPipe[1], m_options.pipeBufferSize);
+    ResizePipe(stdoutPipe[0], m_options.pipeBufferSize);
+
+    // fork 之后只允许调用 async-signal-safe 函数，因此 argv/envp 提前构造好
+    std::vector<char*> argv;
+    argv.reserve(m_options.args.size() + 2);
+    argv.push_back(const_cast<char*>(m_options.executable.c_str()));
+    for (const auto& arg : m_options.args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    // 与 options.env 同名的继承变量被覆盖（去掉继承项），其余照常继承
+    std::vector<char*> envp;
+    if (!m_options.env.empty()) {
+        for (char** entry = environ; entry != nullptr && *entry != nullptr; ++entry) {
+            const std::string_view inherited(*entry);
+            const bool overridden = std::any_of(m_options.env.begin(), m_options.env.end(),
+                [inherited](const std::string& custom) {
+                    const size_t eq = custom.find('=');
+                    return eq != std::string::npos && inherited.starts_with(std::string_view(custom).substr(0, eq + 1));
+                });
+            if (!overridden) {
+                envp.push_back(*entry);
+            }
+        }
+        for (const auto& entry : m_options.env) {
+            envp.push_back(const_cast<char*>(entry.c_str()));
+        }
+        envp.push_back(nullptr);
+    }
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        std::string message = ErrnoMessage("fork");
+        ClosePipe(stdinPipe);
+        ClosePipe(stdoutPipe);
+        ClosePipe(stderrPipe);
+        return std::unexpected(McpError::connectionFailed(message));
+    }
+
+    if (pid == 0) {
+        ::dup2(stdinPipe[0], STDIN_FILENO);
+        ::dup2(stdoutPipe[1], STDOUT_FILENO);
+        ::dup2(stderrPipe[1], STDERR_FILENO);
+        ::signal(SIGPIPE, SIG_DFL);
+        if (!envp.empty()) {
+            environ = envp.data();
+        }
+        ::execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    ::close(stdinPipe[0]);
+    ::close(stdoutPipe[1]);
+    ::close(stderrPipe[1]);
+
+    m_pid = pid;
+    m_exitStatus = 0;
+    m_stdinFd = stdinPipe[1];
+    m_stdoutFd = stdoutPipe[0];
+    m_stderrFd = stderrPipe[0];
+    m_readBuffer.clear();
+    m_readPos = 0;
+
+    m_stderrThread = std::thread([this, fd = m_stderrFd]() { stderrLoop(fd); });
+    return {};
+}
+
+void McpStdioProcess::closePipes() {
+    if (m_stdinFd >= 0) {
+        ::close(m_stdinFd);
+        m_stdinFd = -1;
+    }
+    if (m_stdoutFd >= 0) {
+        ::close(m_stdoutFd);
+        m_stdoutFd = -1;
+    }
+    // 子进程退出后 stderr 写端关闭，后台线程读到 EOF 自然结束
+    if (m_stderrThread.joinable()) {
+        m_stderrThread.join();
+    }
+    if (m_stderrFd >= 0) {
+        ::close(m_stderrFd);
+        m_stderrFd = -1;
+    }
+}
+
+void McpStdioProcess::reap() {
+    if (m_pid <= 0) {
+        return;
+    }
+
+    // 先关闭 stdin，让遵循协议的服务端在读到 EOF 后自行退出
+    if (m_stdinFd >= 0) {
+        ::close(m_stdinFd);
+        m_stdinFd = -1;
+    }
+
+    if (waitForExit(std::chrono::milliseconds(500))) {
+        return;
+    }
+
+    ::kill(m_pid, SIGTERM);
+    if (waitForExit(std::chrono::milliseconds(500))) {
+        return;
+    }
+
+    ::kill(m_pid, SIGKILL);
+    int status = 0;
+    ::waitpid(m_pid, &status, 0);
+    m_exitStatus = status;
+    m_pid = -1;
+}
+
+std::expected<void, McpError> McpStdioProcess::fill() {
+    if (m_stdoutFd < 0) {
+        return std::unexpected(McpError::connectionClosed("Server process not running"));
+    }
+
+    // 已消费的数据超过一半时整体前移，避免缓冲区无限增长
+    if (m_readPos > 0 && m_readPos * 2 >= m_readBuffer.size()) {
+        m_readBuffer.erase(0, m_readPos);
+        m_readPos = 0;
+    }
+
+    const size_t oldSize = m_readBuffer.size();
+    m_readBuffer.resize(oldSize + kReadChunkSize);
+    while (true) {
+        ssize_t n = ::read(m_stdoutFd, m_readBuffer.data() + oldSize, kReadChunkSize);
+        if (n > 0) {
+            m_readBuffer.resize(oldSize + static_cast<size_t>(n));
+            return {};
+        }
+        m_readBuffer.resize(oldSize);
+        if (n == 0) {
+            return std::unexpected(McpError::connectionClosed("Server process closed stdout"));
+        }
+        if (errno == EINTR) {
+            m_readBuffer.resize(oldSize + kReadChunkSize);
+            continue;
+        }
+        return std::unexpected(McpError::readError(ErrnoMessage("read")));
+    }
+}
+
+void McpStdioProcess::stderrLoop(int fd) {
+    std::string pending;
+    char buffer[4096];
+    auto emit = [this](std::string_view line) {
+        if (m_options.stderrHandler) {
+            m_options.stderrHandler(line);
+        } else {
+            std::cerr << line << '\n';
+        }
+    };
+
+    while (true) {
+        ssize_t n = ::read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<size_t>(n));
+
+        size_t start = 0;
+        size_t pos;
+        while ((pos = pending.find('\n', start)) != std::string::npos) {
+            emit(std::string_view(pending).substr(start, pos - start));
+            start = pos + 1;
+        }
+        pending.erase(0, start);
+    }
+
+    if (!pending.empty()) {
+        emit(pending);
+    }
+}
+
+} // namespace mcp
+} // namespace galay
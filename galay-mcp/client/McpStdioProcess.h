@@ -0,0 +1,141 @@
+#ifndef GALAY_MCP_CLIENT_MCPSTDIOPROCESS_H
+#define GALAY_MCP_CLIENT_MCPSTDIOPROCESS_H
+
+#include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpMessageChannel.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 子进程 stdio 传输配置
+ */
+struct McpStdioProcessOptions {
+    // 服务端可执行文件路径（按 execvp 规则查找）
+    std::string executable;
+    // 额外命令行参数（不含 argv[0]）
+    std::vector<std::string> args;
+    // 额外环境变量，格式为 "KEY=VALUE"；与继承的变量同名时覆盖之，否则追加
+    std::vector<std::string> env;
+    // 期望的管道缓冲区大小（Linux 下通过 F_SETPIPE_SZ 设置，0 表示保持系统默认）
+    size_t pipeBufferSize = 1024 * 1024;
+    // 子进程意外退出后是否自动重启
+    bool restartOnCrash = true;
+    // 最多自动重启次数
+    int maxRestarts = 3;
+    // 重启后允许重放的 tools/call 工具名（须为幂等工具；其余工具调用不重放）
+    std::vector<std::string> replayableTools;
+    // 子进程 stderr 行回调；为空时转发到本进程 stderr
+    std::function<void(std::string_view)> stderrHandler;
+};
+
+/**
+ * @brief 托管一个 stdio MCP 服务端子进程
+ *
+ * 通过 fork/exec 启动服务端，并用三条专用管道连接其 stdin/stdout/stderr。
+ * stdout 按行读取（一行一条 JSON-RPC 消息；遇到 Content-Length 头部时按长度一次读取正文），
+ * stderr 由后台线程异步读取并按行回调，
+ * 避免子进程因 stderr 写满而阻塞。子进程崩溃后可以通过 restart() 重新拉起。
+ *
+ * @note 写入与读取分别加锁，但同一时刻只应有一个请求方在等待响应。
+ */
+class McpStdioProcess : public McpMessageChannel {
+public:
+    explicit McpStdioProcess(McpStdioProcessOptions options);
+    ~McpStdioProcess() override;
+
+    McpStdioProcess(const McpStdioProcess&) = delete;
+    McpStdioProcess& operator=(const McpStdioProcess&) = delete;
+    McpStdioProcess(McpStdioProcess&&) = delete;
+    McpStdioProcess& operator=(McpStdioProcess&&) = delete;
+
+    /**
+     * @brief 启动子进程
+     * @return 成功返回void；fork/exec 或管道创建失败返回 ConnectionFailed
+     */
+    std::expected<void, McpError> start();
+
+    /**
+     * @brief 关闭管道并回收子进程（先 SIGTERM，超时后 SIGKILL）
+     */
+    void stop();
+
+    /**
+     * @brief 子进程崩溃后重新拉起
+     * @return 超过 maxRestarts 或未开启 restartOnCrash 时返回 ConnectionClosed
+     */
+    std::expected<void, McpError> restart();
+
+    /**
+     * @brief 检查子进程是否仍在运行（非阻塞回收已退出的子进程）
+     */
+    bool isAlive();
+
+    /**
+     * @brief 等待子进程退出（轮询回收，最多等待 timeout）
+     * @return 子进程已退出返回 true
+     * @note 子进程关闭 stdout 到可以被回收之间有短暂窗口，判断是否崩溃前用它代替 isAlive()
+     */
+    bool waitForExit(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 写入一条消息（按当前分帧方式追加换行符或前置 Content-Length 头部）
+     */
+    std::expected<void, McpError> writeMessage(std::string_view message) override;
+
+    /**
+     * @brief 读取一条非空消息（自动识别两种分帧方式）
+     */
+    std::expected<std::string, McpError> readMessage() override;
+
+    void setFraming(McpStdioFraming framing) override;
+
+    const McpStdioProcessOptions& options() const { return m_options; }
+    pid_t pid() const { return m_pid; }
+    int restartCount() const { return m_restartCount; }
+    int exitStatus() const { return m_exitStatus; }
+
+private:
+    std::expected<void, McpError> spawn();
+    void closePipes();
+    void reap();
+    std::expected<void, McpError> fill();
+    std::expected<std::string, McpError> readLine();
+    std::expected<std::string, McpError> readExact(size_t length);
+    void stderrLoop(int fd);
+
+private:
+    McpStdioProcessOptions m_options;
+    pid_t m_pid{-1};
+    int m_stdinFd{-1};
+    int m_stdoutFd{-1};
+    int m_stderrFd{-1};
+    int m_restartCount{0};
+    int m_exitStatus{0};
+
+    // stdout 读缓冲：[m_readPos, m_readBuffer.size()) 为未消费数据
+    std::string m_readBuffer;
+    size_t m_readPos{0};
+
+    McpStdioFraming m_framing{McpStdioFraming::Newline};
+
+    std::thread m_stderrThread;
+    std::mutex m_writeMutex;
+    std::mutex m_readMutex;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_CLIENT_MCPSTDIOPROCESS_H
@@ -0,0 +1,149 @@
+#include "galay-mcp/common/McpAsyncSemaphore.h"
+#include <algorithm>
+
+namespace galay {
+namespace mcp {
+
+McpAsyncSemaphore::Permit::Permit(McpAsyncSemaphore* owner, std::shared_ptr<Waiter> waiter)
+    : m_owner(owner)
+    , m_waiter(std::move(waiter)) {
+}
+
+McpAsyncSemaphore::Permit::~Permit() {
+    reset();
+}
+
+McpAsyncSemaphore::Permit::Permit(Permit&& other) noexcept
+    : m_owner(other.m_owner)
+    , m_waiter(std::move(other.m_waiter)) {
+    other.m_owner = nullptr;
+}
+
+McpAsyncSemaphore::Permit& McpAsyncSemaphore::Permit::operator=(Permit&& other) noexcept {
+    if (this != &other) {
+        reset();
+        m_owner = other.m_owner;
+        m_waiter = std::move(other.m_waiter);
+        other.m_owner = nullptr;
+    }
+    return *this;
+}
+
+bool McpAsyncSemaphore::Permit::ready() const {
+    if (!m_owner) {
+        return false;
+    }
+    return !m_waiter || m_waiter->granted.load(std::memory_order_acquire);
+}
+
+void McpAsyncSemaphore::Permit::wakeOnReady(std::shared_ptr<McpWakeSignal> signal) {
+    if (m_owner && m_waiter) {
+        m_owner->setWake(m_waiter, std::move(signal));
+        return;
+    }
+    if (signal) {
+        signal->notify();
+    }
+}
+
+void McpAsyncSemaphore::Permit::reset() {
+    if (!m_owner) {
+        return;
+    }
+    if (m_waiter) {
+        m_owner->abandon(m_waiter);
+    } else {
+        m_owner->release();
+    }
+    m_owner = nullptr;
+    m_waiter.reset();
+}
+
+McpAsyncSemaphore::McpAsyncSemaphore(size_t permits)
+    : m_permits(permits == 0 ? 1 : permits) {
+}
+
+McpAsyncSemaphore::Permit McpAsyncSemaphore::acquire() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_inUse < m_permits && m_waiters.empty()) {
+        ++m_inUse;
+        ++m_acquired;
+        return Permit(this, nullptr);
+    }
+
+    auto waiter = std::make_shared<Waiter>();
+    waiter->enqueuedAt = Clock::now();
+    m_waiters.push_back(waiter);
+    ++m_queued;
+    return Permit(this, std::move(waiter));
+}
+
+void McpAsyncSemaphore::release() {
+    std::shared_ptr<McpWakeSignal> wake;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_waiters.empty()) {
+            --m_inUse;
+            return;
+        }
+
+        // 名额直接移交给队首等待者，m_inUse 不变
+        std::shared_ptr<Waiter> next = std::move(m_waiters.front());
+        m_waiters.pop_front();
+        const Clock::duration waited = Clock::now() - next->enqueuedAt;
+        m_totalWait += waited;
+        m_maxWait = std::max(m_maxWait, waited);
+        ++m_acquired;
+        next->granted.store(true, std::memory_order_release);
+        wake = std::move(next->wake);
+    }
+    // notify() 把等待方投递回它自己的执行器，本线程（通常在 Permit 析构中）不会嵌套运行它；
+    // 通知放在锁外，避免与投递路径上的锁交错
+    if (wake) {
+        wake->notify();
+    }
+}
+
+void McpAsyncSemaphore::setWake(const std::shared_ptr<Waiter>& waiter, std::shared_ptr<McpWakeSignal> signal) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!waiter->granted.load(std::memory_order_relaxed)) {
+            waiter->wake = std::move(signal);
+            return;
+        }
+    }
+    if (signal) {
+        signal->notify();
+    }
+}
+
+void McpAsyncSemaphore::abandon(const std::shared_ptr<Waiter>& waiter) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!waiter->granted.load(std::memory_order_relaxed)) {
+            auto it = std::find(m_waiters.begin(), m_waiters.end(), waiter);
+            if (it != m_waiters.end()) {
+                m_waiters.erase(it);
+            }
+            return;
+        }
+    }
+    // 移交已经发生：归还名额
+    release();
+}
+
+McpSemaphoreStats McpAsyncSemaphore::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    McpSemaphoreStats stats;
+    stats.permits = m_permits;
+    stats.inUse = m_inUse;
+    stats.waiting = m_waiters.size();
+    stats.acquired = m_acquired;
+    stats.queued = m_queued;
+    stats.totalWait = std::chrono::duration_cast<std::chrono::microseconds>(m_totalWait);
+    stats.maxWait = std::chrono::duration_cast<std::chrono::microseconds>(m_maxWait);
+    return stats;
+}
+
+} // namespace mcp
+} // namespace galay
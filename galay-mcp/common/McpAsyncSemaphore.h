@@ -0,0 +1,103 @@
+#ifndef GALAY_MCP_COMMON_MCPASYNCSEMAPHORE_H
+#define GALAY_MCP_COMMON_MCPASYNCSEMAPHORE_H
+
+#include "galay-mcp/common/McpWakeSignal.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief McpAsyncSemaphore 计数快照
+ */
+struct McpSemaphoreStats {
+    size_t permits = 0;                     // 名额总数
+    size_t inUse = 0;                       // 已被持有的名额
+    size_t waiting = 0;                     // 当前排队数
+    uint64_t acquired = 0;                  // 累计获得名额次数（含排队后获得）
+    uint64_t queued = 0;                    // 累计需要排队的次数
+    std::chrono::microseconds totalWait{0}; // 排队后获得名额的累计等待时间
+    std::chrono::microseconds maxWait{0};
+};
+
+/**
+ * @brief 不阻塞线程的 FIFO 计数信号量
+ *
+ * acquire() 立即返回一个 Permit：有空闲名额时直接就绪，否则进入等待队列。
+ * 名额释放时按排队顺序直接移交给队首等待者，并通知该等待者通过 wakeOnReady() 登记的
+ * McpWakeSignal，等待的协程 co_await 该唤醒点即可，不占用线程也不需要轮询。等待方被投递回
+ * 它挂起时所在的调度器恢复，释放名额的线程（Permit 析构）不会在自己的调用栈里运行下一个持有者。
+ * Permit 析构时归还名额；尚未就绪的 Permit 析构时退出队列。所有方法线程安全。
+ */
+class McpAsyncSemaphore {
+    struct Waiter;
+
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Permit {
+    public:
+        Permit() = default;
+        ~Permit();
+
+        Permit(Permit&& other) noexcept;
+        Permit& operator=(Permit&& other) noexcept;
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+
+        // 是否已持有名额
+        bool ready() const;
+
+        // 名额移交给本 Permit 时通知 signal；已就绪时立即通知
+        void wakeOnReady(std::shared_ptr<McpWakeSignal> signal);
+
+    private:
+        friend class McpAsyncSemaphore;
+        Permit(McpAsyncSemaphore* owner, std::shared_ptr<Waiter> waiter);
+        void reset();
+
+        McpAsyncSemaphore* m_owner = nullptr;
+        std::shared_ptr<Waiter> m_waiter; // 为空表示立即获得了名额
+    };
+
+    explicit McpAsyncSemaphore(size_t permits);
+
+    McpAsyncSemaphore(const McpAsyncSemaphore&) = delete;
+    McpAsyncSemaphore& operator=(const McpAsyncSemaphore&) = delete;
+
+    Permit acquire();
+
+    McpSemaphoreStats stats() const;
+
+private:
+    struct Waiter {
+        std::atomic<bool> granted{false};
+        Clock::time_point enqueuedAt;
+        std::shared_ptr<McpWakeSignal> wake; // 受 m_mutex 保护
+    };
+
+    void release();
+    void abandon(const std::shared_ptr<Waiter>& waiter);
+    void setWake(const std::shared_ptr<Waiter>& waiter, std::shared_ptr<McpWakeSignal> signal);
+
+    const size_t m_permits;
+    mutable std::mutex m_mutex;
+    size_t m_inUse{0};
+    std::deque<std::shared_ptr<Waiter>> m_waiters;
+    uint64_t m_acquired{0};
+    uint64_t m_queued{0};
+    Clock::duration m_totalWait{};
+    Clock::duration m_maxWait{};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPASYNCSEMAPHORE_H
@@ -1,4 +1,5 @@
 #include "galay-mcp/common/McpBase.h"
+#include <algorithm>
 
 namespace galay {
 namespace mcp {
@@ -29,7 +30,7 @@ std::expected<int64_t, McpError> RequireInt64(const JsonObject& obj, const char*
     return value;
 }
 
-void WriteRawOrEmptyObject(JsonWriter& writer, const JsonString& raw) {
+void WriteRawOrEmptyObject(McpEncoder& writer, const JsonString& raw) {
     if (raw.empty()) {
         writer.StartObject();
         writer.EndObject();
@@ -38,10 +39,19 @@ void WriteRawOrEmptyObject(JsonWriter& writer, const JsonString& raw) {
     writer.Raw(raw);
 }
 
+// tools / resources / prompts 能力对象：{} 或 {"listChanged":true}
+void WriteListCapability(McpEncoder& writer, bool listChanged) {
+    writer.StartObject();
+    if (listChanged) {
+        writer.Key("listChanged");
+        writer.Bool(true);
+    }
+    writer.EndObject();
+}
+
 } // namespace
 
-JsonString Content::toJson() const {
-    JsonWriter writer;
+void Content::encode(McpEncoder& writer) const {
     writer.StartObject();
     switch (type) {
         case ContentType::Text:
@@ -54,7 +64,7 @@ JsonString Content::toJson() const {
             writer.Key("type");
             writer.String("image");
             writer.Key("data");
-            writer.String(data);
+            writer.Base64(data);
             writer.Key("mimeType");
             writer.String(mimeType);
             break;
@@ -66,6 +76,11 @@ JsonString Content::toJson() const {
             break;
     }
     writer.EndObject();
+}
+
+JsonString Content::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -116,8 +131,7 @@ std::expected<Content, McpError> Content::fromJson(const JsonElement& element) {
     return c;
 }
 
-JsonString Tool::toJson() const {
-    JsonWriter writer;
+void Tool::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("name");
     writer.String(name);
@@ -125,7 +139,16 @@ JsonString Tool::toJson() const {
     writer.String(description);
     writer.Key("inputSchema");
     WriteRawOrEmptyObject(writer, inputSchema);
+    if (!outputSchema.empty()) {
+        writer.Key("outputSchema");
+        writer.Raw(outputSchema);
+    }
     writer.EndObject();
+}
+
+JsonString Tool::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -155,12 +178,17 @@ std::expected<Tool, McpError> Tool::fromJson(const JsonElement& element) {
             t.inputSchema = std::move(raw);
         }
     }
+    if (JsonHelper::GetElement(obj, "outputSchema", schemaElement)) {
+        std::string raw;
+        if (JsonHelper::GetRawJson(schemaElement, raw)) {
+            t.outputSchema = std::move(raw);
+        }
+    }
 
     return t;
 }
 
-JsonString Resource::toJson() const {
-    JsonWriter writer;
+void Resource::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("uri");
     writer.String(uri);
@@ -171,6 +199,11 @@ JsonString Resource::toJson() const {
     writer.Key("mimeType");
     writer.String(mimeType);
     writer.EndObject();
+}
+
+JsonString Resource::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -206,8 +239,7 @@ std::expected<Resource, McpError> Resource::fromJson(const JsonElement& element)
     return r;
 }
 
-JsonString PromptArgument::toJson() const {
-    JsonWriter writer;
+void PromptArgument::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("name");
     writer.String(name);
@@ -216,6 +248,11 @@ JsonString PromptArgument::toJson() const {
     writer.Key("required");
     writer.Bool(required);
     writer.EndObject();
+}
+
+JsonString PromptArgument::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -246,8 +283,7 @@ std::expected<PromptArgument, McpError> PromptArgument::fromJson(const JsonEleme
     return arg;
 }
 
-JsonString Prompt::toJson() const {
-    JsonWriter writer;
+void Prompt::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("name");
     writer.String(name);
@@ -256,10 +292,15 @@ JsonString Prompt::toJson() const {
     writer.Key("arguments");
     writer.StartArray();
     for (const auto& arg : arguments) {
-        writer.Raw(arg.toJson());
+        arg.encode(writer);
     }
     writer.EndArray();
     writer.EndObject();
+}
+
+JsonString Prompt::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -296,14 +337,18 @@ std::expected<Prompt, McpError> Prompt::fromJson(const JsonElement& element) {
     return p;
 }
 
-JsonString ClientInfo::toJson() const {
-    JsonWriter writer;
+void ClientInfo::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("name");
     writer.String(name);
     writer.Key("version");
     writer.String(version);
     writer.EndObject();
+}
+
+JsonString ClientInfo::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -328,8 +373,7 @@ std::expected<ClientInfo, McpError> ClientInfo::fromJson(const JsonElement& elem
     return c;
 }
 
-JsonString ServerInfo::toJson() const {
-    JsonWriter writer;
+void ServerInfo::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("name");
     writer.String(name);
@@ -338,6 +382,11 @@ JsonString ServerInfo::toJson() const {
     writer.Key("capabilities");
     WriteRawOrEmptyObject(writer, capabilities);
     writer.EndObject();
+}
+
+JsonString ServerInfo::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -371,30 +420,35 @@ std::expected<ServerInfo, McpError> ServerInfo::fromJson(const JsonElement& elem
     return s;
 }
 
-JsonString ServerCapabilities::toJson() const {
-    JsonWriter writer;
+void ServerCapabilities::encode(McpEncoder& writer) const {
     writer.StartObject();
     if (tools) {
         writer.Key("tools");
-        writer.StartObject();
-        writer.EndObject();
+        WriteListCapability(writer, listChanged);
     }
     if (resources) {
         writer.Key("resources");
-        writer.StartObject();
-        writer.EndObject();
+        WriteListCapability(writer, listChanged);
     }
     if (prompts) {
         writer.Key("prompts");
-        writer.StartObject();
-        writer.EndObject();
+        WriteListCapability(writer, listChanged);
     }
     if (logging) {
         writer.Key("logging");
         writer.StartObject();
         writer.EndObject();
     }
+    if (!experimental.empty()) {
+        writer.Key("experimental");
+        writer.Raw(experimental);
+    }
     writer.EndObject();
+}
+
+JsonString ServerCapabilities::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -415,19 +469,40 @@ std::expected<ServerCapabilities, McpError> ServerCapabilities::fromJson(const J
     auto loggingVal = obj["logging"];
     c.logging = !loggingVal.error() && !loggingVal.is_null();
 
+    for (const char* key : {"tools", "resources", "prompts"}) {
+        JsonObject listObj;
+        bool listChanged = false;
+        if (JsonHelper::GetObject(obj, key, listObj) &&
+            JsonHelper::GetBool(listObj, "listChanged", listChanged) && listChanged) {
+            c.listChanged = true;
+        }
+    }
+
+    JsonElement experimentalElement;
+    if (JsonHelper::GetElement(obj, "experimental", experimentalElement)) {
+        std::string raw;
+        if (JsonHelper::GetRawJson(experimentalElement, raw)) {
+            c.experimental = std::move(raw);
+        }
+    }
+
     return c;
 }
 
-JsonString InitializeParams::toJson() const {
-    JsonWriter writer;
+void InitializeParams::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("protocolVersion");
     writer.String(protocolVersion);
     writer.Key("clientInfo");
-    writer.Raw(clientInfo.toJson());
+    clientInfo.encode(writer);
     writer.Key("capabilities");
     WriteRawOrEmptyObject(writer, capabilities);
     writer.EndObject();
+}
+
+JsonString InitializeParams::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -466,16 +541,20 @@ std::expected<InitializeParams, McpError> InitializeParams::fromJson(const JsonE
     return p;
 }
 
-JsonString InitializeResult::toJson() const {
-    JsonWriter writer;
+void InitializeResult::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("protocolVersion");
     writer.String(protocolVersion);
     writer.Key("serverInfo");
-    writer.Raw(serverInfo.toJson());
+    serverInfo.encode(writer);
     writer.Key("capabilities");
-    writer.Raw(capabilities.toJson());
+    capabilities.encode(writer);
     writer.EndObject();
+}
+
+JsonString InitializeResult::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -516,14 +595,18 @@ std::expected<InitializeResult, McpError> InitializeResult::fromJson(const JsonE
     return r;
 }
 
-JsonString ToolCallParams::toJson() const {
-    JsonWriter writer;
+void ToolCallParams::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("name");
     writer.String(name);
     writer.Key("arguments");
     WriteRawOrEmptyObject(writer, arguments);
     writer.EndObject();
+}
+
+JsonString ToolCallParams::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -552,20 +635,36 @@ std::expected<ToolCallParams, McpError> ToolCallParams::fromJson(const JsonEleme
     return p;
 }
 
-JsonString ToolCallResult::toJson() const {
-    JsonWriter writer;
+void ToolCallResult::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("content");
     writer.StartArray();
     for (const auto& item : content) {
-        writer.Raw(item.toJson());
+        item.encode(writer);
     }
     writer.EndArray();
+    if (!structuredContent.empty()) {
+        writer.Key("structuredContent");
+        // 按行分帧的传输不允许消息内换行；JSON 字符串中的换行总是转义的，裸换行只会是空白
+        if (structuredContent.find_first_of("\r\n") == std::string::npos) {
+            writer.Raw(structuredContent);
+        } else {
+            std::string compact = structuredContent;
+            std::replace(compact.begin(), compact.end(), '\n', ' ');
+            std::replace(compact.begin(), compact.end(), '\r', ' ');
+            writer.Raw(compact);
+        }
+    }
     if (isError) {
         writer.Key("isError");
         writer.Bool(true);
     }
     writer.EndObject();
+}
+
+JsonString ToolCallResult::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -589,6 +688,14 @@ std::expected<ToolCallResult, McpError> ToolCallResult::fromJson(const JsonEleme
         }
     }
 
+    JsonElement structured;
+    if (JsonHelper::GetElement(obj, "structuredContent", structured)) {
+        std::string raw;
+        if (JsonHelper::GetRawJson(structured, raw)) {
+            r.structuredContent = std::move(raw);
+        }
+    }
+
     bool isError = false;
     if (JsonHelper::GetBool(obj, "isError", isError)) {
         r.isError = isError;
@@ -597,8 +704,29 @@ std::expected<ToolCallResult, McpError> ToolCallResult::fromJson(const JsonEleme
     return r;
 }
 
-JsonString JsonRpcRequest::toJson() const {
-    JsonWriter writer;
+std::expected<StructuredToolResult, McpError> StructuredToolResult::parse(std::string_view result) {
+    auto docExp = JsonDocument::Parse(result);
+    if (!docExp) {
+        return std::unexpected(McpError::parseError(docExp.error().details()));
+    }
+    StructuredToolResult r;
+    r.document = std::move(docExp.value());
+
+    auto objExp = RequireObject(r.document.Root(), "tool call result");
+    if (!objExp) {
+        return std::unexpected(objExp.error());
+    }
+    bool isError = false;
+    if (JsonHelper::GetBool(objExp.value(), "isError", isError) && isError) {
+        return std::unexpected(McpError::toolExecutionFailed("Tool returned error"));
+    }
+    if (!JsonHelper::GetElement(objExp.value(), "structuredContent", r.structuredContent)) {
+        return std::unexpected(McpError::parseError("tool call result has no structuredContent"));
+    }
+    return r;
+}
+
+void JsonRpcRequest::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("jsonrpc");
     writer.String(jsonrpc);
@@ -613,11 +741,15 @@ JsonString JsonRpcRequest::toJson() const {
         WriteRawOrEmptyObject(writer, params.value());
     }
     writer.EndObject();
-    return writer.TakeString();
 }
 
-JsonString JsonRpcResponse::toJson() const {
+JsonString JsonRpcRequest::toJson() const {
     JsonWriter writer;
+    encode(writer);
+    return writer.TakeString();
+}
+
+void JsonRpcResponse::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("jsonrpc");
     writer.String(jsonrpc);
@@ -632,6 +764,11 @@ JsonString JsonRpcResponse::toJson() const {
         WriteRawOrEmptyObject(writer, error.value());
     }
     writer.EndObject();
+}
+
+JsonString JsonRpcResponse::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -668,8 +805,7 @@ std::expected<JsonRpcResponse, McpError> JsonRpcResponse::fromJson(const JsonEle
     return r;
 }
 
-JsonString JsonRpcNotification::toJson() const {
-    JsonWriter writer;
+void JsonRpcNotification::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("jsonrpc");
     writer.String(jsonrpc);
@@ -680,11 +816,15 @@ JsonString JsonRpcNotification::toJson() const {
         WriteRawOrEmptyObject(writer, params.value());
     }
     writer.EndObject();
-    return writer.TakeString();
 }
 
-JsonString JsonRpcError::toJson() const {
+JsonString JsonRpcNotification::toJson() const {
     JsonWriter writer;
+    encode(writer);
+    return writer.TakeString();
+}
+
+void JsonRpcError::encode(McpEncoder& writer) const {
     writer.StartObject();
     writer.Key("code");
     writer.Number(static_cast<int64_t>(code));
@@ -695,6 +835,11 @@ JsonString JsonRpcError::toJson() const {
         WriteRawOrEmptyObject(writer, data.value());
     }
     writer.EndObject();
+}
+
+JsonString JsonRpcError::toJson() const {
+    JsonWriter writer;
+    encode(writer);
     return writer.TakeString();
 }
 
@@ -36,8 +36,16 @@ namespace Methods {
     constexpr const char* TOOLS_CALL = "tools/call";
     constexpr const char* RESOURCES_LIST = "resources/list";
     constexpr const char* RESOURCES_READ = "resources/read";
+    constexpr const char* RESOURCES_SUBSCRIBE = "resources/subscribe";
+    constexpr const char* RESOURCES_UNSUBSCRIBE = "resources/unsubscribe";
+    constexpr const char* RESOURCE_UPDATED = "notifications/resources/updated";
+    constexpr const char* RESOURCES_LIST_CHANGED = "notifications/resources/list_changed";
+    constexpr const char* TOOLS_LIST_CHANGED = "notifications/tools/list_changed";
     constexpr const char* PROMPTS_LIST = "prompts/list";
+    constexpr const char* PROMPTS_LIST_CHANGED = "notifications/prompts/list_changed";
     constexpr const char* PROMPTS_GET = "prompts/get";
+    constexpr const char* CANCELLED = "notifications/cancelled";
+    constexpr const char* PROGRESS = "notifications/progress";
 }
 
 // 内容类型
@@ -56,6 +64,7 @@ struct Content {
     std::string uri;            // 用于Resource类型
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<Content, McpError> fromJson(const JsonElement& element);
 };
 
@@ -64,8 +73,10 @@ struct Tool {
     std::string name;
     std::string description;
     JsonString inputSchema;           // JSON Schema格式
+    JsonString outputSchema;          // 为空表示未声明；声明后 tools/call 的结果放在 structuredContent 中
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<Tool, McpError> fromJson(const JsonElement& element);
 };
 
@@ -77,6 +88,7 @@ struct Resource {
     std::string mimeType;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<Resource, McpError> fromJson(const JsonElement& element);
 };
 
@@ -87,6 +99,7 @@ struct PromptArgument {
     bool required{false};
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<PromptArgument, McpError> fromJson(const JsonElement& element);
 };
 
@@ -97,15 +110,28 @@ struct Prompt {
     std::vector<PromptArgument> arguments;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<Prompt, McpError> fromJson(const JsonElement& element);
 };
 
+// tools/list、resources/list、prompts/list 的一页结果；nextCursor 为空表示最后一页
+template <typename T>
+struct ListPage {
+    std::vector<T> items;
+    std::string nextCursor;
+    std::string version;               // _meta.listVersion；服务端未提供时为空
+    bool notModified = false;          // 请求带 ifChangedSince 且列表未变化，items 为空
+    bool delta = false;                // items 只含新增或替换的条目，removed 为删除的 key
+    std::vector<std::string> removed;
+};
+
 // 客户端信息
 struct ClientInfo {
     std::string name;
     std::string version;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<ClientInfo, McpError> fromJson(const JsonElement& element);
 };
 
@@ -116,6 +142,7 @@ struct ServerInfo {
     JsonString capabilities;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<ServerInfo, McpError> fromJson(const JsonElement& element);
 };
 
@@ -125,8 +152,11 @@ struct ServerCapabilities {
     bool resources = false;
     bool prompts = false;
     bool logging = false;
+    bool listChanged = false;  // tools / resources / prompts 声明 listChanged，注册表变化时发送通知
+    JsonString experimental;  // capabilities.experimental 原始 JSON，为空时不输出
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<ServerCapabilities, McpError> fromJson(const JsonElement& element);
 };
 
@@ -137,6 +167,7 @@ struct InitializeParams {
     JsonString capabilities;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<InitializeParams, McpError> fromJson(const JsonElement& element);
 };
 
@@ -147,6 +178,7 @@ struct InitializeResult {
     ServerCapabilities capabilities;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<InitializeResult, McpError> fromJson(const JsonElement& element);
 };
 
@@ -156,18 +188,35 @@ struct ToolCallParams {
     JsonString arguments;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<ToolCallParams, McpError> fromJson(const JsonElement& element);
 };
 
 // 工具调用结果
 struct ToolCallResult {
     std::vector<Content> content;
+    JsonString structuredContent;     // JSON 对象文本，原样嵌入，不再转义为字符串；为空表示没有
     bool isError = false;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<ToolCallResult, McpError> fromJson(const JsonElement& element);
 };
 
+/**
+ * @brief 声明了 outputSchema 的工具的调用结果
+ *
+ * document 持有解析后的 result，structuredContent 指向其中的对象：
+ * 结构化结果在响应中只解析一次，不经字符串转义与二次解析，也不再复制。只在持有本对象期间有效。
+ */
+struct StructuredToolResult {
+    JsonDocument document;
+    JsonElement structuredContent;
+
+    // 从 tools/call 的 result 文本解析；isError 或缺少 structuredContent 时返回错误
+    static std::expected<StructuredToolResult, McpError> parse(std::string_view result);
+};
+
 // JSON-RPC请求（用于生成请求）
 struct JsonRpcRequest {
     std::string jsonrpc = JSONRPC_VERSION;
@@ -176,6 +225,7 @@ struct JsonRpcRequest {
     std::optional<JsonString> params;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
 };
 
 // JSON-RPC响应
@@ -186,6 +236,7 @@ struct JsonRpcResponse {
     std::optional<JsonString> error;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<JsonRpcResponse, McpError> fromJson(const JsonElement& element);
 };
 
@@ -196,6 +247,7 @@ struct JsonRpcNotification {
     std::optional<JsonString> params;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
 };
 
 // JSON-RPC错误
@@ -205,6 +257,7 @@ struct JsonRpcError {
     std::optional<JsonString> data;
 
     JsonString toJson() const;
+    void encode(McpEncoder& writer) const;
     static std::expected<JsonRpcError, McpError> fromJson(const JsonElement& element);
 };
 
@@ -217,6 +270,8 @@ namespace ErrorCodes {
     constexpr int INTERNAL_ERROR = -32603;
     constexpr int SERVER_ERROR_START = -32099;
     constexpr int SERVER_ERROR_END = -32000;
+    constexpr int SERVER_OVERLOADED = -32000;  // 服务端过载，请求未执行，可稍后重试
+    constexpr int REQUEST_CANCELLED = -32001;  // 请求被取消或超过客户端给出的超时时间
 }
 
 } // namespace mcp
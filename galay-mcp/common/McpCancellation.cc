@@ -0,0 +1,142 @@
+#include "galay-mcp/common/McpCancellation.h"
+
+namespace galay {
+namespace mcp {
+
+bool McpCancellationToken::isCancelled() const {
+    return reason() != McpCancelReason::None;
+}
+
+McpCancelReason McpCancellationToken::reason() const {
+    if (!m_state) {
+        return McpCancelReason::None;
+    }
+    const McpCancelReason reason = m_state->reason.load(std::memory_order_acquire);
+    if (reason != McpCancelReason::None) {
+        return reason;
+    }
+    if (m_state->deadline && Clock::now() >= *m_state->deadline) {
+        return McpCancelReason::DeadlineExceeded;
+    }
+    return McpCancelReason::None;
+}
+
+std::optional<McpCancellationToken::Clock::time_point> McpCancellationToken::deadline() const {
+    if (!m_state) {
+        return std::nullopt;
+    }
+    return m_state->deadline;
+}
+
+std::optional<McpCancellationToken::Clock::duration> McpCancellationToken::remaining() const {
+    if (!m_state || !m_state->deadline) {
+        return std::nullopt;
+    }
+    const Clock::time_point now = Clock::now();
+    if (now >= *m_state->deadline) {
+        return Clock::duration::zero();
+    }
+    return *m_state->deadline - now;
+}
+
+void McpCancellationToken::wakeOnCancel(const std::shared_ptr<McpWakeSignal>& signal) const {
+    if (!m_state || !signal) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_state->wakeMutex);
+        if (m_state->reason.load(std::memory_order_acquire) == McpCancelReason::None) {
+            m_state->wakes.push_back(signal);
+            if (m_state->deadline) {
+                McpWakeSignal::notifyAt(signal, *m_state->deadline);
+            }
+            return;
+        }
+    }
+    signal->notify();
+}
+
+McpCancellationSource::McpCancellationSource(std::optional<Clock::time_point> deadline)
+    : m_state(std::make_shared<McpCancellationToken::State>()) {
+    m_state->deadline = deadline;
+}
+
+McpCancellationToken McpCancellationSource::token() const {
+    return McpCancellationToken(m_state);
+}
+
+bool McpCancellationSource::cancel(McpCancelReason reason) {
+    std::vector<std::weak_ptr<McpWakeSignal>> wakes;
+    {
+        std::lock_guard<std::mutex> lock(m_state->wakeMutex);
+        McpCancelReason expected = McpCancelReason::None;
+        if (!m_state->reason.compare_exchange_strong(expected, reason, std::memory_order_acq_rel)) {
+            return false;
+        }
+        wakes.swap(m_state->wakes);
+    }
+    // 取消方可能是其他会话的 IO 线程或 Unix 域套接字连接线程：只投递唤醒，被取消的协程回到自己的调度器上
+    // 恢复；通知放在锁外
+    for (const auto& wake : wakes) {
+        if (auto signal = wake.lock()) {
+            signal->notify();
+        }
+    }
+    return true;
+}
+
+void McpInflightCalls::add(const std::string& owner, int64_t requestId, int connection,
+                           const McpCancellationSource& source) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_calls.emplace(std::make_pair(owner, requestId), Call{source, connection});
+}
+
+void McpInflightCalls::remove(const std::string& owner, int64_t requestId, const McpCancellationSource& source) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [first, last] = m_calls.equal_range(std::make_pair(owner, requestId));
+    for (auto entry = first; entry != last; ++entry) {
+        if (entry->second.source.token() == source.token()) {
+            m_calls.erase(entry);
+            return;
+        }
+    }
+}
+
+bool McpInflightCalls::cancel(const std::string& owner, int64_t requestId, McpCancelReason reason) {
+    // 取消会唤醒等待中的调用，被唤醒方可能立即 remove()，因此在锁外触发
+    std::vector<McpCancellationSource> sources;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto [first, last] = m_calls.equal_range(std::make_pair(owner, requestId));
+        for (auto entry = first; entry != last; ++entry) {
+            sources.push_back(entry->second.source);
+        }
+    }
+    for (auto& source : sources) {
+        source.cancel(reason);
+    }
+    return !sources.empty();
+}
+
+void McpInflightCalls::cancelConnection(int connection) {
+    std::vector<McpCancellationSource> sources;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& [key, call] : m_calls) {
+            if (call.connection == connection) {
+                sources.push_back(call.source);
+            }
+        }
+    }
+    for (auto& source : sources) {
+        source.cancel(McpCancelReason::ConnectionClosed);
+    }
+}
+
+size_t McpInflightCalls::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_calls.size();
+}
+
+} // namespace mcp
+} // namespace galay
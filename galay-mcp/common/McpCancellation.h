@@ -0,0 +1,129 @@
+#ifndef GALAY_MCP_COMMON_MCPCANCELLATION_H
+#define GALAY_MCP_COMMON_MCPCANCELLATION_H
+
+#include "galay-mcp/common/McpWakeSignal.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 请求被取消的原因
+ */
+enum class McpCancelReason {
+    None,
+    Cancelled,          // 客户端发送 notifications/cancelled
+    DeadlineExceeded,   // 超过客户端给出的超时时间
+    ConnectionClosed    // 请求所在的连接 / 输入流已关闭
+};
+
+/**
+ * @brief 单个请求的取消令牌（只读视图）
+ *
+ * 由 McpCancellationSource 创建，处理函数在耗时步骤之间检查 isCancelled()，
+ * 为 true 时应尽快返回并释放资源。截止时间到达后无需任何线程介入即视为已取消。
+ * 默认构造的令牌永不取消。可以跨线程拷贝与读取。
+ */
+class McpCancellationToken {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    McpCancellationToken() = default;
+
+    bool isCancelled() const;
+    McpCancelReason reason() const;
+
+    std::optional<Clock::time_point> deadline() const;
+
+    // 距截止时间的剩余时长（已过期时为 0）；没有截止时间时返回 std::nullopt
+    std::optional<Clock::duration> remaining() const;
+
+    // 取消或截止时间到达时通知 signal（已取消时立即通知），等待方据此代替轮询 isCancelled()；
+    // 取消方与定时线程只投递唤醒，被取消的协程回到它自己的调度器上恢复
+    void wakeOnCancel(const std::shared_ptr<McpWakeSignal>& signal) const;
+
+    // 是否来自同一个取消源
+    friend bool operator==(const McpCancellationToken&, const McpCancellationToken&) = default;
+
+private:
+    friend class McpCancellationSource;
+
+    struct State {
+        std::atomic<McpCancelReason> reason{McpCancelReason::None};
+        std::optional<Clock::time_point> deadline;
+        std::mutex wakeMutex;
+        std::vector<std::weak_ptr<McpWakeSignal>> wakes; // cancel() 时通知，受 wakeMutex 保护
+    };
+
+    explicit McpCancellationToken(std::shared_ptr<State> state)
+        : m_state(std::move(state)) {
+    }
+
+    std::shared_ptr<State> m_state;
+};
+
+/**
+ * @brief 取消令牌的触发端，由服务端为每个请求持有
+ */
+class McpCancellationSource {
+public:
+    using Clock = McpCancellationToken::Clock;
+
+    explicit McpCancellationSource(std::optional<Clock::time_point> deadline = std::nullopt);
+
+    McpCancellationToken token() const;
+
+    // 只有第一次调用生效；返回本次调用是否触发了取消
+    bool cancel(McpCancelReason reason = McpCancelReason::Cancelled);
+
+private:
+    std::shared_ptr<McpCancellationToken::State> m_state;
+};
+
+/**
+ * @brief 按请求方划分的在途调用表
+ *
+ * JSON-RPC id 只在单个请求方内唯一，不同客户端可能同时使用相同的 id，因此调用按
+ * (owner, id) 登记，notifications/cancelled 只取消发送方自己的调用。owner 由传输层给出：
+ * Streamable HTTP 为会话 id，无会话的传输为连接标识。connection 是可检测关闭的连接标识
+ * （没有时为 -1），连接关闭时取消其上的所有调用。线程安全。
+ */
+class McpInflightCalls {
+public:
+    void add(const std::string& owner, int64_t requestId, int connection, const McpCancellationSource& source);
+
+    // 注销 add() 登记的调用（以 source 区分同一请求方重复使用的 id）
+    void remove(const std::string& owner, int64_t requestId, const McpCancellationSource& source);
+
+    // 取消 owner 发出的 requestId 调用；返回是否找到
+    bool cancel(const std::string& owner, int64_t requestId, McpCancelReason reason = McpCancelReason::Cancelled);
+
+    // 取消连接上的所有调用
+    void cancelConnection(int connection);
+
+    size_t size() const;
+
+private:
+    struct Call {
+        McpCancellationSource source;
+        int connection;
+    };
+
+    mutable std::mutex m_mutex;
+    std::multimap<std::pair<std::string, int64_t>, Call> m_calls;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPCANCELLATION_H
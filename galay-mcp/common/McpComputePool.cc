@@ -0,0 +1,125 @@
+#include "galay-mcp/common/McpComputePool.h"
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+// 当前线程所属的线程池与队列下标，用于把工作线程内部提交的任务放进自己的队列
+thread_local const McpComputePool* t_pool = nullptr;
+thread_local size_t t_index = 0;
+
+} // namespace
+
+McpComputePool::McpComputePool(size_t threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    if (threads == 0) {
+        threads = 1;
+    }
+
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&McpComputePool::workerLoop, this, i);
+    }
+}
+
+McpComputePool::~McpComputePool() {
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        m_stopping = true;
+    }
+    m_idle.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void McpComputePool::submit(std::function<void()> task) {
+    const size_t index = t_pool == this
+        ? t_index
+        : m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    {
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_idleMutex);
+        ++m_pending;
+    }
+    m_idle.notify_one();
+}
+
+void McpComputePool::submit(std::function<void()> task, std::shared_ptr<McpWakeSignal> done) {
+    submit([task = std::move(task), done = std::move(done)]() {
+        try {
+            task();
+        } catch (...) {
+        }
+        done->notify();
+    });
+}
+
+void McpComputePool::workerLoop(size_t index) {
+    t_pool = this;
+    t_index = index;
+
+    std::function<void()> task;
+    while (true) {
+        if (popLocal(index, task) || steal(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(m_idleMutex);
+                --m_pending;
+            }
+            try {
+                task();
+            } catch (...) {
+            }
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_idleMutex);
+        m_idle.wait(lock, [this]() { return m_stopping || m_pending > 0; });
+        if (m_stopping && m_pending == 0) {
+            break;
+        }
+    }
+
+    t_pool = nullptr;
+}
+
+bool McpComputePool::popLocal(size_t index, std::function<void()>& task) {
+    Worker& worker = *m_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+bool McpComputePool::steal(size_t index, std::function<void()>& task) {
+    const size_t count = m_workers.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(index + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        m_stolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,82 @@
+#ifndef GALAY_MCP_COMMON_MCPCOMPUTEPOOL_H
+#define GALAY_MCP_COMMON_MCPCOMPUTEPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "galay-mcp/common/McpWakeSignal.h"
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 执行 CPU 密集型任务的工作窃取线程池
+ *
+ * 每个工作线程持有自己的双端队列：本线程按 LIFO 取任务以保持缓存局部性，
+ * 空闲线程从其他队列头部按 FIFO 窃取。外部线程提交的任务轮询分配到各队列，
+ * 工作线程内部提交的任务进入自己的队列。
+ * 析构时执行完已提交的任务再回收线程。
+ */
+class McpComputePool {
+public:
+    /**
+     * @param threads 工作线程数；为 0 时取 std::thread::hardware_concurrency()
+     */
+    explicit McpComputePool(size_t threads = 0);
+    ~McpComputePool();
+
+    McpComputePool(const McpComputePool&) = delete;
+    McpComputePool& operator=(const McpComputePool&) = delete;
+
+    /**
+     * @brief 提交一个任务
+     * @note 任务抛出的异常会被吞掉，需要结果或异常的调用方应自行捕获并传回
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief 提交一个任务，任务结束（包括抛出异常）后在工作线程上 done->notify()
+     * @note 等待 done 的协程在工作线程上恢复，用于代替轮询完成标志
+     */
+    void submit(std::function<void()> task, std::shared_ptr<McpWakeSignal> done);
+
+    // 工作线程数
+    size_t size() const { return m_workers.size(); }
+
+    // 累计被其他线程窃取执行的任务数
+    uint64_t stolenCount() const { return m_stolen.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, std::function<void()>& task);
+    bool steal(size_t index, std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_idleMutex;
+    std::condition_variable m_idle;
+    size_t m_pending{0};    // 已提交未取走的任务数，受 m_idleMutex 保护
+    bool m_stopping{false}; // 受 m_idleMutex 保护
+
+    std::atomic<size_t> m_next{0};
+    std::atomic<uint64_t> m_stolen{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPCOMPUTEPOOL_H
@@ -0,0 +1,77 @@
+#include "galay-mcp/common/McpContentWriter.h"
+#include "galay-mcp/common/McpEncoding.h"
+#include "galay-mcp/common/McpJson.h"
+#include <algorithm>
+
+namespace galay {
+namespace mcp {
+
+McpContentWriter::McpContentWriter(McpContentEncoding encoding, Output output, size_t flushBytes)
+    : m_encoding(encoding)
+    , m_output(std::move(output))
+    , m_flushBytes(std::max<size_t>(flushBytes, 1)) {
+}
+
+bool McpContentWriter::write(std::string_view data) {
+    if (m_failed) {
+        return false;
+    }
+    m_bytesWritten += data.size();
+    // 分段编码，单次写入很大时缓冲区也不会超过 flushBytes 太多
+    while (!data.empty()) {
+        std::string_view part = data.substr(0, m_flushBytes);
+        data.remove_prefix(part.size());
+        if (m_encoding == McpContentEncoding::JsonString) {
+            JsonWriter::AppendEscaped(m_buffer, part);
+        } else if (m_encoding == McpContentEncoding::Base64) {
+            // 先用本段开头补齐上次留下的尾部，再编码整组，剩余不足 3 字节的留到下次
+            if (!m_pending.empty()) {
+                const size_t take = std::min(3 - m_pending.size(), part.size());
+                m_pending.append(part.substr(0, take));
+                part.remove_prefix(take);
+                if (m_pending.size() < 3) {
+                    continue;
+                }
+                m_buffer += encoding::base64Encode(m_pending);
+                m_pending.clear();
+            }
+            const size_t whole = part.size() - part.size() % 3;
+            m_buffer += encoding::base64Encode(part.substr(0, whole));
+            m_pending.assign(part.substr(whole));
+        } else {
+            m_buffer.append(part);
+        }
+        if (m_buffer.size() >= m_flushBytes && !emit()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool McpContentWriter::flush() {
+    if (m_failed) {
+        return false;
+    }
+    if (!m_pending.empty()) {
+        m_buffer += encoding::base64Encode(m_pending);
+        m_pending.clear();
+    }
+    return emit();
+}
+
+bool McpContentWriter::emit() {
+    if (m_failed) {
+        return false;
+    }
+    if (m_buffer.empty()) {
+        return true;
+    }
+    if (!m_output(m_buffer)) {
+        m_failed = true;
+    }
+    m_buffer.clear();
+    return !m_failed;
+}
+
+} // namespace mcp
+} // namespace galay
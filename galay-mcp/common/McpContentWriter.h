@@ -0,0 +1,70 @@
+#ifndef GALAY_MCP_COMMON_MCPCONTENTWRITER_H
+#define GALAY_MCP_COMMON_MCPCONTENTWRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 流式内容写出前的编码方式
+ */
+enum class McpContentEncoding {
+    Raw,         // 原样输出（进程内调用、需要整体编码的传输）
+    JsonString,  // 按 JSON 字符串转义，不含两端引号，直接拼接在响应的 "text":" 之后
+    Base64       // 按 base64 编码，直接拼接在资源内容的 "blob":" 之后
+};
+
+/**
+ * @brief 流式处理函数的输出端
+ *
+ * 处理函数分块调用 write()，内容按编码方式追加到内部缓冲区，达到 flushBytes 时整块交给
+ * 服务端的输出函数并清空缓冲区复用，内存占用与输出总长无关。
+ * 输出函数返回 false（连接已断开、调用已取消或写出失败）后，write() / flush() 一律返回 false，
+ * 处理函数应尽快返回。同一时刻只能由一个线程写入。
+ * Base64 编码时不足 3 字节的尾部留到下一次写入，flush() 补齐填充，之后不应再写入。
+ */
+class McpContentWriter {
+public:
+    // 收到一块已编码的字节；返回 false 表示不再接收
+    using Output = std::function<bool(std::string_view encoded)>;
+
+    static constexpr size_t DEFAULT_FLUSH_BYTES = 64 * 1024;
+
+    McpContentWriter(McpContentEncoding encoding, Output output, size_t flushBytes = DEFAULT_FLUSH_BYTES);
+
+    McpContentWriter(const McpContentWriter&) = delete;
+    McpContentWriter& operator=(const McpContentWriter&) = delete;
+
+    // 追加一段内容；任意边界切分都不影响编码结果
+    bool write(std::string_view data);
+
+    // 把缓冲区中剩余的内容交给输出函数；缓冲区为空时不调用。Base64 编码时同时结束编码
+    bool flush();
+
+    // 输出函数是否已拒绝写入
+    bool failed() const { return m_failed; }
+
+    // 累计写入的原始字节数（编码前）
+    uint64_t bytesWritten() const { return m_bytesWritten; }
+
+private:
+    bool emit();
+
+    McpContentEncoding m_encoding;
+    Output m_output;
+    size_t m_flushBytes;
+    std::string m_buffer;
+    std::string m_pending;  // Base64 编码时尚未凑满 3 字节的尾部
+    uint64_t m_bytesWritten = 0;
+    bool m_failed = false;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPCONTENTWRITER_H
@@ -0,0 +1,747 @@
+#include "galay-mcp/common/McpEncoding.h"
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <limits>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+constexpr int kMaxDepth = 1024;
+
+constexpr char kBase64Alphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void AppendByte(std::string& out, uint8_t value) {
+    out.push_back(static_cast<char>(value));
+}
+
+void AppendBigEndian(std::string& out, uint64_t value, int bytes) {
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+void WriteUnsigned(std::string& out, uint64_t value) {
+    if (value < 0x80) {
+        AppendByte(out, static_cast<uint8_t>(value));
+    } else if (value <= 0xff) {
+        AppendByte(out, 0xcc);
+        AppendBigEndian(out, value, 1);
+    } else if (value <= 0xffff) {
+        AppendByte(out, 0xcd);
+        AppendBigEndian(out, value, 2);
+    } else if (value <= 0xffffffffULL) {
+        AppendByte(out, 0xce);
+        AppendBigEndian(out, value, 4);
+    } else {
+        AppendByte(out, 0xcf);
+        AppendBigEndian(out, value, 8);
+    }
+}
+
+void WriteSigned(std::string& out, int64_t value) {
+    if (value >= 0) {
+        WriteUnsigned(out, static_cast<uint64_t>(value));
+    } else if (value >= -32) {
+        AppendByte(out, static_cast<uint8_t>(value));
+    } else if (value >= std::numeric_limits<int8_t>::min()) {
+        AppendByte(out, 0xd0);
+        AppendBigEndian(out, static_cast<uint64_t>(value), 1);
+    } else if (value >= std::numeric_limits<int16_t>::min()) {
+        AppendByte(out, 0xd1);
+        AppendBigEndian(out, static_cast<uint64_t>(value), 2);
+    } else if (value >= std::numeric_limits<int32_t>::min()) {
+        AppendByte(out, 0xd2);
+        AppendBigEndian(out, static_cast<uint64_t>(value), 4);
+    } else {
+        AppendByte(out, 0xd3);
+        AppendBigEndian(out, static_cast<uint64_t>(value), 8);
+    }
+}
+
+void WriteDouble(std::string& out, double value) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    AppendByte(out, 0xcb);
+    AppendBigEndian(out, bits, 8);
+}
+
+void WriteSized(std::string& out, size_t size, uint8_t fixBase, size_t fixLimit,
+                uint8_t tag8, uint8_t tag16, uint8_t tag32) {
+    if (size < fixLimit) {
+        AppendByte(out, static_cast<uint8_t>(fixBase | size));
+    } else if (tag8 != 0 && size <= 0xff) {
+        AppendByte(out, tag8);
+        AppendBigEndian(out, size, 1);
+    } else if (size <= 0xffff) {
+        AppendByte(out, tag16);
+        AppendBigEndian(out, size, 2);
+    } else {
+        AppendByte(out, tag32);
+        AppendBigEndian(out, size, 4);
+    }
+}
+
+void WriteStr(std::string& out, std::string_view value) {
+    WriteSized(out, value.size(), 0xa0, 32, 0xd9, 0xda, 0xdb);
+    out.append(value);
+}
+
+void WriteBin(std::string& out, std::string_view bytes) {
+    if (bytes.size() <= 0xff) {
+        AppendByte(out, 0xc4);
+        AppendBigEndian(out, bytes.size(), 1);
+    } else if (bytes.size() <= 0xffff) {
+        AppendByte(out, 0xc5);
+        AppendBigEndian(out, bytes.size(), 2);
+    } else {
+        AppendByte(out, 0xc6);
+        AppendBigEndian(out, bytes.size(), 4);
+    }
+    out.append(bytes);
+}
+
+// 把 MsgPackReader 读出的值转写为 JSON
+class JsonSink {
+public:
+    explicit JsonSink(JsonWriter& writer) : m_writer(writer) {}
+
+    void StartObject() { m_writer.StartObject(); }
+    void EndObject() { m_writer.EndObject(); }
+    void StartArray() { m_writer.StartArray(); }
+    void EndArray() { m_writer.EndArray(); }
+    void Key(std::string_view key) { m_writer.Key(std::string(key)); }
+    void String(std::string_view value) { m_writer.String(std::string(value)); }
+    void Binary(std::string_view bytes) { m_writer.String(encoding::base64Encode(bytes)); }
+    void Number(int64_t value) { m_writer.Number(value); }
+    void Number(uint64_t value) { m_writer.Number(value); }
+    void Number(double value) { m_writer.Number(value); }
+    void Bool(bool value) { m_writer.Bool(value); }
+    void Null() { m_writer.Null(); }
+
+private:
+    JsonWriter& m_writer;
+};
+
+// 只校验并跳过值，用于定位字段边界
+struct SkipSink {
+    void StartObject() {}
+    void EndObject() {}
+    void StartArray() {}
+    void EndArray() {}
+    void Key(std::string_view) {}
+    void String(std::string_view) {}
+    void Binary(std::string_view) {}
+    void Number(int64_t) {}
+    void Number(uint64_t) {}
+    void Number(double) {}
+    void Bool(bool) {}
+    void Null() {}
+};
+
+// 读取 MessagePack 并交给 Sink 处理
+class MsgPackReader {
+public:
+    explicit MsgPackReader(std::string_view data) : m_data(data) {}
+
+    template <typename Sink>
+    std::expected<void, McpError> readValue(Sink& writer, int depth) {
+        if (depth > kMaxDepth) {
+            return fail("MessagePack nesting too deep");
+        }
+        uint8_t tag = 0;
+        if (!readByte(tag)) {
+            return fail("Truncated MessagePack value");
+        }
+
+        if (tag <= 0x7f) {
+            writer.Number(static_cast<int64_t>(tag));
+            return {};
+        }
+        if (tag >= 0xe0) {
+            writer.Number(static_cast<int64_t>(static_cast<int8_t>(tag)));
+            return {};
+        }
+        if ((tag & 0xf0) == 0x80) {
+            return readMap(writer, tag & 0x0f, depth);
+        }
+        if ((tag & 0xf0) == 0x90) {
+            return readArray(writer, tag & 0x0f, depth);
+        }
+        if ((tag & 0xe0) == 0xa0) {
+            return readStr(writer, tag & 0x1f);
+        }
+
+        uint64_t value = 0;
+        switch (tag) {
+            case 0xc0: writer.Null(); return {};
+            case 0xc2: writer.Bool(false); return {};
+            case 0xc3: writer.Bool(true); return {};
+            case 0xc4: case 0xc5: case 0xc6: {
+                const int width = 1 << (tag - 0xc4);
+                if (!readBigEndian(value, width)) {
+                    return fail("Truncated MessagePack bin");
+                }
+                std::string_view bytes;
+                if (!readBytes(bytes, value)) {
+                    return fail("Truncated MessagePack bin");
+                }
+                writer.Binary(bytes);
+                return {};
+            }
+            case 0xca: {
+                if (!readBigEndian(value, 4)) {
+                    return fail("Truncated MessagePack float");
+                }
+                const uint32_t bits = static_cast<uint32_t>(value);
+                float f = 0.0f;
+                std::memcpy(&f, &bits, sizeof(f));
+                writer.Number(static_cast<double>(f));
+                return {};
+            }
+            case 0xcb: {
+                if (!readBigEndian(value, 8)) {
+                    return fail("Truncated MessagePack float");
+                }
+                double d = 0.0;
+                std::memcpy(&d, &value, sizeof(d));
+                writer.Number(d);
+                return {};
+            }
+            case 0xcc: case 0xcd: case 0xce: case 0xcf: {
+                if (!readBigEndian(value, 1 << (tag - 0xcc))) {
+                    return fail("Truncated MessagePack integer");
+                }
+                if (value > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+                    writer.Number(value);
+                } else {
+                    writer.Number(static_cast<int64_t>(value));
+                }
+                return {};
+            }
+            case 0xd0: case 0xd1: case 0xd2: case 0xd3: {
+                const int width = 1 << (tag - 0xd0);
+                if (!readBigEndian(value, width)) {
+                    return fail("Truncated MessagePack integer");
+                }
+                // 按宽度做符号扩展
+                const int shift = 64 - width * 8;
+                const int64_t signedValue = shift == 0
+                    ? static_cast<int64_t>(value)
+                    : static_cast<int64_t>(value << shift) >> shift;
+                writer.Number(signedValue);
+                return {};
+            }
+            case 0xd9: case 0xda: case 0xdb: {
+                if (!readBigEndian(value, 1 << (tag - 0xd9))) {
+                    return fail("Truncated MessagePack str");
+                }
+                return readStr(writer, value);
+            }
+            case 0xdc: case 0xdd: {
+                if (!readBigEndian(value, tag == 0xdc ? 2 : 4)) {
+                    return fail("Truncated MessagePack array");
+                }
+                return readArray(writer, value, depth);
+            }
+            case 0xde: case 0xdf: {
+                if (!readBigEndian(value, tag == 0xde ? 2 : 4)) {
+                    return fail("Truncated MessagePack map");
+                }
+                return readMap(writer, value, depth);
+            }
+            default:
+                return fail("Unsupported MessagePack type");
+        }
+    }
+
+    /**
+     * @brief 读取顶层 map 的头部，返回键值对个数
+     */
+    std::expected<uint64_t, McpError> readMapHeader() {
+        uint8_t tag = 0;
+        uint64_t count = 0;
+        if (!readByte(tag)) {
+            return std::unexpected(McpError::parseError("Truncated MessagePack map"));
+        }
+        if ((tag & 0xf0) == 0x80) {
+            count = tag & 0x0f;
+        } else if (tag == 0xde || tag == 0xdf) {
+            if (!readBigEndian(count, tag == 0xde ? 2 : 4)) {
+                return std::unexpected(McpError::parseError("Truncated MessagePack map"));
+            }
+        } else {
+            return std::unexpected(McpError::parseError("Expected MessagePack map"));
+        }
+        return count;
+    }
+
+    /**
+     * @brief 读取一个字符串键
+     */
+    std::expected<std::string_view, McpError> readKey() {
+        uint8_t tag = 0;
+        uint64_t size = 0;
+        if (!readByte(tag)) {
+            return std::unexpected(McpError::parseError("Truncated MessagePack map key"));
+        }
+        if ((tag & 0xe0) == 0xa0) {
+            size = tag & 0x1f;
+        } else if (tag < 0xd9 || tag > 0xdb || !readBigEndian(size, 1 << (tag - 0xd9))) {
+            return std::unexpected(McpError::parseError("MessagePack map key must be a string"));
+        }
+        std::string_view key;
+        if (!readBytes(key, size)) {
+            return std::unexpected(McpError::parseError("Truncated MessagePack map key"));
+        }
+        return key;
+    }
+
+    /**
+     * @brief 跳过一个值并返回其原始字节片段
+     */
+    std::expected<std::string_view, McpError> skipValue() {
+        const size_t start = m_pos;
+        SkipSink sink;
+        auto skipped = readValue(sink, 0);
+        if (!skipped) {
+            return std::unexpected(skipped.error());
+        }
+        return m_data.substr(start, m_pos - start);
+    }
+
+    bool atEnd() const { return m_pos == m_data.size(); }
+
+private:
+    static std::expected<void, McpError> fail(const char* message) {
+        return std::unexpected(McpError::parseError(message));
+    }
+
+    bool readByte(uint8_t& out) {
+        if (m_pos >= m_data.size()) {
+            return false;
+        }
+        out = static_cast<uint8_t>(m_data[m_pos++]);
+        return true;
+    }
+
+    bool readBigEndian(uint64_t& out, int bytes) {
+        if (m_data.size() - m_pos < static_cast<size_t>(bytes)) {
+            return false;
+        }
+        out = 0;
+        for (int i = 0; i < bytes; ++i) {
+            out = (out << 8) | static_cast<uint8_t>(m_data[m_pos++]);
+        }
+        return true;
+    }
+
+    bool readBytes(std::string_view& out, uint64_t size) {
+        if (m_data.size() - m_pos < size) {
+            return false;
+        }
+        out = m_data.substr(m_pos, static_cast<size_t>(size));
+        m_pos += static_cast<size_t>(size);
+        return true;
+    }
+
+    // 每个元素至少占 1 字节，据此拒绝声明了超长元素个数的数据
+    bool plausibleCount(uint64_t count) const {
+        return count <= m_data.size() - m_pos;
+    }
+
+    template <typename Sink>
+    std::expected<void, McpError> readStr(Sink& writer, uint64_t size) {
+        std::string_view bytes;
+        if (!readBytes(bytes, size)) {
+            return fail("Truncated MessagePack str");
+        }
+        writer.String(bytes);
+        return {};
+    }
+
+    template <typename Sink>
+    std::expected<void, McpError> readArray(Sink& writer, uint64_t count, int depth) {
+        if (!plausibleCount(count)) {
+            return fail("Truncated MessagePack array");
+        }
+        writer.StartArray();
+        for (uint64_t i = 0; i < count; ++i) {
+            auto item = readValue(writer, depth + 1);
+            if (!item) {
+                return item;
+            }
+        }
+        writer.EndArray();
+        return {};
+    }
+
+    template <typename Sink>
+    std::expected<void, McpError> readMap(Sink& writer, uint64_t count, int depth) {
+        if (!plausibleCount(count)) {
+            return fail("Truncated MessagePack map");
+        }
+        writer.StartObject();
+        for (uint64_t i = 0; i < count; ++i) {
+            auto key = readKey();
+            if (!key) {
+                return std::unexpected(key.error());
+            }
+            writer.Key(key.value());
+            auto value = readValue(writer, depth + 1);
+            if (!value) {
+                return value;
+            }
+        }
+        writer.EndObject();
+        return {};
+    }
+
+    std::string_view m_data;
+    size_t m_pos = 0;
+};
+
+} // namespace
+
+McpMsgPackEncoder::McpMsgPackEncoder() = default;
+
+McpMsgPackEncoder::~McpMsgPackEncoder() = default;
+
+void McpMsgPackEncoder::CountValue() {
+    if (!m_stack.empty() && !m_stack.back().object) {
+        ++m_stack.back().count;
+    }
+}
+
+void McpMsgPackEncoder::StartContainer(bool object) {
+    CountValue();
+    m_stack.push_back({m_out.size(), 0, object});
+    AppendByte(m_out, object ? 0xdf : 0xdd);
+    AppendBigEndian(m_out, 0, 4);
+}
+
+void McpMsgPackEncoder::EndContainer() {
+    if (m_stack.empty()) {
+        return;
+    }
+    const Container container = m_stack.back();
+    m_stack.pop_back();
+    for (int i = 0; i < 4; ++i) {
+        m_out[container.headerOffset + 1 + i] =
+            static_cast<char>((container.count >> ((3 - i) * 8)) & 0xff);
+    }
+}
+
+void McpMsgPackEncoder::StartObject() {
+    StartContainer(true);
+}
+
+void McpMsgPackEncoder::EndObject() {
+    EndContainer();
+}
+
+void McpMsgPackEncoder::StartArray() {
+    StartContainer(false);
+}
+
+void McpMsgPackEncoder::EndArray() {
+    EndContainer();
+}
+
+void McpMsgPackEncoder::Key(const std::string& key) {
+    if (m_stack.empty() || !m_stack.back().object) {
+        return;
+    }
+    ++m_stack.back().count;
+    WriteStr(m_out, key);
+}
+
+void McpMsgPackEncoder::String(const std::string& value) {
+    CountValue();
+    WriteStr(m_out, value);
+}
+
+void McpMsgPackEncoder::Number(int64_t value) {
+    CountValue();
+    WriteSigned(m_out, value);
+}
+
+void McpMsgPackEncoder::Number(uint64_t value) {
+    CountValue();
+    WriteUnsigned(m_out, value);
+}
+
+void McpMsgPackEncoder::Number(double value) {
+    CountValue();
+    WriteDouble(m_out, value);
+}
+
+void McpMsgPackEncoder::Bool(bool value) {
+    CountValue();
+    AppendByte(m_out, value ? 0xc3 : 0xc2);
+}
+
+void McpMsgPackEncoder::Null() {
+    CountValue();
+    AppendByte(m_out, 0xc0);
+}
+
+void McpMsgPackEncoder::Raw(const std::string& json) {
+    CountValue();
+    if (!m_parser) {
+        m_parser = std::make_unique<simdjson::dom::parser>();
+    }
+    JsonElement element;
+    if (m_parser->parse(json).get(element) != simdjson::SUCCESS) {
+        // 与 JsonWriter 一致不做校验：无法解析的片段按字符串原样保留
+        WriteStr(m_out, json);
+        return;
+    }
+    WriteElement(element);
+}
+
+void McpMsgPackEncoder::Base64(const std::string& base64) {
+    CountValue();
+    auto bytes = encoding::base64Decode(base64);
+    if (!bytes) {
+        WriteStr(m_out, base64);
+        return;
+    }
+    WriteBin(m_out, bytes.value());
+}
+
+std::string McpMsgPackEncoder::TakeString() {
+    return std::move(m_out);
+}
+
+void McpMsgPackEncoder::WriteElement(const JsonElement& element) {
+    switch (element.type()) {
+        case simdjson::dom::element_type::OBJECT: {
+            JsonObject obj = element.get_object().value_unsafe();
+            size_t size = 0;
+            for ([[maybe_unused]] auto field : obj) {
+                ++size;
+            }
+            WriteSized(m_out, size, 0x80, 16, 0, 0xde, 0xdf);
+            for (auto field : obj) {
+                WriteStr(m_out, field.key);
+                WriteElement(field.value);
+            }
+            break;
+        }
+        case simdjson::dom::element_type::ARRAY: {
+            JsonArray arr = element.get_array().value_unsafe();
+            size_t size = 0;
+            for ([[maybe_unused]] auto item : arr) {
+                ++size;
+            }
+            WriteSized(m_out, size, 0x90, 16, 0, 0xdc, 0xdd);
+            for (auto item : arr) {
+                WriteElement(item);
+            }
+            break;
+        }
+        case simdjson::dom::element_type::STRING:
+            WriteStr(m_out, element.get_string().value_unsafe());
+            break;
+        case simdjson::dom::element_type::INT64:
+            WriteSigned(m_out, element.get_int64().value_unsafe());
+            break;
+        case simdjson::dom::element_type::UINT64:
+            WriteUnsigned(m_out, element.get_uint64().value_unsafe());
+            break;
+        case simdjson::dom::element_type::DOUBLE:
+            WriteDouble(m_out, element.get_double().value_unsafe());
+            break;
+        case simdjson::dom::element_type::BOOL:
+            AppendByte(m_out, element.get_bool().value_unsafe() ? 0xc3 : 0xc2);
+            break;
+        default:
+            AppendByte(m_out, 0xc0);
+            break;
+    }
+}
+
+namespace encoding {
+
+bool isMsgPack(std::string_view message) {
+    if (message.empty()) {
+        return false;
+    }
+    const uint8_t first = static_cast<uint8_t>(message.front());
+    return (first & 0xf0) == 0x80 || first == 0xde || first == 0xdf;
+}
+
+std::expected<JsonString, McpError> msgPackToJson(std::string_view message) {
+    MsgPackReader reader(message);
+    JsonWriter writer;
+    JsonSink sink(writer);
+    auto result = reader.readValue(sink, 0);
+    if (!result) {
+        return std::unexpected(result.error());
+    }
+    if (!reader.atEnd()) {
+        return std::unexpected(McpError::parseError("Trailing bytes after MessagePack value"));
+    }
+    return writer.TakeString();
+}
+
+std::expected<std::optional<JsonRpcResponse>, McpError> msgPackToResponse(std::string_view message) {
+    MsgPackReader reader(message);
+    auto count = reader.readMapHeader();
+    if (!count) {
+        return std::unexpected(count.error());
+    }
+
+    std::string_view idValue;
+    std::string_view resultValue;
+    std::string_view errorValue;
+    for (uint64_t i = 0; i < count.value(); ++i) {
+        auto key = reader.readKey();
+        if (!key) {
+            return std::unexpected(key.error());
+        }
+        auto value = reader.skipValue();
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        if (key.value() == "id") {
+            idValue = value.value();
+        } else if (key.value() == "result") {
+            resultValue = value.value();
+        } else if (key.value() == "error") {
+            errorValue = value.value();
+        }
+    }
+    if (!reader.atEnd()) {
+        return std::unexpected(McpError::parseError("Trailing bytes after MessagePack value"));
+    }
+
+    constexpr char kNil = static_cast<char>(0xc0);
+    if (idValue.empty() || idValue == std::string_view(&kNil, 1)) {
+        return std::optional<JsonRpcResponse>();
+    }
+    auto idJson = msgPackToJson(idValue);
+    if (!idJson) {
+        return std::unexpected(idJson.error());
+    }
+    int64_t id = 0;
+    auto [ptr, ec] = std::from_chars(idJson.value().data(), idJson.value().data() + idJson.value().size(), id);
+    if (ec != std::errc() || ptr != idJson.value().data() + idJson.value().size()) {
+        return std::unexpected(McpError::invalidResponse("Invalid response id"));
+    }
+
+    JsonRpcResponse response;
+    response.id = id;
+    if (!errorValue.empty() && errorValue != std::string_view(&kNil, 1)) {
+        auto errorJson = msgPackToJson(errorValue);
+        if (!errorJson) {
+            return std::unexpected(errorJson.error());
+        }
+        response.error = std::move(errorJson.value());
+    }
+    if (!resultValue.empty() && resultValue != std::string_view(&kNil, 1)) {
+        auto resultJson = msgPackToJson(resultValue);
+        if (!resultJson) {
+            return std::unexpected(resultJson.error());
+        }
+        response.result = std::move(resultJson.value());
+    }
+    return std::optional<JsonRpcResponse>(std::move(response));
+}
+
+std::expected<JsonString, McpError> decodeMessage(std::string message) {
+    if (isMsgPack(message)) {
+        return msgPackToJson(message);
+    }
+    return message;
+}
+
+std::string base64Encode(std::string_view bytes) {
+    std::string out;
+    out.reserve((bytes.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 3 <= bytes.size(); i += 3) {
+        const uint32_t chunk = (static_cast<uint8_t>(bytes[i]) << 16) |
+                               (static_cast<uint8_t>(bytes[i + 1]) << 8) |
+                               static_cast<uint8_t>(bytes[i + 2]);
+        out.push_back(kBase64Alphabet[(chunk >> 18) & 0x3f]);
+        out.push_back(kBase64Alphabet[(chunk >> 12) & 0x3f]);
+        out.push_back(kBase64Alphabet[(chunk >> 6) & 0x3f]);
+        out.push_back(kBase64Alphabet[chunk & 0x3f]);
+    }
+    const size_t rest = bytes.size() - i;
+    if (rest > 0) {
+        uint32_t chunk = static_cast<uint8_t>(bytes[i]) << 16;
+        if (rest == 2) {
+            chunk |= static_cast<uint8_t>(bytes[i + 1]) << 8;
+        }
+        out.push_back(kBase64Alphabet[(chunk >> 18) & 0x3f]);
+        out.push_back(kBase64Alphabet[(chunk >> 12) & 0x3f]);
+        out.push_back(rest == 2 ? kBase64Alphabet[(chunk >> 6) & 0x3f] : '=');
+        out.push_back('=');
+    }
+    return out;
+}
+
+std::optional<std::string> base64Decode(std::string_view base64) {
+    static const std::array<int8_t, 256> kDecodeTable = [] {
+        std::array<int8_t, 256> table{};
+        table.fill(-1);
+        for (int i = 0; i < 64; ++i) {
+            table[static_cast<uint8_t>(kBase64Alphabet[i])] = static_cast<int8_t>(i);
+        }
+        return table;
+    }();
+
+    if (base64.size() % 4 != 0) {
+        return std::nullopt;
+    }
+    size_t padding = 0;
+    if (!base64.empty() && base64.back() == '=') {
+        padding = base64.size() >= 2 && base64[base64.size() - 2] == '=' ? 2 : 1;
+    }
+
+    std::string out;
+    out.reserve(base64.size() / 4 * 3);
+    for (size_t i = 0; i < base64.size(); i += 4) {
+        const bool last = i + 4 == base64.size();
+        uint32_t chunk = 0;
+        for (size_t j = 0; j < 4; ++j) {
+            const char c = base64[i + j];
+            int8_t value = 0;
+            if (c == '=') {
+                if (!last || j < 4 - padding) {
+                    return std::nullopt;
+                }
+            } else {
+                value = kDecodeTable[static_cast<uint8_t>(c)];
+                if (value < 0) {
+                    return std::nullopt;
+                }
+            }
+            chunk = (chunk << 6) | static_cast<uint32_t>(value);
+        }
+        out.push_back(static_cast<char>((chunk >> 16) & 0xff));
+        if (!last || padding < 2) {
+            out.push_back(static_cast<char>((chunk >> 8) & 0xff));
+        }
+        if (!last || padding < 1) {
+            out.push_back(static_cast<char>(chunk & 0xff));
+        }
+        // 非规范编码（填充位非零）无法按原样重新编码，视为普通字符串
+        if (last && ((padding == 1 && (chunk & 0xff) != 0) ||
+                     (padding == 2 && (chunk & 0xffff) != 0))) {
+            return std::nullopt;
+        }
+    }
+    return out;
+}
+
+} // namespace encoding
+
+} // namespace mcp
+} // namespace galay
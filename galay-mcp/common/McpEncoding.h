@@ -0,0 +1,147 @@
+#ifndef GALAY_MCP_COMMON_MCPENCODING_H
+#define GALAY_MCP_COMMON_MCPENCODING_H
+
+#include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpJson.h"
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief JSON-RPC 消息在线路上的编码方式
+ */
+enum class McpWireEncoding {
+    Json,       // JSON 文本（MCP 标准编码）
+    MsgPack     // 同一数据模型的 MessagePack 二进制编码，仅在 galay-mcp 对端之间协商启用
+};
+
+/**
+ * @brief MessagePack 编码器
+ *
+ * 与 JsonWriter 接口一致，McpBase 类型通过 encode() 直接写出 MessagePack：
+ * 字符串按原始字节写入（无需转义），Base64() 写入的数据解码后以 bin 类型传输，
+ * Raw() 传入的 JSON 文本经 simdjson 解析后转写。
+ * 对象 / 数组头部固定使用 32 位长度，在 End*() 时回填元素个数。
+ */
+class McpMsgPackEncoder final : public McpEncoder {
+public:
+    McpMsgPackEncoder();
+    ~McpMsgPackEncoder() override;
+
+    void StartObject() override;
+    void EndObject() override;
+    void StartArray() override;
+    void EndArray() override;
+    void Key(const std::string& key) override;
+    void String(const std::string& value) override;
+    void Number(int64_t value) override;
+    void Number(uint64_t value) override;
+    void Number(double value) override;
+    void Bool(bool value) override;
+    void Null() override;
+    void Raw(const std::string& json) override;
+    void Base64(const std::string& base64) override;
+    std::string TakeString() override;
+
+private:
+    struct Container {
+        size_t headerOffset;   // 头部在 m_out 中的偏移
+        uint32_t count;        // 已写入的元素（数组）或键值对（对象）个数
+        bool object;
+    };
+
+    void CountValue();
+    void StartContainer(bool object);
+    void EndContainer();
+    void WriteElement(const JsonElement& element);
+
+    std::string m_out;
+    std::vector<Container> m_stack;
+    std::unique_ptr<simdjson::dom::parser> m_parser;
+};
+
+namespace encoding {
+
+// initialize 协商时 capabilities.experimental.galay.encoding 的取值
+inline constexpr std::string_view MSGPACK = "msgpack";
+
+/**
+ * @brief 判断消息是否为 MessagePack 编码
+ * @note JSON 消息以 '{' 或空白开头，MessagePack 消息以 map 头部（首字节 >= 0x80）开头
+ */
+bool isMsgPack(std::string_view message);
+
+/**
+ * @brief 把一条 MessagePack 消息转回 JSON 文本，供 simdjson 解析
+ * @note bin 类型转为 base64 字符串；ext 类型、非字符串键或截断数据返回 ParseError
+ */
+std::expected<JsonString, McpError> msgPackToJson(std::string_view message);
+
+/**
+ * @brief 直接从 MessagePack 响应中取出 id / result / error，只把 result、error 转写为 JSON
+ * @return 消息不带 id（通知）时返回 std::nullopt；id 不是整数返回 InvalidResponse
+ */
+std::expected<std::optional<JsonRpcResponse>, McpError> msgPackToResponse(std::string_view message);
+
+/**
+ * @brief 把收到的消息规范化为 JSON 文本（JSON 原样返回，MessagePack 转写）
+ */
+std::expected<JsonString, McpError> decodeMessage(std::string message);
+
+/**
+ * @brief 按指定编码序列化任一提供 encode(McpEncoder&) 的 McpBase 类型
+ */
+template <typename Message>
+std::string encodeMessage(const Message& message, McpWireEncoding wireEncoding) {
+    if (wireEncoding == McpWireEncoding::MsgPack) {
+        McpMsgPackEncoder encoder;
+        message.encode(encoder);
+        return encoder.TakeString();
+    }
+    JsonWriter writer;
+    message.encode(writer);
+    return writer.TakeString();
+}
+
+/**
+ * @brief 直接把结果对象编码进 JSON-RPC 成功响应，省去先序列化为 JSON 再嵌入 / 转写的开销
+ * @param result 提供 encode(McpEncoder&) 的结果类型，例如 ToolCallResult
+ */
+template <typename Result>
+std::string encodeResultResponse(int64_t id, const Result& result, McpWireEncoding wireEncoding) {
+    auto write = [&](McpEncoder& writer) {
+        writer.StartObject();
+        writer.Key("jsonrpc");
+        writer.String(JSONRPC_VERSION);
+        writer.Key("id");
+        writer.Number(id);
+        writer.Key("result");
+        result.encode(writer);
+        writer.EndObject();
+        return writer.TakeString();
+    };
+    if (wireEncoding == McpWireEncoding::MsgPack) {
+        McpMsgPackEncoder encoder;
+        return write(encoder);
+    }
+    JsonWriter writer;
+    return write(writer);
+}
+
+std::string base64Encode(std::string_view bytes);
+std::optional<std::string> base64Decode(std::string_view base64);
+
+} // namespace encoding
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPENCODING_H
@@ -25,6 +25,10 @@ int McpError::toJsonRpcErrorCode() const {
             return ErrorCodes::METHOD_NOT_FOUND;
         case McpErrorCode::InvalidParams:
             return ErrorCodes::INVALID_PARAMS;
+        case McpErrorCode::ServerOverloaded:
+            return ErrorCodes::SERVER_OVERLOADED;
+        case McpErrorCode::RequestCancelled:
+            return ErrorCodes::REQUEST_CANCELLED;
         case McpErrorCode::InternalError:
         case McpErrorCode::ToolExecutionFailed:
         case McpErrorCode::InitializationFailed:
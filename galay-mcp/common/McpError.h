@@ -15,6 +15,8 @@ enum class McpErrorCode {
     ConnectionFailed = 1000,
     ConnectionClosed = 1001,
     ConnectionTimeout = 1002,
+    ServerOverloaded = 1003,
+    RequestCancelled = 1004,
 
     // 协议相关错误
     ProtocolError = 2000,
@@ -98,6 +100,18 @@ public:
         return McpError(McpErrorCode::ConnectionFailed, "Connection error", details);
     }
 
+    static McpError timeout(const std::string& details = "") {
+        return McpError(McpErrorCode::ConnectionTimeout, "Request timed out", details);
+    }
+
+    static McpError serverOverloaded(const std::string& details = "") {
+        return McpError(McpErrorCode::ServerOverloaded, "Server overloaded", details);
+    }
+
+    static McpError requestCancelled(const std::string& details = "") {
+        return McpError(McpErrorCode::RequestCancelled, "Request cancelled", details);
+    }
+
     static McpError protocolError(const std::string& details = "") {
         return McpError(McpErrorCode::ProtocolError, "Protocol error", details);
     }
@@ -191,6 +205,10 @@ public:
             mcpCode = McpErrorCode::InvalidParams;
         } else if (code == -32603) {
             mcpCode = McpErrorCode::InternalError;
+        } else if (code == -32000) {
+            mcpCode = McpErrorCode::ServerOverloaded;
+        } else if (code == -32001) {
+            mcpCode = McpErrorCode::RequestCancelled;
         } else {
             mcpCode = McpErrorCode::Unknown;
         }
@@ -0,0 +1,66 @@
+#include "galay-mcp/common/McpExecutor.h"
+#include <utility>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+thread_local McpExecutor* t_currentExecutor = nullptr;
+
+} // namespace
+
+McpExecutor* McpExecutor::current() {
+    return t_currentExecutor;
+}
+
+void McpExecutor::bindCurrent(McpExecutor* executor) {
+    t_currentExecutor = executor;
+}
+
+McpExecutor& McpExecutor::fallback() {
+    static McpThreadExecutor executor;
+    return executor;
+}
+
+McpThreadExecutor::McpThreadExecutor()
+    : m_thread(&McpThreadExecutor::run, this) {
+}
+
+McpThreadExecutor::~McpThreadExecutor() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_posted.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void McpThreadExecutor::post(std::coroutine_handle<> handle) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.push_back(handle);
+    }
+    m_posted.notify_one();
+}
+
+void McpThreadExecutor::run() {
+    bindCurrent(this);
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_posted.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+        if (m_queue.empty()) {
+            return;
+        }
+        std::coroutine_handle<> handle = m_queue.front();
+        m_queue.pop_front();
+        lock.unlock();
+        handle.resume();
+        lock.lock();
+    }
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,69 @@
+#ifndef GALAY_MCP_COMMON_MCPEXECUTOR_H
+#define GALAY_MCP_COMMON_MCPEXECUTOR_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 协程恢复执行器：把挂起的协程交回它所属的线程上恢复
+ *
+ * 每个运行协程的线程（IO 调度器线程）通过 bindCurrent() 绑定自己的执行器，
+ * McpWakeSignal 在协程挂起时记下 current()，事件方通知时调用 post() 把恢复交给该执行器，
+ * 等待方因此总是在挂起它的线程上继续执行，不会在事件方的线程上运行、也不会嵌套在事件方的调用栈里。
+ */
+class McpExecutor {
+public:
+    virtual ~McpExecutor() = default;
+
+    // 在执行器的线程上恢复 handle；任意线程可调用，不在调用线程上直接恢复
+    virtual void post(std::coroutine_handle<> handle) = 0;
+
+    // 当前线程绑定的执行器，未绑定时为 nullptr
+    static McpExecutor* current();
+
+    // 绑定当前线程的执行器；nullptr 解除绑定
+    static void bindCurrent(McpExecutor* executor);
+
+    // 进程共享的后备执行器：没有绑定执行器的线程上挂起的协程在这里恢复
+    static McpExecutor& fallback();
+};
+
+/**
+ * @brief 自带一个线程的执行器：按投递顺序在该线程上逐个恢复协程
+ *
+ * 线程启动时绑定为自己的执行器，在它上面恢复的协程再次挂起时仍回到这个线程。
+ * 析构时先恢复完已投递的协程再回收线程。
+ */
+class McpThreadExecutor : public McpExecutor {
+public:
+    McpThreadExecutor();
+    ~McpThreadExecutor() override;
+
+    McpThreadExecutor(const McpThreadExecutor&) = delete;
+    McpThreadExecutor& operator=(const McpThreadExecutor&) = delete;
+
+    void post(std::coroutine_handle<> handle) override;
+
+    // 执行器线程的 id
+    std::thread::id threadId() const { return m_thread.get_id(); }
+
+private:
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_posted;
+    std::deque<std::coroutine_handle<>> m_queue;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPEXECUTOR_H
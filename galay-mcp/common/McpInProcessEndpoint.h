@@ -0,0 +1,45 @@
+#ifndef GALAY_MCP_COMMON_MCPINPROCESSENDPOINT_H
+#define GALAY_MCP_COMMON_MCPINPROCESSENDPOINT_H
+
+#include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpJson.h"
+#include <expected>
+#include <string>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 进程内调用服务端注册表的入口
+ *
+ * McpStdioServer / McpHttpServer 实现该接口，McpInProcessClient 通过它直接访问注册表：
+ * 不构造 JSON-RPC 信封、不经过分帧与套接字，参数文档原样交给处理函数，
+ * 处理函数的结果字符串原样返回。
+ * 失败时返回的 McpError 与客户端经线路收到同一错误响应后得到的 McpError 一致。
+ */
+class McpInProcessEndpoint {
+public:
+    virtual ~McpInProcessEndpoint() = default;
+
+    // initialize 响应中的服务端信息与能力；不改变服务端自身的连接初始化状态
+    virtual InitializeResult localInitialize() = 0;
+
+    // 注册表快照，顺序与 tools/list、resources/list、prompts/list 结果一致
+    virtual std::vector<Tool> localListTools() = 0;
+    virtual std::vector<Resource> localListResources() = 0;
+    virtual std::vector<Prompt> localListPrompts() = 0;
+
+    // 调用处理函数（阻塞直到完成）
+    virtual std::expected<JsonString, McpError> localCallTool(const std::string& name,
+                                                              const JsonElement& arguments) = 0;
+    virtual std::expected<std::string, McpError> localReadResource(const std::string& uri) = 0;
+    virtual std::expected<JsonString, McpError> localGetPrompt(const std::string& name,
+                                                               const JsonElement& arguments) = 0;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPINPROCESSENDPOINT_H
@@ -1,12 +1,32 @@
 #include "galay-mcp/common/McpJson.h"
 #include <charconv>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <functional>
 #include <utility>
 
 namespace galay {
 namespace mcp {
 
+namespace {
+
+// 8 字节中是否存在需要转义的字节（控制字符、'"'、'\\'）
+bool NeedsEscape(const char* p) {
+    constexpr uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr uint64_t kHighs = 0x8080808080808080ULL;
+    uint64_t word = 0;
+    std::memcpy(&word, p, sizeof(word));
+    const uint64_t quote = word ^ (kOnes * '"');
+    const uint64_t backslash = word ^ (kOnes * '\\');
+    const uint64_t control = (word - kOnes * 0x20) & ~word;
+    const uint64_t quoteHit = (quote - kOnes) & ~quote;
+    const uint64_t backslashHit = (backslash - kOnes) & ~backslash;
+    return ((control | quoteHit | backslashHit) & kHighs) != 0;
+}
+
+} // namespace
+
 std::expected<JsonDocument, McpError> JsonDocument::Parse(std::string_view json) {
     JsonDocument doc;
     try {
@@ -116,6 +136,10 @@ void JsonWriter::Raw(const std::string& json) {
     m_out.append(json);
 }
 
+void JsonWriter::Base64(const std::string& base64) {
+    String(base64);
+}
+
 std::string JsonWriter::TakeString() {
     return std::move(m_out);
 }
@@ -139,8 +163,24 @@ void JsonWriter::WriteValuePrefix() {
     }
 }
 
-void JsonWriter::AppendEscaped(std::string& out, const std::string& value) {
-    for (char c : value) {
+void JsonWriter::AppendEscaped(std::string& out, std::string_view value) {
+    const char* runStart = value.data();
+    const char* const end = value.data() + value.size();
+    const char* p = runStart;
+    while (p != end) {
+        // 无需转义的连续片段按 8 字节一组跳过，最后整段追加
+        while (end - p >= 8 && !NeedsEscape(p)) {
+            p += 8;
+        }
+        if (p == end) {
+            break;
+        }
+        const char c = *p++;
+        if (static_cast<unsigned char>(c) >= 0x20 && c != '\"' && c != '\\') {
+            continue;
+        }
+        out.append(runStart, p - 1);
+        runStart = p;
         switch (c) {
             case '\"': out.append("\\\""); break;
             case '\\': out.append("\\\\"); break;
@@ -149,16 +189,14 @@ void JsonWriter::AppendEscaped(std::string& out, const std::string& value) {
             case '\n': out.append("\\n"); break;
             case '\r': out.append("\\r"); break;
             case '\t': out.append("\\t"); break;
-            default:
-                if (static_cast<unsigned char>(c) < 0x20) {
-                    char buf[7];
-                    std::snprintf(buf, sizeof(buf), "\\u%04x", c);
-                    out.append(buf);
-                } else {
-                    out.push_back(c);
-                }
+            default: {
+                char buf[7];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out.append(buf);
+            }
         }
     }
+    out.append(runStart, end);
 }
 
 bool JsonHelper::GetObject(const JsonElement& element, JsonObject& out) {
@@ -33,21 +33,52 @@ private:
     JsonElement m_root;
 };
 
-class JsonWriter {
+/**
+ * @brief McpBase 类型序列化所经过的编码器接口
+ *
+ * JsonWriter 输出 JSON 文本；McpMsgPackEncoder（McpEncoding.h）输出同一数据模型的 MessagePack。
+ */
+class McpEncoder {
 public:
-    void StartObject();
-    void EndObject();
-    void StartArray();
-    void EndArray();
-    void Key(const std::string& key);
-    void String(const std::string& value);
-    void Number(int64_t value);
-    void Number(uint64_t value);
-    void Number(double value);
-    void Bool(bool value);
-    void Null();
-    void Raw(const std::string& json);
-    std::string TakeString();
+    virtual ~McpEncoder() = default;
+
+    virtual void StartObject() = 0;
+    virtual void EndObject() = 0;
+    virtual void StartArray() = 0;
+    virtual void EndArray() = 0;
+    virtual void Key(const std::string& key) = 0;
+    virtual void String(const std::string& value) = 0;
+    virtual void Number(int64_t value) = 0;
+    virtual void Number(uint64_t value) = 0;
+    virtual void Number(double value) = 0;
+    virtual void Bool(bool value) = 0;
+    virtual void Null() = 0;
+    // 写入一段已编码为 JSON 文本的值
+    virtual void Raw(const std::string& json) = 0;
+    // 写入 base64 数据：JSON 中保持字符串，二进制编码中以原始字节传输
+    virtual void Base64(const std::string& base64) = 0;
+    virtual std::string TakeString() = 0;
+};
+
+class JsonWriter final : public McpEncoder {
+public:
+    void StartObject() override;
+    void EndObject() override;
+    void StartArray() override;
+    void EndArray() override;
+    void Key(const std::string& key) override;
+    void String(const std::string& value) override;
+    void Number(int64_t value) override;
+    void Number(uint64_t value) override;
+    void Number(double value) override;
+    void Bool(bool value) override;
+    void Null() override;
+    void Raw(const std::string& json) override;
+    void Base64(const std::string& base64) override;
+    std::string TakeString() override;
+
+    // 把 value 按 JSON 字符串转义后追加到 out（不含两端引号）；可对同一字符串分段调用
+    static void AppendEscaped(std::string& out, std::string_view value);
 
 private:
     enum class ContextType {
@@ -63,7 +94,6 @@ private:
 
     void WriteValuePrefix();
     void WriteCommaIfNeeded();
-    static void AppendEscaped(std::string& out, const std::string& value);
 
     std::string m_out;
     std::vector<Context> m_stack;
@@ -1,4 +1,5 @@
 #include "galay-mcp/common/McpJsonParser.h"
+#include <charconv>
 
 namespace galay {
 namespace mcp {
@@ -80,5 +81,54 @@ std::expected<ParsedJsonRpcResponse, McpError> parseJsonRpcResponse(std::string_
     return parsed;
 }
 
+std::optional<int64_t> peekJsonRpcId(std::string_view body) {
+    auto skipSpace = [&body](size_t pos) {
+        while (pos < body.size() &&
+               (body[pos] == ' ' || body[pos] == '\t' || body[pos] == '\n' || body[pos] == '\r')) {
+            ++pos;
+        }
+        return pos;
+    };
+
+    size_t depth = 0;
+    for (size_t i = 0; i < body.size(); ++i) {
+        const char c = body[i];
+        if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) {
+                return std::nullopt;
+            }
+            --depth;
+        } else if (c == '"') {
+            const size_t start = i + 1;
+            for (++i; i < body.size() && body[i] != '"'; ++i) {
+                if (body[i] == '\\') {
+                    ++i;
+                }
+            }
+            if (i >= body.size()) {
+                return std::nullopt;
+            }
+            if (depth != 1 || body.substr(start, i - start) != "id") {
+                continue;
+            }
+            // 只有后面紧跟 ':' 的字符串才是键
+            size_t pos = skipSpace(i + 1);
+            if (pos >= body.size() || body[pos] != ':') {
+                continue;
+            }
+            pos = skipSpace(pos + 1);
+            int64_t id = 0;
+            auto [ptr, ec] = std::from_chars(body.data() + pos, body.data() + body.size(), id);
+            if (ec != std::errc() || (ptr < body.data() + body.size() && (*ptr == '.' || *ptr == 'e' || *ptr == 'E'))) {
+                return std::nullopt;
+            }
+            return id;
+        }
+    }
+    return std::nullopt;
+}
+
 } // namespace mcp
 } // namespace galay
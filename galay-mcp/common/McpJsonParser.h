@@ -42,6 +42,11 @@ std::expected<ParsedJsonRpcRequest, McpError> parseJsonRpcRequest(std::string_vi
 // Parse JSON-RPC response from raw JSON text.
 std::expected<ParsedJsonRpcResponse, McpError> parseJsonRpcResponse(std::string_view body);
 
+// Scan the top-level integer "id" of a request without building a DOM.
+// Nested values (e.g. params) are skipped byte-wise; the body is not validated.
+// Returns std::nullopt when the id is absent, null or not an integer.
+std::optional<int64_t> peekJsonRpcId(std::string_view body);
+
 } // namespace mcp
 } // namespace galay
 
@@ -0,0 +1,211 @@
+#include "galay-mcp/common/McpManifest.h"
+#include <simdjson.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+std::string ErrnoMessage(const char* what, const std::string& path) {
+    return std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+McpError EntryError(const char* list, size_t index, const std::string& details) {
+    return McpError::parseError(std::string(list) + "[" + std::to_string(index) + "]: " + details);
+}
+
+// raw_json() 的结果带有值之后的空白
+std::string_view TrimTrailingSpace(std::string_view raw) {
+    while (!raw.empty() && (raw.back() == ' ' || raw.back() == '\t' || raw.back() == '\n' || raw.back() == '\r')) {
+        raw.remove_suffix(1);
+    }
+    return raw;
+}
+
+bool ReadString(simdjson::ondemand::value value, std::string& out) {
+    std::string_view view;
+    if (value.get_string().get(view)) {
+        return false;
+    }
+    out.assign(view);
+    return true;
+}
+
+} // namespace
+
+std::expected<std::shared_ptr<const McpManifest>, McpError> McpManifest::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(McpError::readError(ErrnoMessage("open", path)));
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        std::string message = ErrnoMessage("fstat", path);
+        ::close(fd);
+        return std::unexpected(McpError::readError(message));
+    }
+    if (st.st_size <= 0) {
+        ::close(fd);
+        return std::unexpected(McpError::parseError("empty manifest " + path));
+    }
+
+    std::shared_ptr<McpManifest> manifest(new McpManifest());
+    manifest->m_size = static_cast<size_t>(st.st_size);
+
+    // 先保留含零填充的匿名区域，再把文件映射到区域开头：
+    // 文件末页之后读到的是匿名零页，满足 simdjson 越界读取 SIMDJSON_PADDING 字节的要求
+    const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    const size_t mapped = (manifest->m_size + simdjson::SIMDJSON_PADDING + page - 1) / page * page;
+    void* region = ::mmap(nullptr, mapped, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED) {
+        std::string message = ErrnoMessage("mmap", path);
+        ::close(fd);
+        return std::unexpected(McpError::readError(message));
+    }
+    manifest->m_mapping = region;
+    manifest->m_mappedSize = mapped;
+    int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;  // 一次性预读全部页面，解析期间不再逐页缺页
+#endif
+    void* file = ::mmap(region, manifest->m_size, PROT_READ, flags, fd, 0);
+    const int mapErrno = errno;
+    ::close(fd);
+    if (file == MAP_FAILED) {
+        errno = mapErrno;
+        return std::unexpected(McpError::readError(ErrnoMessage("mmap", path)));
+    }
+
+    auto parsed = manifest->parse();
+    if (!parsed) {
+        return std::unexpected(parsed.error());
+    }
+    return manifest;
+}
+
+McpManifest::~McpManifest() {
+    if (m_mapping) {
+        ::munmap(m_mapping, m_mappedSize);
+    }
+}
+
+std::expected<void, McpError> McpManifest::parse() {
+    using namespace simdjson;
+
+    // 生成的清单通常是单行的（末尾可能有换行），整份检查一次即可跳过逐条检查
+    const std::string_view content = TrimTrailingSpace(bytes());
+    m_multiline = std::memchr(content.data(), '\n', content.size()) || std::memchr(content.data(), '\r', content.size());
+
+    ondemand::parser parser;
+    padded_string_view input(static_cast<const char*>(m_mapping), m_size, m_mappedSize);
+    ondemand::document document;
+    ondemand::object root;
+    if (auto error = parser.iterate(input).get(document); error) {
+        return std::unexpected(McpError::parseError(error_message(error)));
+    }
+    if (auto error = document.get_object().get(root); error) {
+        return std::unexpected(McpError::parseError(error_message(error)));
+    }
+
+    for (auto field : root) {
+        std::string_view key;
+        ondemand::array items;
+        if (auto error = field.unescaped_key().get(key); error) {
+            return std::unexpected(McpError::parseError(error_message(error)));
+        }
+        if (key != "tools" && key != "resources") {
+            continue;
+        }
+        if (auto error = field.value().get_array().get(items); error) {
+            return std::unexpected(McpError::parseError(std::string(key) + ": " + error_message(error)));
+        }
+
+        const bool tools = key == "tools";
+        const char* list = tools ? "tools" : "resources";
+        size_t index = 0;
+        for (auto item : items) {
+            ondemand::object object;
+            std::string_view raw;
+            if (item.get_object().get(object) || object.raw_json().get(raw) || object.reset().error()) {
+                return std::unexpected(EntryError(list, index, "expected an object"));
+            }
+
+            // 先取整个对象的原始字节，再回到对象开头逐个读字段
+            raw = compact(TrimTrailingSpace(raw));
+            McpManifestTool tool;
+            McpManifestResource resource;
+            for (auto member : object) {
+                std::string_view name;
+                ondemand::value value;
+                if (member.unescaped_key().get(name) || member.value().get(value)) {
+                    return std::unexpected(EntryError(list, index, "malformed member"));
+                }
+                bool ok = true;
+                if (name == "name") {
+                    ok = ReadString(value, tools ? tool.name : resource.name);
+                } else if (name == "description") {
+                    ok = ReadString(value, tools ? tool.description : resource.description);
+                } else if (tools && name == "inputSchema") {
+                    ok = !value.raw_json().get(tool.inputSchema);
+                    tool.inputSchema = compact(TrimTrailingSpace(tool.inputSchema));
+                } else if (tools && name == "outputSchema") {
+                    ok = !value.raw_json().get(tool.outputSchema);
+                    tool.outputSchema = compact(TrimTrailingSpace(tool.outputSchema));
+                } else if (!tools && name == "uri") {
+                    ok = ReadString(value, resource.uri);
+                } else if (!tools && name == "mimeType") {
+                    ok = ReadString(value, resource.mimeType);
+                }
+                if (!ok) {
+                    return std::unexpected(EntryError(list, index, "invalid " + std::string(name)));
+                }
+            }
+
+            if (tools) {
+                if (tool.name.empty() || tool.inputSchema.empty()) {
+                    return std::unexpected(EntryError(list, index, "name and inputSchema are required"));
+                }
+                tool.json = raw;
+                m_tools.push_back(std::move(tool));
+            } else {
+                if (resource.uri.empty() || resource.name.empty()) {
+                    return std::unexpected(EntryError(list, index, "uri and name are required"));
+                }
+                resource.json = raw;
+                m_resources.push_back(std::move(resource));
+            }
+            ++index;
+        }
+    }
+
+    if (!document.at_end()) {
+        return std::unexpected(McpError::parseError(error_message(TRAILING_CONTENT)));
+    }
+    return {};
+}
+
+std::string_view McpManifest::compact(std::string_view raw) {
+    if (!m_multiline || (!std::memchr(raw.data(), '\n', raw.size()) && !std::memchr(raw.data(), '\r', raw.size()))) {
+        return raw;
+    }
+    // 换行会破坏按行分帧的 stdio 传输，含换行的片段压缩成单行副本
+    std::string& copy = m_compacted.emplace_back(raw.size(), '\0');
+    size_t length = 0;
+    if (simdjson::minify(raw.data(), raw.size(), copy.data(), length)) {
+        copy.assign(raw);
+        std::replace_if(copy.begin(), copy.end(), [](char c) { return c == '\r' || c == '\n'; }, ' ');
+        return copy;
+    }
+    copy.resize(length);
+    return copy;
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,91 @@
+#ifndef GALAY_MCP_COMMON_MCPMANIFEST_H
+#define GALAY_MCP_COMMON_MCPMANIFEST_H
+
+#include "galay-mcp/common/McpError.h"
+#include <cstddef>
+#include <deque>
+#include <expected>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 清单中的一个工具
+ *
+ * name / description 已反转义；inputSchema 与 json 是指向清单映射的视图，
+ * 只在持有 McpManifest 期间有效。
+ */
+struct McpManifestTool {
+    std::string name;
+    std::string description;
+    std::string_view inputSchema;  // 原始 JSON Schema 字节
+    std::string_view outputSchema; // 原始 JSON Schema 字节；未声明时为空，声明后工具返回 structuredContent
+    std::string_view json;         // 整个工具对象的原始字节，原样进入 tools/list
+};
+
+/**
+ * @brief 清单中的一个资源；json 指向清单映射
+ */
+struct McpManifestResource {
+    std::string uri;
+    std::string name;
+    std::string description;
+    std::string mimeType;
+    std::string_view json;  // 整个资源对象的原始字节，原样进入 resources/list
+};
+
+/**
+ * @brief 以只读内存映射加载的工具 / 资源清单
+ *
+ * 清单是一个 JSON 文件：
+ * {"tools":[{"name":...,"description":...,"inputSchema":{...}}, ...],
+ *  "resources":[{"uri":...,"name":...,"description":...,"mimeType":...}, ...]}
+ *
+ * 文件经 mmap 映射（末尾补足 simdjson 所需的零填充页），用 simdjson On Demand 一遍解析，
+ * 不复制文件内容；工具的 inputSchema 与各条目的原始 JSON 以视图形式指向映射，
+ * 注册到服务端后列表结果直接由这些字节拼接。条目中的其他字段（如 annotations）原样保留。
+ * 按行分帧的传输不允许消息内换行：跨行书写的条目在加载时压缩为单行副本，单行清单全程零复制。
+ * 映射在最后一个持有者释放后解除，服务端注册的每个条目都持有清单。
+ */
+class McpManifest {
+public:
+    /**
+     * @brief 映射并解析清单文件
+     * @return 打开或映射失败返回 ReadError；JSON 无效或条目缺少 name / uri / inputSchema 返回 ParseError
+     */
+    static std::expected<std::shared_ptr<const McpManifest>, McpError> load(const std::string& path);
+
+    ~McpManifest();
+
+    McpManifest(const McpManifest&) = delete;
+    McpManifest& operator=(const McpManifest&) = delete;
+
+    const std::vector<McpManifestTool>& tools() const { return m_tools; }
+    const std::vector<McpManifestResource>& resources() const { return m_resources; }
+
+    // 映射中的文件内容
+    std::string_view bytes() const { return std::string_view(static_cast<const char*>(m_mapping), m_size); }
+
+private:
+    McpManifest() = default;
+
+    std::expected<void, McpError> parse();
+    std::string_view compact(std::string_view raw);
+
+    void* m_mapping = nullptr;
+    size_t m_mappedSize = 0;  // 含零填充
+    size_t m_size = 0;        // 文件大小
+    std::vector<McpManifestTool> m_tools;
+    std::vector<McpManifestResource> m_resources;
+    std::deque<std::string> m_compacted;  // 含换行的片段压缩后的副本，地址稳定
+    bool m_multiline = false;             // 文件内容（去掉末尾空白）是否含换行
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPMANIFEST_H
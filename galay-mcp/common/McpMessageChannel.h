@@ -0,0 +1,37 @@
+#ifndef GALAY_MCP_COMMON_MCPMESSAGECHANNEL_H
+#define GALAY_MCP_COMMON_MCPMESSAGECHANNEL_H
+
+#include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpStdioFraming.h"
+#include <expected>
+#include <string>
+#include <string_view>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 按消息收发 JSON-RPC 文本的双向通道
+ *
+ * McpStdioServer / McpStdioClient 默认直接读写 stdin/stdout；设置通道后，
+ * 消息改由通道收发，协议处理与注册表逻辑保持不变。
+ * 实现方在对端关闭时应返回 McpErrorCode::ConnectionClosed。
+ */
+class McpMessageChannel {
+public:
+    virtual ~McpMessageChannel() = default;
+
+    // 读取一条完整消息（阻塞）
+    virtual std::expected<std::string, McpError> readMessage() = 0;
+
+    // 写入一条完整消息
+    virtual std::expected<void, McpError> writeMessage(std::string_view message) = 0;
+
+    // 切换写出时的分帧方式；只有字节流通道需要处理，消息型通道保持默认的空实现
+    virtual void setFraming(McpStdioFraming framing) { (void)framing; }
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPMESSAGECHANNEL_H
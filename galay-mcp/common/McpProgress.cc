@@ -0,0 +1,110 @@
+#include "galay-mcp/common/McpProgress.h"
+#include <mutex>
+
+namespace galay {
+namespace mcp {
+
+struct McpProgressReporter::State {
+    JsonString token;
+    Clock::duration interval;
+    Sink sink;
+
+    // sink 在锁内调用，保证同一请求的通知按上报顺序发出
+    std::mutex mutex;
+    bool closed = false;
+    std::optional<JsonString> pending;
+    Clock::time_point nextAllowed{};
+    uint64_t reported = 0;
+    uint64_t sent = 0;
+
+    void send(Clock::time_point now) {
+        sink(*pending);
+        pending.reset();
+        nextAllowed = now + interval;
+        ++sent;
+    }
+};
+
+McpProgressReporter::McpProgressReporter(JsonString progressToken,
+                                         std::chrono::milliseconds interval,
+                                         Sink sink)
+    : m_state(std::make_shared<State>()) {
+    m_state->token = std::move(progressToken);
+    m_state->interval = interval;
+    m_state->sink = std::move(sink);
+}
+
+bool McpProgressReporter::active() const {
+    return m_state != nullptr;
+}
+
+void McpProgressReporter::report(double progress, std::optional<double> total, const std::string& message) const {
+    if (!m_state) {
+        return;
+    }
+
+    JsonWriter writer;
+    writer.StartObject();
+    writer.Key("progressToken");
+    writer.Raw(m_state->token);
+    writer.Key("progress");
+    writer.Number(progress);
+    if (total.has_value()) {
+        writer.Key("total");
+        writer.Number(total.value());
+    }
+    if (!message.empty()) {
+        writer.Key("message");
+        writer.String(message);
+    }
+    writer.EndObject();
+
+    const Clock::time_point now = Clock::now();
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (m_state->closed) {
+        return;
+    }
+    ++m_state->reported;
+    m_state->pending = writer.TakeString();
+    if (now >= m_state->nextAllowed) {
+        m_state->send(now);
+    }
+}
+
+void McpProgressReporter::flushDue(Clock::time_point now) {
+    if (!m_state) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    if (!m_state->closed && m_state->pending.has_value() && now >= m_state->nextAllowed) {
+        m_state->send(now);
+    }
+}
+
+void McpProgressReporter::close() {
+    if (!m_state) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    m_state->closed = true;
+    m_state->pending.reset();
+}
+
+uint64_t McpProgressReporter::reportedCount() const {
+    if (!m_state) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->reported;
+}
+
+uint64_t McpProgressReporter::sentCount() const {
+    if (!m_state) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(m_state->mutex);
+    return m_state->sent;
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,63 @@
+#ifndef GALAY_MCP_COMMON_MCPPROGRESS_H
+#define GALAY_MCP_COMMON_MCPPROGRESS_H
+
+#include "galay-mcp/common/McpJson.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 工具处理函数的进度上报句柄
+ *
+ * 请求 params._meta.progressToken 存在时由服务端创建，经 McpToolContext::progress 交给处理函数。
+ * 每次 report() 生成一条 notifications/progress 的 params 交给服务端的输出函数；
+ * 同一请求在 interval 内的多次上报只保留最新一次，在间隔结束后的下一次 report() 或服务端
+ * 调用 flushDue() 时发出，因此每个请求每个 interval 最多发出一条通知。
+ * 默认构造的句柄不发送任何内容。可以跨线程拷贝与调用，拷贝共享同一状态。
+ */
+class McpProgressReporter {
+public:
+    using Clock = std::chrono::steady_clock;
+    // 收到一条 notifications/progress 的 params（JSON 对象）
+    using Sink = std::function<void(const JsonString& params)>;
+
+    McpProgressReporter() = default;
+
+    /**
+     * @param progressToken 请求给出的 progressToken 原始 JSON（字符串或整数）
+     * @param interval 同一请求两条通知之间的最小间隔；0 表示不合并
+     */
+    McpProgressReporter(JsonString progressToken, std::chrono::milliseconds interval, Sink sink);
+
+    // 请求是否带有 progressToken（未带时 report() 直接返回）
+    bool active() const;
+
+    void report(double progress,
+                std::optional<double> total = std::nullopt,
+                const std::string& message = "") const;
+
+    // 发出已到间隔的合并上报；服务端在等待处理函数时周期性调用
+    void flushDue(Clock::time_point now = Clock::now());
+
+    // 请求结束：丢弃未发出的上报，之后的 report() 不再生效
+    void close();
+
+    // 处理函数调用 report() 的次数与实际发出的通知数
+    uint64_t reportedCount() const;
+    uint64_t sentCount() const;
+
+private:
+    struct State;
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPPROGRESS_H
@@ -2,21 +2,25 @@
 #define GALAY_MCP_COMMON_MCPPROTOCOLUTILS_H
 
 #include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpCancellation.h"
 #include "galay-mcp/common/McpJson.h"
+#include <chrono>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace galay {
 namespace mcp {
 namespace protocol {
 
-inline JsonString buildInitializeResult(const std::string& serverName,
-                                        const std::string& serverVersion,
-                                        bool hasTools,
-                                        bool hasResources,
-                                        bool hasPrompts) {
+inline InitializeResult makeInitializeResult(const std::string& serverName,
+                                             const std::string& serverVersion,
+                                             bool hasTools,
+                                             bool hasResources,
+                                             bool hasPrompts,
+                                             const JsonString& experimental = "") {
     InitializeResult result;
     result.protocolVersion = MCP_VERSION;
     result.serverInfo.name = serverName;
@@ -27,8 +31,21 @@ inline JsonString buildInitializeResult(const std::string& serverName,
     result.capabilities.resources = hasResources;
     result.capabilities.prompts = hasPrompts;
     result.capabilities.logging = false;
+    // 注册表可在运行期间变化，变化时向已初始化的客户端发送 list_changed 通知
+    result.capabilities.listChanged = true;
+    result.capabilities.experimental = experimental;
 
-    return result.toJson();
+    return result;
+}
+
+inline JsonString buildInitializeResult(const std::string& serverName,
+                                        const std::string& serverVersion,
+                                        bool hasTools,
+                                        bool hasResources,
+                                        bool hasPrompts,
+                                        const JsonString& experimental = "") {
+    return makeInitializeResult(serverName, serverVersion, hasTools, hasResources, hasPrompts,
+                                experimental).toJson();
 }
 
 inline JsonRpcResponse makeResultResponse(int64_t id, const JsonString& result) {
@@ -93,6 +110,296 @@ inline JsonRpcResponse makeErrorResponse(int64_t id,
     return response;
 }
 
+/**
+ * @brief 构造客户端收到 makeErrorResponse(id, code, message, details) 后得到的 McpError
+ * @note 供进程内调用使用：不经过线路，但错误码映射与 details（JSON 编码后的 data）保持一致
+ */
+inline McpError makeClientError(int code,
+                                const std::string& message,
+                                const std::string& details = "") {
+    std::string data;
+    if (!details.empty()) {
+        JsonWriter writer;
+        writer.String(details);
+        data = writer.TakeString();
+    }
+    return McpError::fromJsonRpcError(code, message, data);
+}
+
+/**
+ * @brief 处理函数返回的错误经 sendError 转发后，客户端看到的 McpError
+ */
+inline McpError makeClientError(const McpError& handlerError) {
+    return makeClientError(handlerError.toJsonRpcErrorCode(), handlerError.message(), handlerError.details());
+}
+
+/**
+ * @brief 把工具处理函数的输出包装为 tools/call 的结果
+ *
+ * 未声明 outputSchema 的工具输出作为一个文本内容项；声明了 outputSchema 的工具输出应是 JSON 对象，
+ * 原样放入 structuredContent，不转义为字符串。只检查首个非空白字符是 '{'，其余语法由处理函数负责。
+ */
+inline std::expected<ToolCallResult, McpError> makeToolCallResult(const Tool& tool, JsonString output) {
+    ToolCallResult callResult;
+    if (tool.outputSchema.empty()) {
+        Content content;
+        content.type = ContentType::Text;
+        content.text = std::move(output);
+        callResult.content.push_back(std::move(content));
+        return callResult;
+    }
+    const size_t first = output.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || output[first] != '{') {
+        return std::unexpected(McpError::internalError("Structured tool result must be a JSON object: " + tool.name));
+    }
+    callResult.structuredContent = std::move(output);
+    return callResult;
+}
+
+/**
+ * @brief 流式结果响应的 JSON-RPC 外层开头；之后拼接 result 的各部分，最后补一个 '}'
+ */
+inline JsonString streamedResponsePrefix(int64_t id) {
+    JsonString prefix = "{\"jsonrpc\":\"2.0\",\"id\":";
+    prefix += std::to_string(id);
+    prefix += ",\"result\":";
+    return prefix;
+}
+
+/**
+ * @brief 流式工具结果的开头，之后直接拼接按 JSON 字符串转义的文本
+ *
+ * 与 ToolCallResult 只有一个文本内容项时的编码一致；整个 result 为
+ * 开头 + 转义文本 + streamedToolResultSuffix()。
+ */
+inline JsonString streamedToolResultPrefix() {
+    return "{\"content\":[{\"type\":\"text\",\"text\":\"";
+}
+
+/**
+ * @brief 流式工具结果的结尾
+ * @param error 非空表示部分文本写出之后处理函数失败或调用被取消：追加一个说明错误的文本内容项并置 isError
+ */
+inline JsonString streamedToolResultSuffix(const McpError* error = nullptr) {
+    if (!error) {
+        return "\"}]}";
+    }
+    std::string text = error->message();
+    if (!error->details().empty()) {
+        text += ": ";
+        text += error->details();
+    }
+    JsonString suffix = "\"},{\"type\":\"text\",\"text\":\"";
+    JsonWriter::AppendEscaped(suffix, text);
+    suffix += "\"}],\"isError\":true}";
+    return suffix;
+}
+
+/**
+ * @brief 流式资源读取结果的开头，之后拼接按 JSON 字符串转义的文本或 base64 编码的字节
+ * @param blob true 时内容写在 "blob" 中（base64），否则写在 "text" 中
+ */
+inline JsonString streamedResourceResultPrefix(const std::string& uri, const std::string& mimeType, bool blob) {
+    JsonString prefix = blob ? "{\"contents\":[{\"uri\":\"" : "{\"contents\":[{\"type\":\"text\",\"uri\":\"";
+    JsonWriter::AppendEscaped(prefix, uri);
+    prefix += "\"";
+    if (!mimeType.empty()) {
+        prefix += ",\"mimeType\":\"";
+        JsonWriter::AppendEscaped(prefix, mimeType);
+        prefix += "\"";
+    }
+    prefix += blob ? ",\"blob\":\"" : ",\"text\":\"";
+    return prefix;
+}
+
+/**
+ * @brief 流式资源读取结果的结尾
+ * @param error 非空表示部分内容写出之后读取失败：置 isError，错误说明写在 _meta.error 中，客户端据此返回错误
+ */
+inline JsonString streamedResourceResultSuffix(const McpError* error = nullptr) {
+    if (!error) {
+        return "\"}]}";
+    }
+    std::string text = error->message();
+    if (!error->details().empty()) {
+        text += ": ";
+        text += error->details();
+    }
+    JsonString suffix = "\"}],\"isError\":true,\"_meta\":{\"error\":\"";
+    JsonWriter::AppendEscaped(suffix, text);
+    suffix += "\"}}";
+    return suffix;
+}
+
+/**
+ * @brief 构造 galay-mcp 对端之间协商扩展用的 experimental 对象
+ * @param fields 写入 experimental.galay 的字符串字段，例如 {"framing", "content-length"}
+ * @return 形如 {"galay":{"framing":"content-length"}} 的 JSON；fields 为空时返回空串
+ */
+inline JsonString makeGalayExperimental(
+    const std::vector<std::pair<std::string, std::string>>& fields) {
+    if (fields.empty()) {
+        return {};
+    }
+    JsonWriter writer;
+    writer.StartObject();
+    writer.Key("galay");
+    writer.StartObject();
+    for (const auto& [key, value] : fields) {
+        writer.Key(key);
+        writer.String(value);
+    }
+    writer.EndObject();
+    writer.EndObject();
+    return writer.TakeString();
+}
+
+/**
+ * @brief 读取 capabilities.experimental.galay.<field> 的字符串值
+ * @param capabilities initialize 请求或响应中的 capabilities 对象
+ * @return 对端未声明（非 galay-mcp 对端）或类型不符时返回空串
+ */
+inline std::string getGalayExtension(const JsonElement& capabilities, const char* field) {
+    JsonObject capsObj;
+    JsonObject experimentalObj;
+    JsonObject galayObj;
+    std::string value;
+    if (!JsonHelper::GetObject(capabilities, capsObj) ||
+        !JsonHelper::GetObject(capsObj, "experimental", experimentalObj) ||
+        !JsonHelper::GetObject(experimentalObj, "galay", galayObj) ||
+        !JsonHelper::GetString(galayObj, field, value)) {
+        return {};
+    }
+    return value;
+}
+
+/**
+ * @brief 读取请求 params._meta.timeoutMs（galay-mcp 扩展：客户端给出的超时时间）
+ * @return 未给出或不是正整数时返回 std::nullopt
+ */
+inline std::optional<std::chrono::milliseconds> getRequestTimeout(const JsonObject& params) {
+    JsonObject metaObj;
+    int64_t timeoutMs = 0;
+    if (!JsonHelper::GetObject(params, "_meta", metaObj) ||
+        !JsonHelper::GetInt64(metaObj, "timeoutMs", timeoutMs) ||
+        timeoutMs <= 0) {
+        return std::nullopt;
+    }
+    return std::chrono::milliseconds(timeoutMs);
+}
+
+/**
+ * @brief 读取请求 params._meta.progressToken 的原始 JSON（字符串或整数）
+ */
+inline std::optional<JsonString> getProgressToken(const JsonObject& params) {
+    JsonObject metaObj;
+    JsonElement tokenElement;
+    JsonString token;
+    if (!JsonHelper::GetObject(params, "_meta", metaObj) ||
+        !JsonHelper::GetElement(metaObj, "progressToken", tokenElement) ||
+        !JsonHelper::GetRawJson(tokenElement, token)) {
+        return std::nullopt;
+    }
+    return token;
+}
+
+/**
+ * @brief 在 params 对象前部插入 _meta（timeoutMs / progressToken）
+ * @param params 客户端构造的 params 对象（不含 _meta）；为空视为 {}
+ * @param timeout 非空时写入 timeoutMs，供服务端按同一截止时间取消
+ * @param progressToken 非空时作为字符串写入 progressToken，请求服务端发送进度通知
+ */
+inline JsonString withRequestMeta(std::string_view params,
+                                  std::optional<std::chrono::milliseconds> timeout,
+                                  std::string_view progressToken = {}) {
+    if (!timeout.has_value() && progressToken.empty()) {
+        return params.empty() ? JsonString("{}") : JsonString(params);
+    }
+
+    JsonWriter metaWriter;
+    metaWriter.StartObject();
+    if (timeout.has_value()) {
+        metaWriter.Key("timeoutMs");
+        metaWriter.Number(static_cast<int64_t>(timeout->count()));
+    }
+    if (!progressToken.empty()) {
+        metaWriter.Key("progressToken");
+        metaWriter.String(std::string(progressToken));
+    }
+    metaWriter.EndObject();
+
+    JsonString meta = "{\"_meta\":" + metaWriter.TakeString();
+    const size_t open = params.find('{');
+    if (open == std::string_view::npos) {
+        return meta + "}";
+    }
+    std::string_view rest = params.substr(open + 1);
+    const size_t next = rest.find_first_not_of(" \t\r\n");
+    if (next == std::string_view::npos || rest[next] != '}') {
+        meta += ',';
+    }
+    meta.append(rest);
+    return meta;
+}
+
+/**
+ * @brief 在 params 对象前部插入 _meta.timeoutMs
+ */
+inline JsonString withRequestTimeout(std::string_view params, std::chrono::milliseconds timeout) {
+    return withRequestMeta(params, timeout);
+}
+
+/**
+ * @brief 读取 notifications/cancelled 的 params.requestId
+ */
+inline std::optional<int64_t> getCancelledRequestId(const JsonElement& params) {
+    JsonObject paramsObj;
+    int64_t requestId = 0;
+    if (!JsonHelper::GetObject(params, paramsObj) ||
+        !JsonHelper::GetInt64(paramsObj, "requestId", requestId)) {
+        return std::nullopt;
+    }
+    return requestId;
+}
+
+/**
+ * @brief tools/list、resources/list、prompts/list 的参数
+ */
+struct ListRequestParams {
+    std::string cursor;          // params.cursor；第一页为空
+    std::string ifChangedSince;  // params._meta.ifChangedSince：客户端缓存的列表版本
+};
+
+inline ListRequestParams getListParams(const JsonElement& params, bool hasParams) {
+    ListRequestParams result;
+    JsonObject paramsObj;
+    if (hasParams && JsonHelper::GetObject(params, paramsObj)) {
+        JsonHelper::GetString(paramsObj, "cursor", result.cursor);
+        JsonObject metaObj;
+        if (JsonHelper::GetObject(paramsObj, "_meta", metaObj)) {
+            JsonHelper::GetString(metaObj, "ifChangedSince", result.ifChangedSince);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief 取消原因在 REQUEST_CANCELLED 错误中的 details
+ */
+inline const char* cancelReasonText(McpCancelReason reason) {
+    switch (reason) {
+        case McpCancelReason::Cancelled:
+            return "Cancelled by client";
+        case McpCancelReason::DeadlineExceeded:
+            return "Deadline exceeded";
+        case McpCancelReason::ConnectionClosed:
+            return "Connection closed";
+        case McpCancelReason::None:
+            break;
+    }
+    return "";
+}
+
 template <typename MapType, typename Extractor>
 JsonString buildListResultFromMap(const MapType& map, const char* key, Extractor extractor) {
     JsonWriter writer;
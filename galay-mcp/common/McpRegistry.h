@@ -0,0 +1,709 @@
+#ifndef GALAY_MCP_COMMON_MCPREGISTRY_H
+#define GALAY_MCP_COMMON_MCPREGISTRY_H
+
+#include "galay-mcp/common/McpJson.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 注册表中的一个条目；创建后不再修改，可被多个快照共享
+ */
+template <typename Info>
+struct McpRegistryEntry {
+    std::string key;
+    Info info;
+    // 该条目在列表结果中的 JSON：指向 storage（注册时序列化一次），
+    // 或指向 info 持有的外部缓冲（例如清单映射）
+    std::string_view json;
+    JsonString storage;
+};
+
+/**
+ * @brief 快照的基础段：按注册顺序排列的条目与索引，发布后不再修改，可被多个快照共享
+ */
+template <typename Info>
+struct McpRegistrySegment {
+    using Entry = McpRegistryEntry<Info>;
+
+    std::string listHead;  // {"<listKey>":[
+    std::vector<std::shared_ptr<const Entry>> entries;
+    std::unordered_map<std::string_view, size_t> index;  // key（指向条目自身）-> entries 下标
+
+    // 由条目缓存的 JSON 拼接，首次访问时生成
+    const JsonString& listResult() const {
+        std::call_once(m_listOnce, [this]() {
+            size_t bytes = listHead.size() + 2 + entries.size();
+            for (const auto& entry : entries) {
+                bytes += entry->json.size();
+            }
+            m_list.reserve(bytes);
+            m_list += listHead;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (i > 0) {
+                    m_list.push_back(',');
+                }
+                m_list += entries[i]->json;
+            }
+            m_list += "]}";
+        });
+        return m_list;
+    }
+
+private:
+    mutable std::once_flag m_listOnce;
+    mutable JsonString m_list;
+};
+
+/**
+ * @brief 注册表的一个不可变版本
+ *
+ * 发布后内容不再变化：读取方拿到后可以在任意线程、任意时长内直接访问，
+ * 注册表之后的增删只会发布新的快照。条目由共享的基础段与其后追加的少量条目组成，
+ * 按注册顺序遍历，与列表结果顺序一致。
+ */
+template <typename Info>
+class McpRegistry;
+
+template <typename Info>
+struct McpRegistrySnapshot {
+    using Entry = McpRegistryEntry<Info>;
+    using Segment = McpRegistrySegment<Info>;
+
+    std::shared_ptr<const Segment> base;
+    std::vector<std::shared_ptr<const Entry>> tail;       // base 之后追加的条目
+    std::unordered_map<std::string_view, size_t> tailIndex;
+    uint64_t version = 0;  // 每次发布加一
+    size_t pageSize = 0;   // list 结果每页条目数，0 表示不分页
+
+    const Entry* findEntry(std::string_view key) const {
+        if (auto it = base->index.find(key); it != base->index.end()) {
+            return base->entries[it->second].get();
+        }
+        auto it = tailIndex.find(key);
+        return it == tailIndex.end() ? nullptr : tail[it->second].get();
+    }
+
+    const Info* find(std::string_view key) const {
+        const Entry* entry = findEntry(key);
+        return entry ? &entry->info : nullptr;
+    }
+
+    size_t size() const { return base->entries.size() + tail.size(); }
+    bool empty() const { return size() == 0; }
+
+    // 按注册顺序的第 position 个条目
+    const Entry& at(size_t position) const {
+        const size_t baseSize = base->entries.size();
+        return position < baseSize ? *base->entries[position] : *tail[position - baseSize];
+    }
+
+    // 按注册顺序访问每个条目
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const auto& entry : base->entries) {
+            fn(*entry);
+        }
+        for (const auto& entry : tail) {
+            fn(*entry);
+        }
+    }
+
+    /**
+     * @brief 预先拼好的 {"<listKey>":[...]}，list 请求直接返回
+     *
+     * 首次访问时生成：基础段的结果每个基础段只拼一次，追加的条目接在其后；
+     * 连续注册期间没有 list 请求时不做任何拼接。
+     */
+    const JsonString& listResult() const {
+        if (tail.empty()) {
+            return base->listResult();
+        }
+        std::call_once(m_listOnce, [this]() {
+            const JsonString& prefix = base->listResult();
+            size_t bytes = prefix.size() + tail.size();
+            for (const auto& entry : tail) {
+                bytes += entry->json.size();
+            }
+            m_list.reserve(bytes);
+            // 去掉基础段结果末尾的 "]}"，接上追加的条目
+            m_list.assign(prefix, 0, prefix.size() - 2);
+            for (size_t i = 0; i < tail.size(); ++i) {
+                if (i > 0 || !base->entries.empty()) {
+                    m_list.push_back(',');
+                }
+                m_list += tail[i]->json;
+            }
+            m_list += "]}";
+        });
+        return m_list;
+    }
+
+    /**
+     * @brief 按 MCP cursor 取一页 list 结果：{"<listKey>":[...],"nextCursor":"..."}
+     *
+     * cursor 为空表示第一页；nextCursor 是下一页第一个条目的位置，最后一页不带 nextCursor。
+     * 每页在首次访问时拼接并缓存，之后同一页的请求只是一次查找；发布新快照时，
+     * 位于变更位置之前的页直接沿用旧快照的缓存。不分页（pageSize 为 0）时返回 listResult()。
+     * @return cursor 不是本注册表签发的位置（或已越过末尾）时返回 nullptr
+     */
+    const JsonString* listPage(std::string_view cursor) const {
+        if (pageSize == 0) {
+            return &listResult();
+        }
+        size_t offset = 0;
+        if (!cursor.empty()) {
+            auto [end, error] = std::from_chars(cursor.data(), cursor.data() + cursor.size(), offset);
+            if (error != std::errc() || end != cursor.data() + cursor.size() ||
+                offset % pageSize != 0 || offset >= size()) {
+                return nullptr;
+            }
+        }
+
+        const size_t index = offset / pageSize;
+        {
+            std::lock_guard<std::mutex> lock(m_pagesMutex);
+            if (m_pages[index]) {
+                return m_pages[index].get();
+            }
+        }
+        // 在锁外拼接；并发首次访问同一页时保留先写入的结果
+        auto page = std::make_shared<const JsonString>(buildPage(offset));
+        std::lock_guard<std::mutex> lock(m_pagesMutex);
+        if (!m_pages[index]) {
+            m_pages[index] = std::move(page);
+        }
+        return m_pages[index].get();
+    }
+
+private:
+    friend class McpRegistry<Info>;
+
+    JsonString buildPage(size_t offset) const {
+        const size_t end = std::min(offset + pageSize, size());
+        const std::string& head = base->listHead;
+        size_t bytes = head.size() + 32 + (end - offset);
+        for (size_t i = offset; i < end; ++i) {
+            bytes += at(i).json.size();
+        }
+        JsonString page;
+        page.reserve(bytes);
+        page += head;
+        for (size_t i = offset; i < end; ++i) {
+            if (i > offset) {
+                page.push_back(',');
+            }
+            page += at(i).json;
+        }
+        page += ']';
+        if (end < size()) {
+            page += ",\"nextCursor\":\"";
+            page += std::to_string(end);
+            page += '"';
+        }
+        page += '}';
+        return page;
+    }
+
+    mutable std::once_flag m_listOnce;
+    mutable JsonString m_list;
+    // 分页结果，按页下标；发布时按页数预先分配，之后只填充空位
+    mutable std::mutex m_pagesMutex;
+    mutable std::vector<std::shared_ptr<const JsonString>> m_pages;
+};
+
+/**
+ * @brief 读多写少的工具 / 资源 / 提示注册表（RCU 快照）
+ *
+ * 写入方在写锁内生成新快照并原子地发布；读取方不加锁：snapshot() 原子地取得当前快照的所有权，
+ * Reader 只在版本号变化时重新取，版本未变时每次读取只有一次原子 load，不写任何共享缓存行。
+ * 旧快照在最后一个持有者释放后回收，正在执行的调用不受并发删除影响。
+ *
+ * 每个条目只在注册时序列化一次。新条目先追加到快照的尾部，新快照与旧快照共享基础段，
+ * 只复制尾部；尾部超过 max(64, √n) 时合并成新的基础段，逐个注册的均摊开销为 O(√n)。
+ * 替换或删除基础段中的条目需要合并整张表；大量注册应使用 putAll() 一次发布。
+ *
+ * 设置每页条目数后 list 结果按页缓存（见 McpRegistrySnapshot::listPage()）。新快照沿用旧快照中
+ * 条目与 nextCursor 都不变的页：追加只重建原来的最后一页，替换只重建被替换条目所在的页；
+ * 删除会使之后的条目前移，所在页及其后的页重建。
+ *
+ * 每个版本有一个标签 "<实例纪元>-<版本号>"，纪元在构造时随机生成，服务端重启后旧标签不会被误认。
+ * 注册表保留最近若干次发布改动过的 key，listResponse() 据此对带旧标签的请求只返回增量。
+ */
+template <typename Info>
+class McpRegistry {
+public:
+    using Snapshot = McpRegistrySnapshot<Info>;
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+    using Segment = McpRegistrySegment<Info>;
+    using Entry = McpRegistryEntry<Info>;
+    // 单个条目序列化为列表中的一个 JSON 对象
+    using ItemSerializer = std::function<JsonString(const Info&)>;
+
+    /**
+     * @brief 单线程读取方持有的快照缓存
+     *
+     * 每个线程（或每条串行处理请求的连接）各持有一个；get() 返回的引用在下一次 get() 之前有效。
+     */
+    class Reader {
+    public:
+        explicit Reader(const McpRegistry& registry)
+            : m_registry(&registry)
+            , m_snapshot(registry.snapshot())
+            , m_version(m_snapshot->version) {
+        }
+
+        const Snapshot& get() {
+            if (m_registry->m_version.load(std::memory_order_acquire) != m_version) {
+                m_snapshot = m_registry->snapshot();
+                m_version = m_snapshot->version;
+            }
+            return *m_snapshot;
+        }
+
+        // 取得当前快照的所有权，供跨越挂起点或交给其他线程使用
+        SnapshotPtr share() {
+            get();
+            return m_snapshot;
+        }
+
+    private:
+        const McpRegistry* m_registry;
+        SnapshotPtr m_snapshot;
+        uint64_t m_version;
+    };
+
+    McpRegistry(const std::string& listKey, ItemSerializer serializer)
+        : m_listHead("{\"" + listKey + "\":[")
+        , m_serializer(std::move(serializer))
+        , m_epoch(makeEpoch()) {
+        auto base = std::make_shared<Segment>();
+        base->listHead = m_listHead;
+        auto initial = std::make_shared<Snapshot>();
+        initial->base = std::move(base);
+        m_snapshot.store(std::move(initial), std::memory_order_release);
+    }
+
+    McpRegistry(const McpRegistry&) = delete;
+    McpRegistry& operator=(const McpRegistry&) = delete;
+
+    SnapshotPtr snapshot() const {
+        return m_snapshot.load(std::memory_order_acquire);
+    }
+
+    uint64_t version() const {
+        return m_version.load(std::memory_order_acquire);
+    }
+
+    // 版本号对应的标签，随 list 结果以 _meta.listVersion 发给客户端
+    std::string versionTag(uint64_t version) const {
+        return m_epoch + "-" + std::to_string(version);
+    }
+
+    /**
+     * @brief 生成 list 请求的结果
+     *
+     * 结果带 _meta.listVersion。第一页请求带 ifChangedSince（客户端缓存的标签）时：
+     * 标签与当前一致返回 {"_meta":{"listVersion":...,"notModified":true}}；
+     * 否则若变更记录仍覆盖该版本（且增量不超过一页），返回
+     * {"<listKey>":[新增或替换的条目],"_meta":{"listVersion":...,"delta":true,"removed":[删除的 key]}}；
+     * 其余情况返回完整结果（或第一页）。
+     * @return cursor 非法时返回 std::nullopt
+     */
+    std::optional<JsonString> listResponse(const Snapshot& snapshot,
+                                           std::string_view cursor,
+                                           std::string_view ifChangedSince) const {
+        const JsonString* page = snapshot.listPage(cursor);
+        if (!page) {
+            return std::nullopt;
+        }
+        const std::string tag = versionTag(snapshot.version);
+        if (cursor.empty() && !ifChangedSince.empty()) {
+            if (ifChangedSince == tag) {
+                return "{\"_meta\":{\"listVersion\":\"" + tag + "\",\"notModified\":true}}";
+            }
+            auto keys = changedSince(ifChangedSince, snapshot.version);
+            if (keys && (snapshot.pageSize == 0 || keys->size() <= snapshot.pageSize)) {
+                return deltaResult(snapshot, tag, *keys);
+            }
+        }
+        // 在缓存的结果末尾的 } 之前插入 _meta
+        JsonString result;
+        result.reserve(page->size() + tag.size() + 32);
+        result.append(*page, 0, page->size() - 1);
+        result += ",\"_meta\":{\"listVersion\":\"";
+        result += tag;
+        result += "\"}}";
+        return result;
+    }
+
+    /**
+     * @brief 设置 list 结果每页条目数，0 表示不分页；发布一个内容不变的新快照
+     */
+    void setPageSize(size_t pageSize) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        SnapshotPtr current = m_snapshot.load(std::memory_order_relaxed);
+        if (current->pageSize == pageSize) {
+            return;
+        }
+        m_pageSize = pageSize;
+        auto next = std::make_shared<Snapshot>();
+        next->base = current->base;
+        next->tail = current->tail;
+        next->tailIndex = current->tailIndex;
+        publish(std::move(next), *current, 0, std::vector<std::string>{});
+    }
+
+    /**
+     * @brief 添加或替换一个条目
+     * @return 是否为新条目
+     */
+    bool put(std::string key, Info info) {
+        std::vector<std::pair<std::string, Info>> items;
+        items.emplace_back(std::move(key), std::move(info));
+        return putAll(std::move(items)) == 1;
+    }
+
+    /**
+     * @brief 添加或替换一批条目，只发布一个新版本
+     *
+     * 条目在写锁外完成序列化；同一批内重复的 key 以后出现的为准。
+     * @return 新增的条目数（替换已有 key 不计入）
+     */
+    size_t putAll(std::vector<std::pair<std::string, Info>> items) {
+        std::vector<std::shared_ptr<const Entry>> created;
+        created.reserve(items.size());
+        for (auto& [key, info] : items) {
+            auto entry = std::make_shared<Entry>();
+            entry->key = std::move(key);
+            entry->info = std::move(info);
+            entry->storage = m_serializer(entry->info);
+            entry->json = entry->storage;
+            created.push_back(std::move(entry));
+        }
+        return putEntries(std::move(created));
+    }
+
+    /**
+     * @brief 同 putAll()，条目的列表 JSON 由调用方给出，不经过序列化函数
+     * @param items (key, info, json)；json 须在条目存活期间有效，通常指向 info 持有的缓冲
+     */
+    size_t putAllSerialized(std::vector<std::tuple<std::string, Info, std::string_view>> items) {
+        std::vector<std::shared_ptr<const Entry>> created;
+        created.reserve(items.size());
+        for (auto& [key, info, json] : items) {
+            auto entry = std::make_shared<Entry>();
+            entry->key = std::move(key);
+            entry->info = std::move(info);
+            entry->json = json;
+            created.push_back(std::move(entry));
+        }
+        return putEntries(std::move(created));
+    }
+
+    /**
+     * @brief 删除一个条目
+     * @return 条目是否存在
+     */
+    bool remove(std::string_view key) {
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        SnapshotPtr current = m_snapshot.load(std::memory_order_relaxed);
+        auto next = std::make_shared<Snapshot>();
+        size_t position = 0;
+        if (auto it = current->base->index.find(key); it != current->base->index.end()) {
+            position = it->second;
+            next->base = merge(*current, current->base->entries[it->second].get(), 0);
+        } else if (auto tailIt = current->tailIndex.find(key); tailIt != current->tailIndex.end()) {
+            // 只在尾部：共享基础段，重建尾部
+            position = current->base->entries.size() + tailIt->second;
+            next->base = current->base;
+            next->tail.reserve(current->tail.size() - 1);
+            for (const auto& entry : current->tail) {
+                if (entry->key != key) {
+                    next->tailIndex.emplace(entry->key, next->tail.size());
+                    next->tail.push_back(entry);
+                }
+            }
+        } else {
+            return false;
+        }
+        publish(std::move(next), *current, position, std::vector<std::string>{std::string(key)});
+        return true;
+    }
+
+private:
+    size_t putEntries(std::vector<std::shared_ptr<const Entry>> created) {
+        if (created.empty()) {
+            return 0;
+        }
+        // 大批量注册不逐个记录 key，之前的版本只能拿到完整结果
+        std::optional<std::vector<std::string>> keys;
+        if (created.size() <= kMaxChangedKeys) {
+            keys.emplace();
+            keys->reserve(created.size());
+            for (const auto& entry : created) {
+                keys->push_back(entry->key);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_writeMutex);
+        SnapshotPtr current = m_snapshot.load(std::memory_order_relaxed);
+        auto next = std::make_shared<Snapshot>();
+
+        const size_t tailSize = current->tail.size() + created.size();
+        if (tailSize <= tailLimit(current->size() + created.size()) && allNew(*current, created)) {
+            // 只追加新条目：共享基础段，复制尾部
+            next->base = current->base;
+            next->tail.reserve(tailSize);
+            next->tail = current->tail;
+            next->tailIndex = current->tailIndex;
+            for (auto& entry : created) {
+                next->tailIndex.emplace(entry->key, next->tail.size());
+                next->tail.push_back(std::move(entry));
+            }
+            const size_t added = next->tail.size() - current->tail.size();
+            publish(std::move(next), *current, current->size(), std::move(keys));
+            return added;
+        }
+
+        auto base = merge(*current, nullptr, created.size());
+        size_t added = 0;
+        size_t firstChanged = current->size();
+        for (auto& entry : created) {
+            auto it = base->index.find(entry->key);
+            if (it != base->index.end()) {
+                // 索引的 key 指向旧条目，替换后改指新条目
+                const size_t position = it->second;
+                firstChanged = std::min(firstChanged, position);
+                base->index.erase(it);
+                base->index.emplace(entry->key, position);
+                base->entries[position] = std::move(entry);
+                continue;
+            }
+            base->index.emplace(entry->key, base->entries.size());
+            base->entries.push_back(std::move(entry));
+            ++added;
+        }
+        next->base = std::move(base);
+        publish(std::move(next), *current, firstChanged, std::move(keys));
+        return added;
+    }
+
+    static size_t tailLimit(size_t total) {
+        return std::max<size_t>(64, static_cast<size_t>(std::sqrt(static_cast<double>(total))));
+    }
+
+    // 批内的 key 互不相同且都不在当前快照中
+    static bool allNew(const Snapshot& current, const std::vector<std::shared_ptr<const Entry>>& created) {
+        std::unordered_set<std::string_view> seen;
+        seen.reserve(created.size());
+        for (const auto& entry : created) {
+            if (current.find(entry->key) || !seen.insert(entry->key).second) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 把当前快照的全部条目（跳过 removed）合并成一个新的基础段
+    std::shared_ptr<Segment> merge(const Snapshot& current, const Entry* removed, size_t extra) const {
+        auto base = std::make_shared<Segment>();
+        base->listHead = m_listHead;
+        base->entries.reserve(current.size() + extra);
+        base->index.reserve(current.size() + extra);
+        for (const auto* part : {&current.base->entries, &current.tail}) {
+            for (const auto& entry : *part) {
+                if (entry.get() == removed) {
+                    continue;
+                }
+                base->index.emplace(entry->key, base->entries.size());
+                base->entries.push_back(entry);
+            }
+        }
+        return base;
+    }
+
+    static bool samePositions(const Snapshot& current, const Snapshot& next, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            if (&current.at(i) != &next.at(i)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static std::string makeEpoch() {
+        std::random_device device;
+        const uint64_t epoch = (static_cast<uint64_t>(device()) << 32) ^ device();
+        char buffer[16];
+        auto [end, error] = std::to_chars(buffer, buffer + sizeof(buffer), epoch, 16);
+        (void)error;
+        return std::string(buffer, end);
+    }
+
+    // ifChangedSince 之后、upTo 及之前改动过的 key；标签不属于本实例或超出变更记录时返回 std::nullopt
+    std::optional<std::vector<std::string>> changedSince(std::string_view tag, uint64_t upTo) const {
+        const size_t dash = tag.rfind('-');
+        if (dash == std::string_view::npos || tag.substr(0, dash) != m_epoch) {
+            return std::nullopt;
+        }
+        uint64_t since = 0;
+        auto [end, error] = std::from_chars(tag.data() + dash + 1, tag.data() + tag.size(), since);
+        if (error != std::errc() || end != tag.data() + tag.size() || since > upTo) {
+            return std::nullopt;
+        }
+
+        std::lock_guard<std::mutex> lock(m_changesMutex);
+        if (since < m_changesFloor) {
+            return std::nullopt;
+        }
+        std::vector<std::string> keys;
+        std::unordered_set<std::string_view> seen;
+        for (const auto& change : m_changes) {
+            if (change.version <= since || change.version > upTo) {
+                continue;
+            }
+            for (const auto& key : change.keys) {
+                if (seen.insert(key).second) {
+                    keys.push_back(key);
+                }
+            }
+        }
+        return keys;
+    }
+
+    JsonString deltaResult(const Snapshot& snapshot, const std::string& tag, const std::vector<std::string>& keys) const {
+        JsonString result = m_listHead;
+        JsonWriter meta;
+        meta.StartObject();
+        meta.Key("listVersion");
+        meta.String(tag);
+        meta.Key("delta");
+        meta.Bool(true);
+        meta.Key("removed");
+        meta.StartArray();
+        bool first = true;
+        for (const auto& key : keys) {
+            if (const Entry* entry = snapshot.findEntry(key)) {
+                if (!first) {
+                    result.push_back(',');
+                }
+                first = false;
+                result += entry->json;
+            } else {
+                meta.String(key);
+            }
+        }
+        meta.EndArray();
+        meta.EndObject();
+        result += "],\"_meta\":";
+        result += meta.TakeString();
+        result += '}';
+        return result;
+    }
+
+    // keys 为 std::nullopt 表示改动太多未记录，清空变更记录
+    void recordChange(uint64_t version, std::optional<std::vector<std::string>> keys) {
+        std::lock_guard<std::mutex> lock(m_changesMutex);
+        if (!keys) {
+            m_changes.clear();
+            m_changedKeys = 0;
+            m_changesFloor = version;
+            return;
+        }
+        if (keys->empty()) {
+            return;
+        }
+        m_changedKeys += keys->size();
+        m_changes.push_back(Change{version, std::move(*keys)});
+        while (m_changedKeys > kMaxChangedKeys || m_changes.size() > kMaxChanges) {
+            // 丢掉版本 v 的记录后，只能计算 v 及之后版本的增量
+            m_changesFloor = m_changes.front().version;
+            m_changedKeys -= m_changes.front().keys.size();
+            m_changes.pop_front();
+        }
+    }
+
+    // firstChanged：新快照中第一个与 current 不同的位置，之前的分页缓存沿用；keys：本次改动的 key
+    void publish(std::shared_ptr<Snapshot> next,
+                 const Snapshot& current,
+                 size_t firstChanged,
+                 std::optional<std::vector<std::string>> keys) {
+        next->version = current.version + 1;
+        recordChange(next->version, std::move(keys));
+        next->pageSize = m_pageSize;
+        if (m_pageSize > 0) {
+            next->m_pages.resize(std::max<size_t>(1, (next->size() + m_pageSize - 1) / m_pageSize));
+            if (current.pageSize == m_pageSize) {
+                // 第 i 页可沿用：是否带 nextCursor 不变，且条目都在 firstChanged 之前；
+                // 条目数不变（只有替换）时位置不移动，之后的页逐个比较条目
+                std::lock_guard<std::mutex> lock(current.m_pagesMutex);
+                const size_t reusable = std::min(current.m_pages.size(), next->m_pages.size());
+                const bool sameSize = current.size() == next->size();
+                for (size_t i = 0; i < reusable; ++i) {
+                    const size_t begin = i * m_pageSize;
+                    const size_t end = std::min(begin + m_pageSize, next->size());
+                    if (end > firstChanged && !sameSize) {
+                        break;
+                    }
+                    if ((end < current.size()) != (end < next->size()) ||
+                        (end > firstChanged && !samePositions(current, *next, begin, end))) {
+                        continue;
+                    }
+                    next->m_pages[i] = current.m_pages[i];
+                }
+            }
+        }
+        const uint64_t version = next->version;
+        m_snapshot.store(std::move(next), std::memory_order_release);
+        m_version.store(version, std::memory_order_release);
+    }
+
+    struct Change {
+        uint64_t version;
+        std::vector<std::string> keys;
+    };
+
+    static constexpr size_t kMaxChangedKeys = 4096;
+    static constexpr size_t kMaxChanges = 1024;
+
+    const std::string m_listHead;  // {"<listKey>":[
+    const ItemSerializer m_serializer;
+    const std::string m_epoch;
+
+    // 最近的变更记录；m_changesFloor 之前的版本无法计算增量
+    mutable std::mutex m_changesMutex;
+    std::deque<Change> m_changes;
+    size_t m_changedKeys = 0;
+    uint64_t m_changesFloor = 0;
+
+    std::mutex m_writeMutex;
+    size_t m_pageSize = 0;  // 受 m_writeMutex 保护
+    std::atomic<SnapshotPtr> m_snapshot;
+    // 与快照版本一致，供 Reader 无锁判断是否需要重新取快照
+    std::atomic<uint64_t> m_version{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPREGISTRY_H
@@ -0,0 +1,84 @@
+#include "galay-mcp/common/McpSchedulerExecutor.h"
+#include "galay-kernel/common/Sleep.hpp"
+
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+// 未绑定执行器的线程上检查通知的间隔
+constexpr auto kUnboundPollInterval = std::chrono::milliseconds(1);
+
+// bindRuntime() 枚举 IO 调度器的上限，防止 getNextIOScheduler() 不轮转时无限循环
+constexpr size_t kMaxBoundSchedulers = 1024;
+
+Coroutine ResumeOn(McpExecutor* executor, std::coroutine_handle<> handle) {
+    McpExecutor::bindCurrent(executor);
+    handle.resume();
+    co_return;
+}
+
+Coroutine RunBound(McpExecutor* executor, Coroutine task) {
+    McpExecutor::bindCurrent(executor);
+    co_await std::move(task);
+}
+
+Coroutine BindOnly(McpExecutor* executor) {
+    McpExecutor::bindCurrent(executor);
+    co_return;
+}
+
+} // namespace
+
+McpSchedulerExecutor* McpSchedulerExecutor::of(kernel::Scheduler* scheduler) {
+    static std::mutex mutex;
+    static std::unordered_map<kernel::Scheduler*, McpSchedulerExecutor*> executors;
+    std::lock_guard<std::mutex> lock(mutex);
+    McpSchedulerExecutor*& executor = executors[scheduler];
+    if (!executor) {
+        // 调度器地址可能被任务长期引用，执行器不回收
+        executor = new McpSchedulerExecutor(scheduler);
+    }
+    return executor;
+}
+
+void McpSchedulerExecutor::bindRuntime(kernel::Runtime& runtime) {
+    std::unordered_set<kernel::Scheduler*> seen;
+    for (size_t i = 0; i < kMaxBoundSchedulers; ++i) {
+        kernel::Scheduler* scheduler = runtime.getNextIOScheduler();
+        if (!scheduler || !seen.insert(scheduler).second) {
+            break;
+        }
+        McpSchedulerExecutor* executor = of(scheduler);
+        scheduleTask(scheduler, BindOnly(executor));
+    }
+}
+
+Coroutine McpSchedulerExecutor::wait(std::shared_ptr<McpWakeSignal> signal) {
+    if (McpExecutor::current()) {
+        co_await signal->wait();
+        co_return;
+    }
+    while (!signal->poll()) {
+        co_await kernel::sleep(kUnboundPollInterval);
+    }
+}
+
+void McpSchedulerExecutor::post(std::coroutine_handle<> handle) {
+    if (!scheduleTask(m_scheduler, ResumeOn(this, handle))) {
+        // 调度器已停止：交给后备执行器，避免等待方永远挂起
+        McpExecutor::fallback().post(handle);
+    }
+}
+
+bool McpSchedulerExecutor::spawn(Coroutine task) {
+    return scheduleTask(m_scheduler, RunBound(this, std::move(task)));
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,54 @@
+#ifndef GALAY_MCP_COMMON_MCPSCHEDULEREXECUTOR_H
+#define GALAY_MCP_COMMON_MCPSCHEDULEREXECUTOR_H
+
+#include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpExecutor.h"
+#include "galay-mcp/common/McpWakeSignal.h"
+#include "galay-kernel/kernel/Runtime.h"
+
+#include <memory>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 绑定到一个 kernel 调度器的执行器：post() 向该调度器投递一个恢复协程的任务
+ *
+ * 每个调度器对应唯一的执行器（of()），随进程存在。通过 spawn() 投递的任务运行前把所在线程
+ * 绑定到该执行器，任务里 co_await McpWakeSignal 挂起后由事件方投递回同一个调度器恢复。
+ */
+class McpSchedulerExecutor : public McpExecutor {
+public:
+    // scheduler 对应的执行器
+    static McpSchedulerExecutor* of(kernel::Scheduler* scheduler);
+
+    // 在 runtime 的每个 IO 调度器线程上绑定对应的执行器，使调用方自己投递的协程也能按调度器恢复
+    static void bindRuntime(kernel::Runtime& runtime);
+
+    /**
+     * @brief 协程等待 signal 的下一次通知
+     *
+     * 当前线程绑定了执行器时挂起，由事件方投递回本调度器恢复；
+     * 未绑定的线程（例如 galay-http 内部创建的 IO 调度器）上按固定间隔检查通知，仍在本调度器上继续。
+     */
+    static Coroutine wait(std::shared_ptr<McpWakeSignal> signal);
+
+    kernel::Scheduler* scheduler() const { return m_scheduler; }
+
+    void post(std::coroutine_handle<> handle) override;
+
+    // 投递 task，运行前绑定所在线程；调度器不接受时返回 false
+    bool spawn(Coroutine task);
+
+private:
+    explicit McpSchedulerExecutor(kernel::Scheduler* scheduler)
+        : m_scheduler(scheduler) {
+    }
+
+    kernel::Scheduler* m_scheduler;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPSCHEDULEREXECUTOR_H
@@ -0,0 +1,407 @@
+#include "galay-mcp/common/McpShmChannel.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <climits>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+constexpr uint32_t kShmMagic = 0x4d435052; // "MCPR"
+constexpr uint32_t kShmVersion = 1;
+constexpr size_t kMinCapacity = 4096;
+constexpr size_t kLengthPrefixSize = 4;
+constexpr auto kWaitTimeout = std::chrono::milliseconds(100);
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+// 单条环的控制块；生产者与消费者各自写的字段分处不同 cache line
+struct RingHeader {
+    alignas(64) std::atomic<uint64_t> head;          // 生产者已发布的位置
+    alignas(64) std::atomic<uint64_t> tail;          // 消费者已释放的位置
+    alignas(64) std::atomic<uint32_t> dataSeq;       // 数据到达时递增（futex 字）
+    std::atomic<uint32_t> readerWaiting;
+    alignas(64) std::atomic<uint32_t> spaceSeq;      // 空间释放时递增（futex 字）
+    std::atomic<uint32_t> writerWaiting;
+    alignas(64) std::atomic<uint32_t> closed;
+};
+
+struct SegmentHeader {
+    alignas(64) std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t capacity;
+    RingHeader rings[2]; // [0] client→server, [1] server→client
+};
+
+size_t RoundUpPow2(size_t value) {
+    size_t result = kMinCapacity;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+// 单核机器上自旋只会耗尽对端本该使用的时间片，直接进入 futex 等待
+uint32_t EffectiveSpin(uint32_t requested) {
+    static const bool multiCore = std::thread::hardware_concurrency() > 1;
+    return multiCore ? requested : 0;
+}
+
+size_t SegmentSize(size_t capacity) {
+    return sizeof(SegmentHeader) + capacity * 2;
+}
+
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+void FutexWait(std::atomic<uint32_t>* word, uint32_t expected) {
+#if defined(__linux__)
+    struct timespec ts;
+    ts.tv_sec = 0;
+    ts.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(kWaitTimeout).count();
+    // 共享内存跨进程唤醒，不能使用 FUTEX_PRIVATE_FLAG
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAIT, expected, &ts, nullptr, 0);
+#else
+    if (word->load(std::memory_order_acquire) == expected) {
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+#endif
+}
+
+void FutexWake(std::atomic<uint32_t>* word) {
+#if defined(__linux__)
+    ::syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+std::string ErrnoMessage(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+struct McpShmChannel::Ring {
+    RingHeader* header;
+    char* data;
+    size_t capacity;
+    size_t mask;
+    uint32_t spinIterations;
+
+    bool closed() const {
+        return header->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    // 自旋后在 seq 上等待，直到 ready() 为真或通道关闭
+    template <typename Ready>
+    bool waitUntil(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting, Ready&& ready) {
+        for (uint32_t i = 0; i < spinIterations; ++i) {
+            if (ready()) {
+                return true;
+            }
+            CpuRelax();
+        }
+
+        while (true) {
+            waiting.store(1, std::memory_order_seq_cst);
+            const uint32_t observed = seq.load(std::memory_order_seq_cst);
+            if (ready()) {
+                waiting.store(0, std::memory_order_relaxed);
+                return true;
+            }
+            if (closed()) {
+                waiting.store(0, std::memory_order_relaxed);
+                return ready();
+            }
+            FutexWait(&seq, observed);
+            waiting.store(0, std::memory_order_relaxed);
+            if (ready()) {
+                return true;
+            }
+        }
+    }
+
+    // 仅在对端处于等待状态时才付出一次 futex 唤醒
+    static void notify(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_seq_cst) != 0) {
+            seq.fetch_add(1, std::memory_order_seq_cst);
+            FutexWake(&seq);
+        }
+    }
+
+    void markClosed() {
+        header->closed.store(1, std::memory_order_release);
+        header->dataSeq.fetch_add(1, std::memory_order_seq_cst);
+        header->spaceSeq.fetch_add(1, std::memory_order_seq_cst);
+        FutexWake(&header->dataSeq);
+        FutexWake(&header->spaceSeq);
+    }
+
+    // 依次写入 parts，空间足够时只发布一次 head
+    bool write(const std::string_view* parts, size_t count) {
+        size_t partIndex = 0;
+        size_t partOffset = 0;
+
+        while (partIndex < count) {
+            if (closed()) {
+                return false;
+            }
+
+            uint64_t head = header->head.load(std::memory_order_relaxed);
+            uint64_t tail = header->tail.load(std::memory_order_acquire);
+            size_t freeBytes = capacity - static_cast<size_t>(head - tail);
+            if (freeBytes == 0) {
+                bool ok = waitUntil(header->spaceSeq, header->writerWaiting, [&]() {
+                    return header->tail.load(std::memory_order_acquire) != tail || closed();
+                });
+                if (!ok || closed()) {
+                    return false;
+                }
+                continue;
+            }
+
+            while (freeBytes > 0 && partIndex < count) {
+                const std::string_view part = parts[partIndex];
+                const size_t n = std::min(freeBytes, part.size() - partOffset);
+                copyIn(head, part.data() + partOffset, n);
+                head += n;
+                freeBytes -= n;
+                partOffset += n;
+                if (partOffset == part.size()) {
+                    ++partIndex;
+                    partOffset = 0;
+                }
+            }
+
+            header->head.store(head, std::memory_order_release);
+            notify(header->dataSeq, header->readerWaiting);
+        }
+        return true;
+    }
+
+    // 读取恰好 size 个字节；通道关闭且数据读空时返回 false
+    bool read(char* out, size_t size) {
+        size_t done = 0;
+        while (done < size) {
+            uint64_t tail = header->tail.load(std::memory_order_relaxed);
+            uint64_t head = header->head.load(std::memory_order_acquire);
+            size_t available = static_cast<size_t>(head - tail);
+            if (available == 0) {
+                bool ok = waitUntil(header->dataSeq, header->readerWaiting, [&]() {
+                    return header->head.load(std::memory_order_acquire) != tail;
+                });
+                if (!ok) {
+                    return false;
+                }
+                continue;
+            }
+
+            const size_t n = std::min(available, size - done);
+            copyOut(tail, out + done, n);
+            done += n;
+            header->tail.store(tail + n, std::memory_order_release);
+            notify(header->spaceSeq, header->writerWaiting);
+        }
+        return true;
+    }
+
+    void copyIn(uint64_t position, const char* src, size_t size) {
+        const size_t offset = static_cast<size_t>(position) & mask;
+        const size_t first = std::min(size, capacity - offset);
+        std::memcpy(data + offset, src, first);
+        if (first < size) {
+            std::memcpy(data, src + first, size - first);
+        }
+    }
+
+    void copyOut(uint64_t position, char* dst, size_t size) const {
+        const size_t offset = static_cast<size_t>(position) & mask;
+        const size_t first = std::min(size, capacity - offset);
+        std::memcpy(dst, data + offset, first);
+        if (first < size) {
+            std::memcpy(dst + first, data, size - first);
+        }
+    }
+};
+
+McpShmChannel::McpShmChannel(std::string name, bool owner, McpShmChannelOptions options)
+    : m_name(std::move(name))
+    , m_owner(owner)
+    , m_options(options) {
+}
+
+McpShmChannel::~McpShmChannel() {
+    close();
+    if (m_base != nullptr) {
+        ::munmap(m_base, m_mappedSize);
+        m_base = nullptr;
+    }
+    if (m_owner) {
+        ::shm_unlink(m_name.c_str());
+    }
+}
+
+std::expected<std::unique_ptr<McpShmChannel>, McpError>
+McpShmChannel::create(const std::string& name, McpShmChannelOptions options) {
+    const size_t capacity = RoundUpPow2(options.capacity);
+    const size_t size = SegmentSize(capacity);
+
+    ::shm_unlink(name.c_str());
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("shm_open")));
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        std::string message = ErrnoMessage("ftruncate");
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return std::unexpected(McpError::connectionFailed(message));
+    }
+
+    std::unique_ptr<McpShmChannel> channel(new McpShmChannel(name, true, options));
+    auto mapped = channel->map(fd, size);
+    ::close(fd);
+    if (!mapped) {
+        return std::unexpected(mapped.error());
+    }
+
+    // ftruncate 保证新段全零，原子字段的初始值即为 0；magic 最后发布
+    auto* segment = static_cast<SegmentHeader*>(channel->m_base);
+    segment->version = kShmVersion;
+    segment->capacity = capacity;
+    segment->magic.store(kShmMagic, std::memory_order_release);
+
+    channel->m_capacity = capacity;
+    char* data = static_cast<char*>(channel->m_base) + sizeof(SegmentHeader);
+    channel->m_readRing = std::make_unique<Ring>(
+        Ring{&segment->rings[0], data, capacity, capacity - 1, EffectiveSpin(options.spinIterations)});
+    channel->m_writeRing = std::make_unique<Ring>(
+        Ring{&segment->rings[1], data + capacity, capacity, capacity - 1, EffectiveSpin(options.spinIterations)});
+    return channel;
+}
+
+std::expected<std::unique_ptr<McpShmChannel>, McpError>
+McpShmChannel::open(const std::string& name, McpShmChannelOptions options) {
+    int fd = ::shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("shm_open")));
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)) {
+        ::close(fd);
+        return std::unexpected(McpError::connectionFailed("Shared memory segment not ready"));
+    }
+
+    std::unique_ptr<McpShmChannel> channel(new McpShmChannel(name, false, options));
+    auto mapped = channel->map(fd, static_cast<size_t>(st.st_size));
+    ::close(fd);
+    if (!mapped) {
+        return std::unexpected(mapped.error());
+    }
+
+    auto* segment = static_cast<SegmentHeader*>(channel->m_base);
+    if (segment->magic.load(std::memory_order_acquire) != kShmMagic ||
+        segment->version != kShmVersion ||
+        SegmentSize(segment->capacity) > static_cast<size_t>(st.st_size)) {
+        return std::unexpected(McpError::connectionFailed("Shared memory segment not ready"));
+    }
+
+    const size_t capacity = segment->capacity;
+    channel->m_capacity = capacity;
+    char* data = static_cast<char*>(channel->m_base) + sizeof(SegmentHeader);
+    channel->m_readRing = std::make_unique<Ring>(
+        Ring{&segment->rings[1], data + capacity, capacity, capacity - 1, EffectiveSpin(options.spinIterations)});
+    channel->m_writeRing = std::make_unique<Ring>(
+        Ring{&segment->rings[0], data, capacity, capacity - 1, EffectiveSpin(options.spinIterations)});
+    return channel;
+}
+
+std::expected<std::string, McpError> McpShmChannel::readMessage() {
+    std::lock_guard<std::mutex> lock(m_readMutex);
+
+    while (true) {
+        unsigned char prefix[kLengthPrefixSize];
+        if (!m_readRing->read(reinterpret_cast<char*>(prefix), sizeof(prefix))) {
+            return std::unexpected(McpError::connectionClosed("Shared memory peer closed"));
+        }
+        const uint32_t length = static_cast<uint32_t>(prefix[0]) |
+                                (static_cast<uint32_t>(prefix[1]) << 8) |
+                                (static_cast<uint32_t>(prefix[2]) << 16) |
+                                (static_cast<uint32_t>(prefix[3]) << 24);
+        if (length == 0) {
+            continue;
+        }
+
+        std::string message;
+        message.resize(length);
+        if (!m_readRing->read(message.data(), length)) {
+            return std::unexpected(McpError::connectionClosed("Shared memory peer closed"));
+        }
+        return message;
+    }
+}
+
+std::expected<void, McpError> McpShmChannel::writeMessage(std::string_view message) {
+    if (message.size() > UINT32_MAX) {
+        return std::unexpected(McpError::writeError("Message too large"));
+    }
+
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+
+    const uint32_t length = static_cast<uint32_t>(message.size());
+    const char prefix[kLengthPrefixSize] = {
+        static_cast<char>(length & 0xff),
+        static_cast<char>((length >> 8) & 0xff),
+        static_cast<char>((length >> 16) & 0xff),
+        static_cast<char>((length >> 24) & 0xff),
+    };
+    const std::string_view parts[2] = {std::string_view(prefix, sizeof(prefix)), message};
+    if (!m_writeRing->write(parts, 2)) {
+        return std::unexpected(McpError::connectionClosed("Shared memory peer closed"));
+    }
+    return {};
+}
+
+void McpShmChannel::close() {
+    if (m_readRing) {
+        m_readRing->markClosed();
+    }
+    if (m_writeRing) {
+        m_writeRing->markClosed();
+    }
+}
+
+std::expected<void, McpError> McpShmChannel::map(int fd, size_t size) {
+    void* base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("mmap")));
+    }
+    m_base = base;
+    m_mappedSize = size;
+    return {};
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,90 @@
+#ifndef GALAY_MCP_COMMON_MCPSHMCHANNEL_H
+#define GALAY_MCP_COMMON_MCPSHMCHANNEL_H
+
+#include "galay-mcp/common/McpMessageChannel.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 共享内存通道配置
+ */
+struct McpShmChannelOptions {
+    // 每个方向环形缓冲区的字节数（向上取整为2的幂，最小 4KiB）
+    size_t capacity = 1024 * 1024;
+    // 进入 futex 等待前的自旋次数；对端繁忙时自旋可省掉一次系统调用（单核机器上忽略）
+    uint32_t spinIterations = 4000;
+};
+
+/**
+ * @brief 基于 POSIX 共享内存的同机 MCP 消息通道
+ *
+ * 一个共享内存段内包含两条无锁 SPSC 字节环（client→server、server→client），
+ * 每条消息以 4 字节小端长度前缀加 JSON-RPC 文本的方式写入，超过环容量的消息会分段流式传递。
+ * 读写方都先自旋等待，只有对端空闲（进入等待状态）时才通过 futex 唤醒，
+ * 热路径上一次往返不需要任何系统调用。非 Linux 平台退化为短睡眠轮询。
+ *
+ * 服务端通过 create() 创建段并交给 McpStdioServer::setChannel()，
+ * 客户端通过 open() 打开同名段并交给 McpStdioClient::attach()。
+ */
+class McpShmChannel : public McpMessageChannel {
+public:
+    /**
+     * @brief 创建共享内存段（服务端）
+     * @param name 段名称，例如 "/galay-mcp-demo"
+     * @return 成功返回通道；shm_open/mmap 失败返回 ConnectionFailed
+     * @note 同名旧段会先被 unlink；通道析构时自动 unlink
+     */
+    static std::expected<std::unique_ptr<McpShmChannel>, McpError>
+    create(const std::string& name, McpShmChannelOptions options = {});
+
+    /**
+     * @brief 打开已有的共享内存段（客户端）
+     * @return 段不存在或尚未初始化完成时返回 ConnectionFailed，调用方可稍后重试
+     */
+    static std::expected<std::unique_ptr<McpShmChannel>, McpError>
+    open(const std::string& name, McpShmChannelOptions options = {});
+
+    ~McpShmChannel() override;
+
+    McpShmChannel(const McpShmChannel&) = delete;
+    McpShmChannel& operator=(const McpShmChannel&) = delete;
+
+    std::expected<std::string, McpError> readMessage() override;
+    std::expected<void, McpError> writeMessage(std::string_view message) override;
+
+    /**
+     * @brief 标记两条环已关闭并唤醒对端；对端读空后返回 ConnectionClosed
+     */
+    void close();
+
+    size_t capacity() const { return m_capacity; }
+
+private:
+    struct Ring;
+
+    McpShmChannel(std::string name, bool owner, McpShmChannelOptions options);
+
+    std::expected<void, McpError> map(int fd, size_t size);
+
+    std::string m_name;
+    bool m_owner;
+    McpShmChannelOptions m_options;
+    void* m_base{nullptr};
+    size_t m_mappedSize{0};
+    size_t m_capacity{0};
+    std::unique_ptr<Ring> m_readRing;
+    std::unique_ptr<Ring> m_writeRing;
+    std::mutex m_readMutex;
+    std::mutex m_writeMutex;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPSHMCHANNEL_H
@@ -0,0 +1,147 @@
+#include "galay-mcp/common/McpSse.h"
+#include <algorithm>
+#include <charconv>
+
+namespace galay {
+namespace mcp {
+
+namespace sse {
+
+bool isEventStream(std::string_view headerValue) {
+    return headerValue.find(CONTENT_TYPE) != std::string_view::npos;
+}
+
+void appendEvent(std::string& out, const JsonString& message, std::string_view id) {
+    if (!id.empty()) {
+        out += "id: ";
+        out += id;
+        out += '\n';
+    }
+    // JSON 序列化结果不含换行，整条消息放在一行 data 中
+    out += "event: message\ndata: ";
+    out += message;
+    out += "\n\n";
+}
+
+void appendChunk(std::string& out, std::string_view payload) {
+    if (payload.empty()) {
+        return;
+    }
+    char sizeHex[16];
+    auto [end, ec] = std::to_chars(sizeHex, sizeHex + sizeof(sizeHex), payload.size(), 16);
+    (void)ec;
+    out.append(sizeHex, end);
+    out += "\r\n";
+    out += payload;
+    out += "\r\n";
+}
+
+std::optional<uint64_t> parseEventId(std::string_view value) {
+    uint64_t id = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), id);
+    if (value.empty() || ec != std::errc() || ptr != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return id;
+}
+
+} // namespace sse
+
+void McpSseParser::feed(std::string_view bytes, std::vector<McpSseEvent>& events) {
+    size_t start = 0;
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        if (bytes[i] != '\n') {
+            continue;
+        }
+        std::string_view line = bytes.substr(start, i - start);
+        if (!m_line.empty()) {
+            m_line.append(line);
+            line = m_line;
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        processLine(line, events);
+        m_line.clear();
+        start = i + 1;
+    }
+    m_line.append(bytes.substr(start));
+}
+
+void McpSseParser::processLine(std::string_view line, std::vector<McpSseEvent>& events) {
+    if (line.empty()) {
+        if (m_hasData) {
+            events.push_back(std::move(m_event));
+        }
+        m_event = McpSseEvent();
+        m_hasData = false;
+        return;
+    }
+    if (line.front() == ':') {
+        return;
+    }
+
+    const size_t colon = line.find(':');
+    std::string_view field = line.substr(0, colon);
+    std::string_view value;
+    if (colon != std::string_view::npos) {
+        value = line.substr(colon + 1);
+        if (!value.empty() && value.front() == ' ') {
+            value.remove_prefix(1);
+        }
+    }
+
+    if (field == "data") {
+        if (m_hasData) {
+            m_event.data += '\n';
+        }
+        m_event.data.append(value);
+        m_hasData = true;
+    } else if (field == "id") {
+        m_event.id.assign(value);
+    } else if (field == "event") {
+        m_event.event.assign(value);
+    } else if (field == "retry") {
+        if (auto retry = sse::parseEventId(value)) {
+            m_retry = retry;
+        }
+    }
+}
+
+McpEventReplayBuffer::McpEventReplayBuffer(size_t capacity)
+    : m_capacity(std::max<size_t>(capacity, 1)) {
+}
+
+uint64_t McpEventReplayBuffer::append(JsonString message) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t id = m_nextId++;
+    if (m_events.size() >= m_capacity) {
+        m_events.pop_front();
+    }
+    m_events.push_back(McpReplayedEvent{id, std::move(message)});
+    return id;
+}
+
+std::vector<McpReplayedEvent> McpEventReplayBuffer::since(uint64_t lastEventId, bool* gap) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<McpReplayedEvent> events;
+    if (gap) {
+        *gap = !m_events.empty() && m_events.front().id > lastEventId + 1;
+    }
+    if (m_events.empty() || m_events.back().id <= lastEventId) {
+        return events;
+    }
+    // id 连续递增，直接定位到第一条未发送的事件
+    const uint64_t firstId = m_events.front().id;
+    const size_t skip = lastEventId >= firstId ? static_cast<size_t>(lastEventId - firstId + 1) : 0;
+    events.assign(m_events.begin() + static_cast<std::ptrdiff_t>(skip), m_events.end());
+    return events;
+}
+
+uint64_t McpEventReplayBuffer::lastEventId() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nextId - 1;
+}
+
+} // namespace mcp
+} // namespace galay
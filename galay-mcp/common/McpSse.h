@@ -0,0 +1,120 @@
+#ifndef GALAY_MCP_COMMON_MCPSSE_H
+#define GALAY_MCP_COMMON_MCPSSE_H
+
+#include "galay-mcp/common/McpJson.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 一个 Server-Sent Events 事件
+ */
+struct McpSseEvent {
+    std::string id;      // id 字段；未给出时为空
+    std::string event;   // event 字段；未给出时为空（等同 "message"）
+    std::string data;    // 多行 data 以 '\n' 连接
+};
+
+namespace sse {
+
+inline constexpr std::string_view CONTENT_TYPE = "text/event-stream";
+
+// chunked 正文的结束块
+inline constexpr std::string_view LAST_CHUNK = "0\r\n\r\n";
+
+/**
+ * @brief 判断 Accept / Content-Type 头部是否包含 text/event-stream
+ */
+bool isEventStream(std::string_view headerValue);
+
+/**
+ * @brief 把一条 JSON-RPC 消息编码为 message 事件，id 非空时写入 id 字段
+ */
+void appendEvent(std::string& out, const JsonString& message, std::string_view id = {});
+
+/**
+ * @brief 把 payload 作为一个 HTTP/1.1 chunk 追加到 out
+ */
+void appendChunk(std::string& out, std::string_view payload);
+
+/**
+ * @brief 解析 Last-Event-ID（十进制序号）
+ */
+std::optional<uint64_t> parseEventId(std::string_view value);
+
+} // namespace sse
+
+/**
+ * @brief 增量 SSE 解析器
+ *
+ * 按任意边界喂入字节，支持 LF / CRLF 行尾、注释行与多行 data；
+ * 一个事件在空行处结束，data 为空的事件被忽略。
+ */
+class McpSseParser {
+public:
+    // 喂入 bytes，把已完整的事件追加到 events
+    void feed(std::string_view bytes, std::vector<McpSseEvent>& events);
+
+    // 最近一次 retry 字段给出的重连间隔（毫秒）
+    std::optional<uint64_t> retry() const { return m_retry; }
+
+private:
+    void processLine(std::string_view line, std::vector<McpSseEvent>& events);
+
+    std::string m_line;
+    McpSseEvent m_event;
+    bool m_hasData = false;
+    std::optional<uint64_t> m_retry;
+};
+
+/**
+ * @brief 回放缓冲中的一条事件
+ */
+struct McpReplayedEvent {
+    uint64_t id = 0;
+    JsonString message;
+};
+
+/**
+ * @brief 有界事件回放缓冲（线程安全）
+ *
+ * 每条消息分配单调递增的序号作为 SSE 事件 id；超过 capacity 时淘汰最旧的事件。
+ * 断线重连的客户端按 Last-Event-ID 取回其后仍在缓冲中的事件。
+ */
+class McpEventReplayBuffer {
+public:
+    explicit McpEventReplayBuffer(size_t capacity);
+
+    // 追加一条消息，返回分配的事件 id（从 1 开始）
+    uint64_t append(JsonString message);
+
+    /**
+     * @brief 取出 id 大于 lastEventId 的事件
+     * @param gap 非空时写入是否有事件已被淘汰、无法完整回放
+     */
+    std::vector<McpReplayedEvent> since(uint64_t lastEventId, bool* gap = nullptr) const;
+
+    // 最近分配的事件 id；尚无事件时为 0
+    uint64_t lastEventId() const;
+
+    size_t capacity() const { return m_capacity; }
+
+private:
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::deque<McpReplayedEvent> m_events;
+    uint64_t m_nextId = 1;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPSSE_H
@@ -0,0 +1,108 @@
+#include "galay-mcp/common/McpStdioFraming.h"
+#include <charconv>
+#include <istream>
+#include <ostream>
+
+namespace galay {
+namespace mcp {
+namespace framing {
+
+namespace {
+
+constexpr std::string_view kHeaderName = "content-length:";
+
+bool StartsWithIgnoreCase(std::string_view value, std::string_view prefix) {
+    if (value.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        char c = value[i];
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (c != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::optional<size_t> parseContentLength(std::string_view headerLine) {
+    if (!StartsWithIgnoreCase(headerLine, kHeaderName)) {
+        return std::nullopt;
+    }
+
+    std::string_view value = headerLine.substr(kHeaderName.size());
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) {
+        value.remove_suffix(1);
+    }
+
+    size_t length = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), length);
+    if (ec != std::errc() || ptr != value.data() + value.size() || value.empty()) {
+        return std::nullopt;
+    }
+    return length;
+}
+
+std::string makeContentLengthHeader(size_t length) {
+    std::string header = "Content-Length: ";
+    header += std::to_string(length);
+    header += "\r\n\r\n";
+    return header;
+}
+
+std::expected<std::string, McpError> readFrame(std::istream& input) {
+    std::string line;
+    if (!std::getline(input, line)) {
+        return std::unexpected(McpError::readError("Failed to read from stdin"));
+    }
+
+    auto length = parseContentLength(line);
+    if (!length) {
+        return line;
+    }
+
+    // 跳过其余头部直到空行
+    while (true) {
+        if (!std::getline(input, line)) {
+            return std::unexpected(McpError::readError("Unexpected end of stream in frame header"));
+        }
+        if (line.empty() || line == "\r") {
+            break;
+        }
+    }
+
+    std::string body(length.value(), '\0');
+    if (!input.read(body.data(), static_cast<std::streamsize>(body.size()))) {
+        return std::unexpected(McpError::readError("Unexpected end of stream in frame body"));
+    }
+    return body;
+}
+
+std::expected<void, McpError> writeFrame(std::ostream& output,
+                                         std::string_view message,
+                                         McpStdioFraming mode) {
+    try {
+        if (mode == McpStdioFraming::ContentLength) {
+            output << makeContentLengthHeader(message.size());
+            output.write(message.data(), static_cast<std::streamsize>(message.size()));
+        } else {
+            output.write(message.data(), static_cast<std::streamsize>(message.size()));
+            output.put('\n');
+        }
+        output.flush();
+        return {};
+    } catch (const std::exception& e) {
+        return std::unexpected(McpError::writeError(e.what()));
+    }
+}
+
+} // namespace framing
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,59 @@
+#ifndef GALAY_MCP_COMMON_MCPSTDIOFRAMING_H
+#define GALAY_MCP_COMMON_MCPSTDIOFRAMING_H
+
+#include "galay-mcp/common/McpError.h"
+#include <cstddef>
+#include <expected>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief stdio 字节流上的消息分帧方式
+ */
+enum class McpStdioFraming {
+    Newline,        // 每条 JSON-RPC 消息占一行（MCP 标准 stdio 传输）
+    ContentLength   // LSP 风格 "Content-Length: N\r\n\r\n" 头部 + N 字节正文
+};
+
+namespace framing {
+
+// initialize 协商时 capabilities.experimental.galay.framing 的取值
+inline constexpr std::string_view CONTENT_LENGTH = "content-length";
+
+/**
+ * @brief 解析 "Content-Length: N" 头部行（名称不区分大小写，允许行尾 '\r'）
+ * @return 不是 Content-Length 头部时返回 std::nullopt
+ */
+std::optional<size_t> parseContentLength(std::string_view headerLine);
+
+/**
+ * @brief 构造 Content-Length 分帧的头部 "Content-Length: N\r\n\r\n"
+ */
+std::string makeContentLengthHeader(size_t length);
+
+/**
+ * @brief 从输入流读取一条消息，按首行自动识别分帧方式
+ *
+ * 首行是 Content-Length 头部时跳过其余头部，按长度一次性读取正文；
+ * 否则把该行（可能为空）作为换行分帧的消息返回。
+ */
+std::expected<std::string, McpError> readFrame(std::istream& input);
+
+/**
+ * @brief 按指定分帧方式把一条消息写入输出流并刷新
+ */
+std::expected<void, McpError> writeFrame(std::ostream& output,
+                                         std::string_view message,
+                                         McpStdioFraming mode);
+
+} // namespace framing
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPSTDIOFRAMING_H
@@ -0,0 +1,27 @@
+#ifndef GALAY_MCP_COMMON_MCPTOOLCONTEXT_H
+#define GALAY_MCP_COMMON_MCPTOOLCONTEXT_H
+
+#include "galay-mcp/common/McpCancellation.h"
+#include "galay-mcp/common/McpProgress.h"
+#include <cstdint>
+#include <optional>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 服务端传给工具处理函数的单次调用上下文
+ */
+struct McpToolContext {
+    // 请求 id；进程内调用没有 id
+    std::optional<int64_t> requestId;
+    // notifications/cancelled、客户端超时或连接关闭时触发
+    McpCancellationToken cancellation;
+    // 请求带 _meta.progressToken 时可用，report() 发出 notifications/progress
+    McpProgressReporter progress;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPTOOLCONTEXT_H
@@ -0,0 +1,508 @@
+#include "galay-mcp/common/McpUnixSocket.h"
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+constexpr size_t kReadChunkSize = 64 * 1024;
+constexpr size_t kMaxHeaderSize = 64 * 1024;
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+std::string ErrnoMessage(const char* what) {
+    return std::string(what) + ": " + std::strerror(errno);
+}
+
+std::string_view Trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+    }
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) {
+        value.remove_suffix(1);
+    }
+    return value;
+}
+
+bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        char a = lhs[i];
+        char b = rhs[i];
+        if (a >= 'A' && a <= 'Z') a = static_cast<char>(a - 'A' + 'a');
+        if (b >= 'A' && b <= 'Z') b = static_cast<char>(b - 'A' + 'a');
+        if (a != b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ContainsIgnoreCase(std::string_view haystack, std::string_view needle) {
+    if (needle.size() > haystack.size()) {
+        return false;
+    }
+    for (size_t i = 0; i + needle.size() <= haystack.size(); ++i) {
+        if (EqualsIgnoreCase(haystack.substr(i, needle.size()), needle)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::expected<sockaddr_un, McpError> MakeAddress(const std::string& path) {
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return std::unexpected(McpError::connectionFailed("Invalid unix socket path: " + path));
+    }
+    std::memcpy(addr.sun_path, path.data(), path.size());
+    return addr;
+}
+
+int OpenStreamSocket() {
+#if defined(SOCK_CLOEXEC)
+    return ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
+    return ::socket(AF_UNIX, SOCK_STREAM, 0);
+#endif
+}
+
+} // namespace
+
+bool McpUnixSocket::isUnixAddress(std::string_view address) {
+    return address.starts_with(kAddressPrefix);
+}
+
+std::string McpUnixSocket::socketPath(std::string_view address) {
+    if (isUnixAddress(address)) {
+        address.remove_prefix(kAddressPrefix.size());
+    }
+    return std::string(address);
+}
+
+std::string_view McpUnixHttpMessage::header(std::string_view name) const {
+    for (const auto& [key, value] : headers) {
+        if (EqualsIgnoreCase(key, name)) {
+            return value;
+        }
+    }
+    return {};
+}
+
+std::expected<McpUnixSocket, McpError> McpUnixSocket::listen(const std::string& path, int backlog) {
+    auto addr = MakeAddress(path);
+    if (!addr) {
+        return std::unexpected(addr.error());
+    }
+
+    McpUnixSocket socket(OpenStreamSocket());
+    if (!socket.isOpen()) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("socket")));
+    }
+
+    ::unlink(path.c_str());
+    if (::bind(socket.m_fd, reinterpret_cast<const sockaddr*>(&addr.value()), sizeof(sockaddr_un)) != 0) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("bind")));
+    }
+    socket.m_unlinkPath = path;
+    if (::listen(socket.m_fd, backlog) != 0) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("listen")));
+    }
+    return socket;
+}
+
+std::expected<McpUnixSocket, McpError> McpUnixSocket::connectTcp(const std::string& host, int port) {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    const std::string service = std::to_string(port);
+    const int rc = ::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+    if (rc != 0) {
+        return std::unexpected(McpError::connectionFailed(std::string("getaddrinfo: ") + ::gai_strerror(rc)));
+    }
+
+    std::string lastError = "connect: no address";
+    for (addrinfo* address = addresses; address; address = address->ai_next) {
+#if defined(SOCK_CLOEXEC)
+        McpUnixSocket socket(::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC, address->ai_protocol));
+#else
+        McpUnixSocket socket(::socket(address->ai_family, address->ai_socktype, address->ai_protocol));
+#endif
+        if (!socket.isOpen()) {
+            lastError = ErrnoMessage("socket");
+            continue;
+        }
+        int connected;
+        do {
+            connected = ::connect(socket.m_fd, address->ai_addr, address->ai_addrlen);
+        } while (connected != 0 && errno == EINTR);
+        if (connected == 0) {
+            ::freeaddrinfo(addresses);
+            return socket;
+        }
+        lastError = ErrnoMessage("connect");
+    }
+    ::freeaddrinfo(addresses);
+    return std::unexpected(McpError::connectionFailed(lastError));
+}
+
+std::expected<McpUnixSocket, McpError> McpUnixSocket::connect(const std::string& path) {
+    auto addr = MakeAddress(path);
+    if (!addr) {
+        return std::unexpected(addr.error());
+    }
+
+    McpUnixSocket socket(OpenStreamSocket());
+    if (!socket.isOpen()) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("socket")));
+    }
+
+    int rc;
+    do {
+        rc = ::connect(socket.m_fd, reinterpret_cast<const sockaddr*>(&addr.value()), sizeof(sockaddr_un));
+    } while (rc != 0 && errno == EINTR);
+    if (rc != 0) {
+        return std::unexpected(McpError::connectionFailed(ErrnoMessage("connect")));
+    }
+    return socket;
+}
+
+McpUnixSocket::~McpUnixSocket() {
+    close();
+}
+
+McpUnixSocket::McpUnixSocket(McpUnixSocket&& other) noexcept
+    : m_fd(other.m_fd)
+    , m_buffer(std::move(other.m_buffer))
+    , m_offset(other.m_offset)
+    , m_unlinkPath(std::move(other.m_unlinkPath)) {
+    other.m_fd = -1;
+    other.m_offset = 0;
+    other.m_unlinkPath.clear();
+}
+
+McpUnixSocket& McpUnixSocket::operator=(McpUnixSocket&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_fd = other.m_fd;
+        m_buffer = std::move(other.m_buffer);
+        m_offset = other.m_offset;
+        m_unlinkPath = std::move(other.m_unlinkPath);
+        other.m_fd = -1;
+        other.m_offset = 0;
+        other.m_unlinkPath.clear();
+    }
+    return *this;
+}
+
+std::expected<McpUnixSocket, McpError> McpUnixSocket::accept() {
+    while (true) {
+#if defined(__linux__)
+        int fd = ::accept4(m_fd, nullptr, nullptr, SOCK_CLOEXEC);
+#else
+        int fd = ::accept(m_fd, nullptr, nullptr);
+#endif
+        if (fd >= 0) {
+            return McpUnixSocket(fd);
+        }
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+        if (errno == EINVAL || errno == EBADF) {
+            return std::unexpected(McpError::connectionClosed("Listener shut down"));
+        }
+        return std::unexpected(McpError::connectionError(ErrnoMessage("accept")));
+    }
+}
+
+std::expected<bool, McpError> McpUnixSocket::fill() {
+    if (m_offset > 0 && m_offset >= m_buffer.size() / 2) {
+        m_buffer.erase(0, m_offset);
+        m_offset = 0;
+    }
+
+    const size_t oldSize = m_buffer.size();
+    m_buffer.resize(oldSize + kReadChunkSize);
+    while (true) {
+        ssize_t n = ::recv(m_fd, m_buffer.data() + oldSize, kReadChunkSize, 0);
+        if (n > 0) {
+            m_buffer.resize(oldSize + static_cast<size_t>(n));
+            return true;
+        }
+        m_buffer.resize(oldSize);
+        if (n == 0) {
+            return false;
+        }
+        if (errno == EINTR) {
+            m_buffer.resize(oldSize + kReadChunkSize);
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return std::unexpected(McpError::timeout("recv"));
+        }
+        return std::unexpected(McpError::readError(ErrnoMessage("recv")));
+    }
+}
+
+std::expected<McpUnixHttpMessage, McpError> McpUnixSocket::readHttpMessage() {
+    auto message = readHttpHead();
+    if (!message) {
+        return std::unexpected(message.error());
+    }
+
+    if (message.value().chunked) {
+        while (true) {
+            auto chunk = readChunk();
+            if (!chunk) {
+                return std::unexpected(chunk.error());
+            }
+            if (chunk.value().empty()) {
+                break;
+            }
+            message.value().body += chunk.value();
+        }
+        return message;
+    }
+
+    const size_t contentLength = message.value().contentLength;
+    while (m_buffer.size() - m_offset < contentLength) {
+        auto filled = fill();
+        if (!filled) {
+            return std::unexpected(filled.error());
+        }
+        if (!filled.value()) {
+            return std::unexpected(McpError::connectionClosed("Truncated HTTP body"));
+        }
+    }
+
+    message.value().body.assign(m_buffer.data() + m_offset, contentLength);
+    consume(contentLength);
+    return message;
+}
+
+std::expected<McpUnixHttpMessage, McpError> McpUnixSocket::readHttpHead() {
+    size_t headerEnd;
+    while (true) {
+        std::string_view pending(m_buffer.data() + m_offset, m_buffer.size() - m_offset);
+        headerEnd = pending.find("\r\n\r\n");
+        if (headerEnd != std::string_view::npos) {
+            break;
+        }
+        if (pending.size() > kMaxHeaderSize) {
+            return std::unexpected(McpError::invalidMessage("HTTP header too large"));
+        }
+        auto filled = fill();
+        if (!filled) {
+            return std::unexpected(filled.error());
+        }
+        if (!filled.value()) {
+            return std::unexpected(McpError::connectionClosed());
+        }
+    }
+
+    std::string_view header(m_buffer.data() + m_offset, headerEnd);
+    McpUnixHttpMessage message;
+
+    size_t lineEnd = header.find("\r\n");
+    message.startLine = std::string(header.substr(0, lineEnd));
+    if (message.startLine.find("HTTP/1.0") != std::string::npos) {
+        message.keepAlive = false;
+    }
+
+    while (lineEnd != std::string_view::npos) {
+        const size_t lineStart = lineEnd + 2;
+        lineEnd = header.find("\r\n", lineStart);
+        std::string_view line = header.substr(lineStart, lineEnd == std::string_view::npos
+                                                             ? std::string_view::npos
+                                                             : lineEnd - lineStart);
+        const size_t colon = line.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        std::string_view name = Trim(line.substr(0, colon));
+        std::string_view value = Trim(line.substr(colon + 1));
+        message.headers.emplace_back(std::string(name), std::string(value));
+        if (EqualsIgnoreCase(name, "Content-Length")) {
+            auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), message.contentLength);
+            if (ec != std::errc() || ptr != value.data() + value.size()) {
+                return std::unexpected(McpError::invalidMessage("Invalid Content-Length"));
+            }
+        } else if (EqualsIgnoreCase(name, "Connection")) {
+            if (ContainsIgnoreCase(value, "close")) {
+                message.keepAlive = false;
+            } else if (ContainsIgnoreCase(value, "keep-alive")) {
+                message.keepAlive = true;
+            }
+        } else if (EqualsIgnoreCase(name, "Transfer-Encoding")) {
+            if (!EqualsIgnoreCase(value, "chunked")) {
+                return std::unexpected(McpError::invalidMessage("Unsupported Transfer-Encoding"));
+            }
+            message.chunked = true;
+        }
+    }
+
+    consume(headerEnd + 4);
+    return message;
+}
+
+std::expected<std::string, McpError> McpUnixSocket::readChunk() {
+    auto sizeLine = readLine();
+    if (!sizeLine) {
+        return std::unexpected(sizeLine.error());
+    }
+
+    // 忽略 chunk 扩展（';' 之后的部分）
+    std::string_view sizeText = Trim(sizeLine.value());
+    sizeText = sizeText.substr(0, sizeText.find(';'));
+    size_t chunkSize = 0;
+    auto [ptr, ec] = std::from_chars(sizeText.data(), sizeText.data() + sizeText.size(), chunkSize, 16);
+    if (sizeText.empty() || ec != std::errc() || ptr != sizeText.data() + sizeText.size()) {
+        return std::unexpected(McpError::invalidMessage("Invalid chunk size"));
+    }
+
+    if (chunkSize == 0) {
+        // 跳过 trailer，直到空行
+        while (true) {
+            auto trailer = readLine();
+            if (!trailer) {
+                return std::unexpected(trailer.error());
+            }
+            if (trailer.value().empty()) {
+                return std::string();
+            }
+        }
+    }
+
+    while (m_buffer.size() - m_offset < chunkSize + 2) {
+        auto filled = fill();
+        if (!filled) {
+            return std::unexpected(filled.error());
+        }
+        if (!filled.value()) {
+            return std::unexpected(McpError::connectionClosed("Truncated HTTP chunk"));
+        }
+    }
+    std::string chunk(m_buffer.data() + m_offset, chunkSize);
+    if (m_buffer.compare(m_offset + chunkSize, 2, "\r\n") != 0) {
+        return std::unexpected(McpError::invalidMessage("Missing chunk terminator"));
+    }
+    consume(chunkSize + 2);
+    return chunk;
+}
+
+std::expected<std::string, McpError> McpUnixSocket::readLine() {
+    while (true) {
+        std::string_view pending(m_buffer.data() + m_offset, m_buffer.size() - m_offset);
+        const size_t lineEnd = pending.find("\r\n");
+        if (lineEnd != std::string_view::npos) {
+            std::string line(pending.substr(0, lineEnd));
+            consume(lineEnd + 2);
+            return line;
+        }
+        if (pending.size() > kMaxHeaderSize) {
+            return std::unexpected(McpError::invalidMessage("HTTP line too long"));
+        }
+        auto filled = fill();
+        if (!filled) {
+            return std::unexpected(filled.error());
+        }
+        if (!filled.value()) {
+            return std::unexpected(McpError::connectionClosed());
+        }
+    }
+}
+
+void McpUnixSocket::consume(size_t bytes) {
+    m_offset += bytes;
+    if (m_offset == m_buffer.size()) {
+        m_buffer.clear();
+        m_offset = 0;
+    }
+}
+
+std::expected<void, McpError> McpUnixSocket::writeAll(std::string_view data) {
+    while (!data.empty()) {
+        ssize_t n = ::send(m_fd, data.data(), data.size(), kSendFlags);
+        if (n > 0) {
+            data.remove_prefix(static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EPIPE || errno == ECONNRESET)) {
+            return std::unexpected(McpError::connectionClosed(ErrnoMessage("send")));
+        }
+        return std::unexpected(McpError::writeError(ErrnoMessage("send")));
+    }
+    return {};
+}
+
+std::expected<void, McpError> McpUnixSocket::setReadTimeout(std::chrono::milliseconds timeout) {
+    if (timeout.count() < 0) {
+        timeout = std::chrono::milliseconds(0);
+    }
+    timeval tv{};
+    tv.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+    tv.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+    if (::setsockopt(m_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) != 0) {
+        return std::unexpected(McpError::connectionError(ErrnoMessage("setsockopt")));
+    }
+    return {};
+}
+
+bool McpUnixSocket::peerClosed() const {
+    if (m_fd < 0) {
+        return true;
+    }
+#if defined(POLLRDHUP)
+    pollfd pfd{m_fd, POLLRDHUP, 0};
+    if (::poll(&pfd, 1, 0) <= 0) {
+        return false;
+    }
+    return (pfd.revents & (POLLRDHUP | POLLHUP | POLLERR)) != 0;
+#else
+    char byte = 0;
+    const ssize_t n = ::recv(m_fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+    return n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+#endif
+}
+
+void McpUnixSocket::shutdown() {
+    if (m_fd >= 0) {
+        ::shutdown(m_fd, SHUT_RDWR);
+    }
+}
+
+void McpUnixSocket::close() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    if (!m_unlinkPath.empty()) {
+        ::unlink(m_unlinkPath.c_str());
+        m_unlinkPath.clear();
+    }
+    m_buffer.clear();
+    m_offset = 0;
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,141 @@
+#ifndef GALAY_MCP_COMMON_MCPUNIXSOCKET_H
+#define GALAY_MCP_COMMON_MCPUNIXSOCKET_H
+
+#include "galay-mcp/common/McpError.h"
+#include <chrono>
+#include <expected>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief Unix 域套接字上读到的一条 HTTP/1.1 报文
+ */
+struct McpUnixHttpMessage {
+    std::string startLine;   // 请求行或状态行
+    std::string body;        // 按 Content-Length 读取或按 chunked 解码后的正文
+    bool keepAlive = true;   // HTTP/1.1 默认保持连接，Connection: close 时为 false
+    bool chunked = false;    // Transfer-Encoding: chunked
+    size_t contentLength = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+
+    // 按名称（不区分大小写）查找头部值，不存在时返回空串
+    std::string_view header(std::string_view name) const;
+};
+
+/**
+ * @brief 本机 sidecar 部署使用的 Unix 域流套接字
+ *
+ * McpHttpServer / McpHttpClient 遇到 "unix:/path/to.sock" 地址时改用该套接字，
+ * 线上协议仍是 HTTP/1.1 + JSON-RPC（Content-Length 或 chunked 正文），
+ * 省去 TCP 回环协议栈的开销。套接字为阻塞模式，只可移动不可拷贝。
+ * 读写接口与地址族无关，McpHttpClient 的 GET 事件流读取线程经 connectTcp() 复用它连接 TCP 服务端。
+ */
+class McpUnixSocket {
+public:
+    static constexpr std::string_view kAddressPrefix = "unix:";
+
+    /**
+     * @brief 判断地址是否为 "unix:" 前缀的 Unix 域地址
+     */
+    static bool isUnixAddress(std::string_view address);
+
+    /**
+     * @brief 去掉 "unix:" 前缀得到文件系统路径；非 unix 地址原样返回
+     */
+    static std::string socketPath(std::string_view address);
+
+    /**
+     * @brief 在 path 上监听（服务端）
+     * @note 已存在的同名套接字文件会先被 unlink
+     * @return bind/listen 失败或路径超长返回 ConnectionFailed
+     */
+    static std::expected<McpUnixSocket, McpError> listen(const std::string& path, int backlog);
+
+    /**
+     * @brief 连接 path 上的监听套接字（客户端）
+     */
+    static std::expected<McpUnixSocket, McpError> connect(const std::string& path);
+
+    /**
+     * @brief 建立阻塞的 TCP 连接
+     */
+    static std::expected<McpUnixSocket, McpError> connectTcp(const std::string& host, int port);
+
+    McpUnixSocket() = default;
+    ~McpUnixSocket();
+
+    McpUnixSocket(const McpUnixSocket&) = delete;
+    McpUnixSocket& operator=(const McpUnixSocket&) = delete;
+    McpUnixSocket(McpUnixSocket&& other) noexcept;
+    McpUnixSocket& operator=(McpUnixSocket&& other) noexcept;
+
+    /**
+     * @brief 接受一个连接；监听套接字被 shutdown() 后返回 ConnectionClosed
+     */
+    std::expected<McpUnixSocket, McpError> accept();
+
+    /**
+     * @brief 读取一条完整的 HTTP/1.1 报文（请求或响应）
+     * @return 对端关闭返回 ConnectionClosed；报文格式不支持返回 InvalidMessage
+     */
+    std::expected<McpUnixHttpMessage, McpError> readHttpMessage();
+
+    /**
+     * @brief 只读取起始行与头部，正文留在连接上（用于逐块读取的 SSE 流）
+     */
+    std::expected<McpUnixHttpMessage, McpError> readHttpHead();
+
+    /**
+     * @brief 读取 chunked 正文的下一个块
+     * @return 块内容；结束块返回空串
+     */
+    std::expected<std::string, McpError> readChunk();
+
+    /**
+     * @brief 写出全部字节
+     */
+    std::expected<void, McpError> writeAll(std::string_view data);
+
+    /**
+     * @brief 设置读超时（SO_RCVTIMEO），超时后 readHttpMessage 返回 ConnectionTimeout；0 表示不超时
+     * @note 超时后连接上可能残留半条报文，调用方应关闭连接
+     */
+    std::expected<void, McpError> setReadTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief 不阻塞地检查对端是否已关闭连接（不消费已缓冲的数据）
+     */
+    bool peerClosed() const;
+
+    /**
+     * @brief 唤醒阻塞在该套接字上的 accept/read，不释放描述符
+     */
+    void shutdown();
+
+    void close();
+
+    bool isOpen() const { return m_fd >= 0; }
+    int fd() const { return m_fd; }
+
+private:
+    explicit McpUnixSocket(int fd) : m_fd(fd) {}
+
+    std::expected<bool, McpError> fill();
+    std::expected<std::string, McpError> readLine();
+    void consume(size_t bytes);
+
+    int m_fd{-1};
+    std::string m_buffer;
+    size_t m_offset{0};
+    std::string m_unlinkPath;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPUNIXSOCKET_H
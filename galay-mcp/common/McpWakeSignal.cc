@@ -0,0 +1,149 @@
+#include "galay-mcp/common/McpWakeSignal.h"
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+// notifyAt() 共享的定时线程：按时刻排序，到时通知仍然存活的唤醒点
+class WakeTimer {
+public:
+    static WakeTimer& instance() {
+        static WakeTimer timer;
+        return timer;
+    }
+
+    void schedule(std::weak_ptr<McpWakeSignal> signal, McpWakeSignal::Clock::time_point when) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_thread.joinable()) {
+                m_thread = std::thread(&WakeTimer::run, this);
+            }
+            m_entries.push(Entry{when, std::move(signal)});
+        }
+        m_changed.notify_one();
+    }
+
+    ~WakeTimer() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_changed.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+    }
+
+private:
+    struct Entry {
+        McpWakeSignal::Clock::time_point when;
+        std::weak_ptr<McpWakeSignal> signal;
+
+        bool operator>(const Entry& other) const { return when > other.when; }
+    };
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_stopping) {
+            if (m_entries.empty()) {
+                m_changed.wait(lock);
+                continue;
+            }
+            const auto when = m_entries.top().when;
+            if (McpWakeSignal::Clock::now() < when) {
+                m_changed.wait_until(lock, when);
+                continue;
+            }
+            std::shared_ptr<McpWakeSignal> signal = m_entries.top().signal.lock();
+            m_entries.pop();
+            if (signal) {
+                // notify() 只投递恢复，不在定时线程上运行等待方
+                lock.unlock();
+                signal->notify();
+                lock.lock();
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> m_entries;
+    std::thread m_thread;
+    bool m_stopping = false;
+};
+
+} // namespace
+
+bool McpWakeSignal::Awaitable::await_ready() noexcept {
+    return m_signal.poll();
+}
+
+bool McpWakeSignal::Awaitable::await_suspend(std::coroutine_handle<> handle) noexcept {
+    std::lock_guard<std::mutex> lock(m_signal.m_mutex);
+    if (m_signal.m_pending) {
+        // await_ready() 之后到达的通知：不挂起
+        m_signal.m_pending = false;
+        return false;
+    }
+    m_signal.m_waiter = handle;
+    m_signal.m_executor = McpExecutor::current();
+    return true;
+}
+
+std::shared_ptr<McpWakeSignal> McpWakeSignal::create() {
+    return std::make_shared<McpWakeSignal>();
+}
+
+McpWakeSignal::Awaitable McpWakeSignal::wait() {
+    return Awaitable(*this);
+}
+
+void McpWakeSignal::block() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_notified.wait(lock, [this]() { return m_pending; });
+    m_pending = false;
+}
+
+bool McpWakeSignal::blockFor(Clock::duration timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_notified.wait_for(lock, timeout, [this]() { return m_pending; })) {
+        return false;
+    }
+    m_pending = false;
+    return true;
+}
+
+void McpWakeSignal::notify() {
+    std::coroutine_handle<> waiter;
+    McpExecutor* executor = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        waiter = std::exchange(m_waiter, nullptr);
+        executor = std::exchange(m_executor, nullptr);
+        if (!waiter) {
+            m_pending = true;
+        }
+    }
+    if (waiter) {
+        (executor ? *executor : McpExecutor::fallback()).post(waiter);
+        return;
+    }
+    m_notified.notify_one();
+}
+
+void McpWakeSignal::notifyAt(const std::shared_ptr<McpWakeSignal>& signal, Clock::time_point when) {
+    WakeTimer::instance().schedule(signal, when);
+}
+
+bool McpWakeSignal::poll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::exchange(m_pending, false);
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,82 @@
+#ifndef GALAY_MCP_COMMON_MCPWAKESIGNAL_H
+#define GALAY_MCP_COMMON_MCPWAKESIGNAL_H
+
+#include "galay-mcp/common/McpExecutor.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <memory>
+#include <mutex>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 协程唤醒点：等待方 co_await wait() 挂起，事件发生方调用 notify() 唤醒它
+ *
+ * 用来代替“检查状态 + co_await kernel::sleep(...)”的轮询：名额移交、计算任务完成、
+ * 取消等事件发生时由事件方 notify()，等待方醒来后重新检查自己关心的状态。
+ * notify() 发生在 wait() 之前时通知被记住，下一次 wait() 不挂起直接返回（多次通知合并为一次）。
+ * notifyAt() 由共享的定时线程在指定时刻 notify()，用于截止时间等没有事件方的唤醒。
+ * 通过 std::shared_ptr 共享，事件方可以比等待方活得更久。同一时刻只允许一个等待方。
+ *
+ * @note notify() 不在调用线程上恢复等待方：wait() 挂起时记下当前线程绑定的 McpExecutor，
+ *       notify() 把恢复投递给它，协程回到挂起它的调度器上继续；挂起线程未绑定执行器时投递给
+ *       McpExecutor::fallback()。因此事件方（计算线程、定时线程、其他会话）只负责投递，
+ *       不会在自己的调用栈里运行等待方。
+ */
+class McpWakeSignal {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Awaitable {
+    public:
+        bool await_ready() noexcept;
+        bool await_suspend(std::coroutine_handle<> handle) noexcept;
+        void await_resume() const noexcept {}
+
+    private:
+        friend class McpWakeSignal;
+        explicit Awaitable(McpWakeSignal& signal)
+            : m_signal(signal) {
+        }
+        McpWakeSignal& m_signal;
+    };
+
+    static std::shared_ptr<McpWakeSignal> create();
+
+    McpWakeSignal() = default;
+    McpWakeSignal(const McpWakeSignal&) = delete;
+    McpWakeSignal& operator=(const McpWakeSignal&) = delete;
+
+    // 协程等待下一次通知（已有未消费的通知时不挂起）
+    Awaitable wait();
+
+    // 线程阻塞等待下一次通知，供不在协程中的调用方使用
+    void block();
+
+    // 同 block()，最多等待 timeout；收到通知时返回 true
+    bool blockFor(Clock::duration timeout);
+
+    // 消费一次未处理的通知，没有时返回 false；供不能挂起的调用方按间隔检查
+    bool poll();
+
+    // 唤醒等待方：把恢复投递给等待方挂起时所在的执行器；任意线程可调用
+    void notify();
+
+    // 在 when 时刻 notify()；等待方先行析构时不再通知。定时线程只投递恢复，不运行等待方
+    static void notifyAt(const std::shared_ptr<McpWakeSignal>& signal, Clock::time_point when);
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_notified;
+    bool m_pending = false;
+    std::coroutine_handle<> m_waiter;
+    McpExecutor* m_executor = nullptr;
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_COMMON_MCPWAKESIGNAL_H
@@ -8,6 +8,9 @@
 #if __has_include(<charconv>)
 #include <charconv>
 #endif
+#if __has_include(<condition_variable>)
+#include <condition_variable>
+#endif
 #if __has_include(<cstdint>)
 #include <cstdint>
 #endif
@@ -20,6 +23,9 @@
 #if __has_include(<functional>)
 #include <functional>
 #endif
+#if __has_include(<future>)
+#include <future>
+#endif
 #if __has_include(<iostream>)
 #include <iostream>
 #endif
@@ -56,9 +62,15 @@
 #if __has_include(<system_error>)
 #include <system_error>
 #endif
+#if __has_include(<thread>)
+#include <thread>
+#endif
 #if __has_include(<unordered_map>)
 #include <unordered_map>
 #endif
+#if __has_include(<unordered_set>)
+#include <unordered_set>
+#endif
 #if __has_include(<utility>)
 #include <utility>
 #endif
@@ -83,36 +95,108 @@
 #if __has_include("galay-kernel/kernel/Runtime.h")
 #include "galay-kernel/kernel/Runtime.h"
 #endif
+#if __has_include("galay-mcp/client/McpCallPolicy.h")
+#include "galay-mcp/client/McpCallPolicy.h"
+#endif
 #if __has_include("galay-mcp/client/McpHttpClient.h")
 #include "galay-mcp/client/McpHttpClient.h"
 #endif
+#if __has_include("galay-mcp/client/McpInProcessClient.h")
+#include "galay-mcp/client/McpInProcessClient.h"
+#endif
+#if __has_include("galay-mcp/client/McpListCache.h")
+#include "galay-mcp/client/McpListCache.h"
+#endif
+#if __has_include("galay-mcp/client/McpStdioProcess.h")
+#include "galay-mcp/client/McpStdioProcess.h"
+#endif
 #if __has_include("galay-mcp/client/McpStdioClient.h")
 #include "galay-mcp/client/McpStdioClient.h"
 #endif
+#if __has_include("galay-mcp/common/McpAsyncSemaphore.h")
+#include "galay-mcp/common/McpAsyncSemaphore.h"
+#endif
 #if __has_include("galay-mcp/common/McpBase.h")
 #include "galay-mcp/common/McpBase.h"
 #endif
+#if __has_include("galay-mcp/common/McpCancellation.h")
+#include "galay-mcp/common/McpCancellation.h"
+#endif
+#if __has_include("galay-mcp/common/McpComputePool.h")
+#include "galay-mcp/common/McpComputePool.h"
+#endif
+#if __has_include("galay-mcp/common/McpContentWriter.h")
+#include "galay-mcp/common/McpContentWriter.h"
+#endif
+#if __has_include("galay-mcp/common/McpEncoding.h")
+#include "galay-mcp/common/McpEncoding.h"
+#endif
 #if __has_include("galay-mcp/common/McpError.h")
 #include "galay-mcp/common/McpError.h"
 #endif
+#if __has_include("galay-mcp/common/McpInProcessEndpoint.h")
+#include "galay-mcp/common/McpInProcessEndpoint.h"
+#endif
 #if __has_include("galay-mcp/common/McpJson.h")
 #include "galay-mcp/common/McpJson.h"
 #endif
 #if __has_include("galay-mcp/common/McpJsonParser.h")
 #include "galay-mcp/common/McpJsonParser.h"
 #endif
+#if __has_include("galay-mcp/common/McpManifest.h")
+#include "galay-mcp/common/McpManifest.h"
+#endif
+#if __has_include("galay-mcp/common/McpMessageChannel.h")
+#include "galay-mcp/common/McpMessageChannel.h"
+#endif
+#if __has_include("galay-mcp/common/McpProgress.h")
+#include "galay-mcp/common/McpProgress.h"
+#endif
 #if __has_include("galay-mcp/common/McpProtocolUtils.h")
 #include "galay-mcp/common/McpProtocolUtils.h"
 #endif
+#if __has_include("galay-mcp/common/McpRegistry.h")
+#include "galay-mcp/common/McpRegistry.h"
+#endif
 #if __has_include("galay-mcp/common/McpSchemaBuilder.h")
 #include "galay-mcp/common/McpSchemaBuilder.h"
 #endif
+#if __has_include("galay-mcp/common/McpSse.h")
+#include "galay-mcp/common/McpSse.h"
+#endif
+#if __has_include("galay-mcp/common/McpShmChannel.h")
+#include "galay-mcp/common/McpShmChannel.h"
+#endif
+#if __has_include("galay-mcp/common/McpStdioFraming.h")
+#include "galay-mcp/common/McpStdioFraming.h"
+#endif
+#if __has_include("galay-mcp/common/McpToolContext.h")
+#include "galay-mcp/common/McpToolContext.h"
+#endif
+#if __has_include("galay-mcp/common/McpUnixSocket.h")
+#include "galay-mcp/common/McpUnixSocket.h"
+#endif
 #if __has_include("galay-mcp/module/ModulePrelude.hpp")
 #include "galay-mcp/module/ModulePrelude.hpp"
 #endif
+#if __has_include("galay-mcp/server/McpAdmissionController.h")
+#include "galay-mcp/server/McpAdmissionController.h"
+#endif
 #if __has_include("galay-mcp/server/McpHttpServer.h")
 #include "galay-mcp/server/McpHttpServer.h"
 #endif
+#if __has_include("galay-mcp/server/McpResultCache.h")
+#include "galay-mcp/server/McpResultCache.h"
+#endif
+#if __has_include("galay-mcp/server/McpResultStore.h")
+#include "galay-mcp/server/McpResultStore.h"
+#endif
+#if __has_include("galay-mcp/server/McpSessionTable.h")
+#include "galay-mcp/server/McpSessionTable.h"
+#endif
+#if __has_include("galay-mcp/server/McpSingleFlight.h")
+#include "galay-mcp/server/McpSingleFlight.h"
+#endif
 #if __has_include("galay-mcp/server/McpStdioServer.h")
 #include "galay-mcp/server/McpStdioServer.h"
 #endif
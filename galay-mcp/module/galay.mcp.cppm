@@ -11,10 +11,34 @@ export {
 #include "galay-mcp/common/McpJsonParser.h"
 #include "galay-mcp/common/McpSchemaBuilder.h"
 #include "galay-mcp/common/McpProtocolUtils.h"
+#include "galay-mcp/common/McpRegistry.h"
+#include "galay-mcp/common/McpManifest.h"
+#include "galay-mcp/common/McpEncoding.h"
+#include "galay-mcp/common/McpStdioFraming.h"
+#include "galay-mcp/common/McpMessageChannel.h"
+#include "galay-mcp/common/McpInProcessEndpoint.h"
+#include "galay-mcp/common/McpCancellation.h"
+#include "galay-mcp/common/McpProgress.h"
+#include "galay-mcp/common/McpToolContext.h"
+#include "galay-mcp/common/McpContentWriter.h"
+#include "galay-mcp/common/McpComputePool.h"
+#include "galay-mcp/common/McpAsyncSemaphore.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/common/McpUnixSocket.h"
+#include "galay-mcp/common/McpSse.h"
 
+#include "galay-mcp/client/McpCallPolicy.h"
+#include "galay-mcp/client/McpListCache.h"
+#include "galay-mcp/client/McpStdioProcess.h"
 #include "galay-mcp/client/McpStdioClient.h"
 #include "galay-mcp/client/McpHttpClient.h"
+#include "galay-mcp/client/McpInProcessClient.h"
 
 #include "galay-mcp/server/McpStdioServer.h"
+#include "galay-mcp/server/McpAdmissionController.h"
+#include "galay-mcp/server/McpResultCache.h"
+#include "galay-mcp/server/McpResultStore.h"
+#include "galay-mcp/server/McpSessionTable.h"
+#include "galay-mcp/server/McpSingleFlight.h"
 #include "galay-mcp/server/McpHttpServer.h"
 }
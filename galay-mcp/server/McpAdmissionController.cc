@@ -0,0 +1,121 @@
+#include "galay-mcp/server/McpAdmissionController.h"
+#include <cmath>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+int64_t ToMicroseconds(McpAdmissionController::Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+}
+
+// CoDel 控制律：第 count 次丢弃后的下一次丢弃间隔
+McpAdmissionController::Clock::duration ControlLaw(std::chrono::microseconds interval, uint32_t count) {
+    const double scaled = static_cast<double>(interval.count()) / std::sqrt(static_cast<double>(count));
+    return std::chrono::microseconds(static_cast<int64_t>(scaled));
+}
+
+} // namespace
+
+McpAdmissionController::McpAdmissionController(const McpAdmissionOptions& options)
+    : m_options(options) {
+}
+
+void McpAdmissionController::setOptions(const McpAdmissionOptions& options) {
+    m_options = options;
+}
+
+McpAdmissionDecision McpAdmissionController::tryAdmit(Clock::time_point now) {
+    const size_t previous = m_inFlight.fetch_add(1, std::memory_order_acq_rel);
+    if (m_options.maxInFlight > 0 && previous >= m_options.maxInFlight) {
+        m_inFlight.fetch_sub(1, std::memory_order_acq_rel);
+        m_shedInFlight.fetch_add(1, std::memory_order_relaxed);
+        return McpAdmissionDecision::ShedInFlight;
+    }
+
+    if (m_options.codelTarget.count() > 0 && shouldDropForQueueDelay(now)) {
+        m_inFlight.fetch_sub(1, std::memory_order_acq_rel);
+        m_shedQueueDelay.fetch_add(1, std::memory_order_relaxed);
+        return McpAdmissionDecision::ShedQueueDelay;
+    }
+
+    m_admitted.fetch_add(1, std::memory_order_relaxed);
+    return McpAdmissionDecision::Admitted;
+}
+
+void McpAdmissionController::release() {
+    m_inFlight.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void McpAdmissionController::recordQueueDelay(Clock::duration delay, Clock::time_point now) {
+    const int64_t delayUs = ToMicroseconds(delay);
+    m_queueDelaySamples.fetch_add(1, std::memory_order_relaxed);
+    m_lastQueueDelayUs.store(delayUs, std::memory_order_relaxed);
+    int64_t observedMax = m_maxQueueDelayUs.load(std::memory_order_relaxed);
+    while (delayUs > observedMax &&
+           !m_maxQueueDelayUs.compare_exchange_weak(observedMax, delayUs, std::memory_order_relaxed)) {
+    }
+
+    if (m_options.codelTarget.count() <= 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_codelMutex);
+    if (delay < m_options.codelTarget) {
+        // 出现低于目标的样本即退出丢弃状态
+        m_firstAboveTime = Clock::time_point{};
+        m_dropping.store(false, std::memory_order_release);
+        return;
+    }
+
+    if (m_firstAboveTime == Clock::time_point{}) {
+        m_firstAboveTime = now + m_options.codelInterval;
+        return;
+    }
+
+    if (!m_dropping.load(std::memory_order_relaxed) && now >= m_firstAboveTime) {
+        // 刚退出丢弃状态不久又超标时沿用上一轮的丢弃速率，而不是从 1 重新爬升
+        const uint32_t delta = m_dropCount - m_lastDropCount;
+        const bool recent = now - m_dropNext < 16 * m_options.codelInterval;
+        m_dropCount = (delta > 1 && recent) ? delta : 1;
+        m_lastDropCount = m_dropCount;
+        m_dropNext = now;
+        m_dropping.store(true, std::memory_order_release);
+    }
+}
+
+void McpAdmissionController::recordToolShed() {
+    m_shedToolLimit.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool McpAdmissionController::shouldDropForQueueDelay(Clock::time_point now) {
+    if (!m_dropping.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_codelMutex);
+    if (!m_dropping.load(std::memory_order_relaxed) || now < m_dropNext) {
+        return false;
+    }
+    ++m_dropCount;
+    m_dropNext = now + ControlLaw(m_options.codelInterval, m_dropCount);
+    return true;
+}
+
+McpAdmissionStats McpAdmissionController::stats() const {
+    McpAdmissionStats stats;
+    stats.admitted = m_admitted.load(std::memory_order_relaxed);
+    stats.shedInFlight = m_shedInFlight.load(std::memory_order_relaxed);
+    stats.shedQueueDelay = m_shedQueueDelay.load(std::memory_order_relaxed);
+    stats.shedToolLimit = m_shedToolLimit.load(std::memory_order_relaxed);
+    stats.queueDelaySamples = m_queueDelaySamples.load(std::memory_order_relaxed);
+    stats.lastQueueDelay = std::chrono::microseconds(m_lastQueueDelayUs.load(std::memory_order_relaxed));
+    stats.maxQueueDelay = std::chrono::microseconds(m_maxQueueDelayUs.load(std::memory_order_relaxed));
+    stats.inFlight = m_inFlight.load(std::memory_order_relaxed);
+    stats.dropping = m_dropping.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace mcp
+} // namespace galay
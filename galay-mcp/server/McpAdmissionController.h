@@ -0,0 +1,110 @@
+#ifndef GALAY_MCP_SERVER_MCPADMISSIONCONTROLLER_H
+#define GALAY_MCP_SERVER_MCPADMISSIONCONTROLLER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 服务端准入控制选项（全部为 0 时不做任何限制）
+ */
+struct McpAdmissionOptions {
+    // 服务端同时处理的请求上限；0 表示不限制
+    size_t maxInFlight = 0;
+    // 排队时延目标；持续超过目标一个 codelInterval 后开始丢弃新请求，0 表示关闭
+    std::chrono::microseconds codelTarget{0};
+    // CoDel 观察窗口，同时决定丢弃间隔（interval / sqrt(count)）
+    std::chrono::microseconds codelInterval{std::chrono::milliseconds(100)};
+};
+
+/**
+ * @brief 准入判定结果
+ */
+enum class McpAdmissionDecision {
+    Admitted,
+    ShedInFlight,   // 超过服务端并发上限
+    ShedQueueDelay  // 排队时延持续超标（CoDel 丢弃状态）
+};
+
+/**
+ * @brief 准入控制计数快照
+ */
+struct McpAdmissionStats {
+    uint64_t admitted = 0;
+    uint64_t shedInFlight = 0;
+    uint64_t shedQueueDelay = 0;
+    uint64_t shedToolLimit = 0;
+    uint64_t queueDelaySamples = 0;
+    std::chrono::microseconds lastQueueDelay{0};
+    std::chrono::microseconds maxQueueDelay{0};
+    size_t inFlight = 0;
+    bool dropping = false;
+};
+
+/**
+ * @brief 并发上限 + CoDel 风格的排队时延丢弃
+ *
+ * 请求到达时调用 tryAdmit()，处理完成后调用 release()；
+ * 处理函数开始执行时用 recordQueueDelay() 上报从到达到开始执行的时延。
+ * 时延持续高于 codelTarget 达一个 codelInterval 后进入丢弃状态，
+ * 按 interval / sqrt(count) 的间隔拒绝新请求，直到出现低于目标的样本为止（RFC 8289 的控制律）。
+ * 除 setOptions() 外所有方法线程安全。
+ */
+class McpAdmissionController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    McpAdmissionController() = default;
+    explicit McpAdmissionController(const McpAdmissionOptions& options);
+
+    McpAdmissionController(const McpAdmissionController&) = delete;
+    McpAdmissionController& operator=(const McpAdmissionController&) = delete;
+
+    // 必须在开始接收请求之前调用
+    void setOptions(const McpAdmissionOptions& options);
+    const McpAdmissionOptions& options() const { return m_options; }
+
+    // 判定是否接收请求；返回 Admitted 时调用方必须在处理结束后调用 release()
+    McpAdmissionDecision tryAdmit(Clock::time_point now = Clock::now());
+    void release();
+
+    // 上报一个请求从到达到处理函数开始执行的时延
+    void recordQueueDelay(Clock::duration delay, Clock::time_point now = Clock::now());
+
+    // 记录一次因单个工具并发上限被拒绝的请求
+    void recordToolShed();
+
+    McpAdmissionStats stats() const;
+
+private:
+    bool shouldDropForQueueDelay(Clock::time_point now);
+
+    McpAdmissionOptions m_options;
+
+    std::atomic<size_t> m_inFlight{0};
+    std::atomic<uint64_t> m_admitted{0};
+    std::atomic<uint64_t> m_shedInFlight{0};
+    std::atomic<uint64_t> m_shedQueueDelay{0};
+    std::atomic<uint64_t> m_shedToolLimit{0};
+    std::atomic<uint64_t> m_queueDelaySamples{0};
+    std::atomic<int64_t> m_lastQueueDelayUs{0};
+    std::atomic<int64_t> m_maxQueueDelayUs{0};
+
+    // CoDel 状态，受 m_codelMutex 保护；m_dropping 供 tryAdmit 无锁快速判断
+    std::mutex m_codelMutex;
+    std::atomic<bool> m_dropping{false};
+    Clock::time_point m_firstAboveTime{};
+    Clock::time_point m_dropNext{};
+    uint32_t m_dropCount{0};
+    uint32_t m_lastDropCount{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_SERVER_MCPADMISSIONCONTROLLER_H
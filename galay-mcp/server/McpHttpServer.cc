@@ -1,6 +1,12 @@
 #include "galay-mcp/server/McpHttpServer.h"
 #include "galay-http/utils/Http1_1ResponseBuilder.h"
+#include "galay-kernel/common/Sleep.hpp"
 #include "galay-mcp/common/McpProtocolUtils.h"
+#include "galay-mcp/common/McpSchedulerExecutor.h"
+#include <algorithm>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <thread>
 
 namespace galay {
 namespace mcp {
@@ -27,6 +33,197 @@ JsonString MakeResultResponse(int64_t id, std::string_view resultJson) {
     return response;
 }
 
+// 计算线程上的同步处理函数与等待它的连接协程之间共享的状态
+struct OffloadState {
+    std::atomic<bool> claimed{false}; // 计算线程开始执行或等待方放弃，先到者置位
+    std::atomic<bool> done{false};
+    std::expected<JsonString, McpError> result;
+    std::exception_ptr exception;
+};
+
+// 流式处理函数已写出、连接协程尚未取走的字节上限，超过时写入方等待
+constexpr size_t kStreamQueueBytes = 4 * McpContentWriter::DEFAULT_FLUSH_BYTES;
+
+// 进程内调用：流式输出原样收集为完整内容
+std::expected<std::string, McpError> CollectStreamed(
+    const std::function<std::expected<void, McpError>(McpContentWriter&)>& produce) {
+    std::string output;
+    McpContentWriter writer(McpContentEncoding::Raw, [&output](std::string_view chunk) {
+        output.append(chunk);
+        return true;
+    });
+    try {
+        auto streamed = produce(writer);
+        if (!streamed) {
+            return std::unexpected(streamed.error());
+        }
+    } catch (const std::exception& e) {
+        return std::unexpected(McpError::internalError(e.what()));
+    }
+    writer.flush();
+    return output;
+}
+
+// 流式处理函数（计算线程）与写出其输出的连接协程之间的有界字节队列
+class StreamPipe {
+public:
+    std::atomic<bool> claimed{false}; // 计算线程开始执行或等待方放弃，先到者置位
+    std::atomic<bool> done{false};
+    std::expected<void, McpError> result;
+    bool refused = false;             // writer 的输出函数曾返回 false（调用被取消或写出方放弃）
+    std::shared_ptr<McpWakeSignal> wake = McpWakeSignal::create(); // 有新输出或生产结束时唤醒写出方
+
+    // 写入方：排队字节达到上限时等待写出方取走；写出方放弃后返回 false
+    bool push(std::string_view bytes) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_drained.wait(lock, [this]() { return m_abandoned || m_pending.size() < kStreamQueueBytes; });
+            if (m_abandoned) {
+                return false;
+            }
+            m_pending.append(bytes);
+        }
+        wake->notify();
+        return true;
+    }
+
+    JsonString take() {
+        JsonString bytes;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            bytes.swap(m_pending);
+        }
+        m_drained.notify_one();
+        return bytes;
+    }
+
+    void abandon() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_abandoned = true;
+        }
+        m_drained.notify_one();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_drained;
+    JsonString m_pending;
+    bool m_abandoned = false;
+};
+
+// Unix 域套接字连接线程等待请求处理完成时检查对端是否关闭的间隔
+constexpr auto kPeerCheckInterval = std::chrono::milliseconds(10);
+
+// 准入成功的请求在协程结束时归还并发名额
+class AdmissionGuard {
+public:
+    explicit AdmissionGuard(McpAdmissionController& controller)
+        : m_controller(controller) {
+    }
+    ~AdmissionGuard() {
+        m_controller.release();
+    }
+
+    AdmissionGuard(const AdmissionGuard&) = delete;
+    AdmissionGuard& operator=(const AdmissionGuard&) = delete;
+
+private:
+    McpAdmissionController& m_controller;
+};
+
+// 作用域结束时执行清理
+template <typename Fn>
+class ScopeExit {
+public:
+    explicit ScopeExit(Fn fn)
+        : m_fn(std::move(fn)) {
+    }
+    ~ScopeExit() {
+        m_fn();
+    }
+
+    ScopeExit(const ScopeExit&) = delete;
+    ScopeExit& operator=(const ScopeExit&) = delete;
+
+private:
+    Fn m_fn;
+};
+
+// 调用被取消时返回给客户端的错误
+McpError CancelledError(const McpCancellationToken& cancellation) {
+    return McpError::requestCancelled(protocol::cancelReasonText(cancellation.reason()));
+}
+
+// 单个工具的并发名额，构造失败时 acquired() 为 false
+class ToolSlot {
+public:
+    ToolSlot(std::atomic<size_t>* inFlight, size_t limit)
+        : m_inFlight(inFlight) {
+        if (!m_inFlight) {
+            return;
+        }
+        if (m_inFlight->fetch_add(1, std::memory_order_acq_rel) >= limit) {
+            m_inFlight->fetch_sub(1, std::memory_order_acq_rel);
+            m_inFlight = nullptr;
+            m_acquired = false;
+        }
+    }
+    ~ToolSlot() {
+        if (m_inFlight) {
+            m_inFlight->fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    ToolSlot(const ToolSlot&) = delete;
+    ToolSlot& operator=(const ToolSlot&) = delete;
+
+    bool acquired() const { return m_acquired; }
+
+private:
+    std::atomic<size_t>* m_inFlight;
+    bool m_acquired = true;
+};
+
+// 一条 JSON-RPC 消息编码为一个 SSE message 事件，并作为一个 chunk 追加
+void AppendEventChunk(JsonString& wire, const JsonString& message, std::string_view id = {}) {
+    std::string event;
+    event.reserve(message.size() + 48);
+    sse::appendEvent(event, message, id);
+    sse::appendChunk(wire, event);
+}
+
+// GET /mcp 事件流检查回放缓冲的间隔
+constexpr auto kEventStreamPollInterval = std::chrono::milliseconds(10);
+
+// 事件流空闲时发送注释行的间隔，用于及时发现已断开的连接
+constexpr auto kEventStreamHeartbeat = std::chrono::seconds(15);
+
+// Unix 域套接字监听服务与 TCP 路由相同的 /mcp 端点
+enum class McpRoute { Post, Get, Delete, NotFound };
+
+McpRoute ParseRoute(std::string_view startLine) {
+    const size_t methodEnd = startLine.find(' ');
+    if (methodEnd == std::string_view::npos) {
+        return McpRoute::NotFound;
+    }
+    std::string_view target = startLine.substr(methodEnd + 1);
+    if (!target.starts_with("/mcp ") && !target.starts_with("/mcp?")) {
+        return McpRoute::NotFound;
+    }
+    std::string_view method = startLine.substr(0, methodEnd);
+    if (method == "POST") {
+        return McpRoute::Post;
+    }
+    if (method == "GET") {
+        return McpRoute::Get;
+    }
+    if (method == "DELETE") {
+        return McpRoute::Delete;
+    }
+    return McpRoute::NotFound;
+}
+
 } // namespace
 
 McpHttpServer::McpHttpServer(const std::string& host,
@@ -39,15 +236,17 @@ McpHttpServer::McpHttpServer(const std::string& host,
     , m_serverVersion("1.0.0")
     , m_ioSchedulers(ioSchedulers)
     , m_computeSchedulers(computeSchedulers)
-    , m_toolsCacheDirty(true)
-    , m_resourcesCacheDirty(true)
-    , m_promptsCacheDirty(true)
-    , m_running(false)
-    , m_initialized(false) {
+    , m_tools("tools", [](const ToolInfo& info) { return info.tool.toJson(); })
+    , m_resources("resources", [](const ResourceInfo& info) { return info.resource.toJson(); })
+    , m_prompts("prompts", [](const PromptInfo& info) { return info.prompt.toJson(); })
+    , m_running(false) {
 }
 
 McpHttpServer::~McpHttpServer() {
     stop();
+    if (m_localRuntime) {
+        m_localRuntime->stop();
+    }
 }
 
 void McpHttpServer::setServerInfo(const std::string& name, const std::string& version) {
@@ -58,7 +257,55 @@ void McpHttpServer::setServerInfo(const std::string& name, const std::string& ve
 void McpHttpServer::addTool(const std::string& name,
                              const std::string& description,
                              const JsonString& inputSchema,
-                             McpHttpServer::ToolHandler handler) {
+                             McpHttpServer::ToolHandler handler,
+                             McpToolOptions options) {
+    addTool(name, description, inputSchema,
+        McpHttpServer::ContextToolHandler(
+            [handler = std::move(handler)](const JsonElement& arguments,
+                                           const McpToolContext&,
+                                           std::expected<JsonString, McpError>& result) {
+                return handler(arguments, result);
+            }),
+        options);
+}
+
+void McpHttpServer::addTool(const std::string& name,
+                             const std::string& description,
+                             const JsonString& inputSchema,
+                             McpHttpServer::BlockingToolHandler handler,
+                             McpToolOptions options) {
+    addTool(name, description, inputSchema,
+        McpHttpServer::BlockingContextToolHandler(
+            [handler = std::move(handler)](const JsonElement& arguments, const McpToolContext&) {
+                return handler(arguments);
+            }),
+        options);
+}
+
+void McpHttpServer::addTool(const std::string& name,
+                             const std::string& description,
+                             const JsonString& inputSchema,
+                             McpHttpServer::ContextToolHandler handler,
+                             McpToolOptions options) {
+    Tool tool;
+    tool.name = name;
+    tool.description = description;
+    tool.inputSchema = inputSchema;
+
+    ToolInfo info;
+    info.tool = tool;
+    info.handler = std::move(handler);
+    applyToolOptions(info, options);
+
+    m_tools.put(name, std::move(info));
+    broadcastNotification(Methods::TOOLS_LIST_CHANGED);
+}
+
+void McpHttpServer::addTool(const std::string& name,
+                             const std::string& description,
+                             const JsonString& inputSchema,
+                             McpHttpServer::BlockingContextToolHandler handler,
+                             McpToolOptions options) {
     Tool tool;
     tool.name = name;
     tool.description = description;
@@ -66,17 +313,80 @@ void McpHttpServer::addTool(const std::string& name,
 
     ToolInfo info;
     info.tool = tool;
-    info.handler = handler;
+    info.blockingHandler = std::move(handler);
+    applyToolOptions(info, options);
 
-    m_tools[name] = info;
-    m_toolsCacheDirty = true;
+    m_tools.put(name, std::move(info));
+    broadcastNotification(Methods::TOOLS_LIST_CHANGED);
+}
+
+void McpHttpServer::addStreamingTool(const std::string& name,
+                                      const std::string& description,
+                                      const JsonString& inputSchema,
+                                      McpHttpServer::StreamingToolHandler handler,
+                                      McpToolOptions options) {
+    ToolInfo info;
+    info.tool.name = name;
+    info.tool.description = description;
+    info.tool.inputSchema = inputSchema;
+    info.streamingHandler = std::move(handler);
+    applyToolOptions(info, options);
+
+    m_tools.put(name, std::move(info));
+    broadcastNotification(Methods::TOOLS_LIST_CHANGED);
+}
+
+void McpHttpServer::applyToolOptions(ToolInfo& info, const McpToolOptions& options) {
+    info.options = options;
+    McpToolExecution execution = options.execution;
+    if (info.streamingHandler) {
+        // 流式输出不经过结果缓存与合并，也没有结构化结果；写入会等待连接写出，不能在 IO 调度器上执行
+        info.options.cacheTtl = std::chrono::milliseconds(0);
+        info.options.coalesce = false;
+        info.options.outputSchema.clear();
+        if (execution == McpToolExecution::Inline) {
+            execution = McpToolExecution::Compute;
+        }
+    }
+    if (!info.options.outputSchema.empty()) {
+        info.tool.outputSchema = info.options.outputSchema;
+    }
+
+    // 协程处理函数总是在 IO 调度器上执行，execution 只对同步与流式处理函数生效
+    if (info.blockingHandler || info.streamingHandler) {
+        if (execution == McpToolExecution::Compute) {
+            info.pool = sharedComputePool();
+        } else if (execution == McpToolExecution::Dedicated) {
+            info.pool = std::make_shared<McpComputePool>(1);
+        }
+    }
+    if (options.maxInFlight > 0) {
+        info.inFlight = std::make_shared<std::atomic<size_t>>(0);
+    }
+    if (options.maxConcurrency > 0) {
+        info.limiter = std::make_shared<McpAsyncSemaphore>(options.maxConcurrency);
+    }
+    // 每次注册取新的代次，替换后的工具不会命中旧实现的结果，也不会合并到旧实现的执行
+    if (info.options.cacheTtl.count() > 0 || info.options.coalesce) {
+        info.cacheScope = m_resultCache.newScope(info.tool.name);
+    }
+}
+
+std::shared_ptr<McpComputePool> McpHttpServer::sharedComputePool() {
+    // 运行期间也可能注册 Compute 工具或流式资源，共享线程池的创建需要加锁
+    std::lock_guard<std::mutex> lock(m_computePoolMutex);
+    if (!m_computePool) {
+        m_computePool = std::make_shared<McpComputePool>(m_computeSchedulers);
+    }
+    return m_computePool;
 }
 
 void McpHttpServer::addResource(const std::string& uri,
                                  const std::string& name,
                                  const std::string& description,
                                  const std::string& mimeType,
-                                 McpHttpServer::ResourceReader reader) {
+                                 McpHttpServer::ResourceReader reader,
+                                 McpResourceOptions options) {
     Resource resource;
     resource.uri = uri;
     resource.name = name;
@@ -85,135 +395,1140 @@ void McpHttpServer::addResource(const std::string& uri,
 
     ResourceInfo info;
     info.resource = resource;
-    info.reader = reader;
+    info.reader = std::move(reader);
+    info.options = options;
+
+    m_resources.put(uri, std::move(info));
+    broadcastNotification(Methods::RESOURCES_LIST_CHANGED);
+}
+
+void McpHttpServer::addStreamingResource(const std::string& uri,
+                                         const std::string& name,
+                                         const std::string& description,
+                                         const std::string& mimeType,
+                                         McpHttpServer::StreamingResourceReader reader,
+                                         bool blob) {
+    ResourceInfo info;
+    info.resource.uri = uri;
+    info.resource.name = name;
+    info.resource.description = description;
+    info.resource.mimeType = mimeType;
+    info.streamingReader = std::move(reader);
+    info.blob = blob;
+    info.pool = sharedComputePool();
+
+    m_resources.put(uri, std::move(info));
+    broadcastNotification(Methods::RESOURCES_LIST_CHANGED);
+}
+
+void McpHttpServer::addPrompt(const std::string& name,
+                               const std::string& description,
+                               const std::vector<PromptArgument>& arguments,
+                               McpHttpServer::PromptGetter getter) {
+    Prompt prompt;
+    prompt.name = name;
+    prompt.description = description;
+    prompt.arguments = arguments;
+
+    PromptInfo info;
+    info.prompt = prompt;
+    info.getter = std::move(getter);
+
+    m_prompts.put(name, std::move(info));
+    broadcastNotification(Methods::PROMPTS_LIST_CHANGED);
+}
+
+size_t McpHttpServer::registerTools(std::vector<ToolDefinition> tools) {
+    if (tools.empty()) {
+        return 0;
+    }
+    std::vector<std::pair<std::string, ToolInfo>> items;
+    items.reserve(tools.size());
+    for (auto& definition : tools) {
+        ToolInfo info;
+        info.tool.name = definition.name;
+        info.tool.description = std::move(definition.description);
+        info.tool.inputSchema = std::move(definition.inputSchema);
+        info.handler = std::move(definition.handler);
+        info.blockingHandler = std::move(definition.blockingHandler);
+        info.streamingHandler = std::move(definition.streamingHandler);
+        applyToolOptions(info, definition.options);
+        items.emplace_back(std::move(definition.name), std::move(info));
+    }
+
+    const size_t added = m_tools.putAll(std::move(items));
+    broadcastNotification(Methods::TOOLS_LIST_CHANGED);
+    return added;
+}
+
+size_t McpHttpServer::registerResources(std::vector<ResourceDefinition> resources) {
+    if (resources.empty()) {
+        return 0;
+    }
+    std::vector<std::pair<std::string, ResourceInfo>> items;
+    items.reserve(resources.size());
+    for (auto& definition : resources) {
+        ResourceInfo info;
+        info.resource.uri = definition.uri;
+        info.resource.name = std::move(definition.name);
+        info.resource.description = std::move(definition.description);
+        info.resource.mimeType = std::move(definition.mimeType);
+        info.reader = std::move(definition.reader);
+        info.options = definition.options;
+        if (definition.streamingReader) {
+            info.streamingReader = std::move(definition.streamingReader);
+            info.blob = definition.blob;
+            info.pool = sharedComputePool();
+        }
+        items.emplace_back(std::move(definition.uri), std::move(info));
+    }
+
+    const size_t added = m_resources.putAll(std::move(items));
+    broadcastNotification(Methods::RESOURCES_LIST_CHANGED);
+    return added;
+}
+
+size_t McpHttpServer::registerPrompts(std::vector<PromptDefinition> prompts) {
+    if (prompts.empty()) {
+        return 0;
+    }
+    std::vector<std::pair<std::string, PromptInfo>> items;
+    items.reserve(prompts.size());
+    for (auto& definition : prompts) {
+        PromptInfo info;
+        info.prompt.name = definition.name;
+        info.prompt.description = std::move(definition.description);
+        info.prompt.arguments = std::move(definition.arguments);
+        info.getter = std::move(definition.getter);
+        items.emplace_back(std::move(definition.name), std::move(info));
+    }
+
+    const size_t added = m_prompts.putAll(std::move(items));
+    broadcastNotification(Methods::PROMPTS_LIST_CHANGED);
+    return added;
+}
+
+std::expected<size_t, McpError> McpHttpServer::loadManifest(std::shared_ptr<const McpManifest> manifest,
+                                                     const ManifestToolBinder& bindTool,
+                                                     const ManifestResourceBinder& bindResource) {
+    // 先取齐并检查全部绑定：applyToolOptions 会创建专用线程、推进持久化的缓存代次，
+    // 缺少绑定时必须在任何工具应用选项之前返回
+    std::vector<ToolBinding> bindings;
+    bindings.reserve(manifest->tools().size());
+    for (const auto& definition : manifest->tools()) {
+        ToolBinding binding = bindTool ? bindTool(definition) : ToolBinding{};
+        if (!binding.handler && !binding.blockingHandler && !binding.streamingHandler) {
+            return std::unexpected(McpError::invalidParams("no handler bound for tool " + definition.name));
+        }
+        bindings.push_back(std::move(binding));
+    }
+    std::vector<ResourceReader> readers;
+    readers.reserve(manifest->resources().size());
+    for (const auto& definition : manifest->resources()) {
+        ResourceReader reader = bindResource ? bindResource(definition) : nullptr;
+        if (!reader) {
+            return std::unexpected(McpError::invalidParams("no reader bound for resource " + definition.uri));
+        }
+        readers.push_back(std::move(reader));
+    }
+
+    std::vector<std::tuple<std::string, ToolInfo, std::string_view>> tools;
+    tools.reserve(bindings.size());
+    for (size_t i = 0; i < bindings.size(); ++i) {
+        const auto& definition = manifest->tools()[i];
+        ToolBinding& binding = bindings[i];
+        ToolInfo info;
+        info.handler = std::move(binding.handler);
+        info.blockingHandler = std::move(binding.blockingHandler);
+        info.streamingHandler = std::move(binding.streamingHandler);
+        info.tool.name = definition.name;
+        applyToolOptions(info, binding.options);
+        info.tool.description = definition.description;
+        if (!definition.outputSchema.empty() && !info.streamingHandler) {
+            info.tool.outputSchema.assign(definition.outputSchema);
+        }
+        info.manifest = manifest;
+        info.schema = definition.inputSchema;
+        tools.emplace_back(definition.name, std::move(info), definition.json);
+    }
+
+    std::vector<std::tuple<std::string, ResourceInfo, std::string_view>> resources;
+    resources.reserve(readers.size());
+    for (size_t i = 0; i < readers.size(); ++i) {
+        const auto& definition = manifest->resources()[i];
+        ResourceInfo info;
+        info.reader = std::move(readers[i]);
+        info.resource.uri = definition.uri;
+        info.resource.name = definition.name;
+        info.resource.description = definition.description;
+        info.resource.mimeType = definition.mimeType;
+        info.manifest = manifest;
+        resources.emplace_back(definition.uri, std::move(info), definition.json);
+    }
+
+    // 清单条目直接以映射中的字节作为列表 JSON
+    size_t added = 0;
+    if (!tools.empty()) {
+        added += m_tools.putAllSerialized(std::move(tools));
+        broadcastNotification(Methods::TOOLS_LIST_CHANGED);
+    }
+    if (!resources.empty()) {
+        added += m_resources.putAllSerialized(std::move(resources));
+        broadcastNotification(Methods::RESOURCES_LIST_CHANGED);
+    }
+    return added;
+}
+
+bool McpHttpServer::removeTool(const std::string& name) {
+    if (!m_tools.remove(name)) {
+        return false;
+    }
+    broadcastNotification(Methods::TOOLS_LIST_CHANGED);
+    return true;
+}
+
+bool McpHttpServer::removeResource(const std::string& uri) {
+    if (!m_resources.remove(uri)) {
+        return false;
+    }
+    broadcastNotification(Methods::RESOURCES_LIST_CHANGED);
+    return true;
+}
+
+bool McpHttpServer::removePrompt(const std::string& name) {
+    if (!m_prompts.remove(name)) {
+        return false;
+    }
+    broadcastNotification(Methods::PROMPTS_LIST_CHANGED);
+    return true;
+}
+
+void McpHttpServer::setListPageSize(size_t pageSize) {
+    m_tools.setPageSize(pageSize);
+    m_resources.setPageSize(pageSize);
+    m_prompts.setPageSize(pageSize);
+}
+
+void McpHttpServer::setAdmissionOptions(const McpAdmissionOptions& options) {
+    m_admission.setOptions(options);
+}
+
+void McpHttpServer::setSessionOptions(const McpSessionOptions& options) {
+    m_sessions.setOptions(options);
+}
+
+size_t McpHttpServer::broadcastNotification(const std::string& method, const JsonString& params) {
+    JsonRpcNotification notification;
+    notification.method = method;
+    if (!params.empty()) {
+        notification.params = params;
+    }
+    const JsonString message = notification.toJson();
+
+    size_t delivered = 0;
+    m_sessions.forEach([&](McpSession& session) {
+        session.events().append(message);
+        ++delivered;
+    });
+    return delivered;
+}
+
+size_t McpHttpServer::notifyResourceUpdated(const std::string& uri) {
+    JsonWriter paramsWriter;
+    paramsWriter.StartObject();
+    paramsWriter.Key("uri");
+    paramsWriter.String(uri);
+    paramsWriter.EndObject();
+
+    JsonRpcNotification notification;
+    notification.method = Methods::RESOURCE_UPDATED;
+    notification.params = paramsWriter.TakeString();
+    const JsonString message = notification.toJson();
+
+    size_t delivered = 0;
+    m_sessions.forEach([&](McpSession& session) {
+        if (session.isSubscribed(uri)) {
+            session.events().append(message);
+            ++delivered;
+        }
+    });
+    return delivered;
+}
+
+size_t McpHttpServer::sessionCount() const {
+    return m_sessions.size();
+}
+
+McpSessionStats McpHttpServer::sessionStats() const {
+    return m_sessions.stats();
+}
+
+JsonString McpHttpServer::takeSessionEvents(McpSession& session, uint64_t& cursor) const {
+    JsonString wireBytes;
+    for (const McpReplayedEvent& event : session.events().since(cursor)) {
+        AppendEventChunk(wireBytes, event.message, std::to_string(event.id));
+        cursor = event.id;
+    }
+    return wireBytes;
+}
+
+Coroutine McpHttpServer::serveEventStream(http::HttpConn& conn, std::string sessionId, std::string lastEventId) {
+    auto writer = conn.getWriter();
+    std::shared_ptr<McpSession> session = m_sessions.find(sessionId);
+    JsonString wireBytes;
+    if (!session) {
+        wireBytes = buildStatusResponse(sessionId.empty() ? 400 : 404,
+                                        sessionId.empty() ? "Bad Request" : "Not Found");
+        while (true) {
+            auto send_result = co_await writer.send(std::move(wireBytes));
+            if (!send_result || send_result.value()) {
+                break;
+            }
+        }
+        co_return;
+    }
+
+    // 未给出 Last-Event-ID 时只发送连接之后产生的事件
+    uint64_t cursor = session->events().lastEventId();
+    if (auto resumed = sse::parseEventId(lastEventId)) {
+        cursor = *resumed;
+    }
+
+    wireBytes = buildEventStreamHead();
+    auto lastWrite = std::chrono::steady_clock::now();
+    while (m_running.load(std::memory_order_relaxed) && !session->closed()) {
+        wireBytes += takeSessionEvents(*session, cursor);
+        const auto now = std::chrono::steady_clock::now();
+        // 打开的事件流让会话保持活跃
+        session->touch(now);
+        if (wireBytes.empty() && now - lastWrite >= kEventStreamHeartbeat) {
+            sse::appendChunk(wireBytes, ": keep-alive\n\n");
+        }
+        if (!wireBytes.empty()) {
+            bool sent = false;
+            while (true) {
+                auto send_result = co_await writer.send(std::move(wireBytes));
+                if (!send_result) {
+                    break;
+                }
+                if (send_result.value()) {
+                    sent = true;
+                    break;
+                }
+            }
+            if (!sent) {
+                co_return;
+            }
+            wireBytes.clear();
+            lastWrite = now;
+        }
+        co_await kernel::sleep(kEventStreamPollInterval);
+    }
+
+    wireBytes = JsonString(sse::LAST_CHUNK);
+    while (true) {
+        auto send_result = co_await writer.send(std::move(wireBytes));
+        if (!send_result || send_result.value()) {
+            break;
+        }
+    }
+}
+
+void McpHttpServer::serveUnixEventStream(McpUnixSocket& socket, const McpUnixHttpMessage& message) {
+    const std::string_view sessionId = message.header("Mcp-Session-Id");
+    std::shared_ptr<McpSession> session = m_sessions.find(sessionId);
+    if (!session) {
+        socket.writeAll(sessionId.empty() ? buildStatusResponse(400, "Bad Request")
+                                          : buildStatusResponse(404, "Not Found"));
+        return;
+    }
+
+    uint64_t cursor = session->events().lastEventId();
+    if (auto resumed = sse::parseEventId(message.header("Last-Event-ID"))) {
+        cursor = *resumed;
+    }
+    if (!socket.writeAll(buildEventStreamHead())) {
+        return;
+    }
+
+    auto lastWrite = std::chrono::steady_clock::now();
+    while (m_running.load(std::memory_order_relaxed) && !session->closed()) {
+        if (socket.peerClosed()) {
+            return;
+        }
+        JsonString wireBytes = takeSessionEvents(*session, cursor);
+        const auto now = std::chrono::steady_clock::now();
+        session->touch(now);
+        if (wireBytes.empty() && now - lastWrite >= kEventStreamHeartbeat) {
+            sse::appendChunk(wireBytes, ": keep-alive\n\n");
+        }
+        if (!wireBytes.empty()) {
+            if (!socket.writeAll(wireBytes)) {
+                return;
+            }
+            lastWrite = now;
+        }
+        std::this_thread::sleep_for(kEventStreamPollInterval);
+    }
+    socket.writeAll(sse::LAST_CHUNK);
+}
+
+void McpHttpServer::setProgressInterval(std::chrono::milliseconds interval) {
+    m_progressInterval = interval;
+}
+
+void McpHttpServer::setUnixConnectionLimit(size_t maxConnections) {
+    m_unixMaxConnections = maxConnections;
+}
+
+McpAdmissionStats McpHttpServer::admissionStats() const {
+    return m_admission.stats();
+}
+
+std::optional<McpSemaphoreStats> McpHttpServer::toolConcurrencyStats(const std::string& name) const {
+    auto tools = m_tools.snapshot();
+    const ToolInfo* info = tools->find(name);
+    if (!info || !info->limiter) {
+        return std::nullopt;
+    }
+    return info->limiter->stats();
+}
+
+std::expected<void, McpError> McpHttpServer::setResultCacheOptions(const McpResultCacheOptions& options) {
+    return m_resultCache.setOptions(options);
+}
+
+McpResultCacheStats McpHttpServer::resultCacheStats() const {
+    return m_resultCache.stats();
+}
+
+McpSingleFlightStats McpHttpServer::toolCoalescingStats() const {
+    return m_toolFlights.stats();
+}
+
+McpSingleFlightStats McpHttpServer::resourceCoalescingStats() const {
+    return m_resourceFlights.stats();
+}
+
+void McpHttpServer::start() {
+    if (m_running) {
+        return;
+    }
+
+    if (McpUnixSocket::isUnixAddress(m_host)) {
+        startUnix();
+        return;
+    }
+
+    m_router = std::make_unique<http::HttpRouter>();
+
+    auto* serverPtr = this;
+    m_router->addHandler<http::HttpMethod::POST>("/mcp",
+        [serverPtr](http::HttpConn& conn, http::HttpRequest req) -> Coroutine {
+            // 不带 Mcp-Session-Id 的请求按连接记录初始化状态
+            bool connectionInitialized = false;
+
+            // 处理第一个请求
+            co_await serverPtr->handlePost(conn, req, connectionInitialized);
+
+            // Keep-Alive: 循环处理后续请求，直到连接关闭
+            auto reader = conn.getReader();
+            while (true) {
+                http::HttpRequest nextReq;
+                while (true) {
+                    auto result = co_await reader.getRequest(nextReq);
+                    if (!result) {
+                        // 连接关闭或出错
+                        co_await conn.close();
+                        co_return;
+                    }
+                    if (result.value()) {
+                        // 请求完整
+                        break;
+                    }
+                    // 请求不完整，继续读取
+                }
+
+                co_await serverPtr->handlePost(conn, nextReq, connectionInitialized);
+            }
+        });
+
+    // 会话事件流：服务端主动发送的消息，断线后按 Last-Event-ID 续传
+    m_router->addHandler<http::HttpMethod::GET>("/mcp",
+        [serverPtr](http::HttpConn& conn, http::HttpRequest req) -> Coroutine {
+            co_await serverPtr->serveEventStream(conn,
+                                                 req.header().headerPairsValue("Mcp-Session-Id"),
+                                                 req.header().headerPairsValue("Last-Event-ID"));
+            co_await conn.close();
+        });
+
+    m_router->addHandler<http::HttpMethod::DELETE>("/mcp",
+        [serverPtr](http::HttpConn& conn, http::HttpRequest req) -> Coroutine {
+            const bool closed = serverPtr->m_sessions.close(req.header().headerPairsValue("Mcp-Session-Id"));
+            JsonString wireBytes = closed ? serverPtr->buildStatusResponse(200, "OK")
+                                          : serverPtr->buildStatusResponse(404, "Not Found");
+            auto writer = conn.getWriter();
+            while (true) {
+                auto send_result = co_await writer.send(std::move(wireBytes));
+                if (!send_result || send_result.value()) {
+                    break;
+                }
+            }
+            co_await conn.close();
+        });
+
+    http::HttpServerConfig config;
+    config.host = m_host;
+    config.port = static_cast<uint16_t>(m_port);
+    config.backlog = 128;
+    config.io_scheduler_count = m_ioSchedulers;
+    config.compute_scheduler_count = m_computeSchedulers;
+
+    m_httpServer = std::make_unique<http::HttpServer>(config);
+    m_running = true;
+    m_httpServer->start(std::move(*m_router));
+
+    while (m_running) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+}
+
+void McpHttpServer::stop() {
+    m_running = false;
+    // 结束所有会话，打开的事件流随之结束
+    m_sessions.clear();
+    // 仅唤醒 accept；连接回收由 startUnix() 完成（stop() 可能在信号处理函数中被调用）
+    m_unixListener.shutdown();
+}
+
+void McpHttpServer::startUnix() {
+    auto listener = McpUnixSocket::listen(McpUnixSocket::socketPath(m_host), 128);
+    if (!listener) {
+        throw std::runtime_error(listener.error().toString());
+    }
+
+    // 处理函数仍是协程，由独立的运行时调度；连接线程只负责阻塞读写
+    m_unixRuntime.reset(new kernel::Runtime(kernel::RuntimeBuilder()
+        .ioSchedulerCount(m_ioSchedulers)
+        .computeSchedulerCount(m_computeSchedulers)
+        .build()));
+    m_unixRuntime->start();
+    m_unixListener = std::move(listener.value());
+    m_running = true;
+
+    while (m_running) {
+        joinUnixConnections(false);
+        {
+            // 达到连接上限时暂停 accept；stop() 可能在信号处理函数中调用、不会通知条件变量，按间隔复查
+            std::unique_lock<std::mutex> lock(m_unixMutex);
+            while (m_running && m_unixMaxConnections != 0 && m_unixActiveConnections >= m_unixMaxConnections) {
+                m_unixDrained.wait_for(lock, std::chrono::milliseconds(10));
+            }
+        }
+        if (!m_running) {
+            break;
+        }
+
+        auto accepted = m_unixListener.accept();
+        if (!accepted) {
+            if (accepted.error().code() == McpErrorCode::ConnectionClosed) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(m_unixMutex);
+        const uint64_t serial = m_unixNextSerial++;
+        m_unixConnections.insert(accepted.value().fd());
+        ++m_unixActiveConnections;
+        m_unixThreads.emplace(serial, std::thread(&McpHttpServer::serveUnixConnection, this,
+                                                  std::move(accepted.value()), serial));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_unixMutex);
+        for (int fd : m_unixConnections) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+    }
+    joinUnixConnections(true);
+
+    m_unixListener.close();
+    m_unixRuntime->stop();
+    m_unixRuntime.reset();
+}
+
+void McpHttpServer::joinUnixConnections(bool all) {
+    std::vector<std::thread> finished;
+    {
+        std::unique_lock<std::mutex> lock(m_unixMutex);
+        if (all) {
+            m_unixDrained.wait(lock, [this]() { return m_unixActiveConnections == 0; });
+        }
+        for (uint64_t serial : m_unixFinished) {
+            auto it = m_unixThreads.find(serial);
+            if (it != m_unixThreads.end()) {
+                finished.push_back(std::move(it->second));
+                m_unixThreads.erase(it);
+            }
+        }
+        m_unixFinished.clear();
+    }
+    // 线程登记结束后只剩返回，join 不会长时间阻塞
+    for (auto& thread : finished) {
+        thread.join();
+    }
+}
+
+void McpHttpServer::serveUnixConnection(McpUnixSocket socket, uint64_t serial) {
+    bool connectionInitialized = false;
+
+    // Keep-Alive: 循环处理同一连接上的请求，直到对端关闭或请求 Connection: close
+    while (true) {
+        auto message = socket.readHttpMessage();
+        if (!message) {
+            break;
+        }
+
+        const McpRoute route = ParseRoute(message.value().startLine);
+        if (route == McpRoute::Get) {
+            // 事件流占用该连接直到结束
+            serveUnixEventStream(socket, message.value());
+            break;
+        }
+        if (route == McpRoute::Delete) {
+            const bool closed = m_sessions.close(message.value().header("Mcp-Session-Id"));
+            socket.writeAll(closed ? buildStatusResponse(200, "OK") : buildStatusResponse(404, "Not Found"));
+            break;
+        }
+        if (route != McpRoute::Post) {
+            socket.writeAll(buildStatusResponse(404, "Not Found"));
+            break;
+        }
+
+        const std::string_view sessionId = message.value().header("Mcp-Session-Id");
+        std::shared_ptr<McpSession> session = m_sessions.find(sessionId);
+        if (!sessionId.empty() && !session) {
+            if (!socket.writeAll(buildStatusResponse(404, "Not Found", true))) {
+                break;
+            }
+            continue;
+        }
+
+        const bool streamable = sse::isEventStream(message.value().header("Accept"));
+        EventStream stream;
+        std::mutex writeMutex;
+        RequestScope scope;
+        scope.session = std::move(session);
+        scope.connection = socket.fd();
+        scope.stream = streamable ? &stream : nullptr;
+        scope.socket = &socket;
+        scope.socketMutex = &writeMutex;
+        JsonString responseJson;
+        std::promise<void> done;
+        auto finished = done.get_future();
+        // 处理协程结束或产生进度事件时唤醒本线程；间隔只用于检查对端是否关闭
+        auto wake = McpWakeSignal::create();
+        if (streamable) {
+            stream.setWake(wake);
+        }
+        auto* scheduler = m_unixRuntime->getNextIOScheduler();
+        if (scheduler &&
+            McpSchedulerExecutor::of(scheduler)->spawn(processUnixRequest(message.value().body, responseJson,
+                                                                          connectionInitialized, scope, done, wake))) {
+            // 等待期间对端关闭连接则取消该连接上进行中的调用，并写出已产生的进度事件
+            bool peerClosed = false;
+            McpWakeSignal::Clock::time_point progressAt{};
+            while (finished.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                // 合并中的进度没有事件方，按进度间隔定时唤醒
+                const auto now = McpWakeSignal::Clock::now();
+                if (streamable && now >= progressAt && stream.hasProgress()) {
+                    progressAt = now + m_progressInterval;
+                    McpWakeSignal::notifyAt(wake, progressAt);
+                }
+                wake->blockFor(kPeerCheckInterval);
+                if (finished.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+                    break;
+                }
+                if (!peerClosed && socket.peerClosed()) {
+                    peerClosed = true;
+                    m_inflight.cancelConnection(socket.fd());
+                }
+                if (streamable && !peerClosed) {
+                    // 流式响应开始后由处理协程独占写出
+                    std::lock_guard<std::mutex> lock(writeMutex);
+                    if (!scope.streamed) {
+                        stream.flushDue();
+                        const JsonString events = drainEventStream(stream, nullptr);
+                        if (!events.empty()) {
+                            socket.writeAll(events);
+                        }
+                    }
+                }
+            }
+        } else {
+            responseJson = createErrorResponse(0, ErrorCodes::INTERNAL_ERROR,
+                                               "Internal error", "Failed to schedule request");
+        }
+
+        if (scope.streamed) {
+            if (!message.value().keepAlive) {
+                break;
+            }
+            continue;
+        }
+        const JsonString wireBytes = streamable ? drainEventStream(stream, &responseJson)
+                                                : buildHttpResponse(responseJson, scope.issuedSessionId);
+        if (!socket.writeAll(wireBytes) || !message.value().keepAlive) {
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_unixMutex);
+    m_unixConnections.erase(socket.fd());
+    socket.close();
+    --m_unixActiveConnections;
+    m_unixFinished.push_back(serial);
+    m_unixDrained.notify_all();
+}
+
+Coroutine McpHttpServer::processUnixRequest(const std::string& requestBody,
+                                            JsonString& responseJson,
+                                            bool& connectionInitialized,
+                                            RequestScope& scope,
+                                            std::promise<void>& done,
+                                            std::shared_ptr<McpWakeSignal> wake) {
+    try {
+        co_await processRequest(requestBody, responseJson, connectionInitialized, scope);
+    } catch (const std::exception& e) {
+        responseJson = createErrorResponse(0, ErrorCodes::PARSE_ERROR, "Parse error", e.what());
+    }
+    // 连接线程可能在 set_value() 之后立即离开本轮，wake 由协程帧持有
+    done.set_value();
+    wake->notify();
+    co_return;
+}
+
+bool McpHttpServer::isRunning() const {
+    return m_running;
+}
+
+InitializeResult McpHttpServer::localInitialize() {
+    return protocol::makeInitializeResult(
+        m_serverName,
+        m_serverVersion,
+        !m_tools.snapshot()->empty(),
+        !m_resources.snapshot()->empty(),
+        !m_prompts.snapshot()->empty());
+}
+
+std::vector<Tool> McpHttpServer::localListTools() {
+    auto tools = m_tools.snapshot();
+    std::vector<Tool> result;
+    result.reserve(tools->size());
+    tools->forEach([&result](const auto& entry) {
+        result.push_back(entry.info.tool);
+        if (entry.info.manifest) {
+            result.back().inputSchema.assign(entry.info.schema);
+        }
+    });
+    return result;
+}
+
+std::vector<Resource> McpHttpServer::localListResources() {
+    auto resources = m_resources.snapshot();
+    std::vector<Resource> result;
+    result.reserve(resources->size());
+    resources->forEach([&result](const auto& entry) { result.push_back(entry.info.resource); });
+    return result;
+}
+
+std::vector<Prompt> McpHttpServer::localListPrompts() {
+    auto prompts = m_prompts.snapshot();
+    std::vector<Prompt> result;
+    result.reserve(prompts->size());
+    prompts->forEach([&result](const auto& entry) { result.push_back(entry.info.prompt); });
+    return result;
+}
+
+std::expected<JsonString, McpError> McpHttpServer::localCallTool(const std::string& name,
+                                                                 const JsonElement& arguments) {
+    auto tools = m_tools.snapshot();
+    const ToolInfo* info = tools->find(name);
+    if (!info) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::METHOD_NOT_FOUND, "Tool not found", name));
+    }
+
+    const McpToolContext context;
+    if (info->streamingHandler) {
+        // 流式处理函数直接在调用线程上执行，输出收集为完整文本
+        McpAsyncSemaphore::Permit permit;
+        if (info->limiter) {
+            permit = info->limiter->acquire();
+            auto wake = McpWakeSignal::create();
+            permit.wakeOnReady(wake);
+            while (!permit.ready()) {
+                wake->block();
+            }
+        }
+        auto output = CollectStreamed([&](McpContentWriter& writer) {
+            return info->streamingHandler(arguments, context, writer);
+        });
+        if (!output) {
+            return std::unexpected(protocol::makeClientError(output.error()));
+        }
+        return output;
+    }
+
+    std::expected<JsonString, McpError> result;
+    auto ran = runLocal([&]() { return invokeTool(*info, arguments, context, result); });
+    if (!ran) {
+        return std::unexpected(ran.error());
+    }
+    if (!result) {
+        return std::unexpected(protocol::makeClientError(result.error()));
+    }
+    return result;
+}
+
+std::expected<std::string, McpError> McpHttpServer::localReadResource(const std::string& uri) {
+    auto resources = m_resources.snapshot();
+    const ResourceInfo* info = resources->find(uri);
+    if (!info) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::METHOD_NOT_FOUND, "Resource not found", uri));
+    }
+
+    if (info->streamingReader) {
+        // 流式读取函数直接在调用线程上执行，返回原始字节，二进制内容不做 base64 编码
+        auto output = CollectStreamed([&](McpContentWriter& writer) { return info->streamingReader(uri, writer); });
+        if (!output) {
+            return std::unexpected(protocol::makeClientError(output.error()));
+        }
+        return output;
+    }
+
+    const McpHttpServer::ResourceReader& reader = info->reader;
+    std::expected<std::string, McpError> result;
+    auto ran = runLocal([&]() { return reader(uri, result); });
+    if (!ran) {
+        return std::unexpected(ran.error());
+    }
+    if (!result) {
+        return std::unexpected(protocol::makeClientError(result.error()));
+    }
+    return result;
+}
+
+std::expected<JsonString, McpError> McpHttpServer::localGetPrompt(const std::string& name,
+                                                                  const JsonElement& arguments) {
+    auto prompts = m_prompts.snapshot();
+    const PromptInfo* info = prompts->find(name);
+    if (!info) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::METHOD_NOT_FOUND, "Prompt not found", name));
+    }
+
+    const McpHttpServer::PromptGetter& getter = info->getter;
+    std::expected<JsonString, McpError> result;
+    auto ran = runLocal([&]() { return getter(name, arguments, result); });
+    if (!ran) {
+        return std::unexpected(ran.error());
+    }
+    if (!result) {
+        return std::unexpected(protocol::makeClientError(result.error()));
+    }
+    return result;
+}
+
+std::expected<void, McpError> McpHttpServer::runLocal(const std::function<Coroutine()>& body) {
+    kernel::Runtime* runtime;
+    {
+        std::lock_guard<std::mutex> lock(m_localMutex);
+        if (!m_localRuntime) {
+            m_localRuntime.reset(new kernel::Runtime(kernel::RuntimeBuilder()
+                .ioSchedulerCount(1)
+                .computeSchedulerCount(m_computeSchedulers)
+                .build()));
+            m_localRuntime->start();
+        }
+        runtime = m_localRuntime.get();
+    }
+
+    std::promise<void> done;
+    auto finished = done.get_future();
+    auto* scheduler = runtime->getNextIOScheduler();
+    if (!scheduler || !McpSchedulerExecutor::of(scheduler)->spawn(runLocalTask(body, done))) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::INTERNAL_ERROR, "Internal error",
+                                                         "Failed to schedule request"));
+    }
+
+    try {
+        finished.get();
+    } catch (const std::exception& e) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::INTERNAL_ERROR, "Internal error", e.what()));
+    }
+    return {};
+}
+
+Coroutine McpHttpServer::runLocalTask(const std::function<Coroutine()>& body, std::promise<void>& done) {
+    try {
+        co_await body();
+    } catch (...) {
+        done.set_exception(std::current_exception());
+        co_return;
+    }
+    done.set_value();
+    co_return;
+}
+
+Coroutine McpHttpServer::handlePost(http::HttpConn& conn, http::HttpRequest& req, bool& connectionInitialized) {
+    const std::string sessionId = req.header().headerPairsValue("Mcp-Session-Id");
+    std::shared_ptr<McpSession> session = m_sessions.find(sessionId);
+    if (!sessionId.empty() && !session) {
+        // 会话已结束（DELETE、空闲过期或服务器重启），客户端需要重新 initialize
+        JsonString wireBytes = buildStatusResponse(404, "Not Found", true);
+        auto writer = conn.getWriter();
+        while (true) {
+            auto send_result = co_await writer.send(std::move(wireBytes));
+            if (!send_result || send_result.value()) {
+                break;
+            }
+        }
+        co_return;
+    }
+
+    const std::string& requestBody = req.bodyStr();
+    const bool streamable = sse::isEventStream(req.header().headerPairsValue("Accept"));
+    EventStream stream;
+    RequestScope scope;
+    scope.session = std::move(session);
+    scope.stream = streamable ? &stream : nullptr;
+    scope.conn = &conn;
+
+    JsonString responseJson;
+    try {
+        co_await processRequest(requestBody, responseJson, connectionInitialized, scope);
+    } catch (const std::exception& e) {
+        responseJson = createErrorResponse(0, ErrorCodes::PARSE_ERROR, "Parse error", e.what());
+    }
+    if (scope.streamed) {
+        co_return;
+    }
+    if (streamable) {
+        co_await sendEvents(conn, stream, &responseJson);
+    } else {
+        co_await sendJsonResponse(conn, responseJson, scope.issuedSessionId);
+    }
+}
+
+Coroutine McpHttpServer::sendJsonResponse(http::HttpConn& conn,
+                                          const JsonString& responseJson,
+                                          std::string_view sessionId) {
+    JsonString wireBytes = buildHttpResponse(responseJson, sessionId);
+
+    auto writer = conn.getWriter();
+    while (true) {
+        auto send_result = co_await writer.send(std::move(wireBytes));
+        if (!send_result || send_result.value()) {
+            break;
+        }
+    }
+    co_return;
+}
+
+void McpHttpServer::EventStream::push(JsonString message) {
+    std::shared_ptr<McpWakeSignal> wake;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.push_back(std::move(message));
+        wake = m_wake;
+    }
+    if (wake) {
+        wake->notify();
+    }
+}
 
-    m_resources[uri] = info;
-    m_resourcesCacheDirty = true;
+std::deque<JsonString> McpHttpServer::EventStream::take() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::exchange(m_pending, {});
 }
 
-void McpHttpServer::addPrompt(const std::string& name,
-                               const std::string& description,
-                               const std::vector<PromptArgument>& arguments,
-                               McpHttpServer::PromptGetter getter) {
-    Prompt prompt;
-    prompt.name = name;
-    prompt.description = description;
-    prompt.arguments = arguments;
+void McpHttpServer::EventStream::setProgress(McpProgressReporter progress) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_progress = std::move(progress);
+}
 
-    PromptInfo info;
-    info.prompt = prompt;
-    info.getter = getter;
+bool McpHttpServer::EventStream::hasProgress() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_progress.active();
+}
 
-    m_prompts[name] = info;
-    m_promptsCacheDirty = true;
+void McpHttpServer::EventStream::setWake(std::shared_ptr<McpWakeSignal> wake) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_wake = std::move(wake);
 }
 
-void McpHttpServer::start() {
-    if (m_running) {
-        return;
+void McpHttpServer::EventStream::flushDue() {
+    McpProgressReporter progress;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        progress = m_progress;
     }
+    // 输出函数会再次进入 push()，不能持锁调用
+    progress.flushDue();
+}
 
-    m_router = std::make_unique<http::HttpRouter>();
-
-    auto* serverPtr = this;
-    m_router->addHandler<http::HttpMethod::POST>("/mcp",
-        [serverPtr](http::HttpConn& conn, http::HttpRequest req) -> Coroutine {
-            // 每个连接独立的初始化状态（若已有全局初始化则允许短连接复用）
-            bool connectionInitialized = false;
+JsonString McpHttpServer::drainEventStream(EventStream& stream, const JsonString* finalResponse) const {
+    std::deque<JsonString> events = stream.take();
+    if (!stream.started) {
+        if (events.empty()) {
+            return finalResponse ? buildHttpResponse(*finalResponse) : JsonString();
+        }
+    }
 
-            // 处理第一个请求
-            {
-                const std::string& requestBody = req.bodyStr();
-                JsonString responseJson;
-                try {
-                    co_await serverPtr->processRequest(requestBody, responseJson, connectionInitialized);
-                } catch (const std::exception& e) {
-                    responseJson = serverPtr->createErrorResponse(0, ErrorCodes::PARSE_ERROR,
-                                                      "Parse error", e.what());
-                }
-                co_await serverPtr->sendJsonResponse(conn, responseJson);
-            }
+    JsonString wireBytes;
+    if (!stream.started) {
+        stream.started = true;
+        wireBytes += buildEventStreamHead();
+    }
+    for (const JsonString& event : events) {
+        AppendEventChunk(wireBytes, event);
+    }
+    if (finalResponse) {
+        AppendEventChunk(wireBytes, *finalResponse);
+        wireBytes += sse::LAST_CHUNK;
+    }
+    return wireBytes;
+}
 
-            // Keep-Alive: 循环处理后续请求，直到连接关闭
-            auto reader = conn.getReader();
-            while (true) {
-                http::HttpRequest nextReq;
-                while (true) {
-                    auto result = co_await reader.getRequest(nextReq);
-                    if (!result) {
-                        // 连接关闭或出错
-                        co_await conn.close();
-                        co_return;
-                    }
-                    if (result.value()) {
-                        // 请求完整
-                        break;
-                    }
-                    // 请求不完整，继续读取
-                }
+Coroutine McpHttpServer::sendEvents(http::HttpConn& conn, EventStream& stream, const JsonString* finalResponse) {
+    JsonString wireBytes = drainEventStream(stream, finalResponse);
+    if (wireBytes.empty()) {
+        co_return;
+    }
 
-                const std::string& requestBody = nextReq.bodyStr();
+    auto writer = conn.getWriter();
+    while (true) {
+        auto send_result = co_await writer.send(std::move(wireBytes));
+        if (!send_result || send_result.value()) {
+            break;
+        }
+    }
+    co_return;
+}
 
-                JsonString responseJson;
-                try {
-                    co_await serverPtr->processRequest(requestBody, responseJson, connectionInitialized);
-                } catch (const std::exception& e) {
-                    responseJson = serverPtr->createErrorResponse(0, ErrorCodes::PARSE_ERROR,
-                                                      "Parse error", e.what());
-                }
-                co_await serverPtr->sendJsonResponse(conn, responseJson);
-            }
-        });
+JsonString McpHttpServer::buildEventStreamHead() const {
+    JsonString head = "HTTP/1.1 200 OK\r\nServer: ";
+    head += m_serverName + "/" + m_serverVersion;
+    head += "\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+            "Connection: keep-alive\r\nTransfer-Encoding: chunked\r\n\r\n";
+    return head;
+}
 
-    http::HttpServerConfig config;
-    config.host = m_host;
-    config.port = static_cast<uint16_t>(m_port);
-    config.backlog = 128;
-    config.io_scheduler_count = m_ioSchedulers;
-    config.compute_scheduler_count = m_computeSchedulers;
+JsonString McpHttpServer::buildChunkedJsonHead() const {
+    JsonString head = "HTTP/1.1 200 OK\r\nServer: ";
+    head += m_serverName + "/" + m_serverVersion;
+    head += "\r\nContent-Type: application/json\r\nConnection: keep-alive\r\nTransfer-Encoding: chunked\r\n\r\n";
+    return head;
+}
 
-    m_httpServer = std::make_unique<http::HttpServer>(config);
-    m_running = true;
-    m_httpServer->start(std::move(*m_router));
+Coroutine McpHttpServer::writeStreamed(RequestScope& scope, JsonString payload, bool begin, bool end, bool& ok) {
+    // Unix 域套接字上连接线程也会写出进度事件：标记 streamed 与写出在同一把锁内完成
+    std::unique_lock<std::mutex> lock;
+    if (scope.socketMutex) {
+        lock = std::unique_lock<std::mutex>(*scope.socketMutex);
+    }
 
-    while (m_running) {
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+    JsonString wireBytes;
+    if (begin) {
+        scope.streamed = true;
+        if (scope.stream) {
+            wireBytes = drainEventStream(*scope.stream, nullptr);
+            if (!scope.stream->started) {
+                scope.stream->started = true;
+                wireBytes += buildEventStreamHead();
+            }
+        } else {
+            wireBytes = buildChunkedJsonHead();
+        }
+    }
+    sse::appendChunk(wireBytes, payload);
+    if (end) {
+        wireBytes += sse::LAST_CHUNK;
     }
-}
 
-void McpHttpServer::stop() {
-    m_running = false;
-    m_initialized = false;
+    if (scope.socket) {
+        ok = scope.socket->writeAll(wireBytes).has_value();
+        co_return;
+    }
+    if (!scope.conn) {
+        ok = false;
+        co_return;
+    }
+    auto writer = scope.conn->getWriter();
+    while (true) {
+        auto send_result = co_await writer.send(std::move(wireBytes));
+        if (!send_result) {
+            ok = false;
+            break;
+        }
+        if (send_result.value()) {
+            break;
+        }
+    }
+    co_return;
 }
 
-bool McpHttpServer::isRunning() const {
-    return m_running;
+JsonString McpHttpServer::buildStatusResponse(int code, std::string_view reason, bool keepAlive) const {
+    JsonString wireBytes = "HTTP/1.1 " + std::to_string(code) + " ";
+    wireBytes += reason;
+    wireBytes += "\r\nServer: ";
+    wireBytes += m_serverName + "/" + m_serverVersion;
+    wireBytes += keepAlive ? "\r\nConnection: keep-alive" : "\r\nConnection: close";
+    wireBytes += "\r\nContent-Length: 0\r\n\r\n";
+    return wireBytes;
 }
 
-Coroutine McpHttpServer::sendJsonResponse(http::HttpConn& conn, const JsonString& responseJson) {
+JsonString McpHttpServer::buildHttpResponse(const JsonString& responseJson, std::string_view sessionId) const {
     JsonString wireBytes;
     const std::string serverHeader = m_serverName + "/" + m_serverVersion;
     const std::string contentLength = std::to_string(responseJson.size());
-    wireBytes.reserve(serverHeader.size() + contentLength.size() + responseJson.size() + 96);
+    wireBytes.reserve(serverHeader.size() + contentLength.size() + responseJson.size() + sessionId.size() + 128);
     wireBytes += "HTTP/1.1 200 OK\r\n";
     wireBytes += "Server: ";
     wireBytes += serverHeader;
+    if (!sessionId.empty()) {
+        wireBytes += "\r\nMcp-Session-Id: ";
+        wireBytes += sessionId;
+    }
     wireBytes += "\r\nContent-Type: application/json\r\nConnection: keep-alive\r\nContent-Length: ";
     wireBytes += contentLength;
     wireBytes += "\r\n\r\n";
     wireBytes += responseJson;
+    return wireBytes;
+}
 
-    auto writer = conn.getWriter();
-    while (true) {
-        auto send_result = co_await writer.send(std::move(wireBytes));
-        if (!send_result || send_result.value()) {
-            break;
-        }
+Coroutine McpHttpServer::processRequest(const std::string& requestBody,
+                                        JsonString& responseJson,
+                                        bool& connectionInitialized,
+                                        RequestScope& scope) {
+    const auto arrival = McpAdmissionController::Clock::now();
+    const McpAdmissionDecision decision = m_admission.tryAdmit(arrival);
+    if (decision == McpAdmissionDecision::ShedInFlight) {
+        responseJson = createOverloadedResponse(requestBody, "Too many in-flight requests");
+        co_return;
+    }
+    if (decision == McpAdmissionDecision::ShedQueueDelay) {
+        responseJson = createOverloadedResponse(requestBody, "Queue delay above target");
+        co_return;
+    }
+    AdmissionGuard admissionGuard(m_admission);
+    if (scope.session && !scope.session->tryAcquire(arrival)) {
+        m_sessions.recordRateLimited();
+        responseJson = createOverloadedResponse(requestBody, "Session rate limit exceeded");
+        co_return;
     }
-    co_return;
-}
 
-Coroutine McpHttpServer::processRequest(const std::string& requestBody, JsonString& responseJson, bool& connectionInitialized) {
     try {
         auto parsed = parseJsonRpcRequest(requestBody);
         if (!parsed) {
@@ -226,23 +1541,30 @@ Coroutine McpHttpServer::processRequest(const std::string& requestBody, JsonStri
 
         const JsonRpcRequestView& request = parsed.value().request;
         const std::string& method = request.method;
+        // 带会话 id 的请求按会话判断（会话在 initialize 成功时创建）
+        const bool initialized = connectionInitialized || scope.session != nullptr;
 
         if (method == Methods::INITIALIZE) {
-            responseJson = handleInitialize(request, connectionInitialized);
+            responseJson = handleInitialize(request, connectionInitialized, scope);
         } else if (method == Methods::TOOLS_LIST) {
-            responseJson = handleToolsList(request, connectionInitialized);
+            responseJson = handleToolsList(request, initialized);
         } else if (method == Methods::TOOLS_CALL) {
-            co_await handleToolsCall(request, responseJson, connectionInitialized);
+            co_await handleToolsCall(request, responseJson, initialized, arrival, scope);
         } else if (method == Methods::RESOURCES_LIST) {
-            responseJson = handleResourcesList(request, connectionInitialized);
+            responseJson = handleResourcesList(request, initialized);
         } else if (method == Methods::RESOURCES_READ) {
-            co_await handleResourcesRead(request, responseJson, connectionInitialized);
+            co_await handleResourcesRead(request, responseJson, initialized, scope);
+        } else if (method == Methods::RESOURCES_SUBSCRIBE || method == Methods::RESOURCES_UNSUBSCRIBE) {
+            responseJson = handleResourcesSubscribe(request, scope.session.get(),
+                                                    method == Methods::RESOURCES_SUBSCRIBE);
         } else if (method == Methods::PROMPTS_LIST) {
-            responseJson = handlePromptsList(request, connectionInitialized);
+            responseJson = handlePromptsList(request, initialized);
         } else if (method == Methods::PROMPTS_GET) {
-            co_await handlePromptsGet(request, responseJson, connectionInitialized);
+            co_await handlePromptsGet(request, responseJson, initialized);
         } else if (method == Methods::PING) {
             responseJson = handlePing(request);
+        } else if (method == Methods::CANCELLED) {
+            responseJson = handleCancelled(request, scope);
         } else {
             if (request.id.has_value()) {
                 responseJson = createErrorResponse(request.id.value(),
@@ -259,12 +1581,14 @@ Coroutine McpHttpServer::processRequest(const std::string& requestBody, JsonStri
     co_return;
 }
 
-JsonString McpHttpServer::handleInitialize(const JsonRpcRequestView& request, bool& connectionInitialized) {
+JsonString McpHttpServer::handleInitialize(const JsonRpcRequestView& request,
+                                           bool& connectionInitialized,
+                                           RequestScope& scope) {
     if (!request.id.has_value()) {
         return EmptyObjectString();
     }
 
-    if (connectionInitialized) {
+    if (connectionInitialized || scope.session) {
         return createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Already initialized", "");
     }
@@ -283,36 +1607,47 @@ JsonString McpHttpServer::handleInitialize(const JsonRpcRequestView& request, bo
     JsonString result = protocol::buildInitializeResult(
         m_serverName,
         m_serverVersion,
-        !m_tools.empty(),
-        !m_resources.empty(),
-        !m_prompts.empty());
+        !m_tools.snapshot()->empty(),
+        !m_resources.snapshot()->empty(),
+        !m_prompts.snapshot()->empty());
 
     connectionInitialized = true;
-    m_initialized.store(true, std::memory_order_relaxed);
+    scope.session = m_sessions.create();
+    scope.session->setClient(std::move(paramsExp.value()));
+    scope.issuedSessionId = scope.session->id();
 
     return MakeResultResponse(request.id.value(), result);
 }
 
-JsonString McpHttpServer::handleToolsList(const JsonRpcRequestView& request, bool& connectionInitialized) {
+JsonString McpHttpServer::handleToolsList(const JsonRpcRequestView& request, bool initialized) {
     if (!request.id.has_value()) {
         return EmptyObjectString();
     }
 
-    if (!connectionInitialized && !m_initialized.load(std::memory_order_relaxed)) {
+    if (!initialized) {
         return createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Not initialized", "");
     }
 
-    return MakeResultResponse(request.id.value(), getToolsListResult());
+    const auto params = protocol::getListParams(request.params, request.hasParams);
+    auto result = m_tools.listResponse(*m_tools.snapshot(), params.cursor, params.ifChangedSince);
+    if (!result) {
+        return createErrorResponse(request.id.value(), ErrorCodes::INVALID_PARAMS, "Invalid cursor", "");
+    }
+    return MakeResultResponse(request.id.value(), result.value());
 }
 
-Coroutine McpHttpServer::handleToolsCall(const JsonRpcRequestView& request, JsonString& responseJson, bool& connectionInitialized) {
+Coroutine McpHttpServer::handleToolsCall(const JsonRpcRequestView& request,
+                                         JsonString& responseJson,
+                                         bool initialized,
+                                         McpAdmissionController::Clock::time_point arrival,
+                                         RequestScope& scope) {
     if (!request.id.has_value()) {
         responseJson = EmptyObjectString();
         co_return;
     }
 
-    if (!connectionInitialized && !m_initialized.load(std::memory_order_relaxed)) {
+    if (!initialized) {
         responseJson = createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Not initialized", "");
         co_return;
@@ -339,24 +1674,106 @@ Coroutine McpHttpServer::handleToolsCall(const JsonRpcRequestView& request, Json
             co_return;
         }
 
-        auto it = m_tools.find(toolName);
-        if (it == m_tools.end()) {
+        // 协程帧持有快照直到调用结束，期间删除或替换该工具不影响本次调用
+        auto tools = m_tools.snapshot();
+        const ToolInfo* info = tools->find(toolName);
+        if (!info) {
             responseJson = createErrorResponse(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
                                       "Tool not found", toolName);
             co_return;
         }
 
-        McpHttpServer::ToolHandler handler = it->second.handler;
-
         JsonElement arguments = JsonHelper::EmptyObject();
         JsonElement argsElement;
         if (JsonHelper::GetElement(paramsObj, "arguments", argsElement)) {
             arguments = argsElement;
         }
 
-        // 调用工具处理函数（协程）
+        // 命中结果缓存时直接拼接响应，不占用并发名额
+        const bool cached = info->options.cacheTtl.count() > 0;
+        std::optional<McpResultCacheKey> callKey;
+        if (cached || info->options.coalesce) {
+            callKey = McpResultCache::makeKey(toolName, info->cacheScope, arguments);
+        }
+        if (cached) {
+            if (auto hit = m_resultCache.find(*callKey)) {
+                responseJson = MakeResultResponse(request.id.value(), *hit);
+                co_return;
+            }
+        }
+
+        ToolSlot slot(info->inFlight.get(), info->options.maxInFlight);
+        if (!slot.acquired()) {
+            m_admission.recordToolShed();
+            responseJson = createErrorResponse(request.id.value(), ErrorCodes::SERVER_OVERLOADED,
+                                      "Server overloaded", "Tool concurrency limit reached: " + toolName);
+            co_return;
+        }
+
+        std::optional<McpCancellationToken::Clock::time_point> deadline;
+        if (auto timeout = protocol::getRequestTimeout(paramsObj)) {
+            deadline = McpCancellationToken::Clock::now() + timeout.value();
+        }
+        const int64_t id = request.id.value();
+        McpCancellationSource source(deadline);
+        std::string owner = inflightOwner(scope);
+        m_inflight.add(owner, id, scope.connection, source);
+        ScopeExit unregister([this, owner = std::move(owner), id, source]() {
+            m_inflight.remove(owner, id, source);
+        });
+
+        McpToolContext context;
+        context.requestId = id;
+        context.cancellation = source.token();
+        EventStream* stream = scope.stream;
+        std::optional<JsonString> progressToken = protocol::getProgressToken(paramsObj);
+        if (stream && progressToken.has_value()) {
+            // 处理函数可能在计算线程上上报，通知先进入 stream 队列，由连接方写出
+            context.progress = McpProgressReporter(*progressToken, m_progressInterval,
+                [stream](const JsonString& params) {
+                    JsonRpcNotification notification;
+                    notification.method = Methods::PROGRESS;
+                    notification.params = params;
+                    stream->push(notification.toJson());
+                });
+            stream->setProgress(context.progress);
+        }
+        ScopeExit closeProgress([stream, progress = context.progress]() mutable {
+            progress.close();
+            if (stream) {
+                stream->setProgress(McpProgressReporter());
+            }
+        });
+
+        if (info->streamingHandler) {
+            co_await streamTool(*info, arguments, context, arrival, scope, responseJson);
+            co_return;
+        }
+
+        // 调用工具处理函数（协程；同步处理函数按执行方式投递）
         std::expected<JsonString, McpError> result;
-        co_await handler(arguments, result);
+        if (!info->options.coalesce) {
+            co_await invokeTool(*info, arguments, context, result, arrival, stream, scope.conn);
+        }
+        while (info->options.coalesce) {
+            McpSingleFlight::Call call = m_toolFlights.join(callKey->text);
+            if (call.leader()) {
+                co_await invokeTool(*info, arguments, context, result, arrival, stream, scope.conn);
+                call.complete(result);
+                break;
+            }
+            co_await awaitFlight(call, context.cancellation);
+            if (!call.ready()) {
+                result = std::unexpected(CancelledError(context.cancellation));
+                break;
+            }
+            // 执行方被它自己的客户端取消或超时，结果不适用于本请求：重新合并或执行
+            if (!call.result() && call.result().error().code() == McpErrorCode::RequestCancelled) {
+                continue;
+            }
+            result = call.result();
+            break;
+        }
 
         if (!result) {
             responseJson = createErrorResponse(request.id.value(),
@@ -366,13 +1783,18 @@ Coroutine McpHttpServer::handleToolsCall(const JsonRpcRequestView& request, Json
             co_return;
         }
 
-        ToolCallResult callResult;
-        Content content;
-        content.type = ContentType::Text;
-        content.text = result.value();
-        callResult.content.push_back(content);
+        auto callResult = protocol::makeToolCallResult(info->tool, std::move(result.value()));
+        if (!callResult) {
+            responseJson = createErrorResponse(request.id.value(), ErrorCodes::INTERNAL_ERROR,
+                                      callResult.error().message(), callResult.error().details());
+            co_return;
+        }
 
-        responseJson = MakeResultResponse(request.id.value(), callResult.toJson());
+        JsonString resultJson = callResult->toJson();
+        responseJson = MakeResultResponse(request.id.value(), resultJson);
+        if (cached) {
+            m_resultCache.store(*callKey, std::move(resultJson), info->options.cacheTtl);
+        }
 
     } catch (const std::exception& e) {
         responseJson = createErrorResponse(request.id.value(), ErrorCodes::INTERNAL_ERROR,
@@ -381,26 +1803,289 @@ Coroutine McpHttpServer::handleToolsCall(const JsonRpcRequestView& request, Json
     co_return;
 }
 
-JsonString McpHttpServer::handleResourcesList(const JsonRpcRequestView& request, bool& connectionInitialized) {
+Coroutine McpHttpServer::invokeTool(const ToolInfo& info,
+                                    const JsonElement& arguments,
+                                    const McpToolContext& context,
+                                    std::expected<JsonString, McpError>& result,
+                                    McpAdmissionController::Clock::time_point arrival,
+                                    EventStream* stream,
+                                    http::HttpConn* conn) {
+    const McpCancellationToken& cancellation = context.cancellation;
+
+    McpAsyncSemaphore::Permit permit;
+    if (info.limiter) {
+        co_await acquirePermit(info, cancellation, permit, stream, conn);
+    }
+    if (cancellation.isCancelled()) {
+        result = std::unexpected(CancelledError(cancellation));
+        co_return;
+    }
+
+    const bool measured = arrival != McpAdmissionController::Clock::time_point{};
+    if (info.handler) {
+        if (measured) {
+            m_admission.recordQueueDelay(McpAdmissionController::Clock::now() - arrival);
+        }
+        co_await info.handler(arguments, context, result);
+        co_return;
+    }
+
+    McpComputePool* pool = info.pool.get();
+    if (!pool) {
+        if (measured) {
+            m_admission.recordQueueDelay(McpAdmissionController::Clock::now() - arrival);
+        }
+        result = info.blockingHandler(arguments, context);
+        co_return;
+    }
+
+    // 参数文档与上下文归请求协程所有；协程在处理函数开始执行后一直等到完成才返回，
+    // 计算线程可以直接只读访问。处理函数开始前被取消时由等待方放弃任务，计算线程不再访问
+    auto state = std::make_shared<OffloadState>();
+    const BlockingContextToolHandler* handler = &info.blockingHandler;
+    const JsonElement* args = &arguments;
+    const McpToolContext* ctx = &context;
+    McpAdmissionController* admission = measured ? &m_admission : nullptr;
+    auto wake = McpWakeSignal::create();
+    cancellation.wakeOnCancel(wake);
+    pool->submit([state, handler, args, ctx, admission, arrival]() {
+        if (state->claimed.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        // 排队时延包含在计算线程池中等待的时间
+        if (admission) {
+            admission->recordQueueDelay(McpAdmissionController::Clock::now() - arrival);
+        }
+        try {
+            state->result = (*handler)(*args, *ctx);
+        } catch (...) {
+            state->exception = std::current_exception();
+        }
+        state->done.store(true, std::memory_order_release);
+    }, wake);
+
+    // 挂起等待计算线程结束、取消或进度到期，醒来后重新检查；计算线程结束时只投递唤醒，
+    // 本协程回到原 IO 调度器线程上发送响应
+    while (!state->done.load(std::memory_order_acquire)) {
+        if (cancellation.isCancelled() && !state->claimed.exchange(true, std::memory_order_acq_rel)) {
+            result = std::unexpected(CancelledError(cancellation));
+            co_return;
+        }
+        co_await waitWake(wake, stream, conn);
+    }
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+    result = std::move(state->result);
+    co_return;
+}
+
+Coroutine McpHttpServer::acquirePermit(const ToolInfo& info,
+                                       const McpCancellationToken& cancellation,
+                                       McpAsyncSemaphore::Permit& permit,
+                                       EventStream* stream,
+                                       http::HttpConn* conn) {
+    // 超过 maxConcurrency 的调用在这里排队，名额按到达顺序移交；排队期间被取消则退出队列
+    permit = info.limiter->acquire();
+    if (permit.ready()) {
+        co_return;
+    }
+    auto wake = McpWakeSignal::create();
+    permit.wakeOnReady(wake);
+    cancellation.wakeOnCancel(wake);
+    while (!permit.ready()) {
+        if (cancellation.isCancelled()) {
+            co_return;
+        }
+        co_await waitWake(wake, stream, conn);
+    }
+    co_return;
+}
+
+Coroutine McpHttpServer::waitWake(const std::shared_ptr<McpWakeSignal>& wake,
+                                  EventStream* stream,
+                                  http::HttpConn* conn) {
+    if (!stream || !conn) {
+        co_await McpSchedulerExecutor::wait(wake);
+        co_return;
+    }
+    // 合并中的进度没有事件方，按进度间隔定时唤醒
+    if (stream->hasProgress()) {
+        McpWakeSignal::notifyAt(wake, McpWakeSignal::Clock::now() + m_progressInterval);
+    }
+    stream->setWake(wake);
+    co_await McpSchedulerExecutor::wait(wake);
+    stream->setWake(nullptr);
+    stream->flushDue();
+    co_await sendEvents(*conn, *stream, nullptr);
+    co_return;
+}
+
+Coroutine McpHttpServer::streamTool(const ToolInfo& info,
+                                    const JsonElement& arguments,
+                                    const McpToolContext& context,
+                                    McpAdmissionController::Clock::time_point arrival,
+                                    RequestScope& scope,
+                                    JsonString& responseJson) {
+    const McpCancellationToken& cancellation = context.cancellation;
+
+    McpAsyncSemaphore::Permit permit;
+    if (info.limiter) {
+        co_await acquirePermit(info, cancellation, permit, scope.stream, scope.conn);
+    }
+    if (cancellation.isCancelled()) {
+        const McpError error = CancelledError(cancellation);
+        responseJson = createErrorResponse(context.requestId.value(), error.toJsonRpcErrorCode(),
+                                           error.message(), error.details());
+        co_return;
+    }
+
+    // 与 invokeTool 相同：协程等到处理函数结束才返回，计算线程可以直接只读访问参数与上下文
+    const StreamingToolHandler* handler = &info.streamingHandler;
+    const JsonElement* args = &arguments;
+    const McpToolContext* ctx = &context;
+    McpAdmissionController* admission = &m_admission;
+    co_await streamResult(*info.pool, McpContentEncoding::JsonString, protocol::streamedToolResultPrefix(),
+                          &protocol::streamedToolResultSuffix,
+                          [handler, args, ctx, admission, arrival](McpContentWriter& writer) {
+                              admission->recordQueueDelay(McpAdmissionController::Clock::now() - arrival);
+                              return (*handler)(*args, *ctx, writer);
+                          },
+                          context, scope, responseJson);
+    co_return;
+}
+
+Coroutine McpHttpServer::streamResult(McpComputePool& pool,
+                                      McpContentEncoding encoding,
+                                      JsonString resultPrefix,
+                                      JsonString (*resultSuffix)(const McpError*),
+                                      StreamProducer produce,
+                                      const McpToolContext& context,
+                                      RequestScope& scope,
+                                      JsonString& responseJson) {
+    const int64_t id = context.requestId.value();
+    const McpCancellationToken& cancellation = context.cancellation;
+    EventStream* stream = scope.stream;
+
+    // 协程等到生产函数结束才返回，计算线程可以直接访问 produce 与上下文
+    auto pipe = std::make_shared<StreamPipe>();
+    const StreamProducer* producer = &produce;
+    const McpToolContext* ctx = &context;
+    cancellation.wakeOnCancel(pipe->wake);
+    pool.submit([pipe, producer, ctx, encoding]() {
+        if (pipe->claimed.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        StreamPipe* output = pipe.get();
+        McpContentWriter writer(encoding, [output, ctx](std::string_view chunk) {
+            return !ctx->cancellation.isCancelled() && output->push(chunk);
+        });
+        try {
+            output->result = (*producer)(writer);
+            if (output->result) {
+                writer.flush();
+            }
+        } catch (const std::exception& e) {
+            output->result = std::unexpected(McpError::internalError(e.what()));
+        } catch (...) {
+            output->result = std::unexpected(McpError::internalError("Unknown exception"));
+        }
+        output->refused = writer.failed();
+        output->done.store(true, std::memory_order_release);
+    }, pipe->wake);
+
+    // 第一块输出在生产函数返回前到达时开始 chunked 写出；SSE 响应中最终响应是一个跨多个 chunk 的 message 事件
+    const JsonString eventPrefix = stream ? "event: message\ndata: " : "";
+    bool started = false;
+    bool ok = true;
+    while (!pipe->done.load(std::memory_order_acquire)) {
+        if (cancellation.isCancelled() && !pipe->claimed.exchange(true, std::memory_order_acq_rel)) {
+            const McpError error = CancelledError(cancellation);
+            responseJson = createErrorResponse(id, error.toJsonRpcErrorCode(), error.message(), error.details());
+            co_return;
+        }
+        // 最终响应开始写出后不再发送进度事件
+        co_await waitWake(pipe->wake, started ? nullptr : stream, scope.conn);
+        JsonString chunk = pipe->take();
+        if (chunk.empty() || !ok) {
+            continue;
+        }
+        if (!started) {
+            // 最终响应事件开始之后不能再插入进度事件
+            McpProgressReporter progress = context.progress;
+            progress.close();
+            chunk.insert(0, eventPrefix + protocol::streamedResponsePrefix(id) + resultPrefix);
+        }
+        co_await writeStreamed(scope, std::move(chunk), !started, false, ok);
+        started = true;
+        if (!ok) {
+            pipe->abandon();
+        }
+    }
+
+    std::optional<McpError> error;
+    if (!pipe->result) {
+        error = pipe->result.error();
+    } else if (pipe->refused) {
+        error = CancelledError(cancellation);
+    }
+    JsonString rest = pipe->take();
+    if (!started) {
+        if (error) {
+            responseJson = createErrorResponse(id, error->toJsonRpcErrorCode(), error->message(), error->details());
+        } else {
+            responseJson = MakeResultResponse(id, resultPrefix + rest + resultSuffix(nullptr));
+        }
+        co_return;
+    }
+    if (!ok) {
+        co_return;
+    }
+    rest += resultSuffix(error ? &error.value() : nullptr);
+    rest += stream ? "}\n\n" : "}";
+    co_await writeStreamed(scope, std::move(rest), false, true, ok);
+    co_return;
+}
+
+Coroutine McpHttpServer::awaitFlight(const McpSingleFlight::Call& call, const McpCancellationToken& cancellation) {
+    // 执行方 complete() 或本请求被取消时唤醒；本协程回到自己的 IO 调度器上恢复
+    auto wake = McpWakeSignal::create();
+    call.wakeOnReady(wake);
+    cancellation.wakeOnCancel(wake);
+    while (!call.ready() && !cancellation.isCancelled()) {
+        co_await McpSchedulerExecutor::wait(wake);
+    }
+    co_return;
+}
+
+JsonString McpHttpServer::handleResourcesList(const JsonRpcRequestView& request, bool initialized) {
     if (!request.id.has_value()) {
         return EmptyObjectString();
     }
 
-    if (!connectionInitialized && !m_initialized.load(std::memory_order_relaxed)) {
+    if (!initialized) {
         return createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Not initialized", "");
     }
 
-    return MakeResultResponse(request.id.value(), getResourcesListResult());
+    const auto params = protocol::getListParams(request.params, request.hasParams);
+    auto result = m_resources.listResponse(*m_resources.snapshot(), params.cursor, params.ifChangedSince);
+    if (!result) {
+        return createErrorResponse(request.id.value(), ErrorCodes::INVALID_PARAMS, "Invalid cursor", "");
+    }
+    return MakeResultResponse(request.id.value(), result.value());
 }
 
-Coroutine McpHttpServer::handleResourcesRead(const JsonRpcRequestView& request, JsonString& responseJson, bool& connectionInitialized) {
+Coroutine McpHttpServer::handleResourcesRead(const JsonRpcRequestView& request,
+                                             JsonString& responseJson,
+                                             bool initialized,
+                                             RequestScope& scope) {
     if (!request.id.has_value()) {
         responseJson = EmptyObjectString();
         co_return;
     }
 
-    if (!connectionInitialized && !m_initialized.load(std::memory_order_relaxed)) {
+    if (!initialized) {
         responseJson = createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Not initialized", "");
         co_return;
@@ -427,18 +2112,45 @@ Coroutine McpHttpServer::handleResourcesRead(const JsonRpcRequestView& request,
             co_return;
         }
 
-        auto it = m_resources.find(uri);
-        if (it == m_resources.end()) {
+        auto resources = m_resources.snapshot();
+        const ResourceInfo* info = resources->find(uri);
+        if (!info) {
             responseJson = createErrorResponse(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
                                       "Resource not found", uri);
             co_return;
         }
 
-        McpHttpServer::ResourceReader reader = it->second.reader;
+        if (info->streamingReader) {
+            McpToolContext context;
+            context.requestId = request.id.value();
+            const StreamingResourceReader* streamingReader = &info->streamingReader;
+            co_await streamResult(*info->pool,
+                                  info->blob ? McpContentEncoding::Base64 : McpContentEncoding::JsonString,
+                                  protocol::streamedResourceResultPrefix(uri, info->resource.mimeType, info->blob),
+                                  &protocol::streamedResourceResultSuffix,
+                                  [streamingReader, uri](McpContentWriter& writer) {
+                                      return (*streamingReader)(uri, writer);
+                                  },
+                                  context, scope, responseJson);
+            co_return;
+        }
+
+        const McpHttpServer::ResourceReader& reader = info->reader;
 
-        // 调用资源读取函数（协程）
+        // 调用资源读取函数（协程）；合并读取时只有执行方调用，其余请求等待同一结果
         std::expected<std::string, McpError> result;
-        co_await reader(uri, result);
+        if (info->options.coalesce) {
+            McpSingleFlight::Call call = m_resourceFlights.join(uri);
+            if (call.leader()) {
+                co_await reader(uri, result);
+                call.complete(result);
+            } else {
+                co_await awaitFlight(call, McpCancellationToken());
+                result = call.result();
+            }
+        } else {
+            co_await reader(uri, result);
+        }
 
         if (!result) {
             responseJson = createErrorResponse(request.id.value(),
@@ -469,26 +2181,63 @@ Coroutine McpHttpServer::handleResourcesRead(const JsonRpcRequestView& request,
     co_return;
 }
 
-JsonString McpHttpServer::handlePromptsList(const JsonRpcRequestView& request, bool& connectionInitialized) {
+JsonString McpHttpServer::handleResourcesSubscribe(const JsonRpcRequestView& request,
+                                                   McpSession* session,
+                                                   bool subscribe) {
     if (!request.id.has_value()) {
         return EmptyObjectString();
     }
 
-    if (!connectionInitialized && !m_initialized.load(std::memory_order_relaxed)) {
+    if (!session) {
+        return createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
+                                  "Session required", "Missing Mcp-Session-Id");
+    }
+
+    JsonObject paramsObj;
+    std::string uri;
+    if (!request.hasParams || !JsonHelper::GetObject(request.params, paramsObj) ||
+        !JsonHelper::GetString(paramsObj, "uri", uri)) {
+        return createErrorResponse(request.id.value(), ErrorCodes::INVALID_PARAMS,
+                                  "Invalid parameters", "Missing uri");
+    }
+
+    if (subscribe) {
+        if (!m_resources.snapshot()->find(uri)) {
+            return createErrorResponse(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
+                                      "Resource not found", uri);
+        }
+        session->subscribe(uri);
+    } else {
+        session->unsubscribe(uri);
+    }
+    return MakeResultResponse(request.id.value(), EmptyObjectString());
+}
+
+JsonString McpHttpServer::handlePromptsList(const JsonRpcRequestView& request, bool initialized) {
+    if (!request.id.has_value()) {
+        return EmptyObjectString();
+    }
+
+    if (!initialized) {
         return createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Not initialized", "");
     }
 
-    return MakeResultResponse(request.id.value(), getPromptsListResult());
+    const auto params = protocol::getListParams(request.params, request.hasParams);
+    auto result = m_prompts.listResponse(*m_prompts.snapshot(), params.cursor, params.ifChangedSince);
+    if (!result) {
+        return createErrorResponse(request.id.value(), ErrorCodes::INVALID_PARAMS, "Invalid cursor", "");
+    }
+    return MakeResultResponse(request.id.value(), result.value());
 }
 
-Coroutine McpHttpServer::handlePromptsGet(const JsonRpcRequestView& request, JsonString& responseJson, bool& connectionInitialized) {
+Coroutine McpHttpServer::handlePromptsGet(const JsonRpcRequestView& request, JsonString& responseJson, bool initialized) {
     if (!request.id.has_value()) {
         responseJson = EmptyObjectString();
         co_return;
     }
 
-    if (!connectionInitialized && !m_initialized.load(std::memory_order_relaxed)) {
+    if (!initialized) {
         responseJson = createErrorResponse(request.id.value(), ErrorCodes::INVALID_REQUEST,
                                   "Not initialized", "");
         co_return;
@@ -521,14 +2270,15 @@ Coroutine McpHttpServer::handlePromptsGet(const JsonRpcRequestView& request, Jso
             arguments = argsElement;
         }
 
-        auto it = m_prompts.find(name);
-        if (it == m_prompts.end()) {
+        auto prompts = m_prompts.snapshot();
+        const PromptInfo* info = prompts->find(name);
+        if (!info) {
             responseJson = createErrorResponse(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
                                       "Prompt not found", name);
             co_return;
         }
 
-        McpHttpServer::PromptGetter getter = it->second.getter;
+        const McpHttpServer::PromptGetter& getter = info->getter;
 
         // 调用提示获取函数（协程）
         std::expected<JsonString, McpError> result;
@@ -559,40 +2309,42 @@ JsonString McpHttpServer::handlePing(const JsonRpcRequestView& request) {
     return MakeResultResponse(request.id.value(), EmptyObjectString());
 }
 
-JsonString McpHttpServer::createErrorResponse(int64_t id, int code,
-                                        const std::string& message,
-                                        const std::string& details) {
-    return protocol::makeErrorResponse(id, code, message, details).toJson();
+JsonString McpHttpServer::handleCancelled(const JsonRpcRequestView& request, const RequestScope& scope) {
+    if (request.hasParams) {
+        if (auto requestId = protocol::getCancelledRequestId(request.params)) {
+            m_inflight.cancel(inflightOwner(scope), requestId.value());
+        }
+    }
+    // 通知没有响应
+    return EmptyObjectString();
 }
 
-const JsonString& McpHttpServer::getToolsListResult() {
-    if (m_toolsCacheDirty) {
-        m_toolsListCache = protocol::buildListResultFromMap(
-            m_tools, "tools",
-            [](const ToolInfo& info) -> const Tool& { return info.tool; });
-        m_toolsCacheDirty = false;
+std::string McpHttpServer::inflightOwner(const RequestScope& scope) {
+    if (scope.session) {
+        return "session:" + scope.session->id();
     }
-    return m_toolsListCache;
+    if (scope.connection >= 0) {
+        return "unix:" + std::to_string(scope.connection);
+    }
+    if (scope.conn == nullptr) {
+        return "local";
+    }
+    // TCP 连接在整个 keep-alive 期间使用同一个 HttpConn
+    return "tcp:" + std::to_string(reinterpret_cast<uintptr_t>(scope.conn));
 }
 
-const JsonString& McpHttpServer::getResourcesListResult() {
-    if (m_resourcesCacheDirty) {
-        m_resourcesListCache = protocol::buildListResultFromMap(
-            m_resources, "resources",
-            [](const ResourceInfo& info) -> const Resource& { return info.resource; });
-        m_resourcesCacheDirty = false;
-    }
-    return m_resourcesListCache;
+JsonString McpHttpServer::createErrorResponse(int64_t id, int code,
+                                        const std::string& message,
+                                        const std::string& details) {
+    return protocol::makeErrorResponse(id, code, message, details).toJson();
 }
 
-const JsonString& McpHttpServer::getPromptsListResult() {
-    if (m_promptsCacheDirty) {
-        m_promptsListCache = protocol::buildListResultFromMap(
-            m_prompts, "prompts",
-            [](const PromptInfo& info) -> const Prompt& { return info.prompt; });
-        m_promptsCacheDirty = false;
+JsonString McpHttpServer::createOverloadedResponse(const std::string& requestBody, const std::string& reason) {
+    const std::optional<int64_t> id = peekJsonRpcId(requestBody);
+    if (!id.has_value()) {
+        return EmptyObjectString();
     }
-    return m_promptsListCache;
+    return createErrorResponse(id.value(), ErrorCodes::SERVER_OVERLOADED, "Server overloaded", reason);
 }
 
 } // namespace mcp
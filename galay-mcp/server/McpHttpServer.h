@@ -1,41 +1,192 @@
 #ifndef GALAY_MCP_SERVER_MCPHTTPSERVER_H
 #define GALAY_MCP_SERVER_MCPHTTPSERVER_H
 
+#include "galay-mcp/common/McpAsyncSemaphore.h"
 #include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpCancellation.h"
+#include "galay-mcp/common/McpComputePool.h"
+#include "galay-mcp/common/McpContentWriter.h"
 #include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpInProcessEndpoint.h"
 #include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpManifest.h"
+#include "galay-mcp/common/McpRegistry.h"
+#include "galay-mcp/common/McpSse.h"
+#include "galay-mcp/common/McpToolContext.h"
+#include "galay-mcp/common/McpUnixSocket.h"
+#include "galay-mcp/common/McpWakeSignal.h"
+#include "galay-mcp/server/McpAdmissionController.h"
+#include "galay-mcp/server/McpResultCache.h"
+#include "galay-mcp/server/McpSessionTable.h"
+#include "galay-mcp/server/McpSingleFlight.h"
 #include "galay-http/kernel/http/HttpServer.h"
 #include "galay-http/kernel/http/HttpRouter.h"
+#include "galay-kernel/kernel/Runtime.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_set>
 #include <unordered_map>
 #include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include <atomic>
 
 namespace galay {
 namespace mcp {
 
+/**
+ * @brief 同步工具处理函数的执行方式
+ */
+enum class McpToolExecution {
+    Inline,     // 在连接所在的 IO 调度器上直接执行（适合轻量处理）
+    Compute,    // 投递到服务器共享的工作窃取计算线程池
+    Dedicated   // 投递到该工具独占的单线程（串行执行，不与其他工具争用）
+};
+
+/**
+ * @brief addTool 时指定的单个工具选项
+ */
+struct McpToolOptions {
+    McpToolExecution execution = McpToolExecution::Inline;
+    // 该工具同时执行的调用上限，超出的调用挂起排队（按到达顺序执行）；0 表示不限制
+    size_t maxConcurrency = 0;
+    // 该工具同时接收的调用上限（含排队），超出时直接返回 SERVER_OVERLOADED；0 表示不限制
+    size_t maxInFlight = 0;
+    // 结果缓存时长；大于 0 时参数等价的调用在该时长内直接返回缓存的结果（处理函数须只依赖 arguments）
+    std::chrono::milliseconds cacheTtl{0};
+    // 合并并发的等价调用（同一工具、规范化后的 arguments 相同）：只执行一次，全部调用收到同一结果
+    bool coalesce = false;
+    // 输出的 JSON Schema；非空时在 tools/list 中声明，处理函数返回的 JSON 对象原样放入 structuredContent
+    JsonString outputSchema;
+};
+
+/**
+ * @brief addResource 时指定的单个资源选项
+ */
+struct McpResourceOptions {
+    // 合并同一 URI 的并发读取：只调用一次读取函数，全部请求收到同一内容
+    bool coalesce = false;
+};
+
 /**
  * @brief 基于HTTP的MCP服务器
  *
- * @note 非线程安全：addTool/addResource/addPrompt 必须在 start() 之前调用，
- *       服务器运行期间不支持动态添加工具、资源或提示。
+ * host 形如 "unix:/run/mcp.sock" 时改为监听 Unix 域套接字（port 被忽略），
+ * 同一连接上按 keep-alive 循环处理请求，处理逻辑与 TCP 监听完全一致。
+ * 同一进程内的调用方可以用 McpInProcessClient 直接绑定注册表（无需 start()），
+ * 协程处理函数由服务器按需创建的本地运行时调度。
+ * CPU 密集型工具可注册为同步处理函数并指定 McpToolExecution::Compute / Dedicated，
+ * 处理函数在计算线程上执行，期间连接协程挂起、不占用 IO 调度器，处理函数结束时计算线程只投递唤醒，连接协程回到原 IO 调度器线程上发送响应。
+ * McpToolOptions::maxConcurrency 限制单个工具同时执行的调用数，超出的调用在协程内挂起排队，
+ * 不占用调度器线程；进程内调用同样受该限制。
+ * 接收 McpToolContext 的工具可以通过取消令牌感知 notifications/cancelled、客户端超时
+ * （params._meta.timeoutMs）与 Unix 域套接字连接关闭；服务端在排队与等待计算线程时检查令牌，
+ * 被取消的调用立即返回 REQUEST_CANCELLED 并归还并发名额。
+ * setAdmissionOptions() 开启准入控制后，超过并发上限或排队时延持续超标的请求
+ * 不解析 params，直接以 SERVER_OVERLOADED（-32000）错误返回；进程内调用不受准入控制。
+ * 请求头 Accept 含 text/event-stream 且 tools/call 带 params._meta.progressToken 时，
+ * 处理函数经 McpToolContext::progress 上报的进度以 SSE 事件流（chunked）先于最终响应发出，
+ * 同一请求每个间隔最多一条；其他请求仍返回单个 application/json 响应。
+ * Streamable HTTP：initialize 成功时响应头返回 Mcp-Session-Id，之后的请求带着它归属同一会话；
+ * 初始化状态、客户端能力、资源订阅与请求速率令牌桶都按会话保存在分段加锁的 McpSessionTable 中，
+ * 空闲超过 McpSessionOptions::idleTimeout 的会话被回收。客户端带着会话 id GET /mcp 打开会话事件流，
+ * 接收 broadcastNotification() 等服务端主动发送的消息，断线后按 Last-Event-ID 续传。
+ * DELETE /mcp 结束会话，之后带该会话 id 的请求返回 404。
+ * 工具、资源与提示保存在 RCU 快照注册表（McpRegistry）中：add* / remove* 可在运行期间从任意线程调用，
+ * 每次变化发布一个新快照（含预先序列化的列表结果），并向所有会话的事件流发送
+ * notifications/{tools,resources,prompts}/list_changed；请求处理只原子地取快照，不加锁，
+ * 进行中的调用持有取到的快照，不受并发删除影响。
+ * McpToolOptions::cacheTtl 开启工具结果缓存：键为工具名与规范化的 arguments，值为预先序列化的 result，
+ * 命中时不经过并发限制与处理函数；缓存是分段 LRU，内存预算与分段数由 setResultCacheOptions() 设置，
+ * 设置 persistentPath 时结果同时写入磁盘日志（McpResultStore），重启后仍可命中。
+ * McpToolOptions::outputSchema 声明结构化输出：处理函数返回的 JSON 对象作为 structuredContent 原样嵌入响应，
+ * 不转义为文本内容，客户端用 callToolStructured() 直接取得解析后的元素。
+ * addStreamingTool() 注册的工具在计算线程上把文本分块写入 McpContentWriter，输出边转义边经有界队列交给
+ * 连接协程；第一块（64KB）在处理函数返回前写满时响应改用 chunked 传输边生成边写出，内存占用与输出总长无关。
+ * addStreamingResource() 注册的资源以同样方式分块读取，二进制内容边读边按 base64 编码为 blob。
+ * McpToolOptions::coalesce / McpResourceOptions::coalesce 合并并发的相同请求（singleflight）：
+ * 后到的请求挂起等待进行中的那次执行，执行方完成时把各等待方投递回它们自己的 IO 调度器，不占用调度器线程，完成后全部收到同一结果。
  */
-class McpHttpServer {
+class McpHttpServer : public McpInProcessEndpoint {
 public:
     // 工具处理函数类型（协程）
     using ToolHandler = std::function<Coroutine(const JsonElement&, std::expected<JsonString, McpError>&)>;
 
+    // 同步工具处理函数类型（按 McpToolOptions::execution 执行）
+    using BlockingToolHandler = std::function<std::expected<JsonString, McpError>(const JsonElement&)>;
+
+    // 接收调用上下文（取消令牌等）的工具处理函数类型
+    using ContextToolHandler = std::function<Coroutine(const JsonElement&,
+                                                       const McpToolContext&,
+                                                       std::expected<JsonString, McpError>&)>;
+    using BlockingContextToolHandler = std::function<std::expected<JsonString, McpError>(const JsonElement&,
+                                                                                         const McpToolContext&)>;
+
+    // 流式工具处理函数类型（在计算线程上执行）：文本输出分块写入 writer，返回错误时已写出的部分作废
+    using StreamingToolHandler = std::function<std::expected<void, McpError>(const JsonElement&,
+                                                                             const McpToolContext&,
+                                                                             McpContentWriter&)>;
+
     // 资源读取函数类型（协程）
     using ResourceReader = std::function<Coroutine(const std::string&, std::expected<std::string, McpError>&)>;
 
+    // 流式资源读取函数类型（在计算线程上执行）：内容分块写入 writer，返回错误时已写出的部分作废
+    using StreamingResourceReader = std::function<std::expected<void, McpError>(const std::string&,
+                                                                                McpContentWriter&)>;
+
     // 提示获取函数类型（协程）
     using PromptGetter = std::function<Coroutine(const std::string&, const JsonElement&, std::expected<JsonString, McpError>&)>;
 
+    // 批量注册的工具定义；handler、blockingHandler 与 streamingHandler 三选一
+    struct ToolDefinition {
+        std::string name;
+        std::string description;
+        JsonString inputSchema;
+        ContextToolHandler handler;
+        BlockingContextToolHandler blockingHandler;
+        McpToolOptions options;
+        StreamingToolHandler streamingHandler;
+    };
+
+    struct ResourceDefinition {
+        std::string uri;
+        std::string name;
+        std::string description;
+        std::string mimeType;
+        ResourceReader reader;
+        McpResourceOptions options;
+        StreamingResourceReader streamingReader;  // 非空时代替 reader，同 addStreamingResource
+        bool blob = false;
+    };
+
+    struct PromptDefinition {
+        std::string name;
+        std::string description;
+        std::vector<PromptArgument> arguments;
+        PromptGetter getter;
+    };
+
+    // 清单工具的实现；三种处理函数都为空表示本进程没有实现该工具
+    struct ToolBinding {
+        ContextToolHandler handler;
+        BlockingContextToolHandler blockingHandler;
+        McpToolOptions options;
+        StreamingToolHandler streamingHandler;
+    };
+    using ManifestToolBinder = std::function<ToolBinding(const McpManifestTool&)>;
+    using ManifestResourceBinder = std::function<ResourceReader(const McpManifestResource&)>;
+
     McpHttpServer(const std::string& host = "0.0.0.0",
                   int port = 8080,
                   size_t ioSchedulers = 8,
                   size_t computeSchedulers = 0);
-    ~McpHttpServer();
+    ~McpHttpServer() override;
 
     McpHttpServer(const McpHttpServer&) = delete;
     McpHttpServer& operator=(const McpHttpServer&) = delete;
@@ -47,45 +198,290 @@ public:
     void addTool(const std::string& name,
                  const std::string& description,
                  const JsonString& inputSchema,
-                 ToolHandler handler);
+                 ToolHandler handler,
+                 McpToolOptions options = {});
+
+    /**
+     * @brief 添加同步工具
+     * @param options 执行方式与并发上限；Compute 使用的线程池大小取 computeSchedulers（为 0 时取 CPU 核数）
+     * @note 处理函数异常按 INTERNAL_ERROR 返回，与协程处理函数一致
+     */
+    void addTool(const std::string& name,
+                 const std::string& description,
+                 const JsonString& inputSchema,
+                 BlockingToolHandler handler,
+                 McpToolOptions options = {});
+
+    /**
+     * @brief 添加接收调用上下文的工具（协程 / 同步）
+     * @note 处理函数应在耗时步骤或挂起点之间检查 context.cancellation，被取消时尽快返回
+     */
+    void addTool(const std::string& name,
+                 const std::string& description,
+                 const JsonString& inputSchema,
+                 ContextToolHandler handler,
+                 McpToolOptions options = {});
+    void addTool(const std::string& name,
+                 const std::string& description,
+                 const JsonString& inputSchema,
+                 BlockingContextToolHandler handler,
+                 McpToolOptions options = {});
+
+    /**
+     * @brief 添加流式输出文本的工具
+     * @param options execution 为 Inline 时按 Compute 执行（写入会等待连接写出，不能占用 IO 调度器）；
+     *                cacheTtl、coalesce 与 outputSchema 对流式工具不生效
+     * @note 结果是一个文本内容项。输出不足一块时按普通响应返回；否则先写出响应头与已完成的块，
+     *       之后每块作为一个 chunk 写出，SSE 响应中进度通知在此之后不再发送。部分输出之后处理函数返回错误
+     *       或调用被取消时，响应以一条说明错误的文本内容项和 isError=true 结束。
+     *       连接断开或调用被取消后 writer.write() 返回 false
+     */
+    void addStreamingTool(const std::string& name,
+                          const std::string& description,
+                          const JsonString& inputSchema,
+                          StreamingToolHandler handler,
+                          McpToolOptions options = {});
 
     void addResource(const std::string& uri,
                      const std::string& name,
                      const std::string& description,
                      const std::string& mimeType,
-                     ResourceReader reader);
+                     ResourceReader reader,
+                     McpResourceOptions options = {});
+
+    /**
+     * @brief 添加分块读取的资源（线程安全）
+     * @param blob true 时内容是二进制，按 base64 编码写入 "blob"；否则转义写入 "text"
+     * @note 读取函数在共享计算线程池上执行，写出方式同 addStreamingTool()：第一块（64KB）写满时改用
+     *       chunked 传输，排队的已编码内容有上限。部分内容写出后读取失败时，result 带 isError=true，
+     *       错误说明在 _meta.error 中。流式资源不合并并发读取
+     */
+    void addStreamingResource(const std::string& uri,
+                              const std::string& name,
+                              const std::string& description,
+                              const std::string& mimeType,
+                              StreamingResourceReader reader,
+                              bool blob = false);
 
     void addPrompt(const std::string& name,
                    const std::string& description,
                    const std::vector<PromptArgument>& arguments,
                    PromptGetter getter);
 
+    /**
+     * @brief 批量添加工具 / 资源 / 提示（线程安全）
+     * @return 新增的条目数；与已有条目同名时替换，不计入
+     * @note 整批只发布一个注册表版本、至多广播一条 list_changed；启动时注册大量条目应使用这组接口
+     */
+    size_t registerTools(std::vector<ToolDefinition> tools);
+    size_t registerResources(std::vector<ResourceDefinition> resources);
+    size_t registerPrompts(std::vector<PromptDefinition> prompts);
+
+    /**
+     * @brief 注册清单中的全部工具与资源（线程安全）
+     * @return 新增的条目数；有条目未绑定时返回 InvalidParams，且不注册任何条目
+     * @note 先检查全部绑定再应用工具选项，失败时不创建专用线程、不推进缓存代次；工具与资源各发布一个快照；inputSchema 与列表 JSON 直接引用清单映射
+     */
+    std::expected<size_t, McpError> loadManifest(std::shared_ptr<const McpManifest> manifest,
+                                                 const ManifestToolBinder& bindTool,
+                                                 const ManifestResourceBinder& bindResource = {});
+
+    // 删除工具 / 资源 / 提示（线程安全）；返回条目是否存在
+    bool removeTool(const std::string& name);
+    bool removeResource(const std::string& uri);
+    bool removePrompt(const std::string& name);
+
+    // tools/list、resources/list、prompts/list 每页的条目数（默认 0 表示不分页；线程安全）。
+    // 分页后请求通过 params.cursor 翻页，结果带 nextCursor，每页首次请求时拼接并缓存
+    void setListPageSize(size_t pageSize);
+
+    // 准入控制选项，必须在 start() 之前设置
+    void setAdmissionOptions(const McpAdmissionOptions& options);
+
+    // 准入与丢弃计数、排队时延（线程安全）
+    McpAdmissionStats admissionStats() const;
+
+    // 设置了 maxConcurrency 的工具的排队深度与等待时间（线程安全）；其他工具返回 std::nullopt
+    std::optional<McpSemaphoreStats> toolConcurrencyStats(const std::string& name) const;
+
+    // 工具结果缓存的分段数、内存预算与持久层目录，必须在 start() 之前、注册可缓存工具之前设置；
+    // 持久层目录无法打开时返回错误，缓存退回只用内存
+    std::expected<void, McpError> setResultCacheOptions(const McpResultCacheOptions& options);
+
+    // 结果缓存的条目数、字节数与命中、未命中、淘汰计数（线程安全）
+    McpResultCacheStats resultCacheStats() const;
+
+    // 设置了 coalesce 的工具 / 资源的执行与合并计数（线程安全）
+    McpSingleFlightStats toolCoalescingStats() const;
+    McpSingleFlightStats resourceCoalescingStats() const;
+
+    // 同一请求两条 notifications/progress 之间的最小间隔（默认 100ms，0 表示不合并），必须在 start() 之前设置
+    void setProgressInterval(std::chrono::milliseconds interval);
+
+    // 会话分段数、空闲过期、事件回放容量与单会话速率上限，必须在 start() 之前设置
+    void setSessionOptions(const McpSessionOptions& options);
+
+    // Unix 域套接字同时服务的连接数上限（默认 256，0 表示不限制），必须在 start() 之前设置；
+    // 达到上限时暂停 accept，新连接留在监听队列中直到有连接结束
+    void setUnixConnectionLimit(size_t maxConnections);
+
+    /**
+     * @brief 向所有会话的 GET 事件流发送一条通知（线程安全）
+     * @param params 通知的 params（JSON 对象），为空时省略
+     * @return 收到该通知的会话数
+     */
+    size_t broadcastNotification(const std::string& method, const JsonString& params = "");
+
+    /**
+     * @brief 向订阅了 uri 的会话发送 notifications/resources/updated（线程安全）
+     * @return 收到该通知的会话数
+     */
+    size_t notifyResourceUpdated(const std::string& uri);
+
+    // 当前会话数（线程安全）
+    size_t sessionCount() const;
+
+    // 会话创建、过期、结束与限速计数（线程安全）
+    McpSessionStats sessionStats() const;
+
     void start();
     void stop();
     bool isRunning() const;
 
+    // McpInProcessEndpoint：进程内直接访问注册表，调用线程阻塞到处理函数完成
+    InitializeResult localInitialize() override;
+    std::vector<Tool> localListTools() override;
+    std::vector<Resource> localListResources() override;
+    std::vector<Prompt> localListPrompts() override;
+    std::expected<JsonString, McpError> localCallTool(const std::string& name,
+                                                      const JsonElement& arguments) override;
+    std::expected<std::string, McpError> localReadResource(const std::string& uri) override;
+    std::expected<JsonString, McpError> localGetPrompt(const std::string& name,
+                                                       const JsonElement& arguments) override;
+
 private:
+    // 单个请求的 SSE 响应：进度通知可能来自计算线程，先进入队列，
+    // 再由连接协程（TCP）或连接线程（Unix 域套接字）按 chunked 事件写出
+    struct EventStream {
+        bool started = false;  // 是否已写出响应头，只由写出方访问
+
+        void push(JsonString message);
+        std::deque<JsonString> take();
+        void setProgress(McpProgressReporter progress);
+        // 发出已到间隔的合并进度
+        void flushDue();
+        // 是否有需要按间隔发出的进度
+        bool hasProgress();
+        // push() 时通知的唤醒点（处理协程等待期间设置，结束后清空）
+        void setWake(std::shared_ptr<McpWakeSignal> wake);
+
+    private:
+        std::mutex m_mutex;
+        std::deque<JsonString> m_pending;
+        McpProgressReporter m_progress;
+        std::shared_ptr<McpWakeSignal> m_wake;
+    };
+
+    // 单个 POST 请求的传输上下文
+    struct RequestScope {
+        int connection = -1;             // 可检测关闭的连接标识（Unix 域套接字描述符），否则为 -1
+        EventStream* stream = nullptr;   // 客户端接受 SSE 响应时非空
+        http::HttpConn* conn = nullptr;  // 非空时等待处理函数期间由处理协程写出进度事件
+        McpUnixSocket* socket = nullptr;   // Unix 域套接字连接：流式响应由处理协程直接写出
+        std::mutex* socketMutex = nullptr; // 与连接线程写出进度事件互斥
+        bool streamed = false;             // 响应已由处理协程直接写出；Unix 域套接字上受 socketMutex 保护
+        std::shared_ptr<McpSession> session;  // 请求头 Mcp-Session-Id 对应的会话，或 initialize 新建的会话
+        std::string issuedSessionId;     // initialize 新建的会话，随响应头 Mcp-Session-Id 返回
+    };
+
+    // 处理 TCP 连接上的一个 POST /mcp 请求并写出响应
+    Coroutine handlePost(http::HttpConn& conn, http::HttpRequest& req, bool& connectionInitialized);
+
     // 发送JSON响应的协程（只有这一层是协程）
-    Coroutine sendJsonResponse(http::HttpConn& conn, const JsonString& responseJson);
+    Coroutine sendJsonResponse(http::HttpConn& conn, const JsonString& responseJson, std::string_view sessionId = {});
+
+    // 构造完整的 HTTP/1.1 200 响应报文；sessionId 非空时附带 Mcp-Session-Id 头
+    JsonString buildHttpResponse(const JsonString& responseJson, std::string_view sessionId = {}) const;
+
+    // 构造无正文的状态响应（404 等）
+    JsonString buildStatusResponse(int code, std::string_view reason, bool keepAlive = false) const;
+
+    // SSE 响应头（chunked）
+    JsonString buildEventStreamHead() const;
+
+    // 流式 tools/call / resources/read 的 application/json 响应头（chunked）
+    JsonString buildChunkedJsonHead() const;
+
+    // 写出流式响应的一段正文（作为一个 chunk）；begin 时先写出响应头，SSE 时连同已排队的进度事件，
+    // end 时追加结束块。写出失败时 ok 置为 false
+    Coroutine writeStreamed(RequestScope& scope, JsonString payload, bool begin, bool end, bool& ok);
+
+    // 编码 cursor 之后的会话事件（带 id），并推进 cursor
+    JsonString takeSessionEvents(McpSession& session, uint64_t& cursor) const;
+
+    // GET /mcp：写出会话事件流，直到连接断开、会话结束或服务器停止
+    Coroutine serveEventStream(http::HttpConn& conn, std::string sessionId, std::string lastEventId);
+    void serveUnixEventStream(McpUnixSocket& socket, const McpUnixHttpMessage& message);
+
+    // 取出 stream 中待发送的事件并编码为 chunked SSE 字节（首次附带响应头）；
+    // finalResponse 非空时追加最终响应事件与结束块
+    JsonString drainEventStream(EventStream& stream, const JsonString* finalResponse) const;
+
+    // 写出 SSE 事件；最终响应之前没有任何事件时退化为普通 JSON 响应
+    Coroutine sendEvents(http::HttpConn& conn, EventStream& stream, const JsonString* finalResponse);
+
+    // Unix 域套接字监听：accept 循环与每连接 keep-alive 循环
+    void startUnix();
+    void serveUnixConnection(McpUnixSocket socket, uint64_t serial);
+    // 回收已结束的连接线程；all 为 true 时等待全部连接结束
+    void joinUnixConnections(bool all);
+    Coroutine processUnixRequest(const std::string& requestBody,
+                                 JsonString& responseJson,
+                                 bool& connectionInitialized,
+                                 RequestScope& scope,
+                                 std::promise<void>& done,
+                                 std::shared_ptr<McpWakeSignal> wake);
+
+    // 进程内调用：在本地运行时上执行协程处理函数并等待完成
+    std::expected<void, McpError> runLocal(const std::function<Coroutine()>& body);
+    Coroutine runLocalTask(const std::function<Coroutine()>& body, std::promise<void>& done);
 
     // 处理JSON-RPC请求（协程）
-    Coroutine processRequest(const std::string& requestBody, JsonString& responseJson, bool& connectionInitialized);
-
-    // 处理各种方法（全部同步，除了需要调用handler的）
-    JsonString handleInitialize(const JsonRpcRequestView& request, bool& connectionInitialized);
-    JsonString handleToolsList(const JsonRpcRequestView& request, bool& connectionInitialized);
-    Coroutine handleToolsCall(const JsonRpcRequestView& request, JsonString& responseJson, bool& connectionInitialized);
-    JsonString handleResourcesList(const JsonRpcRequestView& request, bool& connectionInitialized);
-    Coroutine handleResourcesRead(const JsonRpcRequestView& request, JsonString& responseJson, bool& connectionInitialized);
-    JsonString handlePromptsList(const JsonRpcRequestView& request, bool& connectionInitialized);
-    Coroutine handlePromptsGet(const JsonRpcRequestView& request, JsonString& responseJson, bool& connectionInitialized);
+    Coroutine processRequest(const std::string& requestBody,
+                             JsonString& responseJson,
+                             bool& connectionInitialized,
+                             RequestScope& scope);
+
+    // 处理各种方法（全部同步，除了需要调用handler的）；initialized 为连接或会话是否已初始化
+    JsonString handleInitialize(const JsonRpcRequestView& request,
+                                bool& connectionInitialized,
+                                RequestScope& scope);
+    JsonString handleToolsList(const JsonRpcRequestView& request, bool initialized);
+    Coroutine handleToolsCall(const JsonRpcRequestView& request,
+                              JsonString& responseJson,
+                              bool initialized,
+                              McpAdmissionController::Clock::time_point arrival,
+                              RequestScope& scope);
+    JsonString handleResourcesList(const JsonRpcRequestView& request, bool initialized);
+    Coroutine handleResourcesRead(const JsonRpcRequestView& request,
+                                  JsonString& responseJson,
+                                  bool initialized,
+                                  RequestScope& scope);
+    // resources/subscribe 与 resources/unsubscribe：订阅记录在会话中，没有会话时返回 INVALID_REQUEST
+    JsonString handleResourcesSubscribe(const JsonRpcRequestView& request, McpSession* session, bool subscribe);
+    JsonString handlePromptsList(const JsonRpcRequestView& request, bool initialized);
+    Coroutine handlePromptsGet(const JsonRpcRequestView& request, JsonString& responseJson, bool initialized);
     JsonString handlePing(const JsonRpcRequestView& request);
+    // notifications/cancelled：只取消同一请求方（inflightOwner）发出的调用
+    JsonString handleCancelled(const JsonRpcRequestView& request, const RequestScope& scope);
+
+    // 在途调用表中的请求方标识：会话 id，没有会话时为连接标识
+    static std::string inflightOwner(const RequestScope& scope);
 
     JsonString createErrorResponse(int64_t id, int code, const std::string& message, const std::string& details = "");
 
-    const JsonString& getToolsListResult();
-    const JsonString& getResourcesListResult();
-    const JsonString& getPromptsListResult();
+    // 被准入控制拒绝的请求：只扫描 id，不解析 params
+    JsonString createOverloadedResponse(const std::string& requestBody, const std::string& reason);
 
 private:
     std::string m_host;
@@ -97,34 +493,128 @@ private:
 
     struct ToolInfo {
         Tool tool;
-        ToolHandler handler;
+        ContextToolHandler handler;               // 协程处理函数
+        BlockingContextToolHandler blockingHandler; // 同步处理函数（与 handler 二选一）
+        StreamingToolHandler streamingHandler;      // 流式处理函数（非空时 handler 与 blockingHandler 为空）
+        McpToolOptions options;
+        std::shared_ptr<McpComputePool> pool;      // Compute 共享的线程池或 Dedicated 独占的线程；为空时在 IO 调度器上执行
+        std::shared_ptr<std::atomic<size_t>> inFlight; // options.maxInFlight > 0 时的当前并发数
+        std::shared_ptr<McpAsyncSemaphore> limiter;     // options.maxConcurrency > 0 时的并发名额
+        std::shared_ptr<const McpManifest> manifest;    // 由清单加载时持有清单：tool.inputSchema 为空，schema 指向映射
+        std::string_view schema;
+        uint64_t cacheScope = 0;                        // options.cacheTtl > 0 或 coalesce 时的注册代次，参与调用键
     };
-    std::unordered_map<std::string, ToolInfo> m_tools;
+
+    // 按 McpToolOptions 创建工具的执行线程与并发限制状态
+    void applyToolOptions(ToolInfo& info, const McpToolOptions& options);
+    McpRegistry<ToolInfo> m_tools;
+
+    // 设置了 cacheTtl 的工具的调用结果
+    McpResultCache m_resultCache;
+
+    // 设置了 coalesce 的工具调用（按调用键）与资源读取（按 URI）的进行中执行
+    McpSingleFlight m_toolFlights;
+    McpSingleFlight m_resourceFlights;
+
+    // 等待合并的执行完成（协程）；cancellation 被触发时提前返回，此时 call.ready() 仍为 false
+    Coroutine awaitFlight(const McpSingleFlight::Call& call, const McpCancellationToken& cancellation);
+
+    // 按工具的并发名额与执行方式调用处理函数（协程）；arrival 非默认值时在处理函数开始执行时上报排队时延；
+    // stream 与 conn 非空时在排队与等待计算线程期间写出进度事件
+    Coroutine invokeTool(const ToolInfo& info,
+                         const JsonElement& arguments,
+                         const McpToolContext& context,
+                         std::expected<JsonString, McpError>& result,
+                         McpAdmissionController::Clock::time_point arrival = {},
+                         EventStream* stream = nullptr,
+                         http::HttpConn* conn = nullptr);
+
+    // 等待 wake 的下一次通知（协程）；stream 与 conn 非空时期间的进度事件也会唤醒，醒来后写出，
+    // 有合并中的进度时最迟在一个进度间隔后醒来
+    Coroutine waitWake(const std::shared_ptr<McpWakeSignal>& wake, EventStream* stream, http::HttpConn* conn);
+
+    // 按工具的并发名额排队（协程）；排队期间被取消时 permit 未就绪即返回
+    Coroutine acquirePermit(const ToolInfo& info,
+                            const McpCancellationToken& cancellation,
+                            McpAsyncSemaphore::Permit& permit,
+                            EventStream* stream,
+                            http::HttpConn* conn);
+
+    // 流式结果的生产函数，在计算线程上执行
+    using StreamProducer = std::function<std::expected<void, McpError>(McpContentWriter&)>;
+
+    // 在 pool 上执行 produce，把 resultPrefix + 编码后的内容 + resultSuffix 作为响应写到 scope 对应的连接，
+    // 输出不足一块时写入 responseJson；context 给出请求 id、取消令牌与进度（资源读取只有 id）
+    Coroutine streamResult(McpComputePool& pool,
+                           McpContentEncoding encoding,
+                           JsonString resultPrefix,
+                           JsonString (*resultSuffix)(const McpError*),
+                           StreamProducer produce,
+                           const McpToolContext& context,
+                           RequestScope& scope,
+                           JsonString& responseJson);
+
+    // 流式工具：按并发名额排队后经 streamResult 执行
+    Coroutine streamTool(const ToolInfo& info,
+                         const JsonElement& arguments,
+                         const McpToolContext& context,
+                         McpAdmissionController::Clock::time_point arrival,
+                         RequestScope& scope,
+                         JsonString& responseJson);
 
     struct ResourceInfo {
         Resource resource;
         ResourceReader reader;
+        McpResourceOptions options;
+        StreamingResourceReader streamingReader;      // 非空时代替 reader
+        bool blob = false;
+        std::shared_ptr<McpComputePool> pool;         // 流式读取函数执行的共享计算线程池
+        std::shared_ptr<const McpManifest> manifest;  // 列表 JSON 指向清单映射时持有清单
     };
-    std::unordered_map<std::string, ResourceInfo> m_resources;
+    McpRegistry<ResourceInfo> m_resources;
 
     struct PromptInfo {
         Prompt prompt;
         PromptGetter getter;
     };
-    std::unordered_map<std::string, PromptInfo> m_prompts;
-
-    JsonString m_toolsListCache;
-    JsonString m_resourcesListCache;
-    JsonString m_promptsListCache;
-    bool m_toolsCacheDirty;
-    bool m_resourcesCacheDirty;
-    bool m_promptsCacheDirty;
+    McpRegistry<PromptInfo> m_prompts;
 
     std::atomic<bool> m_running;
-    std::atomic<bool> m_initialized;
 
     std::unique_ptr<http::HttpServer> m_httpServer;
     std::unique_ptr<http::HttpRouter> m_router;
+
+    // Unix 域套接字监听状态
+    std::unique_ptr<kernel::Runtime> m_unixRuntime;
+    McpUnixSocket m_unixListener;
+    std::mutex m_unixMutex;
+    std::condition_variable m_unixDrained;
+    std::unordered_set<int> m_unixConnections;
+    size_t m_unixActiveConnections{0};
+    size_t m_unixMaxConnections{256};
+    uint64_t m_unixNextSerial{0};
+    std::unordered_map<uint64_t, std::thread> m_unixThreads; // 连接线程，按连接序号索引
+    std::vector<uint64_t> m_unixFinished;                    // 已结束、等待 join 的连接序号
+
+    // 准入控制
+    McpAdmissionController m_admission;
+
+    // 进行中的 tools/call：按 (请求方, 请求 id) 索引取消源
+    McpInflightCalls m_inflight;
+
+    // Compute 工具与流式资源共享的计算线程池（首次需要时创建）
+    std::shared_ptr<McpComputePool> sharedComputePool();
+    std::mutex m_computePoolMutex;
+    std::shared_ptr<McpComputePool> m_computePool;
+
+    std::chrono::milliseconds m_progressInterval{100};
+
+    // Streamable HTTP 会话（initialize 时创建，DELETE /mcp、空闲过期或 stop() 时结束）
+    McpSessionTable m_sessions;
+
+    // 进程内调用的运行时（首次调用时创建）
+    std::unique_ptr<kernel::Runtime> m_localRuntime;
+    std::mutex m_localMutex;
 };
 
 } // namespace mcp
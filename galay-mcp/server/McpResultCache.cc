@@ -0,0 +1,242 @@
+#include "galay-mcp/server/McpResultCache.h"
+#include <algorithm>
+#include <bit>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+// 条目在键与结果之外的固定开销（链表节点与哈希表槽位的近似值）
+constexpr size_t kEntryOverhead = 96;
+
+// 按规范形式写出 JSON 值：对象键按字典序排列，不含空白
+void WriteCanonical(const JsonElement& element, JsonWriter& writer) {
+    switch (element.type()) {
+    case simdjson::dom::element_type::OBJECT: {
+        JsonObject object;
+        JsonHelper::GetObject(element, object);
+        std::vector<std::pair<std::string_view, JsonElement>> fields;
+        for (auto field : object) {
+            fields.emplace_back(field.key, field.value);
+        }
+        std::sort(fields.begin(), fields.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        writer.StartObject();
+        for (const auto& [key, value] : fields) {
+            writer.Key(std::string(key));
+            WriteCanonical(value, writer);
+        }
+        writer.EndObject();
+        break;
+    }
+    case simdjson::dom::element_type::ARRAY: {
+        JsonArray array;
+        JsonHelper::GetArray(element, array);
+        writer.StartArray();
+        for (auto value : array) {
+            WriteCanonical(value, writer);
+        }
+        writer.EndArray();
+        break;
+    }
+    case simdjson::dom::element_type::STRING:
+        writer.String(std::string(element.get_string().value_unsafe()));
+        break;
+    case simdjson::dom::element_type::INT64:
+        writer.Number(element.get_int64().value_unsafe());
+        break;
+    case simdjson::dom::element_type::UINT64:
+        writer.Number(element.get_uint64().value_unsafe());
+        break;
+    case simdjson::dom::element_type::DOUBLE:
+        writer.Number(element.get_double().value_unsafe());
+        break;
+    case simdjson::dom::element_type::BOOL:
+        writer.Bool(element.get_bool().value_unsafe());
+        break;
+    case simdjson::dom::element_type::NULL_VALUE:
+        writer.Null();
+        break;
+    }
+}
+
+} // namespace
+
+McpResultCache::McpResultCache(const McpResultCacheOptions& options) {
+    auto applied = setOptions(options);
+    (void)applied;
+}
+
+std::expected<void, McpError> McpResultCache::setOptions(const McpResultCacheOptions& options) {
+    m_options = options;
+    const size_t shards = std::bit_ceil(std::max<size_t>(m_options.shards, 1));
+    m_options.shards = shards;
+    m_shards = std::make_unique<Shard[]>(shards);
+    m_shardMask = shards - 1;
+    m_shardBudget = m_options.maxBytes / shards;
+
+    // 先关闭旧的持久层，同一目录可以重新打开
+    m_store.reset();
+    if (m_options.persistentPath.empty()) {
+        return {};
+    }
+    auto store = McpResultStore::open(m_options.persistentPath, m_options.persistent);
+    if (!store) {
+        m_options.persistentPath.clear();
+        return std::unexpected(store.error());
+    }
+    m_store = std::move(store.value());
+    return {};
+}
+
+uint64_t McpResultCache::newScope(std::string_view tool) {
+    std::lock_guard<std::mutex> lock(m_scopeMutex);
+    auto it = m_scopes.find(std::string(tool));
+    if (it == m_scopes.end()) {
+        const uint64_t scope = m_store ? m_store->generation(tool) : 0;
+        m_scopes.emplace(std::string(tool), scope);
+        return scope;
+    }
+    const uint64_t scope = ++it->second;
+    if (m_store) {
+        m_store->setGeneration(tool, scope);
+    }
+    return scope;
+}
+
+McpResultCacheKey McpResultCache::makeKey(std::string_view tool, uint64_t scope, const JsonElement& arguments) {
+    JsonWriter writer;
+    WriteCanonical(arguments, writer);
+    const std::string canonical = writer.TakeString();
+    const std::string scopeText = std::to_string(scope);
+
+    McpResultCacheKey key;
+    key.text.reserve(tool.size() + scopeText.size() + canonical.size() + 2);
+    key.text.append(tool);
+    key.text.push_back('\0');
+    key.text.append(scopeText);
+    key.text.push_back('\0');
+    key.text.append(canonical);
+    key.hash = std::hash<std::string_view>{}(key.text);
+    return key;
+}
+
+McpResultCache::Shard& McpResultCache::shardFor(uint64_t hash) const {
+    // 混入哈希高位选分段，避免与分段内哈希表的分桶位相关
+    return m_shards[(hash >> 32 ^ hash) & m_shardMask];
+}
+
+void McpResultCache::erase(Shard& shard, std::list<Entry>::iterator entry) {
+    shard.bytes -= entry->bytes;
+    shard.index.erase(entry->hash);
+    shard.lru.erase(entry);
+}
+
+std::optional<JsonString> McpResultCache::find(const McpResultCacheKey& key, Clock::time_point now) {
+    {
+        Shard& shard = shardFor(key.hash);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key.hash);
+        if (it != shard.index.end() && it->second->key == key.text) {
+            if (now < it->second->expires) {
+                shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return it->second->result;
+            }
+            erase(shard, it->second);
+            m_expirations.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // 持久层命中的结果以剩余 TTL 放回内存层
+    if (m_store) {
+        if (auto hit = m_store->find(key.text)) {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                hit->expires - McpResultStore::Clock::now());
+            m_hits.fetch_add(1, std::memory_order_relaxed);
+            m_persistentHits.fetch_add(1, std::memory_order_relaxed);
+            insert(key, hit->result, remaining, now);
+            return std::move(hit->result);
+        }
+    }
+    m_misses.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+}
+
+void McpResultCache::store(const McpResultCacheKey& key,
+                           JsonString result,
+                           std::chrono::milliseconds ttl,
+                           Clock::time_point now) {
+    if (ttl.count() <= 0) {
+        return;
+    }
+    if (m_store) {
+        m_store->store(key.text, result, McpResultStore::Clock::now() + ttl);
+    }
+    insert(key, std::move(result), ttl, now);
+}
+
+void McpResultCache::insert(const McpResultCacheKey& key,
+                            JsonString result,
+                            std::chrono::milliseconds ttl,
+                            Clock::time_point now) {
+    const size_t bytes = key.text.size() + result.size() + kEntryOverhead;
+    if (ttl.count() <= 0 || bytes > m_shardBudget) {
+        return;
+    }
+
+    Shard& shard = shardFor(key.hash);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // 同一键（或哈希冲突的旧键）被并发调用重复写入时以最后一次为准
+    if (auto it = shard.index.find(key.hash); it != shard.index.end()) {
+        erase(shard, it->second);
+    }
+    while (shard.bytes + bytes > m_shardBudget && !shard.lru.empty()) {
+        erase(shard, std::prev(shard.lru.end()));
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.lru.push_front(Entry{key.hash, key.text, std::move(result), now + ttl, bytes});
+    shard.index.emplace(key.hash, shard.lru.begin());
+    shard.bytes += bytes;
+    m_inserts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void McpResultCache::clear() {
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.lru.clear();
+        shard.index.clear();
+        shard.bytes = 0;
+    }
+    if (m_store) {
+        m_store->clear();
+    }
+}
+
+McpResultCacheStats McpResultCache::stats() const {
+    McpResultCacheStats stats;
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        const Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.entries += shard.lru.size();
+        stats.bytes += shard.bytes;
+    }
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.inserts = m_inserts.load(std::memory_order_relaxed);
+    stats.evictions = m_evictions.load(std::memory_order_relaxed);
+    stats.expirations = m_expirations.load(std::memory_order_relaxed);
+    stats.persistentHits = m_persistentHits.load(std::memory_order_relaxed);
+    if (m_store) {
+        stats.persistent = m_store->stats();
+    }
+    return stats;
+}
+
+} // namespace mcp
+} // namespace galay
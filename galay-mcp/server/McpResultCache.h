@@ -0,0 +1,146 @@
+#ifndef GALAY_MCP_SERVER_MCPRESULTCACHE_H
+#define GALAY_MCP_SERVER_MCPRESULTCACHE_H
+
+#include "galay-mcp/common/McpJson.h"
+#include "galay-mcp/server/McpResultStore.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 工具结果缓存选项
+ */
+struct McpResultCacheOptions {
+    // 锁分段数（向上取 2 的幂）；查找与写入只锁条目所在的分段
+    size_t shards = 16;
+    // 全部条目（键与结果字节）的内存预算，平均分给各分段；超出时按 LRU 淘汰
+    size_t maxBytes = 64 * 1024 * 1024;
+    // 持久层目录；为空时只缓存在内存中。设置后结果同时写入该目录下的日志，重启后仍可命中
+    std::string persistentPath;
+    // 持久层的日志上限与压缩阈值
+    McpResultStoreOptions persistent;
+};
+
+/**
+ * @brief 工具结果缓存计数快照
+ */
+struct McpResultCacheStats {
+    size_t entries = 0;
+    size_t bytes = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;    // 超出内存预算被淘汰的条目
+    uint64_t expirations = 0;  // 查找时发现已过期而删除的条目
+    uint64_t persistentHits = 0;  // 内存未命中、由持久层命中的次数（计入 hits）
+    McpResultStoreStats persistent;  // 未开启持久层时全为 0
+};
+
+/**
+ * @brief 工具调用结果的缓存键：工具名、工具注册代次与规范化参数
+ */
+struct McpResultCacheKey {
+    uint64_t hash = 0;
+    std::string text;
+};
+
+/**
+ * @brief 分段加锁、带 TTL 与内存预算的 LRU 工具结果缓存
+ *
+ * 键由工具名、工具注册代次（scope）与规范化后的 arguments 组成：对象键按字典序排列、
+ * 去掉空白，键顺序或格式不同的等价参数命中同一条目。值是预先序列化的 result 片段，
+ * 命中时只是一次拷贝，不再调用处理函数，也不再序列化 ToolCallResult。
+ * 重新注册同名工具时 scope 加一，旧条目不再命中，随 LRU 淘汰或过期回收。
+ * 条目按键的哈希分布到各分段，每个分段一把锁、一条 LRU 链表与一张哈希表。所有方法线程安全。
+ *
+ * 设置 persistentPath 后在内存之下增加一层 McpResultStore：写入同时追加到磁盘日志，
+ * 内存未命中时查磁盘，命中的条目以剩余 TTL 放回内存。scope 按工具名记录在磁盘上，
+ * 进程内首次注册沿用上次记录的代次，键跨重启不变；进程内替换实现时代次加一并写回磁盘。
+ * 因此持久层假定各次启动首次注册的同名工具实现相同，实现变化（例如升级）后应改名或 clear()。
+ */
+class McpResultCache {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit McpResultCache(const McpResultCacheOptions& options = {});
+
+    McpResultCache(const McpResultCache&) = delete;
+    McpResultCache& operator=(const McpResultCache&) = delete;
+
+    // 只能在没有条目、注册可缓存工具之前调用（服务器 start() / run() 之前）；
+    // 持久层目录无法打开时返回错误，此时只使用内存层。构造函数忽略该错误
+    std::expected<void, McpError> setOptions(const McpResultCacheOptions& options);
+    const McpResultCacheOptions& options() const { return m_options; }
+
+    // 为新注册的可缓存工具分配注册代次：进程内首次注册沿用持久层记录的代次（没有时为 0），之后每次加一
+    uint64_t newScope(std::string_view tool);
+
+    static McpResultCacheKey makeKey(std::string_view tool, uint64_t scope, const JsonElement& arguments);
+
+    // 命中且未过期时返回结果片段的拷贝
+    std::optional<JsonString> find(const McpResultCacheKey& key, Clock::time_point now = Clock::now());
+
+    // 写入结果片段；单个条目超过分段预算时不进入内存层（持久层仍会写入）
+    void store(const McpResultCacheKey& key,
+               JsonString result,
+               std::chrono::milliseconds ttl,
+               Clock::time_point now = Clock::now());
+
+    // 清空内存层与持久层
+    void clear();
+
+    McpResultCacheStats stats() const;
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::string key;
+        JsonString result;
+        Clock::time_point expires;
+        size_t bytes;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::list<Entry> lru;  // 表头为最近使用
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+        size_t bytes = 0;
+    };
+
+    Shard& shardFor(uint64_t hash) const;
+    void erase(Shard& shard, std::list<Entry>::iterator entry);
+    void insert(const McpResultCacheKey& key, JsonString result, std::chrono::milliseconds ttl, Clock::time_point now);
+
+    McpResultCacheOptions m_options;
+    std::unique_ptr<Shard[]> m_shards;
+    size_t m_shardMask = 0;
+    size_t m_shardBudget = 0;
+
+    std::unique_ptr<McpResultStore> m_store;
+
+    std::mutex m_scopeMutex;
+    std::unordered_map<std::string, uint64_t> m_scopes;  // 工具名 -> 当前代次
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_inserts{0};
+    std::atomic<uint64_t> m_evictions{0};
+    std::atomic<uint64_t> m_expirations{0};
+    std::atomic<uint64_t> m_persistentHits{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_SERVER_MCPRESULTCACHE_H
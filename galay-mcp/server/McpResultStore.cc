@@ -0,0 +1,792 @@
+#include "galay-mcp/server/McpResultStore.h"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+constexpr char kLogMagic[8] = {'G', 'M', 'C', 'P', 'R', 'L', 'O', 'G'};
+constexpr char kIndexMagic[8] = {'G', 'M', 'C', 'P', 'R', 'I', 'D', 'X'};
+constexpr uint32_t kRecordMagic = 0x4d435052;
+constexpr uint16_t kEntryRecord = 1;
+constexpr uint16_t kGenerationRecord = 2;
+constexpr uint64_t kMinCapacity = 1024;
+constexpr uint32_t kMaxKeySize = 1024 * 1024;
+// 日志已满、但没有追加新记录时，拒绝写入触发压缩的最短间隔（回收过期条目）
+constexpr auto kRejectCompactInterval = std::chrono::minutes(1);
+
+struct LogHeader {
+    char magic[8];
+    uint64_t epoch;
+};
+
+struct IndexHeader {
+    char magic[8];
+    uint64_t epoch;      // 与日志头一致时索引才有效
+    uint64_t capacity;   // 槽位数，2 的幂
+    uint64_t count;      // 已占用的槽位（条目与代次记录）
+    uint64_t entries;    // 其中的结果条目
+    uint64_t logSize;    // 已编入索引的日志长度
+    uint64_t liveBytes;  // 槽位指向的记录字节之和
+    uint64_t reserved;
+};
+
+// offset 为 0 表示空槽：记录都在日志头之后
+struct Slot {
+    uint64_t hash;
+    uint64_t offset;
+};
+
+struct RecordHeader {
+    uint32_t magic;
+    uint16_t type;
+    uint16_t reserved;
+    uint32_t keySize;
+    uint32_t valueSize;
+    int64_t stamp;  // 条目：过期时刻（Unix 毫秒）；代次记录：代次
+    uint32_t checksum;
+    uint32_t reserved2;
+};
+
+static_assert(sizeof(IndexHeader) == 64 && sizeof(Slot) == 16 && sizeof(RecordHeader) == 32);
+
+struct Record {
+    RecordHeader header{};
+    std::string key;
+    std::string value;
+};
+
+std::string ErrnoMessage(const char* what, const std::string& path) {
+    return std::string(what) + " " + path + ": " + std::strerror(errno);
+}
+
+// 把文件内容落盘；rename 替换之前调用，掉电后新文件名不会指向未写完的内容
+bool SyncData(int fd) {
+#if defined(__APPLE__)
+    return ::fsync(fd) == 0;
+#else
+    return ::fdatasync(fd) == 0;
+#endif
+}
+
+// 把目录项落盘，使之前的 rename 在掉电后仍然生效
+bool SyncDirectory(const std::string& directory) {
+    const int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    const bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+uint64_t HashKey(uint16_t type, std::string_view key) {
+    // FNV-1a：与标准库实现无关，索引文件跨构建保持有效
+    uint64_t hash = 14695981039346656037ull ^ type;
+    hash *= 1099511628211ull;
+    for (unsigned char c : key) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint32_t Checksum(std::string_view key, std::string_view value) {
+    uint32_t hash = 2166136261u;
+    for (std::string_view part : {key, value}) {
+        for (unsigned char c : part) {
+            hash ^= c;
+            hash *= 16777619u;
+        }
+    }
+    return hash;
+}
+
+uint64_t RecordBytes(const RecordHeader& header) {
+    return sizeof(RecordHeader) + header.keySize + header.valueSize;
+}
+
+uint64_t NewEpoch() {
+    std::random_device device;
+    const uint64_t random = static_cast<uint64_t>(device()) << 32 | device();
+    return random ^ static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count());
+}
+
+int64_t ToMillis(McpResultStore::Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+McpResultStore::Clock::time_point FromMillis(int64_t millis) {
+    return McpResultStore::Clock::time_point(
+        std::chrono::duration_cast<McpResultStore::Clock::duration>(std::chrono::milliseconds(millis)));
+}
+
+bool WriteAll(int fd, const void* data, size_t size, uint64_t offset) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        const ssize_t written = ::pwrite(fd, bytes, size, static_cast<off_t>(offset));
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+        offset += static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+bool ReadAll(int fd, void* data, size_t size, uint64_t offset) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        const ssize_t read = ::pread(fd, bytes, size, static_cast<off_t>(offset));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            return false;
+        }
+        bytes += read;
+        size -= static_cast<size_t>(read);
+        offset += static_cast<uint64_t>(read);
+    }
+    return true;
+}
+
+bool ReadRecord(int fd, uint64_t offset, Record& record, bool withValue) {
+    if (!ReadAll(fd, &record.header, sizeof(RecordHeader), offset)) {
+        return false;
+    }
+    const RecordHeader& header = record.header;
+    if (header.magic != kRecordMagic || (header.type != kEntryRecord && header.type != kGenerationRecord) ||
+        header.keySize > kMaxKeySize) {
+        return false;
+    }
+    record.key.resize(header.keySize);
+    if (!ReadAll(fd, record.key.data(), header.keySize, offset + sizeof(RecordHeader))) {
+        return false;
+    }
+    if (withValue) {
+        record.value.resize(header.valueSize);
+        return ReadAll(fd, record.value.data(), header.valueSize, offset + sizeof(RecordHeader) + header.keySize);
+    }
+    return true;
+}
+
+bool WriteRecord(int fd, uint64_t offset, uint16_t type, std::string_view key, std::string_view value, int64_t stamp) {
+    RecordHeader header{};
+    header.magic = kRecordMagic;
+    header.type = type;
+    header.keySize = static_cast<uint32_t>(key.size());
+    header.valueSize = static_cast<uint32_t>(value.size());
+    header.stamp = stamp;
+    header.checksum = Checksum(key, value);
+
+    std::string buffer;
+    buffer.reserve(sizeof(RecordHeader) + key.size() + value.size());
+    buffer.append(reinterpret_cast<const char*>(&header), sizeof(RecordHeader));
+    buffer.append(key);
+    buffer.append(value);
+    return WriteAll(fd, buffer.data(), buffer.size(), offset);
+}
+
+IndexHeader* HeaderOf(void* index) {
+    return static_cast<IndexHeader*>(index);
+}
+
+Slot* SlotsOf(void* index) {
+    return reinterpret_cast<Slot*>(static_cast<char*>(index) + sizeof(IndexHeader));
+}
+
+size_t IndexBytes(uint64_t capacity) {
+    return sizeof(IndexHeader) + capacity * sizeof(Slot);
+}
+
+// 线性探测，found 为 false 时返回可写入的空槽
+uint64_t Probe(int fd, void* index, uint16_t type, std::string_view key,
+               Record& record, bool withValue, bool& found) {
+    const uint64_t hash = HashKey(type, key);
+    const uint64_t mask = HeaderOf(index)->capacity - 1;
+    const Slot* slots = SlotsOf(index);
+    for (uint64_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.offset == 0) {
+            found = false;
+            return i;
+        }
+        if (slot.hash == hash && ReadRecord(fd, slot.offset, record, withValue) &&
+            record.header.type == type && record.key == key) {
+            found = true;
+            return i;
+        }
+    }
+}
+
+// 只按哈希放入空槽，用于重建索引（键已知互不相同）
+void PlaceSlot(void* index, uint64_t hash, uint64_t offset) {
+    const uint64_t mask = HeaderOf(index)->capacity - 1;
+    Slot* slots = SlotsOf(index);
+    uint64_t i = hash & mask;
+    while (slots[i].offset != 0) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = Slot{hash, offset};
+}
+
+bool WriteLogHeader(int fd, uint64_t epoch) {
+    LogHeader header{};
+    std::memcpy(header.magic, kLogMagic, sizeof(kLogMagic));
+    header.epoch = epoch;
+    return ::ftruncate(fd, 0) == 0 && WriteAll(fd, &header, sizeof(header), 0);
+}
+
+void InitIndex(void* mapping, uint64_t epoch, uint64_t capacity) {
+    IndexHeader* header = HeaderOf(mapping);
+    std::memcpy(header->magic, kIndexMagic, sizeof(kIndexMagic));
+    header->epoch = epoch;
+    header->capacity = capacity;
+    header->logSize = sizeof(LogHeader);
+}
+
+// 新建并映射一个空索引文件
+std::expected<std::pair<int, void*>, McpError> CreateIndex(const std::string& path, uint64_t epoch, uint64_t capacity) {
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(McpError::readError(ErrnoMessage("open", path)));
+    }
+    const size_t bytes = IndexBytes(capacity);
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::string message = ErrnoMessage("ftruncate", path);
+        ::close(fd);
+        return std::unexpected(McpError::readError(message));
+    }
+    void* mapping = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        std::string message = ErrnoMessage("mmap", path);
+        ::close(fd);
+        return std::unexpected(McpError::readError(message));
+    }
+    InitIndex(mapping, epoch, capacity);
+    return std::pair<int, void*>(fd, mapping);
+}
+
+// McpResultCacheKey::text 的形式为 工具名\0代次\0参数
+bool ParseScopedKey(std::string_view key, std::string_view& tool, uint64_t& generation) {
+    const size_t first = key.find('\0');
+    if (first == std::string_view::npos) {
+        return false;
+    }
+    const size_t second = key.find('\0', first + 1);
+    if (second == std::string_view::npos) {
+        return false;
+    }
+    tool = key.substr(0, first);
+    const char* begin = key.data() + first + 1;
+    const char* end = key.data() + second;
+    return std::from_chars(begin, end, generation).ptr == end;
+}
+
+struct StagedRecord {
+    uint16_t type;
+    std::string key;
+    uint64_t offset;
+    uint64_t bytes;
+};
+
+} // namespace
+
+std::expected<std::unique_ptr<McpResultStore>, McpError> McpResultStore::open(const std::string& directory,
+                                                                             const McpResultStoreOptions& options) {
+    if (::mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+        return std::unexpected(McpError::readError(ErrnoMessage("mkdir", directory)));
+    }
+    std::unique_ptr<McpResultStore> store(new McpResultStore());
+    store->m_directory = directory;
+    store->m_options = options;
+    auto loaded = store->load();
+    if (!loaded) {
+        return std::unexpected(loaded.error());
+    }
+    store->m_lastCompaction = Clock::now();
+    store->m_compactor = std::thread([raw = store.get()]() { raw->compactionLoop(); });
+    return store;
+}
+
+McpResultStore::~McpResultStore() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    if (m_compactor.joinable()) {
+        m_compactor.join();
+    }
+    if (m_index) {
+        ::munmap(m_index, m_indexBytes);
+    }
+    if (m_indexFd >= 0) {
+        ::close(m_indexFd);
+    }
+    if (m_logFd >= 0) {
+        ::close(m_logFd);
+    }
+}
+
+std::expected<void, McpError> McpResultStore::load() {
+    const std::string logPath = m_directory + "/results.log";
+    m_logFd = ::open(logPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_logFd < 0) {
+        return std::unexpected(McpError::readError(ErrnoMessage("open", logPath)));
+    }
+    if (::flock(m_logFd, LOCK_EX | LOCK_NB) != 0) {
+        if (errno == EWOULDBLOCK) {
+            return std::unexpected(McpError::readError("result store in use by another process: " + logPath));
+        }
+        return std::unexpected(McpError::readError(ErrnoMessage("flock", logPath)));
+    }
+    struct stat st {};
+    if (::fstat(m_logFd, &st) != 0) {
+        return std::unexpected(McpError::readError(ErrnoMessage("fstat", logPath)));
+    }
+    if (static_cast<size_t>(st.st_size) < sizeof(LogHeader)) {
+        m_epoch = NewEpoch();
+        if (!WriteLogHeader(m_logFd, m_epoch)) {
+            return std::unexpected(McpError::readError(ErrnoMessage("write", logPath)));
+        }
+        m_logSize = sizeof(LogHeader);
+    } else {
+        LogHeader header{};
+        if (!ReadAll(m_logFd, &header, sizeof(header), 0) ||
+            std::memcmp(header.magic, kLogMagic, sizeof(kLogMagic)) != 0) {
+            return std::unexpected(McpError::parseError("not a result log: " + logPath));
+        }
+        m_epoch = header.epoch;
+        m_logSize = static_cast<uint64_t>(st.st_size);
+    }
+
+    // 索引与日志匹配时直接映射，只重放索引之后追加的记录
+    const std::string indexPath = m_directory + "/results.idx";
+    const int indexFd = ::open(indexPath.c_str(), O_RDWR | O_CLOEXEC);
+    if (indexFd >= 0) {
+        IndexHeader header{};
+        struct stat indexStat {};
+        const bool valid = ::fstat(indexFd, &indexStat) == 0 &&
+                           ReadAll(indexFd, &header, sizeof(header), 0) &&
+                           std::memcmp(header.magic, kIndexMagic, sizeof(kIndexMagic)) == 0 &&
+                           header.epoch == m_epoch &&
+                           header.capacity >= kMinCapacity && std::has_single_bit(header.capacity) &&
+                           static_cast<size_t>(indexStat.st_size) == IndexBytes(header.capacity) &&
+                           header.logSize >= sizeof(LogHeader) && header.logSize <= m_logSize;
+        void* mapping = valid ? ::mmap(nullptr, IndexBytes(header.capacity), PROT_READ | PROT_WRITE,
+                                       MAP_SHARED, indexFd, 0)
+                              : MAP_FAILED;
+        if (mapping != MAP_FAILED) {
+            m_indexFd = indexFd;
+            m_index = mapping;
+            m_indexBytes = IndexBytes(header.capacity);
+            m_capacityMask = header.capacity - 1;
+            replay(header.logSize);
+            return {};
+        }
+        ::close(indexFd);
+    }
+
+    auto created = CreateIndex(m_directory + "/results.idx.tmp", m_epoch, kMinCapacity);
+    if (!created) {
+        return std::unexpected(created.error());
+    }
+    auto installed = installIndex(created->first, created->second, IndexBytes(kMinCapacity));
+    if (!installed) {
+        return installed;
+    }
+    replay(sizeof(LogHeader));
+    return {};
+}
+
+void McpResultStore::replay(uint64_t from) {
+    Record record;
+    uint64_t offset = from;
+    while (offset < m_logSize) {
+        if (!ReadRecord(m_logFd, offset, record, true) ||
+            record.header.checksum != Checksum(record.key, record.value) ||
+            !insertSlot(record.header.type, record.key, offset, RecordBytes(record.header))) {
+            break;
+        }
+        offset += RecordBytes(record.header);
+    }
+    // 截掉写到一半的尾部记录，之后的追加从完整记录之后开始
+    if (offset < m_logSize && ::ftruncate(m_logFd, static_cast<off_t>(offset)) == 0) {
+        m_logSize = offset;
+    }
+    HeaderOf(m_index)->logSize = std::min(offset, m_logSize);
+}
+
+std::expected<void, McpError> McpResultStore::installIndex(int fd, void* mapping, size_t bytes) {
+    const std::string path = m_directory + "/results.idx";
+    // 映射中的新索引先落盘再替换，替换后同步目录（compact() 之前替换的日志一并生效）
+    const bool synced = ::msync(mapping, bytes, MS_SYNC) == 0 && SyncData(fd);
+    if (!synced || ::rename((path + ".tmp").c_str(), path.c_str()) != 0) {
+        std::string message = ErrnoMessage(synced ? "rename" : "sync", path);
+        ::munmap(mapping, bytes);
+        ::close(fd);
+        return std::unexpected(McpError::readError(message));
+    }
+    SyncDirectory(m_directory);
+    if (m_index) {
+        ::munmap(m_index, m_indexBytes);
+    }
+    if (m_indexFd >= 0) {
+        ::close(m_indexFd);
+    }
+    m_indexFd = fd;
+    m_index = mapping;
+    m_indexBytes = bytes;
+    m_capacityMask = HeaderOf(mapping)->capacity - 1;
+    return {};
+}
+
+bool McpResultStore::growIndex() {
+    const IndexHeader* old = HeaderOf(m_index);
+    const uint64_t capacity = old->capacity * 2;
+    auto created = CreateIndex(m_directory + "/results.idx.tmp", m_epoch, capacity);
+    if (!created) {
+        return false;
+    }
+    void* mapping = created->second;
+    IndexHeader* header = HeaderOf(mapping);
+    header->count = old->count;
+    header->entries = old->entries;
+    header->logSize = old->logSize;
+    header->liveBytes = old->liveBytes;
+    const Slot* slots = SlotsOf(m_index);
+    for (uint64_t i = 0; i < old->capacity; ++i) {
+        if (slots[i].offset != 0) {
+            PlaceSlot(mapping, slots[i].hash, slots[i].offset);
+        }
+    }
+    return installIndex(created->first, mapping, IndexBytes(capacity)).has_value();
+}
+
+bool McpResultStore::insertSlot(uint16_t type, std::string_view key, uint64_t offset, uint64_t bytes) {
+    // 装载因子不超过 0.7
+    if ((HeaderOf(m_index)->count + 1) * 10 > (m_capacityMask + 1) * 7 && !growIndex()) {
+        return false;
+    }
+    IndexHeader* header = HeaderOf(m_index);
+    Record record;
+    bool found = false;
+    const uint64_t position = Probe(m_logFd, m_index, type, key, record, false, found);
+    Slot& slot = SlotsOf(m_index)[position];
+    if (found) {
+        header->liveBytes -= RecordBytes(record.header);
+    } else {
+        ++header->count;
+        if (type == kEntryRecord) {
+            ++header->entries;
+        }
+    }
+    slot.hash = HashKey(type, key);
+    slot.offset = offset;
+    header->liveBytes += bytes;
+    return true;
+}
+
+bool McpResultStore::append(uint16_t type, std::string_view key, std::string_view value, int64_t stamp) {
+    const uint64_t bytes = sizeof(RecordHeader) + key.size() + value.size();
+    if (key.size() > kMaxKeySize || value.size() > UINT32_MAX) {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    // 代次记录很小且关系到正确性，不受 maxBytes 限制
+    if (type == kEntryRecord && m_logSize + bytes > m_options.maxBytes) {
+        m_rejected.fetch_add(1, std::memory_order_relaxed);
+        if (Clock::now() - m_lastCompaction >= kRejectCompactInterval) {
+            requestCompaction();
+        }
+        return false;
+    }
+    const uint64_t offset = m_logSize;
+    if (!WriteRecord(m_logFd, offset, type, key, value, stamp)) {
+        return false;
+    }
+    m_logSize += bytes;
+    if (!insertSlot(type, key, offset, bytes)) {
+        return false;
+    }
+    IndexHeader* header = HeaderOf(m_index);
+    header->logSize = m_logSize;
+    m_appends.fetch_add(1, std::memory_order_relaxed);
+    if (m_logSize >= m_options.compactMinBytes && header->liveBytes * 2 < m_logSize) {
+        requestCompaction();
+    }
+    return true;
+}
+
+std::optional<McpResultStore::Hit> McpResultStore::find(std::string_view key, Clock::time_point now) {
+    Record record;
+    bool found = false;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        Probe(m_logFd, m_index, kEntryRecord, key, record, true, found);
+    }
+    // 校验和挡住断电后索引指向的未落盘记录
+    if (!found || FromMillis(record.header.stamp) <= now ||
+        record.header.checksum != Checksum(record.key, record.value)) {
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    m_hits.fetch_add(1, std::memory_order_relaxed);
+    return Hit{std::move(record.value), FromMillis(record.header.stamp)};
+}
+
+bool McpResultStore::store(std::string_view key, std::string_view result, Clock::time_point expires) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    return append(kEntryRecord, key, result, ToMillis(expires));
+}
+
+uint64_t McpResultStore::generation(std::string_view tool) const {
+    Record record;
+    bool found = false;
+    std::shared_lock<std::shared_mutex> lock(m_mutex);
+    Probe(m_logFd, m_index, kGenerationRecord, tool, record, false, found);
+    return found ? static_cast<uint64_t>(record.header.stamp) : 0;
+}
+
+void McpResultStore::setGeneration(std::string_view tool, uint64_t generation) {
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    append(kGenerationRecord, tool, {}, static_cast<int64_t>(generation));
+}
+
+void McpResultStore::requestCompaction() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        if (m_compactRequested) {
+            return;
+        }
+        m_compactRequested = true;
+    }
+    m_wake.notify_one();
+}
+
+void McpResultStore::compactionLoop() {
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    while (true) {
+        m_wake.wait(lock, [this]() { return m_stopping || m_compactRequested; });
+        if (m_stopping) {
+            return;
+        }
+        m_compactRequested = false;
+        lock.unlock();
+        compact();
+        lock.lock();
+    }
+}
+
+std::expected<void, McpError> McpResultStore::compact() {
+    std::lock_guard<std::mutex> compactLock(m_compactMutex);
+
+    // 快照索引指向的记录；日志只追加，快照范围内的字节在复制期间不会变化
+    std::vector<uint64_t> offsets;
+    uint64_t snapshotEnd = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        const Slot* slots = SlotsOf(m_index);
+        for (uint64_t i = 0; i <= m_capacityMask; ++i) {
+            if (slots[i].offset != 0) {
+                offsets.push_back(slots[i].offset);
+            }
+        }
+        snapshotEnd = m_logSize;
+    }
+    std::sort(offsets.begin(), offsets.end());
+
+    // 先取各工具的当前代次，旧代次的条目不再可达，随压缩丢弃
+    std::unordered_map<std::string, uint64_t> generations;
+    Record record;
+    for (uint64_t offset : offsets) {
+        if (ReadRecord(m_logFd, offset, record, false) && record.header.type == kGenerationRecord) {
+            generations[record.key] = static_cast<uint64_t>(record.header.stamp);
+        }
+    }
+
+    const std::string logPath = m_directory + "/results.log";
+    const std::string compactPath = logPath + ".compact";
+    const int fd = ::open(compactPath.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(McpError::readError(ErrnoMessage("open", compactPath)));
+    }
+    auto fail = [&](std::string message) -> std::expected<void, McpError> {
+        ::close(fd);
+        ::unlink(compactPath.c_str());
+        return std::unexpected(McpError::readError(std::move(message)));
+    };
+    const uint64_t epoch = NewEpoch();
+    if (::flock(fd, LOCK_EX | LOCK_NB) != 0 || !WriteLogHeader(fd, epoch)) {
+        return fail(ErrnoMessage("write", compactPath));
+    }
+
+    std::vector<StagedRecord> staged;
+    uint64_t size = sizeof(LogHeader);
+    auto copy = [&](uint64_t offset) -> bool {
+        if (!ReadRecord(m_logFd, offset, record, true)) {
+            return true;
+        }
+        if (!WriteRecord(fd, size, record.header.type, record.key, record.value, record.header.stamp)) {
+            return false;
+        }
+        staged.push_back(StagedRecord{record.header.type, record.key, size, RecordBytes(record.header)});
+        size += RecordBytes(record.header);
+        return true;
+    };
+
+    const int64_t now = ToMillis(Clock::now());
+    for (uint64_t offset : offsets) {
+        if (!ReadRecord(m_logFd, offset, record, false)) {
+            continue;
+        }
+        if (record.header.type == kEntryRecord) {
+            std::string_view tool;
+            uint64_t generation = 0;
+            if (record.header.stamp <= now) {
+                continue;
+            }
+            if (ParseScopedKey(record.key, tool, generation)) {
+                auto it = generations.find(std::string(tool));
+                if (generation != (it == generations.end() ? 0 : it->second)) {
+                    continue;
+                }
+            }
+        }
+        if (!copy(offset)) {
+            return fail(ErrnoMessage("write", compactPath));
+        }
+    }
+
+    // 收尾：复制快照之后追加的记录，生成新索引并替换文件
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    for (uint64_t offset = snapshotEnd; offset < m_logSize;) {
+        if (!ReadRecord(m_logFd, offset, record, false)) {
+            break;
+        }
+        const uint64_t next = offset + RecordBytes(record.header);
+        if (!copy(offset)) {
+            return fail(ErrnoMessage("write", compactPath));
+        }
+        offset = next;
+    }
+
+    // 复制期间被覆盖的键以最后一条记录为准
+    std::unordered_map<std::string, size_t> latest;
+    for (size_t i = 0; i < staged.size(); ++i) {
+        std::string typed(1, static_cast<char>(staged[i].type));
+        typed.append(staged[i].key);
+        latest[std::move(typed)] = i;
+    }
+    const uint64_t capacity = std::max(kMinCapacity, std::bit_ceil(static_cast<uint64_t>(latest.size()) * 2));
+    auto fill = [&](void* mapping) {
+        IndexHeader* header = HeaderOf(mapping);
+        for (const auto& [typed, i] : latest) {
+            const StagedRecord& item = staged[i];
+            PlaceSlot(mapping, HashKey(item.type, item.key), item.offset);
+            ++header->count;
+            if (item.type == kEntryRecord) {
+                ++header->entries;
+            }
+            header->liveBytes += item.bytes;
+        }
+        header->logSize = size;
+    };
+    auto created = CreateIndex(m_directory + "/results.idx.tmp", epoch, capacity);
+    if (!created) {
+        return fail(created.error().details());
+    }
+    fill(created->second);
+
+    // 先替换日志：两次 rename 之间退出时新日志与旧索引的 epoch 不同，下次打开会从日志重建索引。
+    // 新日志在 rename 之前落盘，目录由 installIndex() 同步
+    const bool synced = SyncData(fd);
+    if (!synced || ::rename(compactPath.c_str(), logPath.c_str()) != 0) {
+        ::munmap(created->second, IndexBytes(capacity));
+        ::close(created->first);
+        return fail(ErrnoMessage(synced ? "rename" : "fdatasync", synced ? logPath : compactPath));
+    }
+    auto installed = installIndex(created->first, created->second, IndexBytes(capacity));
+    if (!installed) {
+        // 新日志已生效而新索引未能替换：在匿名映射上按新日志重建索引，m_index 与 m_logFd 始终指向同一份日志。
+        // 磁盘上的旧索引与新日志 epoch 不同，下次打开时从日志重建；之后 growIndex() 成功会重新落盘索引
+        void* mapping = ::mmap(nullptr, IndexBytes(capacity), PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mapping == MAP_FAILED) {
+            // 保留旧日志与旧索引：已替换的文件由下次打开时重建，本进程继续使用旧日志
+            ::close(fd);
+            return installed;
+        }
+        InitIndex(mapping, epoch, capacity);
+        fill(mapping);
+        ::munmap(m_index, m_indexBytes);
+        if (m_indexFd >= 0) {
+            ::close(m_indexFd);
+        }
+        m_indexFd = -1;
+        m_index = mapping;
+        m_indexBytes = IndexBytes(capacity);
+        m_capacityMask = capacity - 1;
+    }
+    ::close(m_logFd);
+    m_logFd = fd;
+    m_logSize = size;
+    m_epoch = epoch;
+    m_lastCompaction = Clock::now();
+    m_compactions.fetch_add(1, std::memory_order_relaxed);
+    return installed;
+}
+
+void McpResultStore::clear() {
+    std::lock_guard<std::mutex> compactLock(m_compactMutex);
+    std::unique_lock<std::shared_mutex> lock(m_mutex);
+    const uint64_t epoch = NewEpoch();
+    if (!WriteLogHeader(m_logFd, epoch)) {
+        return;
+    }
+    m_epoch = epoch;
+    m_logSize = sizeof(LogHeader);
+    if (auto created = CreateIndex(m_directory + "/results.idx.tmp", epoch, kMinCapacity)) {
+        installIndex(created->first, created->second, IndexBytes(kMinCapacity));
+    }
+}
+
+McpResultStoreStats McpResultStore::stats() const {
+    McpResultStoreStats stats;
+    {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        const IndexHeader* header = HeaderOf(m_index);
+        stats.entries = header->entries;
+        stats.liveBytes = header->liveBytes;
+        stats.logBytes = m_logSize;
+    }
+    stats.hits = m_hits.load(std::memory_order_relaxed);
+    stats.misses = m_misses.load(std::memory_order_relaxed);
+    stats.appends = m_appends.load(std::memory_order_relaxed);
+    stats.rejected = m_rejected.load(std::memory_order_relaxed);
+    stats.compactions = m_compactions.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace mcp
+} // namespace galay
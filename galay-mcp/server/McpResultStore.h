@@ -0,0 +1,147 @@
+#ifndef GALAY_MCP_SERVER_MCPRESULTSTORE_H
+#define GALAY_MCP_SERVER_MCPRESULTSTORE_H
+
+#include "galay-mcp/common/McpError.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 持久化结果存储选项
+ */
+struct McpResultStoreOptions {
+    // 日志文件上限；写入会超出时拒绝该条目并请求压缩
+    size_t maxBytes = 1024 * 1024 * 1024;
+    // 日志达到该长度且一半以上是失效记录时由后台线程压缩
+    size_t compactMinBytes = 16 * 1024 * 1024;
+};
+
+/**
+ * @brief McpResultStore 计数快照
+ */
+struct McpResultStoreStats {
+    size_t entries = 0;      // 索引中的结果条目（含已过期、尚未压缩的条目）
+    size_t logBytes = 0;     // 日志文件长度
+    size_t liveBytes = 0;    // 索引仍指向的记录字节
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t appends = 0;
+    uint64_t rejected = 0;     // 超出 maxBytes 未写入的条目
+    uint64_t compactions = 0;
+};
+
+/**
+ * @brief 日志结构的持久化工具结果存储，作为 McpResultCache 的磁盘层
+ *
+ * 目录下两个文件：
+ * - results.log：只追加的记录日志，每条记录是固定长度的头、键与预先序列化的 result 片段；
+ *   另有按工具名记录的注册代次，使缓存键跨重启保持稳定。
+ * - results.idx：以 MAP_SHARED 映射的开放寻址哈希表，槽位是键哈希与记录偏移，
+ *   写入只更新映射中的槽位，重启后无需扫描日志即可查找。
+ * 命中时按偏移读出记录并比较键，值原样返回，不做任何解析。
+ * 索引落后于日志时（例如进程异常退出）打开时重放尾部记录；尾部不完整的记录被截掉；
+ * 索引缺失或与日志不匹配时从日志重建。
+ * 同一目录同时只能被一个进程打开（flock）。文件使用本机字节序，不跨体系结构共享。
+ *
+ * 覆盖写入与过期的记录仍占用日志空间：失效字节过半时后台线程把仍有效的记录复制到新日志、
+ * 生成新索引后原子替换，复制期间查找与写入照常进行，只有收尾重放复制期间追加的记录时短暂加锁。
+ * 替换（压缩与索引扩容）时新文件先 fdatasync 再 rename，之后 fsync 目录，掉电后不会留下指向
+ * 未写完内容的文件名；平时的追加不做 fsync，掉电可能丢失最近写入的条目。
+ * 查找可并发进行；写入、代次更新与收尾互斥。所有方法线程安全。
+ */
+class McpResultStore {
+public:
+    using Clock = std::chrono::system_clock;
+
+    struct Hit {
+        std::string result;
+        Clock::time_point expires;
+    };
+
+    /**
+     * @brief 打开（必要时创建）目录下的存储并启动后台压缩线程
+     * @return 目录或文件无法创建、映射或加锁时返回 ReadError；日志头无效时返回 ParseError
+     */
+    static std::expected<std::unique_ptr<McpResultStore>, McpError> open(const std::string& directory,
+                                                                        const McpResultStoreOptions& options = {});
+
+    ~McpResultStore();
+
+    McpResultStore(const McpResultStore&) = delete;
+    McpResultStore& operator=(const McpResultStore&) = delete;
+
+    // 命中且未过期时返回结果片段与过期时刻
+    std::optional<Hit> find(std::string_view key, Clock::time_point now = Clock::now());
+
+    // 追加条目；日志会超出 maxBytes 或写入失败时返回 false
+    bool store(std::string_view key, std::string_view result, Clock::time_point expires);
+
+    // 工具的持久化注册代次，从未记录过时为 0
+    uint64_t generation(std::string_view tool) const;
+    void setGeneration(std::string_view tool, uint64_t generation);
+
+    // 立即在调用线程上压缩（后台线程使用同一流程）
+    std::expected<void, McpError> compact();
+
+    // 丢弃全部条目与代次
+    void clear();
+
+    McpResultStoreStats stats() const;
+
+private:
+    McpResultStore() = default;
+
+    std::expected<void, McpError> load();
+    void replay(uint64_t from);
+    // 把写好的 results.idx.tmp 换为当前索引
+    std::expected<void, McpError> installIndex(int fd, void* mapping, size_t bytes);
+    bool append(uint16_t type, std::string_view key, std::string_view value, int64_t stamp);
+    bool insertSlot(uint16_t type, std::string_view key, uint64_t offset, uint64_t bytes);
+    bool growIndex();
+    void requestCompaction();
+    void compactionLoop();
+
+    std::string m_directory;
+    McpResultStoreOptions m_options;
+
+    mutable std::shared_mutex m_mutex;  // 保护以下文件状态；find() 取共享锁
+    int m_logFd = -1;
+    int m_indexFd = -1;
+    uint64_t m_logSize = 0;
+    uint64_t m_epoch = 0;  // 日志头中的随机标识，索引记录同一值才视为有效
+    void* m_index = nullptr;
+    size_t m_indexBytes = 0;
+    uint64_t m_capacityMask = 0;
+
+    std::mutex m_compactMutex;  // 同时只有一次压缩或清空
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    bool m_compactRequested = false;
+    bool m_stopping = false;
+    Clock::time_point m_lastCompaction{};
+    std::thread m_compactor;
+
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+    std::atomic<uint64_t> m_appends{0};
+    std::atomic<uint64_t> m_rejected{0};
+    std::atomic<uint64_t> m_compactions{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_SERVER_MCPRESULTSTORE_H
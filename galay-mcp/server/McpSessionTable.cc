@@ -0,0 +1,303 @@
+#include "galay-mcp/server/McpSessionTable.h"
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <random>
+#include <vector>
+#if defined(__APPLE__)
+#include <stdlib.h>
+#else
+#include <sys/random.h>
+#endif
+
+namespace galay {
+namespace mcp {
+
+namespace {
+
+// 从系统 CSPRNG 填充 size 字节；内核接口不可用时每个字节都取自 std::random_device
+void FillRandom(unsigned char* out, size_t size) {
+#if defined(__APPLE__)
+    arc4random_buf(out, size);
+#else
+    size_t filled = 0;
+    while (filled < size) {
+        const ssize_t n = getrandom(out + filled, size - filled, 0);
+        if (n > 0) {
+            filled += static_cast<size_t>(n);
+        } else if (n < 0 && errno != EINTR) {
+            break;
+        }
+    }
+    if (filled == size) {
+        return;
+    }
+    std::random_device device;
+    for (; filled < size; ++filled) {
+        out[filled] = static_cast<unsigned char>(device());
+    }
+#endif
+}
+
+// 128 位随机数的十六进制：会话 ID 即访问凭据，直接取自系统 CSPRNG，不经过可预测的伪随机数发生器
+std::string GenerateSessionId() {
+    static constexpr char kHex[] = "0123456789abcdef";
+    unsigned char bytes[16];
+    FillRandom(bytes, sizeof(bytes));
+    std::string id;
+    id.reserve(32);
+    for (unsigned char byte : bytes) {
+        id.push_back(kHex[byte >> 4]);
+        id.push_back(kHex[byte & 0xF]);
+    }
+    return id;
+}
+
+double BucketCapacity(const McpSessionOptions& options) {
+    if (options.burst > 0) {
+        return static_cast<double>(options.burst);
+    }
+    return std::max(1.0, options.requestsPerSecond);
+}
+
+} // namespace
+
+McpSession::McpSession(std::string id, const McpSessionOptions& options, Clock::time_point now)
+    : m_id(std::move(id))
+    , m_events(options.replayCapacity)
+    , m_lastActive(now.time_since_epoch().count())
+    , m_rate(options.requestsPerSecond)
+    , m_burst(BucketCapacity(options))
+    , m_tokens(m_burst)
+    , m_refillTime(now) {
+}
+
+void McpSession::touch(Clock::time_point now) {
+    m_lastActive.store(now.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+McpSession::Clock::time_point McpSession::lastActive() const {
+    return Clock::time_point(Clock::duration(m_lastActive.load(std::memory_order_relaxed)));
+}
+
+void McpSession::setClient(InitializeParams params) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_client = std::move(params);
+}
+
+InitializeParams McpSession::client() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_client;
+}
+
+bool McpSession::subscribe(const std::string& uri) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_subscriptions.insert(uri).second;
+}
+
+bool McpSession::unsubscribe(const std::string& uri) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_subscriptions.erase(uri) > 0;
+}
+
+bool McpSession::isSubscribed(const std::string& uri) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_subscriptions.contains(uri);
+}
+
+std::optional<JsonString> McpSession::cachedList(std::string_view kind, uint64_t version) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lists.find(std::string(kind));
+    if (it == m_lists.end() || it->second.version != version) {
+        return std::nullopt;
+    }
+    return it->second.result;
+}
+
+void McpSession::storeList(std::string_view kind, uint64_t version, JsonString result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lists[std::string(kind)] = CachedList{version, std::move(result)};
+}
+
+bool McpSession::tryAcquire(Clock::time_point now) {
+    if (m_rate <= 0) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (now > m_refillTime) {
+        const double elapsed = std::chrono::duration<double>(now - m_refillTime).count();
+        m_tokens = std::min(m_burst, m_tokens + elapsed * m_rate);
+        m_refillTime = now;
+    }
+    if (m_tokens < 1.0) {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+McpSessionTable::McpSessionTable(const McpSessionOptions& options) {
+    setOptions(options);
+}
+
+void McpSessionTable::setOptions(const McpSessionOptions& options) {
+    m_options = options;
+    m_options.replayCapacity = std::max<size_t>(m_options.replayCapacity, 1);
+    const size_t shards = std::bit_ceil(std::max<size_t>(m_options.shards, 1));
+    m_options.shards = shards;
+    m_shards = std::make_unique<Shard[]>(shards);
+    m_shardMask = shards - 1;
+    m_size.store(0, std::memory_order_relaxed);
+}
+
+McpSessionTable::Shard& McpSessionTable::shardFor(std::string_view id) const {
+    // 混入哈希高位选分段，避免与分段内哈希表的分桶位相关
+    const size_t hash = IdHash{}(id);
+    return m_shards[(hash >> 32 ^ hash) & m_shardMask];
+}
+
+bool McpSessionTable::isExpired(const McpSession& session, Clock::time_point now) const {
+    return m_options.idleTimeout.count() > 0 && now - session.lastActive() > m_options.idleTimeout;
+}
+
+std::shared_ptr<McpSession> McpSessionTable::create(Clock::time_point now) {
+    if (m_options.idleTimeout.count() > 0) {
+        const size_t cursor = m_sweepCursor.fetch_add(1, std::memory_order_relaxed);
+        Shard& sweep = m_shards[cursor & m_shardMask];
+        Clock::rep due = sweep.nextSweep.load(std::memory_order_relaxed);
+        const Clock::rep next = (now + m_options.idleTimeout).time_since_epoch().count();
+        if (now.time_since_epoch().count() >= due &&
+            sweep.nextSweep.compare_exchange_strong(due, next, std::memory_order_relaxed)) {
+            expireShard(sweep, now);
+        }
+    }
+
+    while (true) {
+        std::string id = GenerateSessionId();
+        Shard& shard = shardFor(id);
+        auto session = std::make_shared<McpSession>(id, m_options, now);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.sessions.emplace(std::move(id), session).second) {
+            m_size.fetch_add(1, std::memory_order_relaxed);
+            m_created.fetch_add(1, std::memory_order_relaxed);
+            return session;
+        }
+    }
+}
+
+std::shared_ptr<McpSession> McpSessionTable::find(std::string_view id, Clock::time_point now) {
+    if (id.empty()) {
+        return nullptr;
+    }
+    Shard& shard = shardFor(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(id);
+    if (it == shard.sessions.end()) {
+        return nullptr;
+    }
+    if (isExpired(*it->second, now)) {
+        it->second->close();
+        shard.sessions.erase(it);
+        m_size.fetch_sub(1, std::memory_order_relaxed);
+        m_expired.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    it->second->touch(now);
+    return it->second;
+}
+
+bool McpSessionTable::close(std::string_view id) {
+    if (id.empty()) {
+        return false;
+    }
+    Shard& shard = shardFor(id);
+    std::shared_ptr<McpSession> session;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(id);
+        if (it == shard.sessions.end()) {
+            return false;
+        }
+        session = std::move(it->second);
+        shard.sessions.erase(it);
+    }
+    m_size.fetch_sub(1, std::memory_order_relaxed);
+    m_closed.fetch_add(1, std::memory_order_relaxed);
+    session->close();
+    return true;
+}
+
+size_t McpSessionTable::expireShard(Shard& shard, Clock::time_point now) {
+    size_t expired = 0;
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+        if (isExpired(*it->second, now)) {
+            it->second->close();
+            it = shard.sessions.erase(it);
+            ++expired;
+        } else {
+            ++it;
+        }
+    }
+    if (expired > 0) {
+        m_size.fetch_sub(expired, std::memory_order_relaxed);
+        m_expired.fetch_add(expired, std::memory_order_relaxed);
+    }
+    return expired;
+}
+
+size_t McpSessionTable::expireIdle(Clock::time_point now) {
+    if (m_options.idleTimeout.count() <= 0) {
+        return 0;
+    }
+    size_t expired = 0;
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        expired += expireShard(m_shards[i], now);
+    }
+    return expired;
+}
+
+void McpSessionTable::clear() {
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        Shard& shard = m_shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto& [id, session] : shard.sessions) {
+            session->close();
+        }
+        m_size.fetch_sub(shard.sessions.size(), std::memory_order_relaxed);
+        m_closed.fetch_add(shard.sessions.size(), std::memory_order_relaxed);
+        shard.sessions.clear();
+    }
+}
+
+void McpSessionTable::forEach(const std::function<void(McpSession&)>& fn) const {
+    std::vector<std::shared_ptr<McpSession>> sessions;
+    for (size_t i = 0; i <= m_shardMask; ++i) {
+        // 先复制分段内的会话再回调，回调期间不持有分段锁
+        sessions.clear();
+        {
+            const Shard& shard = m_shards[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            sessions.reserve(shard.sessions.size());
+            for (const auto& [id, session] : shard.sessions) {
+                sessions.push_back(session);
+            }
+        }
+        for (const auto& session : sessions) {
+            fn(*session);
+        }
+    }
+}
+
+McpSessionStats McpSessionTable::stats() const {
+    McpSessionStats stats;
+    stats.active = m_size.load(std::memory_order_relaxed);
+    stats.created = m_created.load(std::memory_order_relaxed);
+    stats.expired = m_expired.load(std::memory_order_relaxed);
+    stats.closed = m_closed.load(std::memory_order_relaxed);
+    stats.rateLimited = m_rateLimited.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace mcp
+} // namespace galay
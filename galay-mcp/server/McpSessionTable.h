@@ -0,0 +1,196 @@
+#ifndef GALAY_MCP_SERVER_MCPSESSIONTABLE_H
+#define GALAY_MCP_SERVER_MCPSESSIONTABLE_H
+
+#include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpSse.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief 服务端会话选项
+ */
+struct McpSessionOptions {
+    // 锁分段数（向上取 2 的幂）；查找、创建与删除只锁会话所在的分段
+    size_t shards = 64;
+    // 空闲超过该时长的会话被回收；0 表示不过期
+    std::chrono::milliseconds idleTimeout{std::chrono::minutes(30)};
+    // 每个会话为 GET 事件流保留的最近事件数
+    size_t replayCapacity = 256;
+    // 每个会话的请求速率上限（令牌桶每秒补充的令牌数）；0 表示不限制
+    double requestsPerSecond = 0;
+    // 令牌桶容量，即允许的突发请求数；0 时取 max(1, requestsPerSecond)
+    size_t burst = 0;
+};
+
+/**
+ * @brief 会话表计数快照
+ */
+struct McpSessionStats {
+    size_t active = 0;
+    uint64_t created = 0;
+    uint64_t expired = 0;
+    uint64_t closed = 0;
+    uint64_t rateLimited = 0;
+};
+
+/**
+ * @brief 一个 Mcp-Session-Id 对应的服务端状态
+ *
+ * initialize 时创建，保存客户端信息与能力、资源订阅、按会话过滤的列表缓存、
+ * 请求速率令牌桶以及 GET 事件流的回放缓冲。所有方法线程安全。
+ */
+class McpSession {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    McpSession(std::string id, const McpSessionOptions& options, Clock::time_point now);
+
+    McpSession(const McpSession&) = delete;
+    McpSession& operator=(const McpSession&) = delete;
+
+    const std::string& id() const { return m_id; }
+    McpEventReplayBuffer& events() { return m_events; }
+
+    // 会话结束后事件流随之结束
+    bool closed() const { return m_closed.load(std::memory_order_acquire); }
+    void close() { m_closed.store(true, std::memory_order_release); }
+
+    // 刷新最近活动时间（请求到达、事件流仍打开）
+    void touch(Clock::time_point now = Clock::now());
+    Clock::time_point lastActive() const;
+
+    // initialize 请求中的协议版本、客户端信息与能力
+    void setClient(InitializeParams params);
+    InitializeParams client() const;
+
+    // 资源订阅；subscribe / unsubscribe 返回订阅集合是否发生变化
+    bool subscribe(const std::string& uri);
+    bool unsubscribe(const std::string& uri);
+    bool isSubscribed(const std::string& uri) const;
+
+    /**
+     * @brief 按会话过滤的列表缓存
+     * @param version 注册表版本；与写入时不同视为失效
+     */
+    std::optional<JsonString> cachedList(std::string_view kind, uint64_t version) const;
+    void storeList(std::string_view kind, uint64_t version, JsonString result);
+
+    // 取一个请求令牌；返回 false 表示超过该会话的速率上限
+    bool tryAcquire(Clock::time_point now = Clock::now());
+
+private:
+    struct CachedList {
+        uint64_t version = 0;
+        JsonString result;
+    };
+
+    const std::string m_id;
+    McpEventReplayBuffer m_events;
+    std::atomic<bool> m_closed{false};
+    std::atomic<Clock::rep> m_lastActive;
+
+    const double m_rate;
+    const double m_burst;
+
+    // 保护以下状态；只在单个会话内竞争
+    mutable std::mutex m_mutex;
+    InitializeParams m_client;
+    std::unordered_set<std::string> m_subscriptions;
+    std::unordered_map<std::string, CachedList> m_lists;
+    double m_tokens;
+    Clock::time_point m_refillTime;
+};
+
+/**
+ * @brief 分段加锁的会话表
+ *
+ * 会话按 id 的哈希分布到 2 的幂个分段，每个分段一把锁与一张哈希表，
+ * 不同会话的查找、创建与删除互不阻塞；会话数只用原子计数维护。
+ * 空闲过期分摊执行：每次 create() 轮流检查一个分段，距该分段上次清理超过 idleTimeout 时才清理，
+ * find() 遇到过期会话时就地回收；每个分段每个 idleTimeout 至多扫描一次，
+ * 十万级会话下既不需要后台线程，也不会让 create() 退化为全表扫描。所有方法线程安全。
+ */
+class McpSessionTable {
+public:
+    using Clock = McpSession::Clock;
+
+    explicit McpSessionTable(const McpSessionOptions& options = {});
+
+    McpSessionTable(const McpSessionTable&) = delete;
+    McpSessionTable& operator=(const McpSessionTable&) = delete;
+
+    // 只能在没有会话时调用（服务器 start() 之前）
+    void setOptions(const McpSessionOptions& options);
+    const McpSessionOptions& options() const { return m_options; }
+
+    // 新建会话并分配 128 位随机 id
+    std::shared_ptr<McpSession> create(Clock::time_point now = Clock::now());
+
+    // 查找会话并刷新活动时间；不存在或已过期时返回空
+    std::shared_ptr<McpSession> find(std::string_view id, Clock::time_point now = Clock::now());
+
+    // 结束会话；不存在时返回 false
+    bool close(std::string_view id);
+
+    // 回收全部空闲超时的会话，返回回收数
+    size_t expireIdle(Clock::time_point now = Clock::now());
+
+    // 结束全部会话
+    void clear();
+
+    // 逐个分段遍历会话；回调时不持有分段锁，遍历期间新建或结束的会话可能被跳过
+    void forEach(const std::function<void(McpSession&)>& fn) const;
+
+    size_t size() const { return m_size.load(std::memory_order_relaxed); }
+
+    // 记录一次因会话速率上限被拒绝的请求
+    void recordRateLimited() { m_rateLimited.fetch_add(1, std::memory_order_relaxed); }
+
+    McpSessionStats stats() const;
+
+private:
+    struct IdHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view id) const { return std::hash<std::string_view>{}(id); }
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, std::shared_ptr<McpSession>, IdHash, std::equal_to<>> sessions;
+        // 下一次分摊清理的时间（Clock 计数），无锁判断是否需要清理
+        std::atomic<Clock::rep> nextSweep{0};
+    };
+
+    Shard& shardFor(std::string_view id) const;
+    bool isExpired(const McpSession& session, Clock::time_point now) const;
+    size_t expireShard(Shard& shard, Clock::time_point now);
+
+    McpSessionOptions m_options;
+    std::unique_ptr<Shard[]> m_shards;
+    size_t m_shardMask = 0;
+
+    std::atomic<size_t> m_sweepCursor{0};
+    std::atomic<size_t> m_size{0};
+    std::atomic<uint64_t> m_created{0};
+    std::atomic<uint64_t> m_expired{0};
+    std::atomic<uint64_t> m_closed{0};
+    std::atomic<uint64_t> m_rateLimited{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_SERVER_MCPSESSIONTABLE_H
@@ -0,0 +1,119 @@
+#include "galay-mcp/server/McpSingleFlight.h"
+#include <utility>
+
+namespace galay {
+namespace mcp {
+
+McpSingleFlight::Call::Call(McpSingleFlight* owner, std::string key, std::shared_ptr<Flight> flight, bool leader)
+    : m_owner(owner)
+    , m_key(std::move(key))
+    , m_flight(std::move(flight))
+    , m_leader(leader) {
+}
+
+McpSingleFlight::Call::~Call() {
+    if (m_leader && m_owner) {
+        complete(std::unexpected(McpError::internalError("Coalesced call abandoned")));
+    }
+}
+
+McpSingleFlight::Call::Call(Call&& other) noexcept
+    : m_owner(std::exchange(other.m_owner, nullptr))
+    , m_key(std::move(other.m_key))
+    , m_flight(std::move(other.m_flight))
+    , m_leader(std::exchange(other.m_leader, false)) {
+}
+
+McpSingleFlight::Call& McpSingleFlight::Call::operator=(Call&& other) noexcept {
+    if (this != &other) {
+        if (m_leader && m_owner) {
+            complete(std::unexpected(McpError::internalError("Coalesced call abandoned")));
+        }
+        m_owner = std::exchange(other.m_owner, nullptr);
+        m_key = std::move(other.m_key);
+        m_flight = std::move(other.m_flight);
+        m_leader = std::exchange(other.m_leader, false);
+    }
+    return *this;
+}
+
+bool McpSingleFlight::Call::ready() const {
+    return m_flight && m_flight->done.load(std::memory_order_acquire);
+}
+
+void McpSingleFlight::Call::wakeOnReady(const std::shared_ptr<McpWakeSignal>& signal) const {
+    if (!m_flight || !signal) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_flight->wakeMutex);
+        if (!m_flight->done.load(std::memory_order_acquire)) {
+            m_flight->wakes.push_back(signal);
+            return;
+        }
+    }
+    signal->notify();
+}
+
+const McpSingleFlight::Result& McpSingleFlight::Call::result() const {
+    return m_flight->result;
+}
+
+void McpSingleFlight::Call::complete(Result result) {
+    if (!m_leader || !m_owner) {
+        return;
+    }
+    m_owner->finish(m_key, m_flight, std::move(result));
+    m_owner = nullptr;
+}
+
+McpSingleFlight::Call McpSingleFlight::join(const std::string& key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [it, inserted] = m_flights.try_emplace(key);
+    if (inserted) {
+        it->second = std::make_shared<Flight>();
+        m_leaders.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_coalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+    return Call(this, key, it->second, inserted);
+}
+
+void McpSingleFlight::finish(const std::string& key, const std::shared_ptr<Flight>& flight, Result result) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_flights.find(key);
+        if (it != m_flights.end() && it->second == flight) {
+            m_flights.erase(it);
+        }
+    }
+    // 结果在 done 的 release 之前写入，等待方 acquire 之后只读访问
+    flight->result = std::move(result);
+    std::vector<std::weak_ptr<McpWakeSignal>> wakes;
+    {
+        std::lock_guard<std::mutex> lock(flight->wakeMutex);
+        flight->done.store(true, std::memory_order_release);
+        wakes.swap(flight->wakes);
+    }
+    // notify() 只把每个等待方投递回它自己的调度器，执行方随即返回并发送自己的响应，
+    // 不在本线程上依次运行等待方的写出；通知放在 wakeMutex 之外
+    for (const auto& wake : wakes) {
+        if (auto signal = wake.lock()) {
+            signal->notify();
+        }
+    }
+}
+
+McpSingleFlightStats McpSingleFlight::stats() const {
+    McpSingleFlightStats stats;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        stats.inFlight = m_flights.size();
+    }
+    stats.leaders = m_leaders.load(std::memory_order_relaxed);
+    stats.coalesced = m_coalesced.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace mcp
+} // namespace galay
@@ -0,0 +1,109 @@
+#ifndef GALAY_MCP_SERVER_MCPSINGLEFLIGHT_H
+#define GALAY_MCP_SERVER_MCPSINGLEFLIGHT_H
+
+#include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpWakeSignal.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace galay {
+namespace mcp {
+
+/**
+ * @brief McpSingleFlight 计数快照
+ */
+struct McpSingleFlightStats {
+    size_t inFlight = 0;     // 当前正在执行的键数
+    uint64_t leaders = 0;    // 实际执行的次数
+    uint64_t coalesced = 0;  // 合并到已有执行、未再执行的次数
+};
+
+/**
+ * @brief 合并相同键的并发执行（singleflight）
+ *
+ * join() 立即返回一个 Call：该键没有进行中的执行时成为执行方（leader()），
+ * 否则成为等待方，与之前的调用共享同一次执行的结果。执行方完成后调用 complete()，
+ * 它通知等待方经 Call::wakeOnReady() 登记的 McpWakeSignal，等待的协程 co_await 该唤醒点即可，
+ * 不占用线程也不需要轮询。等待方被投递回各自挂起时所在的调度器恢复，complete() 不在执行方线程上
+ * 运行它们，执行方随即发送自己的响应。complete() 之后到达的调用重新执行，不复用已完成的结果。
+ * 执行方的 Call 未 complete() 就析构时（例如处理函数抛出异常）以 INTERNAL_ERROR 结束，
+ * 等待方不会一直挂起。所有方法线程安全。
+ */
+class McpSingleFlight {
+    struct Flight;
+
+public:
+    using Result = std::expected<std::string, McpError>;
+
+    class Call {
+    public:
+        Call() = default;
+        ~Call();
+
+        Call(Call&& other) noexcept;
+        Call& operator=(Call&& other) noexcept;
+        Call(const Call&) = delete;
+        Call& operator=(const Call&) = delete;
+
+        // 是否由本调用执行
+        bool leader() const { return m_leader; }
+
+        // 执行是否已完成（执行方与等待方均可检查）
+        bool ready() const;
+
+        // 执行完成时通知 signal；已完成时立即通知
+        void wakeOnReady(const std::shared_ptr<McpWakeSignal>& signal) const;
+
+        // 执行结果；ready() 之后才能读取
+        const Result& result() const;
+
+        // 执行方写入结果并唤醒所有等待方；只能调用一次
+        void complete(Result result);
+
+    private:
+        friend class McpSingleFlight;
+        Call(McpSingleFlight* owner, std::string key, std::shared_ptr<Flight> flight, bool leader);
+
+        McpSingleFlight* m_owner = nullptr;
+        std::string m_key;
+        std::shared_ptr<Flight> m_flight;
+        bool m_leader = false;
+    };
+
+    McpSingleFlight() = default;
+
+    McpSingleFlight(const McpSingleFlight&) = delete;
+    McpSingleFlight& operator=(const McpSingleFlight&) = delete;
+
+    Call join(const std::string& key);
+
+    McpSingleFlightStats stats() const;
+
+private:
+    struct Flight {
+        std::atomic<bool> done{false};
+        Result result;
+        std::mutex wakeMutex;                            // 保护 wakes 与 done 的置位
+        std::vector<std::weak_ptr<McpWakeSignal>> wakes; // complete() 时通知的等待方
+    };
+
+    // 执行方完成时从表中移除，之后到达的调用重新执行
+    void finish(const std::string& key, const std::shared_ptr<Flight>& flight, Result result);
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::shared_ptr<Flight>> m_flights;
+    std::atomic<uint64_t> m_leaders{0};
+    std::atomic<uint64_t> m_coalesced{0};
+};
+
+} // namespace mcp
+} // namespace galay
+
+#endif // GALAY_MCP_SERVER_MCPSINGLEFLIGHT_H
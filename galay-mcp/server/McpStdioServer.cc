@@ -13,24 +13,63 @@ JsonString EmptyObjectString() {
     return "{}";
 }
 
+// 结果缓存中的 result 片段，按连接当前的编码写出
+struct CachedToolResult {
+    const JsonString& json;
+
+    void encode(McpEncoder& writer) const { writer.Raw(json); }
+};
+
+// 进程内调用：流式输出原样收集为完整内容
+std::expected<std::string, McpError> CollectStreamed(
+    const std::function<std::expected<void, McpError>(McpContentWriter&)>& produce) {
+    std::string output;
+    McpContentWriter writer(McpContentEncoding::Raw, [&output](std::string_view chunk) {
+        output.append(chunk);
+        return true;
+    });
+    auto streamed = produce(writer);
+    if (!streamed) {
+        return std::unexpected(streamed.error());
+    }
+    writer.flush();
+    return output;
+}
+
+// 作用域结束时执行清理
+template <typename Fn>
+class ScopeExit {
+public:
+    explicit ScopeExit(Fn fn)
+        : m_fn(std::move(fn)) {
+    }
+    ~ScopeExit() {
+        m_fn();
+    }
+
+    ScopeExit(const ScopeExit&) = delete;
+    ScopeExit& operator=(const ScopeExit&) = delete;
+
+private:
+    Fn m_fn;
+};
+
 } // namespace
 
-McpStdioServer::McpStdioServer()
+McpStdioServer::McpStdioServer(McpStdioFraming framing)
     : m_serverName("galay-mcp-server")
     , m_serverVersion("1.0.0")
+    , m_tools("tools", [](const ToolInfo& info) { return info.tool.toJson(); })
+    , m_resources("resources", [](const ResourceInfo& info) { return info.resource.toJson(); })
+    , m_prompts("prompts", [](const PromptInfo& info) { return info.prompt.toJson(); })
+    , m_toolsReader(m_tools)
+    , m_resourcesReader(m_resources)
+    , m_promptsReader(m_prompts)
     , m_running(false)
     , m_initialized(false)
     , m_input(&std::cin)
-    , m_output(&std::cout) {
-    m_toolsListCache = protocol::buildListResultFromMap(
-        m_tools, "tools",
-        [](const ToolInfo& info) -> const Tool& { return info.tool; });
-    m_resourcesListCache = protocol::buildListResultFromMap(
-        m_resources, "resources",
-        [](const ResourceInfo& info) -> const Resource& { return info.resource; });
-    m_promptsListCache = protocol::buildListResultFromMap(
-        m_prompts, "prompts",
-        [](const PromptInfo& info) -> const Prompt& { return info.prompt; });
+    , m_output(&std::cout)
+    , m_framing(framing) {
 }
 
 McpStdioServer::~McpStdioServer() {
@@ -45,22 +84,72 @@ void McpStdioServer::setServerInfo(const std::string& name, const std::string& v
 void McpStdioServer::addTool(const std::string& name,
                              const std::string& description,
                              const JsonString& inputSchema,
-                             McpStdioServer::ToolHandler handler) {
-    std::unique_lock<std::shared_mutex> lock(m_toolsMutex);
+                             McpStdioServer::ToolHandler handler,
+                             std::chrono::milliseconds cacheTtl) {
+    addTool(name, description, inputSchema,
+        ContextToolHandler([handler = std::move(handler)](const JsonElement& arguments, const McpToolContext&) {
+            return handler(arguments);
+        }),
+        cacheTtl);
+}
+
+void McpStdioServer::addTool(const std::string& name,
+                             const std::string& description,
+                             const JsonString& inputSchema,
+                             McpStdioServer::ContextToolHandler handler,
+                             std::chrono::milliseconds cacheTtl) {
+    addStructuredTool(name, description, inputSchema, JsonString(), std::move(handler), cacheTtl);
+}
+
+void McpStdioServer::addStructuredTool(const std::string& name,
+                                       const std::string& description,
+                                       const JsonString& inputSchema,
+                                       const JsonString& outputSchema,
+                                       McpStdioServer::ToolHandler handler,
+                                       std::chrono::milliseconds cacheTtl) {
+    addStructuredTool(name, description, inputSchema, outputSchema,
+        ContextToolHandler([handler = std::move(handler)](const JsonElement& arguments, const McpToolContext&) {
+            return handler(arguments);
+        }),
+        cacheTtl);
+}
 
+void McpStdioServer::addStructuredTool(const std::string& name,
+                                       const std::string& description,
+                                       const JsonString& inputSchema,
+                                       const JsonString& outputSchema,
+                                       McpStdioServer::ContextToolHandler handler,
+                                       std::chrono::milliseconds cacheTtl) {
     Tool tool;
     tool.name = name;
     tool.description = description;
     tool.inputSchema = inputSchema;
+    tool.outputSchema = outputSchema;
 
     ToolInfo info;
     info.tool = tool;
-    info.handler = handler;
+    info.handler = std::move(handler);
+    if (cacheTtl.count() > 0) {
+        info.cacheTtl = cacheTtl;
+        info.cacheScope = m_resultCache.newScope(name);
+    }
+
+    m_tools.put(name, std::move(info));
+    notifyListChanged(Methods::TOOLS_LIST_CHANGED);
+}
+
+void McpStdioServer::addStreamingTool(const std::string& name,
+                                      const std::string& description,
+                                      const JsonString& inputSchema,
+                                      McpStdioServer::StreamingToolHandler handler) {
+    ToolInfo info;
+    info.tool.name = name;
+    info.tool.description = description;
+    info.tool.inputSchema = inputSchema;
+    info.streamingHandler = std::move(handler);
 
-    m_tools[name] = info;
-    m_toolsListCache = protocol::buildListResultFromMap(
-        m_tools, "tools",
-        [](const ToolInfo& info) -> const Tool& { return info.tool; });
+    m_tools.put(name, std::move(info));
+    notifyListChanged(Methods::TOOLS_LIST_CHANGED);
 }
 
 void McpStdioServer::addResource(const std::string& uri,
@@ -68,8 +157,6 @@ void McpStdioServer::addResource(const std::string& uri,
                                  const std::string& description,
                                  const std::string& mimeType,
                                  McpStdioServer::ResourceReader reader) {
-    std::unique_lock<std::shared_mutex> lock(m_resourcesMutex);
-
     Resource resource;
     resource.uri = uri;
     resource.name = name;
@@ -78,20 +165,34 @@ void McpStdioServer::addResource(const std::string& uri,
 
     ResourceInfo info;
     info.resource = resource;
-    info.reader = reader;
+    info.reader = std::move(reader);
 
-    m_resources[uri] = info;
-    m_resourcesListCache = protocol::buildListResultFromMap(
-        m_resources, "resources",
-        [](const ResourceInfo& info) -> const Resource& { return info.resource; });
+    m_resources.put(uri, std::move(info));
+    notifyListChanged(Methods::RESOURCES_LIST_CHANGED);
+}
+
+void McpStdioServer::addStreamingResource(const std::string& uri,
+                                          const std::string& name,
+                                          const std::string& description,
+                                          const std::string& mimeType,
+                                          McpStdioServer::StreamingResourceReader reader,
+                                          bool blob) {
+    ResourceInfo info;
+    info.resource.uri = uri;
+    info.resource.name = name;
+    info.resource.description = description;
+    info.resource.mimeType = mimeType;
+    info.streamingReader = std::move(reader);
+    info.blob = blob;
+
+    m_resources.put(uri, std::move(info));
+    notifyListChanged(Methods::RESOURCES_LIST_CHANGED);
 }
 
 void McpStdioServer::addPrompt(const std::string& name,
                                const std::string& description,
                                const std::vector<PromptArgument>& arguments,
                                McpStdioServer::PromptGetter getter) {
-    std::unique_lock<std::shared_mutex> lock(m_promptsMutex);
-
     Prompt prompt;
     prompt.name = name;
     prompt.description = description;
@@ -99,36 +200,225 @@ void McpStdioServer::addPrompt(const std::string& name,
 
     PromptInfo info;
     info.prompt = prompt;
-    info.getter = getter;
+    info.getter = std::move(getter);
+
+    m_prompts.put(name, std::move(info));
+    notifyListChanged(Methods::PROMPTS_LIST_CHANGED);
+}
+
+size_t McpStdioServer::registerTools(std::vector<ToolDefinition> tools) {
+    if (tools.empty()) {
+        return 0;
+    }
+    std::vector<std::pair<std::string, ToolInfo>> items;
+    items.reserve(tools.size());
+    for (auto& definition : tools) {
+        ToolInfo info;
+        info.tool.name = definition.name;
+        info.tool.description = std::move(definition.description);
+        info.tool.inputSchema = std::move(definition.inputSchema);
+        info.tool.outputSchema = std::move(definition.outputSchema);
+        info.handler = std::move(definition.handler);
+        info.streamingHandler = std::move(definition.streamingHandler);
+        if (definition.cacheTtl.count() > 0 && !info.streamingHandler) {
+            info.cacheTtl = definition.cacheTtl;
+            info.cacheScope = m_resultCache.newScope(definition.name);
+        }
+        items.emplace_back(std::move(definition.name), std::move(info));
+    }
+
+    const size_t added = m_tools.putAll(std::move(items));
+    notifyListChanged(Methods::TOOLS_LIST_CHANGED);
+    return added;
+}
+
+size_t McpStdioServer::registerResources(std::vector<ResourceDefinition> resources) {
+    if (resources.empty()) {
+        return 0;
+    }
+    std::vector<std::pair<std::string, ResourceInfo>> items;
+    items.reserve(resources.size());
+    for (auto& definition : resources) {
+        ResourceInfo info;
+        info.resource.uri = definition.uri;
+        info.resource.name = std::move(definition.name);
+        info.resource.description = std::move(definition.description);
+        info.resource.mimeType = std::move(definition.mimeType);
+        info.reader = std::move(definition.reader);
+        info.streamingReader = std::move(definition.streamingReader);
+        info.blob = definition.blob;
+        items.emplace_back(std::move(definition.uri), std::move(info));
+    }
+
+    const size_t added = m_resources.putAll(std::move(items));
+    notifyListChanged(Methods::RESOURCES_LIST_CHANGED);
+    return added;
+}
+
+size_t McpStdioServer::registerPrompts(std::vector<PromptDefinition> prompts) {
+    if (prompts.empty()) {
+        return 0;
+    }
+    std::vector<std::pair<std::string, PromptInfo>> items;
+    items.reserve(prompts.size());
+    for (auto& definition : prompts) {
+        PromptInfo info;
+        info.prompt.name = definition.name;
+        info.prompt.description = std::move(definition.description);
+        info.prompt.arguments = std::move(definition.arguments);
+        info.getter = std::move(definition.getter);
+        items.emplace_back(std::move(definition.name), std::move(info));
+    }
+
+    const size_t added = m_prompts.putAll(std::move(items));
+    notifyListChanged(Methods::PROMPTS_LIST_CHANGED);
+    return added;
+}
+
+std::expected<size_t, McpError> McpStdioServer::loadManifest(std::shared_ptr<const McpManifest> manifest,
+                                                     const ManifestToolBinder& bindTool,
+                                                     const ManifestResourceBinder& bindResource) {
+    std::vector<std::tuple<std::string, ToolInfo, std::string_view>> tools;
+    tools.reserve(manifest->tools().size());
+    for (const auto& definition : manifest->tools()) {
+        ToolInfo info;
+        info.handler = bindTool ? bindTool(definition) : nullptr;
+        if (!info.handler) {
+            return std::unexpected(McpError::invalidParams("no handler bound for tool " + definition.name));
+        }
+        info.tool.name = definition.name;
+        info.tool.description = definition.description;
+        info.tool.outputSchema.assign(definition.outputSchema);
+        info.manifest = manifest;
+        info.schema = definition.inputSchema;
+        tools.emplace_back(definition.name, std::move(info), definition.json);
+    }
+
+    std::vector<std::tuple<std::string, ResourceInfo, std::string_view>> resources;
+    resources.reserve(manifest->resources().size());
+    for (const auto& definition : manifest->resources()) {
+        ResourceInfo info;
+        info.reader = bindResource ? bindResource(definition) : nullptr;
+        if (!info.reader) {
+            return std::unexpected(McpError::invalidParams("no reader bound for resource " + definition.uri));
+        }
+        info.resource.uri = definition.uri;
+        info.resource.name = definition.name;
+        info.resource.description = definition.description;
+        info.resource.mimeType = definition.mimeType;
+        info.manifest = manifest;
+        resources.emplace_back(definition.uri, std::move(info), definition.json);
+    }
+
+    // 清单条目直接以映射中的字节作为列表 JSON
+    size_t added = 0;
+    if (!tools.empty()) {
+        added += m_tools.putAllSerialized(std::move(tools));
+        notifyListChanged(Methods::TOOLS_LIST_CHANGED);
+    }
+    if (!resources.empty()) {
+        added += m_resources.putAllSerialized(std::move(resources));
+        notifyListChanged(Methods::RESOURCES_LIST_CHANGED);
+    }
+    return added;
+}
+
+bool McpStdioServer::removeTool(const std::string& name) {
+    if (!m_tools.remove(name)) {
+        return false;
+    }
+    notifyListChanged(Methods::TOOLS_LIST_CHANGED);
+    return true;
+}
+
+bool McpStdioServer::removeResource(const std::string& uri) {
+    if (!m_resources.remove(uri)) {
+        return false;
+    }
+    notifyListChanged(Methods::RESOURCES_LIST_CHANGED);
+    return true;
+}
+
+bool McpStdioServer::removePrompt(const std::string& name) {
+    if (!m_prompts.remove(name)) {
+        return false;
+    }
+    notifyListChanged(Methods::PROMPTS_LIST_CHANGED);
+    return true;
+}
+
+std::expected<void, McpError> McpStdioServer::setResultCacheOptions(const McpResultCacheOptions& options) {
+    return m_resultCache.setOptions(options);
+}
+
+McpResultCacheStats McpStdioServer::resultCacheStats() const {
+    return m_resultCache.stats();
+}
+
+void McpStdioServer::setListPageSize(size_t pageSize) {
+    m_tools.setPageSize(pageSize);
+    m_resources.setPageSize(pageSize);
+    m_prompts.setPageSize(pageSize);
+}
+
+void McpStdioServer::setChannel(std::unique_ptr<McpMessageChannel> channel) {
+    m_channel = std::move(channel);
+}
+
+void McpStdioServer::setToolWorkers(size_t threads) {
+    m_toolWorkers = threads;
+}
 
-    m_prompts[name] = info;
-    m_promptsListCache = protocol::buildListResultFromMap(
-        m_prompts, "prompts",
-        [](const PromptInfo& info) -> const Prompt& { return info.prompt; });
+void McpStdioServer::setProgressInterval(std::chrono::milliseconds interval) {
+    m_progressInterval = interval;
 }
 
 void McpStdioServer::run() {
     m_running = true;
+    if (m_toolWorkers > 0) {
+        m_toolPool = std::make_unique<McpComputePool>(m_toolWorkers);
+    }
 
     while (m_running) {
         auto messageResult = readMessage();
         if (!messageResult) {
             // 读取失败，可能是EOF或错误
+            if (m_channel) {
+                if (messageResult.error().code() == McpErrorCode::ConnectionClosed) {
+                    break;
+                }
+                continue;
+            }
             if (m_input->eof()) {
                 break;
             }
             continue;
         }
 
-        auto parsed = parseJsonRpcRequest(messageResult.value());
+        auto decoded = encoding::decodeMessage(std::move(messageResult.value()));
+        if (!decoded) {
+            sendError(0, ErrorCodes::PARSE_ERROR, "Parse error", decoded.error().details());
+            continue;
+        }
+
+        auto parsed = parseJsonRpcRequest(decoded.value());
         if (!parsed) {
             sendError(0, ErrorCodes::PARSE_ERROR, "Parse error", parsed.error().details());
             continue;
         }
 
-        handleRequest(parsed.value().request);
+        handleRequest(parsed.value());
     }
 
+    // 输入流已关闭：取消进行中的调用，等工作线程执行完已提交的调用
+    {
+        std::lock_guard<std::mutex> lock(m_inflightMutex);
+        for (auto& [id, source] : m_inflight) {
+            source.cancel(McpCancelReason::ConnectionClosed);
+        }
+    }
+    m_toolPool.reset();
+
     m_running = false;
 }
 
@@ -140,7 +430,113 @@ bool McpStdioServer::isRunning() const {
     return m_running;
 }
 
-void McpStdioServer::handleRequest(const JsonRpcRequestView& request) {
+InitializeResult McpStdioServer::localInitialize() {
+    return protocol::makeInitializeResult(m_serverName, m_serverVersion,
+                                          !m_tools.snapshot()->empty(),
+                                          !m_resources.snapshot()->empty(),
+                                          !m_prompts.snapshot()->empty());
+}
+
+std::vector<Tool> McpStdioServer::localListTools() {
+    auto tools = m_tools.snapshot();
+    std::vector<Tool> result;
+    result.reserve(tools->size());
+    tools->forEach([&result](const auto& entry) {
+        result.push_back(entry.info.tool);
+        if (entry.info.manifest) {
+            result.back().inputSchema.assign(entry.info.schema);
+        }
+    });
+    return result;
+}
+
+std::vector<Resource> McpStdioServer::localListResources() {
+    auto resources = m_resources.snapshot();
+    std::vector<Resource> result;
+    result.reserve(resources->size());
+    resources->forEach([&result](const auto& entry) { result.push_back(entry.info.resource); });
+    return result;
+}
+
+std::vector<Prompt> McpStdioServer::localListPrompts() {
+    auto prompts = m_prompts.snapshot();
+    std::vector<Prompt> result;
+    result.reserve(prompts->size());
+    prompts->forEach([&result](const auto& entry) { result.push_back(entry.info.prompt); });
+    return result;
+}
+
+std::expected<JsonString, McpError> McpStdioServer::localCallTool(const std::string& name,
+                                                                  const JsonElement& arguments) {
+    try {
+        auto tools = m_tools.snapshot();
+        const ToolInfo* info = tools->find(name);
+        if (!info) {
+            return std::unexpected(protocol::makeClientError(ErrorCodes::METHOD_NOT_FOUND, "Tool not found", name));
+        }
+
+        if (info->streamingHandler) {
+            auto output = CollectStreamed([&](McpContentWriter& writer) {
+                return info->streamingHandler(arguments, McpToolContext{}, writer);
+            });
+            if (!output) {
+                return std::unexpected(protocol::makeClientError(output.error()));
+            }
+            return output;
+        }
+
+        auto result = info->handler(arguments, McpToolContext{});
+        if (!result) {
+            return std::unexpected(protocol::makeClientError(result.error()));
+        }
+        return result;
+    } catch (const std::exception& e) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::INTERNAL_ERROR, "Internal error", e.what()));
+    }
+}
+
+std::expected<std::string, McpError> McpStdioServer::localReadResource(const std::string& uri) {
+    try {
+        auto resources = m_resources.snapshot();
+        const ResourceInfo* info = resources->find(uri);
+        if (!info) {
+            return std::unexpected(protocol::makeClientError(ErrorCodes::METHOD_NOT_FOUND, "Resource not found", uri));
+        }
+
+        // 流式资源返回原始字节，二进制内容不做 base64 编码
+        auto result = info->streamingReader
+            ? CollectStreamed([&](McpContentWriter& writer) { return info->streamingReader(uri, writer); })
+            : info->reader(uri);
+        if (!result) {
+            return std::unexpected(protocol::makeClientError(result.error()));
+        }
+        return result;
+    } catch (const std::exception& e) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::INTERNAL_ERROR, "Internal error", e.what()));
+    }
+}
+
+std::expected<JsonString, McpError> McpStdioServer::localGetPrompt(const std::string& name,
+                                                                   const JsonElement& arguments) {
+    try {
+        auto prompts = m_prompts.snapshot();
+        const PromptInfo* info = prompts->find(name);
+        if (!info) {
+            return std::unexpected(protocol::makeClientError(ErrorCodes::METHOD_NOT_FOUND, "Prompt not found", name));
+        }
+
+        auto result = info->getter(name, arguments);
+        if (!result) {
+            return std::unexpected(protocol::makeClientError(result.error()));
+        }
+        return result;
+    } catch (const std::exception& e) {
+        return std::unexpected(protocol::makeClientError(ErrorCodes::INTERNAL_ERROR, "Internal error", e.what()));
+    }
+}
+
+void McpStdioServer::handleRequest(ParsedJsonRpcRequest& message) {
+    const JsonRpcRequestView& request = message.request;
     const std::string& method = request.method;
 
     if (method == Methods::INITIALIZE) {
@@ -148,7 +544,7 @@ void McpStdioServer::handleRequest(const JsonRpcRequestView& request) {
     } else if (method == Methods::TOOLS_LIST) {
         handleToolsList(request);
     } else if (method == Methods::TOOLS_CALL) {
-        handleToolsCall(request);
+        handleToolsCall(message);
     } else if (method == Methods::RESOURCES_LIST) {
         handleResourcesList(request);
     } else if (method == Methods::RESOURCES_READ) {
@@ -159,6 +555,8 @@ void McpStdioServer::handleRequest(const JsonRpcRequestView& request) {
         handlePromptsGet(request);
     } else if (method == Methods::PING) {
         handlePing(request);
+    } else if (method == Methods::CANCELLED) {
+        handleCancelled(request);
     } else {
         if (request.id.has_value()) {
             sendError(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
@@ -191,18 +589,55 @@ void McpStdioServer::handleInitialize(const JsonRpcRequestView& request) {
         return;
     }
 
+    // galay-mcp 客户端可以协商 Content-Length 分帧；其他客户端不会声明该字段
+    bool contentLength = false;
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        contentLength = m_framing == McpStdioFraming::ContentLength;
+    }
+    bool msgPack = false;
+    JsonObject paramsObj;
+    JsonElement capsElement;
+    if (JsonHelper::GetObject(request.params, paramsObj) &&
+        JsonHelper::GetElement(paramsObj, "capabilities", capsElement)) {
+        if (protocol::getGalayExtension(capsElement, "framing") == framing::CONTENT_LENGTH) {
+            contentLength = true;
+        }
+        // MessagePack 含任意字节，换行分帧的 stdout 无法承载
+        msgPack = protocol::getGalayExtension(capsElement, "encoding") == encoding::MSGPACK &&
+                  (contentLength || m_channel);
+    }
+
+    std::vector<std::pair<std::string, std::string>> extensions;
+    if (contentLength) {
+        extensions.emplace_back("framing", std::string(framing::CONTENT_LENGTH));
+    }
+    if (msgPack) {
+        extensions.emplace_back("encoding", std::string(encoding::MSGPACK));
+    }
+
     // 构建响应
     JsonString result = protocol::buildInitializeResult(
         m_serverName,
         m_serverVersion,
-        !m_tools.empty(),
-        !m_resources.empty(),
-        !m_prompts.empty());
+        !m_toolsReader.get().empty(),
+        !m_resourcesReader.get().empty(),
+        !m_promptsReader.get().empty(),
+        protocol::makeGalayExperimental(extensions));
 
     JsonRpcResponse response = protocol::makeResultResponse(request.id.value(), result);
 
     sendResponse(response);
 
+    // 确认响应仍按协商前的分帧与编码写出，之后的消息改用协商结果
+    if (contentLength) {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        m_framing = McpStdioFraming::ContentLength;
+    }
+    if (msgPack) {
+        m_encoding.store(McpWireEncoding::MsgPack, std::memory_order_release);
+    }
+
     m_initialized = true;
 
     // 发送initialized通知
@@ -220,15 +655,20 @@ void McpStdioServer::handleToolsList(const JsonRpcRequestView& request) {
         return;
     }
 
-    std::shared_lock<std::shared_mutex> lock(m_toolsMutex);
+    const auto params = protocol::getListParams(request.params, request.hasParams);
+    auto result = m_tools.listResponse(m_toolsReader.get(), params.cursor, params.ifChangedSince);
+    if (!result) {
+        sendError(request.id.value(), ErrorCodes::INVALID_PARAMS, "Invalid cursor", "");
+        return;
+    }
 
-    JsonRpcResponse response = protocol::makeResultResponse(
-        request.id.value(), m_toolsListCache);
+    JsonRpcResponse response = protocol::makeResultResponse(request.id.value(), result.value());
 
     sendResponse(response);
 }
 
-void McpStdioServer::handleToolsCall(const JsonRpcRequestView& request) {
+void McpStdioServer::handleToolsCall(ParsedJsonRpcRequest& message) {
+    const JsonRpcRequestView& request = message.request;
     if (!request.id.has_value()) {
         return;
     }
@@ -260,49 +700,271 @@ void McpStdioServer::handleToolsCall(const JsonRpcRequestView& request) {
             return;
         }
 
-        std::shared_lock<std::shared_mutex> lock(m_toolsMutex);
+        JsonElement arguments = JsonHelper::EmptyObject();
+        JsonElement argsElement;
+        if (JsonHelper::GetElement(paramsObj, "arguments", argsElement)) {
+            arguments = argsElement;
+        }
 
-        auto it = m_tools.find(toolName);
-        if (it == m_tools.end()) {
-            sendError(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
+        std::optional<McpCancellationToken::Clock::time_point> deadline;
+        if (auto timeout = protocol::getRequestTimeout(paramsObj)) {
+            deadline = McpCancellationToken::Clock::now() + timeout.value();
+        }
+        std::optional<JsonString> progressToken = protocol::getProgressToken(paramsObj);
+        const int64_t id = request.id.value();
+        McpCancellationSource source(deadline);
+        {
+            std::lock_guard<std::mutex> lock(m_inflightMutex);
+            m_inflight.insert_or_assign(id, source);
+        }
+
+        if (!m_toolPool) {
+            executeToolCall(id, toolName, arguments, source.token(), progressToken);
+            return;
+        }
+
+        // 参数借用自请求文档，文档随任务一起交给工作线程
+        auto owned = std::make_shared<ParsedJsonRpcRequest>(std::move(message));
+        m_toolPool->submit([this, owned, id, toolName, arguments, token = source.token(),
+                            progressToken = std::move(progressToken)]() {
+            executeToolCall(id, toolName, arguments, token, progressToken);
+        });
+
+    } catch (const std::exception& e) {
+        sendError(request.id.value(), ErrorCodes::INTERNAL_ERROR,
+                 "Internal error", e.what());
+    }
+}
+
+void McpStdioServer::handleCancelled(const JsonRpcRequestView& request) {
+    if (!request.hasParams) {
+        return;
+    }
+    auto requestId = protocol::getCancelledRequestId(request.params);
+    if (!requestId) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_inflightMutex);
+    auto it = m_inflight.find(requestId.value());
+    if (it != m_inflight.end()) {
+        it->second.cancel(McpCancelReason::Cancelled);
+    }
+}
+
+void McpStdioServer::executeToolCall(int64_t id,
+                                     const std::string& toolName,
+                                     const JsonElement& arguments,
+                                     const McpCancellationToken& cancellation,
+                                     const std::optional<JsonString>& progressToken) {
+    auto finish = [this, id]() {
+        std::lock_guard<std::mutex> lock(m_inflightMutex);
+        m_inflight.erase(id);
+    };
+
+    try {
+        // 排队期间已被取消：客户端取消或输入流关闭时不再响应，超时返回错误
+        const McpCancelReason queuedReason = cancellation.reason();
+        if (queuedReason != McpCancelReason::None) {
+            finish();
+            if (queuedReason == McpCancelReason::DeadlineExceeded) {
+                sendError(id, ErrorCodes::REQUEST_CANCELLED, "Request cancelled",
+                         protocol::cancelReasonText(queuedReason));
+            }
+            return;
+        }
+
+        // 可能在工作线程上执行：持有快照直到处理函数返回，期间删除该工具不影响本次调用
+        auto tools = m_tools.snapshot();
+        const ToolInfo* info = tools->find(toolName);
+        if (!info) {
+            finish();
+            sendError(id, ErrorCodes::METHOD_NOT_FOUND,
                      "Tool not found", toolName);
             return;
         }
 
-        JsonElement arguments = JsonHelper::EmptyObject();
-        JsonElement argsElement;
-        if (JsonHelper::GetElement(paramsObj, "arguments", argsElement)) {
-            arguments = argsElement;
+        // 命中结果缓存时直接写出缓存的 result 片段
+        std::optional<McpResultCacheKey> cacheKey;
+        if (info->cacheTtl.count() > 0) {
+            cacheKey = McpResultCache::makeKey(toolName, info->cacheScope, arguments);
+            if (auto cached = m_resultCache.find(*cacheKey)) {
+                finish();
+                writeMessage(encoding::encodeResultResponse(
+                    id, CachedToolResult{*cached}, m_encoding.load(std::memory_order_acquire)));
+                return;
+            }
+        }
+
+        McpToolContext context;
+        context.requestId = id;
+        context.cancellation = cancellation;
+        if (progressToken.has_value()) {
+            // 进度通知与响应共用 writeMessage，按写出顺序先于响应到达客户端
+            context.progress = McpProgressReporter(*progressToken, m_progressInterval,
+                [this](const JsonString& params) {
+                    sendNotification(Methods::PROGRESS, params);
+                });
+        }
+
+        if (info->streamingHandler) {
+            streamResult(id, McpContentEncoding::JsonString, protocol::streamedToolResultPrefix(),
+                         &protocol::streamedToolResultSuffix, &context,
+                         [&](McpContentWriter& writer) { return info->streamingHandler(arguments, context, writer); });
+            context.progress.close();
+            finish();
+            return;
         }
 
         // 调用工具处理函数
-        auto result = it->second.handler(arguments);
+        auto result = info->handler(arguments, context);
+        context.progress.close();
+        finish();
+
+        const McpCancelReason reason = cancellation.reason();
+        if (reason == McpCancelReason::Cancelled || reason == McpCancelReason::ConnectionClosed) {
+            return;
+        }
 
         if (!result) {
-            sendError(request.id.value(), result.error().toJsonRpcErrorCode(),
+            sendError(id, result.error().toJsonRpcErrorCode(),
                      result.error().message(), result.error().details());
             return;
         }
 
         // 构建响应
-        ToolCallResult callResult;
-        Content content;
-        content.type = ContentType::Text;
-        content.text = result.value();
-        callResult.content.push_back(content);
-
-        JsonRpcResponse response;
-        response.id = request.id.value();
-        response.result = callResult.toJson();
+        auto callResult = protocol::makeToolCallResult(info->tool, std::move(result.value()));
+        if (!callResult) {
+            sendError(id, ErrorCodes::INTERNAL_ERROR,
+                     callResult.error().message(), callResult.error().details());
+            return;
+        }
 
-        sendResponse(response);
+        writeMessage(encoding::encodeResultResponse(
+            id, callResult.value(), m_encoding.load(std::memory_order_acquire)));
+        if (cacheKey) {
+            m_resultCache.store(*cacheKey, callResult->toJson(), info->cacheTtl);
+        }
 
     } catch (const std::exception& e) {
-        sendError(request.id.value(), ErrorCodes::INTERNAL_ERROR,
+        finish();
+        sendError(id, ErrorCodes::INTERNAL_ERROR,
                  "Internal error", e.what());
     }
 }
 
+void McpStdioServer::streamResult(int64_t id,
+                                  McpContentEncoding encoding,
+                                  const JsonString& resultPrefix,
+                                  JsonString (*resultSuffix)(const McpError*),
+                                  const McpToolContext* context,
+                                  const StreamProducer& produce) {
+    const McpWireEncoding wireEncoding = m_encoding.load(std::memory_order_acquire);
+    bool direct = false;
+    {
+        std::lock_guard<std::mutex> lock(m_outputMutex);
+        direct = !m_channel && m_framing == McpStdioFraming::Newline && wireEncoding == McpWireEncoding::Json;
+    }
+
+    // 直接写出时第一块输出到达才写出响应前缀并占用输出行（m_streaming），直到写完结尾；
+    // 输出锁只在写每一块时持有，其他消息在占用期间排队，不会插入这一行。
+    // 否则收集编码后的内容，结束后作为 result 写出
+    bool started = false;
+    bool released = false;
+    // 结束这一行、紧跟着写出占用期间排队的消息并释放占用
+    auto release = [&](std::string_view tail) {
+        {
+            std::lock_guard<std::mutex> lock(m_outputMutex);
+            m_output->write(tail.data(), static_cast<std::streamsize>(tail.size()));
+            m_output->put('\n');
+            for (const auto& [message, framing] : m_deferred) {
+                framing::writeFrame(*m_output, message, framing);
+            }
+            m_deferred.clear();
+            m_output->flush();
+            m_streaming = false;
+        }
+        released = true;
+        m_streamDone.notify_all();
+    };
+    // 以异常离开时同样释放占用，否则之后的消息一直排队、下一个流式响应永远等待
+    ScopeExit releaseOnExit([&]() {
+        if (started && !released) {
+            release({});
+        }
+    });
+    std::string collected;
+    McpContentWriter writer(encoding, [&](std::string_view chunk) {
+        if (context && context->cancellation.isCancelled()) {
+            return false;
+        }
+        if (!direct) {
+            collected.append(chunk);
+            return true;
+        }
+        if (!started && context) {
+            // 响应开始写出后不再发送进度通知（排队的进度会落在响应之后）
+            McpProgressReporter progress = context->progress;
+            progress.close();
+        }
+        std::unique_lock<std::mutex> output(m_outputMutex);
+        if (!started) {
+            // 另一个流式响应正占用输出行时等它结束
+            m_streamDone.wait(output, [this]() { return !m_streaming; });
+            m_streaming = true;
+            started = true;
+            const JsonString prefix = protocol::streamedResponsePrefix(id) + resultPrefix;
+            m_output->write(prefix.data(), static_cast<std::streamsize>(prefix.size()));
+        }
+        m_output->write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        m_output->flush();
+        return m_output->good();
+    });
+
+    std::expected<void, McpError> result;
+    try {
+        result = produce(writer);
+    } catch (const std::exception& e) {
+        result = std::unexpected(McpError::internalError(e.what()));
+    } catch (...) {
+        result = std::unexpected(McpError::internalError("Unknown exception"));
+    }
+    if (result) {
+        writer.flush();
+    }
+
+    const McpCancelReason reason = context ? context->cancellation.reason() : McpCancelReason::None;
+    if (!started) {
+        // 尚未写出任何字节：与普通调用的结束方式相同
+        if (reason == McpCancelReason::Cancelled || reason == McpCancelReason::ConnectionClosed) {
+            return;
+        }
+        if (!result) {
+            sendError(id, result.error().toJsonRpcErrorCode(),
+                     result.error().message(), result.error().details());
+            return;
+        }
+        if (writer.failed()) {
+            sendError(id, ErrorCodes::REQUEST_CANCELLED, "Request cancelled", protocol::cancelReasonText(reason));
+            return;
+        }
+        JsonRpcResponse response;
+        response.id = id;
+        response.result = resultPrefix + collected + resultSuffix(nullptr);
+        sendResponse(response);
+        return;
+    }
+
+    // 已写出部分内容：响应必须在这一行内结束，失败以 isError 结果表示
+    std::optional<McpError> error;
+    if (!result) {
+        error = result.error();
+    } else if (writer.failed()) {
+        error = McpError::requestCancelled(protocol::cancelReasonText(reason));
+    }
+    release(resultSuffix(error ? &error.value() : nullptr) + "}");
+}
+
 void McpStdioServer::handleResourcesList(const JsonRpcRequestView& request) {
     if (!request.id.has_value()) {
         return;
@@ -314,10 +976,14 @@ void McpStdioServer::handleResourcesList(const JsonRpcRequestView& request) {
         return;
     }
 
-    std::shared_lock<std::shared_mutex> lock(m_resourcesMutex);
+    const auto params = protocol::getListParams(request.params, request.hasParams);
+    auto result = m_resources.listResponse(m_resourcesReader.get(), params.cursor, params.ifChangedSince);
+    if (!result) {
+        sendError(request.id.value(), ErrorCodes::INVALID_PARAMS, "Invalid cursor", "");
+        return;
+    }
 
-    JsonRpcResponse response = protocol::makeResultResponse(
-        request.id.value(), m_resourcesListCache);
+    JsonRpcResponse response = protocol::makeResultResponse(request.id.value(), result.value());
 
     sendResponse(response);
 }
@@ -354,17 +1020,42 @@ void McpStdioServer::handleResourcesRead(const JsonRpcRequestView& request) {
             return;
         }
 
-        std::shared_lock<std::shared_mutex> lock(m_resourcesMutex);
-
-        auto it = m_resources.find(uri);
-        if (it == m_resources.end()) {
+        const ResourceInfo* info = m_resourcesReader.get().find(uri);
+        if (!info) {
             sendError(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
                      "Resource not found", uri);
             return;
         }
 
+        if (info->streamingReader) {
+            // 设置了工作线程时在工作线程上读取：另一个流式响应占用输出行时只有工作线程等待，
+            // 读取线程继续处理请求；持有快照直到读取结束
+            auto read = [this, id = request.id.value(), uri, resources = m_resources.snapshot()]() {
+                const ResourceInfo* entry = resources->find(uri);
+                if (!entry || !entry->streamingReader) {
+                    sendError(id, ErrorCodes::METHOD_NOT_FOUND, "Resource not found", uri);
+                    return;
+                }
+                try {
+                    streamResult(id,
+                                 entry->blob ? McpContentEncoding::Base64 : McpContentEncoding::JsonString,
+                                 protocol::streamedResourceResultPrefix(uri, entry->resource.mimeType, entry->blob),
+                                 &protocol::streamedResourceResultSuffix, nullptr,
+                                 [&](McpContentWriter& writer) { return entry->streamingReader(uri, writer); });
+                } catch (const std::exception& e) {
+                    sendError(id, ErrorCodes::INTERNAL_ERROR, "Internal error", e.what());
+                }
+            };
+            if (m_toolPool) {
+                m_toolPool->submit(std::move(read));
+            } else {
+                read();
+            }
+            return;
+        }
+
         // 调用资源读取函数
-        auto result = it->second.reader(uri);
+        auto result = info->reader(uri);
 
         if (!result) {
             sendError(request.id.value(), result.error().toJsonRpcErrorCode(),
@@ -408,10 +1099,14 @@ void McpStdioServer::handlePromptsList(const JsonRpcRequestView& request) {
         return;
     }
 
-    std::shared_lock<std::shared_mutex> lock(m_promptsMutex);
+    const auto params = protocol::getListParams(request.params, request.hasParams);
+    auto result = m_prompts.listResponse(m_promptsReader.get(), params.cursor, params.ifChangedSince);
+    if (!result) {
+        sendError(request.id.value(), ErrorCodes::INVALID_PARAMS, "Invalid cursor", "");
+        return;
+    }
 
-    JsonRpcResponse response = protocol::makeResultResponse(
-        request.id.value(), m_promptsListCache);
+    JsonRpcResponse response = protocol::makeResultResponse(request.id.value(), result.value());
 
     sendResponse(response);
 }
@@ -454,17 +1149,15 @@ void McpStdioServer::handlePromptsGet(const JsonRpcRequestView& request) {
             arguments = argsElement;
         }
 
-        std::shared_lock<std::shared_mutex> lock(m_promptsMutex);
-
-        auto it = m_prompts.find(name);
-        if (it == m_prompts.end()) {
+        const PromptInfo* info = m_promptsReader.get().find(name);
+        if (!info) {
             sendError(request.id.value(), ErrorCodes::METHOD_NOT_FOUND,
                      "Prompt not found", name);
             return;
         }
 
         // 调用提示获取函数
-        auto result = it->second.getter(name, arguments);
+        auto result = info->getter(name, arguments);
 
         if (!result) {
             sendError(request.id.value(), result.error().toJsonRpcErrorCode(),
@@ -496,7 +1189,7 @@ void McpStdioServer::handlePing(const JsonRpcRequestView& request) {
 }
 
 void McpStdioServer::sendResponse(const JsonRpcResponse& response) {
-    writeMessage(response.toJson());
+    writeMessage(encoding::encodeMessage(response, m_encoding.load(std::memory_order_acquire)));
 }
 
 void McpStdioServer::sendError(int64_t id, int code, const std::string& message,
@@ -509,32 +1202,45 @@ void McpStdioServer::sendNotification(const std::string& method, const JsonStrin
     notification.method = method;
     notification.params = params;
 
-    writeMessage(notification.toJson());
+    writeMessage(encoding::encodeMessage(notification, m_encoding.load(std::memory_order_acquire)));
+}
+
+void McpStdioServer::notifyListChanged(const char* method) {
+    if (m_initialized && m_running) {
+        sendNotification(method, EmptyObjectString());
+    }
 }
 
 std::expected<std::string, McpError> McpStdioServer::readMessage() {
-    std::string line;
-    if (!std::getline(*m_input, line)) {
-        return std::unexpected(McpError::readError("Failed to read from stdin"));
+    if (m_channel) {
+        return m_channel->readMessage();
     }
 
-    if (line.empty()) {
+    auto message = framing::readFrame(*m_input);
+    if (!message) {
+        return std::unexpected(message.error());
+    }
+
+    if (message.value().empty()) {
         return std::unexpected(McpError::invalidMessage("Empty message"));
     }
 
-    return line;
+    return message;
 }
 
 std::expected<void, McpError> McpStdioServer::writeMessage(const JsonString& message) {
+    // 工具工作线程与读取线程都会写出，通道同样需要串行化
     std::lock_guard<std::mutex> lock(m_outputMutex);
-
-    try {
-        *m_output << message << '\n';
-        m_output->flush();
+    if (m_channel) {
+        return m_channel->writeMessage(message);
+    }
+    if (m_streaming) {
+        // 流式响应正占用输出行：排队，不阻塞调用线程
+        m_deferred.emplace_back(message, m_framing);
         return {};
-    } catch (const std::exception& e) {
-        return std::unexpected(McpError::writeError(e.what()));
     }
+
+    return framing::writeFrame(*m_output, message, m_framing);
 }
 
 } // namespace mcp
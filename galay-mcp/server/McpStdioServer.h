@@ -2,13 +2,28 @@
 #define GALAY_MCP_SERVER_MCPSTDIOSERVER_H
 
 #include "galay-mcp/common/McpBase.h"
+#include "galay-mcp/common/McpCancellation.h"
+#include "galay-mcp/common/McpComputePool.h"
+#include "galay-mcp/common/McpContentWriter.h"
+#include "galay-mcp/common/McpEncoding.h"
 #include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpInProcessEndpoint.h"
 #include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpManifest.h"
+#include "galay-mcp/common/McpMessageChannel.h"
+#include "galay-mcp/common/McpRegistry.h"
+#include "galay-mcp/common/McpToolContext.h"
+#include "galay-mcp/server/McpResultCache.h"
+#include <condition_variable>
 #include <functional>
 #include <unordered_map>
 #include <memory>
+#include <mutex>
 #include <atomic>
-#include <shared_mutex>
+#include <chrono>
+#include <optional>
+#include <utility>
+#include <vector>
 #include <iostream>
 
 namespace galay {
@@ -18,21 +33,89 @@ namespace mcp {
  * @brief 基于标准输入输出的MCP服务器
  *
  * 该类实现了MCP协议的服务器端，通过stdin接收请求，通过stdout发送响应。
- * 每条消息以换行符分隔，使用JSON-RPC 2.0格式。
+ * 默认每条消息以换行符分隔，使用JSON-RPC 2.0格式；读取时同时识别 Content-Length 分帧。
+ * 客户端在 initialize 中声明 capabilities.experimental.galay.framing = "content-length" 时，
+ * 服务端在响应中确认，并从下一条消息起改用 Content-Length 分帧写出。
+ * 传输可承载二进制（已协商 Content-Length 分帧或使用消息通道）且客户端声明
+ * capabilities.experimental.galay.encoding = "msgpack" 时，同样确认并改用 MessagePack 编码；
+ * 读取时按消息首字节自动识别 JSON / MessagePack。
+ * 通过 setChannel() 可以改用其他消息通道（例如同机共享内存 McpShmChannel），注册表与协议处理不变。
+ * 同一进程内的调用方可以用 McpInProcessClient 直接绑定注册表，无需 run()。
+ * 工具处理函数可以接收 McpToolContext，通过其中的取消令牌感知 notifications/cancelled、
+ * 客户端超时（params._meta.timeoutMs）与输入流关闭；setToolWorkers() 开启后 tools/call
+ * 在工作线程上执行，读取线程继续接收后续消息（包括取消通知）。
+ * 请求带 params._meta.progressToken 时，处理函数可经 McpToolContext::progress 上报进度，
+ * notifications/progress 与响应经同一输出函数串行写出，且同一请求每个间隔最多一条。
+ * 工具、资源与提示保存在 RCU 快照注册表（McpRegistry）中：add* / remove* 可在 run() 期间随时调用，
+ * 查找与列表请求不加锁；初始化之后注册表变化时发送 notifications/{tools,resources,prompts}/list_changed。
+ * addStructuredTool() 注册的工具声明 outputSchema，返回的 JSON 对象作为 structuredContent 原样嵌入响应。
+ * addStreamingTool() 注册的工具把输出分块写入 McpContentWriter：按行分帧的 JSON 连接上边转义边写入 stdout，
+ * 不在内存中拼出完整结果；addStreamingResource() 注册的资源同样分块写出，二进制内容按 base64 编码为 blob。
+ * 注册时指定 cacheTtl 的工具开启结果缓存：参数等价（键顺序、空白不同）的调用在 TTL 内直接返回
+ * 预先序列化的 result，不再调用处理函数；缓存是分段 LRU，内存预算由 setResultCacheOptions() 设置，
+ * 设置 persistentPath 时结果同时写入磁盘日志（McpResultStore），重启后仍可命中。
  */
-class McpStdioServer {
+class McpStdioServer : public McpInProcessEndpoint {
 public:
     // 工具处理函数类型
     using ToolHandler = std::function<std::expected<JsonString, McpError>(const JsonElement&)>;
 
+    // 接收调用上下文（取消令牌等）的工具处理函数类型
+    using ContextToolHandler = std::function<std::expected<JsonString, McpError>(const JsonElement&,
+                                                                                 const McpToolContext&)>;
+
+    // 流式工具处理函数类型：文本输出分块写入 writer，返回错误时已写出的部分作废
+    using StreamingToolHandler = std::function<std::expected<void, McpError>(const JsonElement&,
+                                                                             const McpToolContext&,
+                                                                             McpContentWriter&)>;
+
     // 资源读取函数类型
     using ResourceReader = std::function<std::expected<std::string, McpError>(const std::string&)>;
 
+    // 流式资源读取函数类型：内容分块写入 writer，返回错误时已写出的部分作废
+    using StreamingResourceReader = std::function<std::expected<void, McpError>(const std::string&,
+                                                                                McpContentWriter&)>;
+
     // 提示获取函数类型
     using PromptGetter = std::function<std::expected<JsonString, McpError>(const std::string&, const JsonElement&)>;
 
-    McpStdioServer();
-    ~McpStdioServer();
+    // 批量注册的条目定义，字段与对应 add* 的参数一致
+    struct ToolDefinition {
+        std::string name;
+        std::string description;
+        JsonString inputSchema;
+        ContextToolHandler handler;
+        std::chrono::milliseconds cacheTtl{0};
+        JsonString outputSchema;  // 非空时同 addStructuredTool
+        StreamingToolHandler streamingHandler;  // 非空时代替 handler，同 addStreamingTool
+    };
+
+    struct ResourceDefinition {
+        std::string uri;
+        std::string name;
+        std::string description;
+        std::string mimeType;
+        ResourceReader reader;
+        StreamingResourceReader streamingReader;  // 非空时代替 reader，同 addStreamingResource
+        bool blob = false;
+    };
+
+    struct PromptDefinition {
+        std::string name;
+        std::string description;
+        std::vector<PromptArgument> arguments;
+        PromptGetter getter;
+    };
+
+    // 为清单条目绑定实现；返回空函数表示本进程没有实现该条目
+    using ManifestToolBinder = std::function<ContextToolHandler(const McpManifestTool&)>;
+    using ManifestResourceBinder = std::function<ResourceReader(const McpManifestResource&)>;
+
+    /**
+     * @param framing 写出分帧方式；ContentLength 时从第一条消息起即使用该分帧（仅适用于已知支持它的对端）
+     */
+    explicit McpStdioServer(McpStdioFraming framing = McpStdioFraming::Newline);
+    ~McpStdioServer() override;
 
     // 禁止拷贝和移动
     McpStdioServer(const McpStdioServer&) = delete;
@@ -53,11 +136,61 @@ public:
      * @param description 工具描述
      * @param inputSchema 输入参数的JSON Schema
      * @param handler 工具处理函数
+     * @param cacheTtl 结果缓存时长；大于 0 时参数等价的调用在该时长内直接返回缓存的结果，
+     *                 只适用于结果只依赖 arguments 的工具
      */
     void addTool(const std::string& name,
                  const std::string& description,
                  const JsonString& inputSchema,
-                 ToolHandler handler);
+                 ToolHandler handler,
+                 std::chrono::milliseconds cacheTtl = {});
+
+    /**
+     * @brief 添加接收调用上下文的工具
+     * @note 处理函数应在耗时步骤之间检查 context.cancellation，被取消时尽快返回
+     */
+    void addTool(const std::string& name,
+                 const std::string& description,
+                 const JsonString& inputSchema,
+                 ContextToolHandler handler,
+                 std::chrono::milliseconds cacheTtl = {});
+
+    /**
+     * @brief 添加声明了 outputSchema 的工具
+     * @param outputSchema 输出的 JSON Schema，在 tools/list 中声明
+     * @note 处理函数返回 JSON 对象文本，原样作为 structuredContent 写入响应，不转义为文本内容；
+     *       返回值不是对象时调用以 INTERNAL_ERROR 结束
+     */
+    void addStructuredTool(const std::string& name,
+                           const std::string& description,
+                           const JsonString& inputSchema,
+                           const JsonString& outputSchema,
+                           ToolHandler handler,
+                           std::chrono::milliseconds cacheTtl = {});
+
+    void addStructuredTool(const std::string& name,
+                           const std::string& description,
+                           const JsonString& inputSchema,
+                           const JsonString& outputSchema,
+                           ContextToolHandler handler,
+                           std::chrono::milliseconds cacheTtl = {});
+
+    /**
+     * @brief 添加流式输出文本的工具
+     * @note 结果是一个文本内容项。按行分帧的 JSON 连接上，writer 每满一块（64KB）就转义写入 stdout，
+     *       第一块写出后该响应占用输出行直到结束，期间进度通知不再发送；输出锁只在写每一块时持有，
+     *       其他消息（例如工作线程上并发请求的响应、ping 的响应）排队，在该响应结束后依次写出，
+     *       这些响应要等流式响应写完才能到达客户端。设置了 setToolWorkers() 时流式工具与流式资源都在
+     *       工作线程上执行，等待输出行的只有工作线程，读取线程继续接收请求与取消通知；未设置时所有请求
+     *       在读取线程上依次处理。处理函数在部分输出之后返回错误或调用被取消时，响应以一条说明错误的
+     *       文本内容项和 isError=true 结束。
+     *       Content-Length 分帧、MessagePack 编码或设置了通道时先收集完整文本，再按普通结果写出。
+     *       流式工具不经过结果缓存。
+     */
+    void addStreamingTool(const std::string& name,
+                          const std::string& description,
+                          const JsonString& inputSchema,
+                          StreamingToolHandler handler);
 
     /**
      * @brief 添加资源
@@ -73,6 +206,20 @@ public:
                      const std::string& mimeType,
                      ResourceReader reader);
 
+    /**
+     * @brief 添加分块读取的资源
+     * @param blob true 时内容是二进制，按 base64 编码写入 "blob"；否则转义写入 "text"
+     * @note 写出方式同 addStreamingTool()：按行分帧的 JSON 连接上每满一块（64KB）就编码写入 stdout，
+     *       其他传输先收集完整内容；设置了 setToolWorkers() 时在工作线程上读取。部分内容写出后读取失败时，
+     *       result 带 isError=true，错误说明在 _meta.error 中。
+     */
+    void addStreamingResource(const std::string& uri,
+                              const std::string& name,
+                              const std::string& description,
+                              const std::string& mimeType,
+                              StreamingResourceReader reader,
+                              bool blob = false);
+
     /**
      * @brief 添加提示
      * @param name 提示名称
@@ -85,6 +232,71 @@ public:
                    const std::vector<PromptArgument>& arguments,
                    PromptGetter getter);
 
+    /**
+     * @brief 批量添加工具 / 资源 / 提示
+     * @return 新增的条目数；与已有条目同名时替换，不计入
+     * @note 整批只发布一个注册表版本、至多发送一条 list_changed，
+     *       逐个 add* 每次都要复制整张注册表，启动时注册成百上千个条目应使用这组接口
+     */
+    size_t registerTools(std::vector<ToolDefinition> tools);
+    size_t registerResources(std::vector<ResourceDefinition> resources);
+    size_t registerPrompts(std::vector<PromptDefinition> prompts);
+
+    /**
+     * @brief 注册清单中的全部工具与资源
+     * @param bindTool 为每个工具返回处理函数（通常按 name 查表）
+     * @param bindResource 为每个资源返回读取函数；清单没有资源时可为空
+     * @return 新增的条目数；有条目未绑定时返回 InvalidParams，且不注册任何条目
+     * @note 工具与资源各发布一个快照；inputSchema 与列表 JSON 直接引用清单映射，不再复制或重新序列化
+     */
+    std::expected<size_t, McpError> loadManifest(std::shared_ptr<const McpManifest> manifest,
+                                                 const ManifestToolBinder& bindTool,
+                                                 const ManifestResourceBinder& bindResource = {});
+
+    /**
+     * @brief 删除工具 / 资源 / 提示
+     * @return 条目是否存在；进行中的调用使用删除前的快照，不受影响
+     */
+    bool removeTool(const std::string& name);
+    bool removeResource(const std::string& uri);
+    bool removePrompt(const std::string& name);
+
+    /**
+     * @brief 设置 tools/list、resources/list、prompts/list 每页的条目数（默认 0 表示不分页）
+     * @note 分页后请求通过 params.cursor 翻页，结果带 nextCursor；每页首次请求时拼接并缓存。
+     *       可在运行期间修改，之前签发的 cursor 若不再对齐页边界会以 InvalidParams 拒绝
+     */
+    void setListPageSize(size_t pageSize);
+
+    /**
+     * @brief 改为经由指定消息通道收发消息
+     * @param channel 已建立的消息通道；需在 run() 之前设置
+     */
+    void setChannel(std::unique_ptr<McpMessageChannel> channel);
+
+    /**
+     * @brief 在工作线程上执行 tools/call（以及流式资源的 resources/read）
+     * @param threads 工作线程数；默认 0 表示在读取线程上依次执行（此时取消通知要等当前调用结束后才会被读到）
+     * @note 需在 run() 之前设置；开启后响应可能不按请求顺序写出，处理函数需要线程安全
+     */
+    void setToolWorkers(size_t threads);
+
+    /**
+     * @brief 设置同一请求两条 notifications/progress 之间的最小间隔（默认 100ms，0 表示不合并）
+     * @note 需在 run() 之前设置
+     */
+    void setProgressInterval(std::chrono::milliseconds interval);
+
+    /**
+     * @brief 设置工具结果缓存的分段数、内存预算与持久层目录
+     * @return 持久层目录无法打开时返回错误，缓存退回只用内存
+     * @note 需在 run() 之前、注册可缓存工具之前设置
+     */
+    std::expected<void, McpError> setResultCacheOptions(const McpResultCacheOptions& options);
+
+    // 结果缓存的条目数、字节数与命中、未命中、淘汰计数（线程安全）
+    McpResultCacheStats resultCacheStats() const;
+
     /**
      * @brief 运行服务器（阻塞）
      *
@@ -102,14 +314,33 @@ public:
      */
     bool isRunning() const;
 
+    // McpInProcessEndpoint：进程内直接访问注册表，可与 run() 并发调用
+    InitializeResult localInitialize() override;
+    std::vector<Tool> localListTools() override;
+    std::vector<Resource> localListResources() override;
+    std::vector<Prompt> localListPrompts() override;
+    std::expected<JsonString, McpError> localCallTool(const std::string& name,
+                                                      const JsonElement& arguments) override;
+    std::expected<std::string, McpError> localReadResource(const std::string& uri) override;
+    std::expected<JsonString, McpError> localGetPrompt(const std::string& name,
+                                                       const JsonElement& arguments) override;
+
 private:
     // 处理请求
-    void handleRequest(const JsonRpcRequestView& request);
+    void handleRequest(ParsedJsonRpcRequest& message);
 
     // 处理各种方法
     void handleInitialize(const JsonRpcRequestView& request);
     void handleToolsList(const JsonRpcRequestView& request);
-    void handleToolsCall(const JsonRpcRequestView& request);
+    void handleToolsCall(ParsedJsonRpcRequest& message);
+    void handleCancelled(const JsonRpcRequestView& request);
+
+    // 执行一次工具调用并写出响应；被客户端取消或输入流关闭时不写响应
+    void executeToolCall(int64_t id,
+                         const std::string& toolName,
+                         const JsonElement& arguments,
+                         const McpCancellationToken& cancellation,
+                         const std::optional<JsonString>& progressToken);
     void handleResourcesList(const JsonRpcRequestView& request);
     void handleResourcesRead(const JsonRpcRequestView& request);
     void handlePromptsList(const JsonRpcRequestView& request);
@@ -121,10 +352,13 @@ private:
     void sendError(int64_t id, int code, const std::string& message, const std::string& details = "");
     void sendNotification(const std::string& method, const JsonString& params);
 
-    // 读取一行JSON消息
+    // 已初始化且正在运行时发送注册表变化通知
+    void notifyListChanged(const char* method);
+
+    // 读取一条JSON消息（自动识别换行 / Content-Length 分帧）
     std::expected<std::string, McpError> readMessage();
 
-    // 写入一行JSON消息
+    // 按当前分帧方式写入一条JSON消息
     std::expected<void, McpError> writeMessage(const JsonString& message);
 
 private:
@@ -135,30 +369,53 @@ private:
     // 工具注册表
     struct ToolInfo {
         Tool tool;
-        ToolHandler handler;
+        ContextToolHandler handler;
+        StreamingToolHandler streamingHandler;  // 非空时代替 handler
+        // 由清单加载的工具持有清单：tool.inputSchema 为空，schema 指向映射
+        std::shared_ptr<const McpManifest> manifest;
+        std::string_view schema;
+        // cacheTtl > 0 时开启结果缓存，cacheScope 为注册代次
+        std::chrono::milliseconds cacheTtl{0};
+        uint64_t cacheScope = 0;
     };
-    std::unordered_map<std::string, ToolInfo> m_tools;
-    mutable std::shared_mutex m_toolsMutex;
+    McpRegistry<ToolInfo> m_tools;
+
+    // 流式结果的生产函数：在调用线程上把内容写入 writer
+    using StreamProducer = std::function<std::expected<void, McpError>(McpContentWriter&)>;
+
+    // 流式工具与流式资源共用的写出：按行分帧的 JSON 连接上边编码边写入响应，否则收集编码后的内容，
+    // 结束后以 resultPrefix + 内容 + resultSuffix 作为 result 写出；context 只在工具调用时给出
+    void streamResult(int64_t id,
+                      McpContentEncoding encoding,
+                      const JsonString& resultPrefix,
+                      JsonString (*resultSuffix)(const McpError*),
+                      const McpToolContext* context,
+                      const StreamProducer& produce);
+
+    // 设置了 cacheTtl 的工具的调用结果
+    McpResultCache m_resultCache;
 
     // 资源注册表
     struct ResourceInfo {
         Resource resource;
         ResourceReader reader;
+        StreamingResourceReader streamingReader;  // 非空时代替 reader
+        bool blob = false;
+        std::shared_ptr<const McpManifest> manifest;  // 列表 JSON 指向清单映射时持有清单
     };
-    std::unordered_map<std::string, ResourceInfo> m_resources;
-    mutable std::shared_mutex m_resourcesMutex;
+    McpRegistry<ResourceInfo> m_resources;
 
     // 提示注册表
     struct PromptInfo {
         Prompt prompt;
         PromptGetter getter;
     };
-    std::unordered_map<std::string, PromptInfo> m_prompts;
-    mutable std::shared_mutex m_promptsMutex;
+    McpRegistry<PromptInfo> m_prompts;
 
-    JsonString m_toolsListCache;
-    JsonString m_resourcesListCache;
-    JsonString m_promptsListCache;
+    // 读取线程的快照缓存，只在 run() 所在线程上使用
+    McpRegistry<ToolInfo>::Reader m_toolsReader;
+    McpRegistry<ResourceInfo>::Reader m_resourcesReader;
+    McpRegistry<PromptInfo>::Reader m_promptsReader;
 
     // 运行状态
     std::atomic<bool> m_running;
@@ -168,6 +425,25 @@ private:
     std::istream* m_input;
     std::ostream* m_output;
     std::mutex m_outputMutex;
+    McpStdioFraming m_framing;  // 受 m_outputMutex 保护
+    // 流式响应直接写出、占用输出行期间为 true；其他消息按当时的分帧排入 m_deferred，响应结束后写出
+    bool m_streaming = false;  // 受 m_outputMutex 保护
+    std::vector<std::pair<JsonString, McpStdioFraming>> m_deferred;  // 受 m_outputMutex 保护
+    std::condition_variable m_streamDone;  // 流式响应结束时通知等待开始写出的其他流式响应
+    std::atomic<McpWireEncoding> m_encoding{McpWireEncoding::Json};
+
+    // 消息通道（为空时使用 stdin/stdout）
+    std::unique_ptr<McpMessageChannel> m_channel;
+
+    // 进行中的 tools/call，按请求 id 索引取消源
+    std::mutex m_inflightMutex;
+    std::unordered_map<int64_t, McpCancellationSource> m_inflight;
+
+    // tools/call 工作线程（run() 期间存在）
+    size_t m_toolWorkers{0};
+    std::unique_ptr<McpComputePool> m_toolPool;
+
+    std::chrono::milliseconds m_progressInterval{100};
 };
 
 } // namespace mcp
@@ -23,15 +23,7 @@ require_bin "${BIN_DIR}/T2-stdio_server"
 require_bin "${BIN_DIR}/T4-http_server"
 
 echo "== B1 stdio benchmark =="
-mkfifo /tmp/galay-mcp-b1-c2s /tmp/galay-mcp-b1-s2c
-"${BIN_DIR}/T2-stdio_server" < /tmp/galay-mcp-b1-c2s > /tmp/galay-mcp-b1-s2c &
-SERVER_PID=$!
-trap 'kill ${SERVER_PID} >/dev/null 2>&1 || true; wait ${SERVER_PID} 2>/dev/null || true; rm -f /tmp/galay-mcp-b1-c2s /tmp/galay-mcp-b1-s2c' EXIT
-"${BIN_DIR}/B1-stdio_performance" 1000 > /tmp/galay-mcp-b1-c2s < /tmp/galay-mcp-b1-s2c
-kill ${SERVER_PID} >/dev/null 2>&1 || true
-wait ${SERVER_PID} 2>/dev/null || true
-rm -f /tmp/galay-mcp-b1-c2s /tmp/galay-mcp-b1-s2c
-trap - EXIT
+"${BIN_DIR}/B1-stdio_performance" 1000 "${BIN_DIR}/T2-stdio_server"
 echo
 
 echo "== B2/B3 HTTP benchmarks =="
@@ -44,7 +36,16 @@ echo
 "${BIN_DIR}/B3-concurrent_requests" --url http://127.0.0.1:8080/mcp --workers 10 --requests 100
 echo
 
+echo "== B2 unix socket vs TCP loopback =="
+echo "start a second server in another terminal:"
+echo "  ${BIN_DIR}/T4-http_server 0 unix:/tmp/galay-mcp-bench.sock"
+echo
+read -r -p "Press Enter when the unix socket server is ready, or Ctrl+C to abort..."
+"${BIN_DIR}/B2-http_performance" --url http://127.0.0.1:8080/mcp --compare-url unix:/tmp/galay-mcp-bench.sock --connections 8 --requests 2000 --io 8 --compute 0
+echo
+
 echo "=== Benchmark reminders ==="
 echo "- Save raw stdout for every run."
-echo "- B1 uses the local stdio server target."
+echo "- B1 spawns the local stdio server target as a child process."
 echo "- B2/B3 expect a running HTTP MCP server at http://127.0.0.1:8080/mcp."
+echo "- The B2 comparison run also expects a unix socket server at /tmp/galay-mcp-bench.sock."
@@ -43,3 +43,27 @@ fi
 
 "$CLIENT_BIN" "$URL"
 echo "✓ HTTP integration test passed"
+
+kill "${SERVER_PID}" 2>/dev/null || true
+wait "${SERVER_PID}" 2>/dev/null || true
+SERVER_PID=""
+
+SOCKET_PATH="${SOCKET_PATH:-/tmp/galay-mcp-http-$$.sock}"
+echo "Starting HTTP MCP integration test over unix:${SOCKET_PATH}..."
+"$SERVER_BIN" 0 "unix:${SOCKET_PATH}" >/tmp/mcp_http_uds_server_$$.log 2>&1 &
+SERVER_PID=$!
+
+for _ in $(seq 1 50); do
+    if [ -S "$SOCKET_PATH" ]; then
+        break
+    fi
+    sleep 0.1
+done
+
+if [ ! -S "$SOCKET_PATH" ]; then
+    echo "HTTP server did not create unix socket: $SOCKET_PATH"
+    exit 1
+fi
+
+"$CLIENT_BIN" "unix:${SOCKET_PATH}"
+echo "✓ HTTP unix socket integration test passed"
@@ -8,11 +8,24 @@ void printError(const McpError& error) {
     std::cerr << "Error: " << error.toString() << std::endl;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
     McpStdioClient client;
 
     std::cerr << "=== MCP Client Test ===" << std::endl;
 
+    // 0. 可选：托管服务端子进程（用法: T1-stdio_client <server-binary>）
+    if (argc > 1) {
+        std::cerr << "\n0. Spawning server process: " << argv[1] << std::endl;
+        McpStdioProcessOptions options;
+        options.executable = argv[1];
+        auto spawnResult = client.spawn(std::move(options));
+        if (!spawnResult) {
+            printError(spawnResult.error());
+            return 1;
+        }
+        std::cerr << "✓ Server process spawned" << std::endl;
+    }
+
     // 1. 初始化连接
     std::cerr << "\n1. Initializing connection..." << std::endl;
     auto initResult = client.initialize("test-mcp-client", "1.0.0");
@@ -0,0 +1,159 @@
+/**
+ * @file T10-in_process.cc
+ * @brief 进程内直接绑定 McpStdioServer 注册表，并与经共享内存通道的线路调用对照结果与错误语义。
+ */
+
+#include "galay-mcp/client/McpInProcessClient.h"
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool sameError(const std::expected<T, McpError>& local, const std::expected<T, McpError>& wire)
+{
+    return !local.has_value() && !wire.has_value() &&
+           local.error().code() == wire.error().code() &&
+           local.error().message() == wire.error().message() &&
+           local.error().details() == wire.error().details();
+}
+
+void registerRegistry(McpStdioServer& server)
+{
+    server.setServerInfo("t10-in-process-server", "1.0.0");
+    server.addTool("echo", "Echo the message argument", "{}",
+        [](const JsonElement& args) -> std::expected<JsonString, McpError> {
+            JsonObject obj;
+            std::string message;
+            if (!JsonHelper::GetObject(args, obj) || !JsonHelper::GetString(obj, "message", message)) {
+                return std::unexpected(McpError::invalidParams("Missing message"));
+            }
+            return message;
+        });
+    server.addTool("throws", "Always throws", "{}",
+        [](const JsonElement&) -> std::expected<JsonString, McpError> {
+            throw std::runtime_error("handler exploded");
+        });
+    server.addResource("mem://greeting", "greeting", "Greeting text", "text/plain",
+        [](const std::string&) -> std::expected<std::string, McpError> {
+            return std::string("hello");
+        });
+    server.addPrompt("summarize", "Summarize text", {},
+        [](const std::string&, const JsonElement&) -> std::expected<JsonString, McpError> {
+            return JsonString(R"({"messages":[]})");
+        });
+}
+
+} // namespace
+
+int main()
+{
+    const std::string name = "/galay-mcp-t10-" + std::to_string(::getpid());
+
+    McpStdioServer server;
+    registerRegistry(server);
+
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    McpStdioClient wire;
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel") ||
+        !require(wire.attach(std::move(clientChannel.value())).has_value(), "attach failed")) {
+        return 1;
+    }
+
+    McpInProcessClient local(server);
+
+    bool ok = true;
+    ok = ok && require(local.callTool("echo", R"({"message":"x"})").error().code() == McpErrorCode::NotInitialized,
+                       "call before initialize not rejected");
+    ok = ok && require(local.initialize("t10-local", "1.0.0").has_value(), "in-process initialize failed");
+    ok = ok && require(local.initialize("t10-local", "1.0.0").error().code() == McpErrorCode::AlreadyInitialized,
+                       "second initialize not rejected");
+    ok = ok && require(wire.initialize("t10-wire", "1.0.0").has_value(), "wire initialize failed");
+
+    ok = ok && require(local.getServerInfo().name == wire.getServerInfo().name &&
+                       local.getServerCapabilities().tools && local.getServerCapabilities().resources &&
+                       local.getServerCapabilities().prompts,
+                       "initialize result differs from wire");
+    ok = ok && require(local.ping().has_value(), "ping failed");
+
+    // 结果字符串与线路调用一致
+    const JsonString args = R"({"message":"line\nquote\" é"})";
+    auto localEcho = local.callTool("echo", args);
+    auto wireEcho = wire.callTool("echo", args);
+    ok = ok && require(localEcho.has_value() && wireEcho.has_value() && localEcho.value() == wireEcho.value(),
+                       "echo result differs from wire");
+
+    auto doc = JsonDocument::Parse(R"({"message":"from document"})");
+    auto fromDoc = local.callTool("echo", doc.value().Root());
+    ok = ok && require(fromDoc.has_value() && fromDoc.value() == "from document", "document call failed");
+
+    // 列表与线路调用一致
+    auto localTools = local.listTools();
+    auto wireTools = wire.listTools();
+    ok = ok && require(localTools.has_value() && wireTools.has_value() &&
+                       localTools.value().size() == wireTools.value().size(),
+                       "tools/list differs from wire");
+    for (size_t i = 0; ok && i < localTools.value().size(); ++i) {
+        ok = require(localTools.value()[i].name == wireTools.value()[i].name, "tools/list order differs from wire");
+    }
+    ok = ok && require(local.listResources().value().size() == wire.listResources().value().size() &&
+                       local.listPrompts().value().size() == wire.listPrompts().value().size(),
+                       "resources/prompts list differs from wire");
+
+    auto localResource = local.readResource("mem://greeting");
+    ok = ok && require(localResource.has_value() && localResource.value() == wire.readResource("mem://greeting").value(),
+                       "resources/read differs from wire");
+    ok = ok && require(local.getPrompt("summarize", "").has_value(), "prompts/get failed");
+
+    // 错误码、消息与详情与线路调用完全一致
+    ok = ok && require(sameError(local.callTool("no-such-tool", "{}"), wire.callTool("no-such-tool", "{}")),
+                       "missing tool error differs from wire");
+    ok = ok && require(sameError(local.callTool("echo", "{}"), wire.callTool("echo", "{}")),
+                       "handler error differs from wire");
+    ok = ok && require(sameError(local.callTool("throws", "{}"), wire.callTool("throws", "{}")),
+                       "handler exception differs from wire");
+    ok = ok && require(sameError(local.readResource("mem://missing"), wire.readResource("mem://missing")),
+                       "missing resource error differs from wire");
+    ok = ok && require(sameError(local.getPrompt("missing", ""), wire.getPrompt("missing", "")),
+                       "missing prompt error differs from wire");
+    ok = ok && require(local.callTool("echo", "{not json").error().code() == McpErrorCode::ParseError,
+                       "malformed arguments accepted");
+
+    local.disconnect();
+    ok = ok && require(!local.isInitialized() && !local.ping().has_value(), "disconnect did not reset state");
+
+    wire.disconnect();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T10-InProcess PASS\n";
+    return 0;
+}
@@ -0,0 +1,155 @@
+/**
+ * @file T11-compute_pool.cc
+ * @brief 覆盖 McpComputePool 的任务执行、工作线程内提交后的窃取、异常隔离、完成通知（等待协程回到自己的执行器线程上恢复）
+ *        与析构时排空队列。
+ */
+
+#include "galay-mcp/common/McpComputePool.h"
+#include "galay-mcp/common/McpExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <iostream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 创建后挂起、投递到执行器上开始运行、结束后自行销毁的协程
+struct Spawned {
+    struct promise_type {
+        Spawned get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<> handle;
+};
+
+// 模拟连接协程：把计算任务交给线程池，挂起等待完成，醒来后“写出响应”并记录所在线程
+Spawned awaitCompute(McpComputePool& pool,
+                     std::thread::id& computedOn,
+                     std::thread::id& respondedOn,
+                     std::atomic<bool>& responded)
+{
+    auto done = McpWakeSignal::create();
+    std::atomic<bool> computed{false};
+    pool.submit([&computed, &computedOn]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        computedOn = std::this_thread::get_id();
+        computed.store(true, std::memory_order_release);
+    }, done);
+    while (!computed.load(std::memory_order_acquire)) {
+        co_await done->wait();
+    }
+    respondedOn = std::this_thread::get_id();
+    responded.store(true, std::memory_order_release);
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        McpComputePool pool(4);
+        ok = ok && require(pool.size() == 4, "unexpected worker count");
+
+        std::atomic<int> executed{0};
+        for (int i = 0; i < 1000; ++i) {
+            pool.submit([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+        }
+        ok = ok && require(waitFor([&]() { return executed.load() == 1000; }), "submitted tasks did not all run");
+
+        // 一个工作线程内部提交的子任务都进入自己的队列，其他线程只能靠窃取分担
+        std::atomic<int> children{0};
+        pool.submit([&pool, &children]() {
+            for (int i = 0; i < 64; ++i) {
+                pool.submit([&children]() {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    children.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        });
+        ok = ok && require(waitFor([&]() { return children.load() == 64; }), "nested tasks did not all run");
+        ok = ok && require(pool.stolenCount() > 0, "idle workers did not steal nested tasks");
+
+        // 任务抛出的异常不会终止工作线程
+        std::atomic<bool> afterThrow{false};
+        pool.submit([]() { throw std::runtime_error("task failure"); });
+        pool.submit([&afterThrow]() { afterThrow.store(true); });
+        ok = ok && require(waitFor([&]() { return afterThrow.load(); }), "pool stopped after a throwing task");
+
+        // 完成通知：任务结束（包括抛出异常）后唤醒等待方
+        auto done = McpWakeSignal::create();
+        std::atomic<bool> finished{false};
+        pool.submit([&finished]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            finished.store(true);
+        }, done);
+        done->block();
+        ok = ok && require(finished.load(), "completion notified before the task finished");
+        pool.submit([]() { throw std::runtime_error("task failure"); }, done);
+        done->block();
+
+        // 等待完成的协程回到挂起它的执行器线程上继续，不在计算线程上写出响应
+        McpThreadExecutor loop;
+        std::thread::id computedOn;
+        std::thread::id respondedOn;
+        std::atomic<bool> responded{false};
+        loop.post(awaitCompute(pool, computedOn, respondedOn, responded).handle);
+        ok = ok && require(waitFor([&]() { return responded.load(std::memory_order_acquire); }),
+                           "waiting coroutine was not resumed");
+        ok = ok && require(respondedOn == loop.threadId() && respondedOn != computedOn,
+                           "response written off the waiter's executor thread");
+    }
+
+    {
+        // 析构时执行完已提交的任务
+        std::atomic<int> drained{0};
+        {
+            McpComputePool pool(1);
+            for (int i = 0; i < 50; ++i) {
+                pool.submit([&drained]() {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    drained.fetch_add(1, std::memory_order_relaxed);
+                });
+            }
+        }
+        ok = ok && require(drained.load() == 50, "destructor did not drain pending tasks");
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T11-ComputePool PASS\n";
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file T12-admission_control.cc
+ * @brief 覆盖 McpAdmissionController 的并发上限与 CoDel 丢弃状态、计数导出，以及过载响应使用的 id 扫描。
+ */
+
+#include "galay-mcp/common/McpError.h"
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/server/McpAdmissionController.h"
+
+#include <chrono>
+#include <iostream>
+#include <string_view>
+
+using namespace galay::mcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    using Clock = McpAdmissionController::Clock;
+
+    {
+        // 不配置时不做限制，只计数
+        McpAdmissionController controller;
+        for (int i = 0; i < 100; ++i) {
+            ok = ok && require(controller.tryAdmit() == McpAdmissionDecision::Admitted, "unlimited controller shed");
+        }
+        ok = ok && require(controller.stats().admitted == 100 && controller.stats().inFlight == 100,
+                           "unexpected unlimited counters");
+    }
+
+    {
+        // 服务端并发上限
+        McpAdmissionOptions options;
+        options.maxInFlight = 2;
+        McpAdmissionController controller(options);
+        ok = ok && require(controller.tryAdmit() == McpAdmissionDecision::Admitted, "first request shed");
+        ok = ok && require(controller.tryAdmit() == McpAdmissionDecision::Admitted, "second request shed");
+        ok = ok && require(controller.tryAdmit() == McpAdmissionDecision::ShedInFlight, "in-flight cap not enforced");
+        controller.release();
+        ok = ok && require(controller.tryAdmit() == McpAdmissionDecision::Admitted, "released slot not reusable");
+
+        controller.recordToolShed();
+        const McpAdmissionStats stats = controller.stats();
+        ok = ok && require(stats.admitted == 3 && stats.shedInFlight == 1 && stats.shedToolLimit == 1 &&
+                           stats.inFlight == 2,
+                           "unexpected in-flight counters");
+    }
+
+    {
+        // 排队时延持续超标一个 interval 后进入丢弃状态，按控制律间隔丢弃，低于目标后退出
+        McpAdmissionOptions options;
+        options.codelTarget = 5ms;
+        options.codelInterval = 100ms;
+        McpAdmissionController controller(options);
+        const Clock::time_point t0 = Clock::now();
+
+        controller.recordQueueDelay(20ms, t0);
+        ok = ok && require(!controller.stats().dropping, "dropping before a full interval above target");
+        ok = ok && require(controller.tryAdmit(t0) == McpAdmissionDecision::Admitted, "shed before interval elapsed");
+        controller.release();
+
+        controller.recordQueueDelay(20ms, t0 + 110ms);
+        ok = ok && require(controller.stats().dropping, "not dropping after an interval above target");
+        ok = ok && require(controller.tryAdmit(t0 + 110ms) == McpAdmissionDecision::ShedQueueDelay,
+                           "first request in dropping state not shed");
+        // 下一次丢弃在 interval / sqrt(2) ≈ 70.7ms 之后
+        ok = ok && require(controller.tryAdmit(t0 + 150ms) == McpAdmissionDecision::Admitted,
+                           "shed before control-law interval");
+        controller.release();
+        ok = ok && require(controller.tryAdmit(t0 + 190ms) == McpAdmissionDecision::ShedQueueDelay,
+                           "not shed after control-law interval");
+
+        controller.recordQueueDelay(1ms, t0 + 200ms);
+        ok = ok && require(!controller.stats().dropping, "still dropping after a sample below target");
+        ok = ok && require(controller.tryAdmit(t0 + 400ms) == McpAdmissionDecision::Admitted,
+                           "shed after leaving dropping state");
+        controller.release();
+
+        const McpAdmissionStats stats = controller.stats();
+        ok = ok && require(stats.shedQueueDelay == 2 && stats.queueDelaySamples == 3 &&
+                           stats.maxQueueDelay == 20ms && stats.lastQueueDelay == 1ms && stats.inFlight == 0,
+                           "unexpected queue-delay counters");
+    }
+
+    {
+        // 过载响应只扫描顶层 id，不解析 params
+        ok = ok && require(peekJsonRpcId(R"({"jsonrpc":"2.0","id":42,"method":"tools/call"})") == 42,
+                           "leading id not found");
+        ok = ok && require(peekJsonRpcId(R"({"method":"tools/call","params":{"id":7,"s":"\"id\":9"},"id":-3})") == -3,
+                           "nested or quoted id taken as request id");
+        ok = ok && require(peekJsonRpcId(R"({"method":"id","params":{"arguments":[1,{"x":"}"}]}, "id" : 11 })") == 11,
+                           "id after string value not found");
+        ok = ok && require(!peekJsonRpcId(R"({"jsonrpc":"2.0","method":"notifications/initialized"})").has_value(),
+                           "notification reported an id");
+        ok = ok && require(!peekJsonRpcId(R"({"id":"abc","method":"ping"})").has_value() &&
+                           !peekJsonRpcId(R"({"id":1.5,"method":"ping"})").has_value() &&
+                           !peekJsonRpcId(R"({"id":null})").has_value() &&
+                           !peekJsonRpcId("{\"params\":{\"id\":").has_value(),
+                           "non-integer or truncated id accepted");
+    }
+
+    {
+        McpError overloaded = McpError::fromJsonRpcError(-32000, "Server overloaded", "");
+        ok = ok && require(overloaded.code() == McpErrorCode::ServerOverloaded &&
+                           overloaded.toJsonRpcErrorCode() == -32000,
+                           "server overloaded error does not round-trip");
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T12-AdmissionControl PASS\n";
+    return 0;
+}
@@ -0,0 +1,252 @@
+/**
+ * @file T13-async_semaphore.cc
+ * @brief 覆盖 McpAsyncSemaphore 的名额上限、FIFO 移交、放弃排队与排队深度 / 等待时间统计，
+ *        以及经 McpWakeSignal 的唤醒：名额移交时把挂起的协程投递回它自己的执行器（不嵌套在释放方的调用栈中）、
+ *        线程阻塞 / 限时阻塞等待与定时通知。
+ */
+
+#include "galay-mcp/common/McpAsyncSemaphore.h"
+#include "galay-mcp/common/McpExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 立即开始执行、结束后自行销毁的协程，用于在测试中等待唤醒点
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+Detached awaitPermit(McpAsyncSemaphore::Permit& permit, std::shared_ptr<McpWakeSignal> wake, std::atomic<int>& resumed)
+{
+    permit.wakeOnReady(wake);
+    while (!permit.ready()) {
+        co_await wake->wait();
+    }
+    ++resumed;
+}
+
+// 创建后挂起、投递到执行器上开始运行、结束后自行销毁的协程
+struct Spawned {
+    struct promise_type {
+        Spawned get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<> handle;
+};
+
+struct HandoffProbe {
+    std::thread::id loop;
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    std::atomic<int> finished{0};
+    std::atomic<bool> offLoop{false};
+};
+
+// 排队获得名额后立即释放：释放时如果直接恢复下一个等待方，会嵌套在本协程里运行
+Spawned holdAndRelease(McpAsyncSemaphore& semaphore, HandoffProbe& probe)
+{
+    auto permit = semaphore.acquire();
+    auto wake = McpWakeSignal::create();
+    permit.wakeOnReady(wake);
+    while (!permit.ready()) {
+        co_await wake->wait();
+    }
+    if (std::this_thread::get_id() != probe.loop) {
+        probe.offLoop.store(true);
+    }
+    const int now = probe.active.fetch_add(1) + 1;
+    int observed = probe.peak.load();
+    while (now > observed && !probe.peak.compare_exchange_weak(observed, now)) {
+    }
+    permit = McpAsyncSemaphore::Permit();
+    probe.active.fetch_sub(1);
+    probe.finished.fetch_add(1);
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        McpAsyncSemaphore semaphore(2);
+        auto first = semaphore.acquire();
+        auto second = semaphore.acquire();
+        auto third = semaphore.acquire();
+        auto fourth = semaphore.acquire();
+        ok = ok && require(first.ready() && second.ready(), "free permits not granted immediately");
+        ok = ok && require(!third.ready() && !fourth.ready(), "permit granted above the limit");
+        ok = ok && require(semaphore.stats().waiting == 2 && semaphore.stats().inUse == 2, "unexpected queue depth");
+
+        // 名额按排队顺序移交
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        first = McpAsyncSemaphore::Permit();
+        ok = ok && require(third.ready() && !fourth.ready(), "released permit not handed to the oldest waiter");
+
+        // 放弃排队不占用名额
+        fourth = McpAsyncSemaphore::Permit();
+        ok = ok && require(semaphore.stats().waiting == 0, "abandoned waiter still queued");
+        second = McpAsyncSemaphore::Permit();
+        third = McpAsyncSemaphore::Permit();
+
+        const McpSemaphoreStats stats = semaphore.stats();
+        ok = ok && require(stats.permits == 2 && stats.inUse == 0 && stats.acquired == 3 && stats.queued == 2,
+                           "unexpected semaphore counters");
+        ok = ok && require(stats.maxWait >= std::chrono::milliseconds(5) && stats.totalWait >= stats.maxWait,
+                           "wait time not recorded");
+
+        // 新来的调用不能越过已排队的调用
+        auto a = semaphore.acquire();
+        auto b = semaphore.acquire();
+        auto c = semaphore.acquire();
+        b = McpAsyncSemaphore::Permit();
+        auto d = semaphore.acquire();
+        ok = ok && require(c.ready() && !d.ready(), "late caller overtook a queued waiter");
+    }
+
+    {
+        // 多线程阻塞等待唤醒：任何时刻持有名额的调用不超过上限
+        McpAsyncSemaphore semaphore(3);
+        std::atomic<int> running{0};
+        std::atomic<int> peak{0};
+        std::atomic<int> completed{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; ++t) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 50; ++i) {
+                    auto permit = semaphore.acquire();
+                    auto wake = McpWakeSignal::create();
+                    permit.wakeOnReady(wake);
+                    while (!permit.ready()) {
+                        wake->block();
+                    }
+                    const int now = running.fetch_add(1) + 1;
+                    int observed = peak.load();
+                    while (now > observed && !peak.compare_exchange_weak(observed, now)) {
+                    }
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    running.fetch_sub(1);
+                    completed.fetch_add(1);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        ok = ok && require(completed.load() == 400, "not every caller acquired a permit");
+        ok = ok && require(peak.load() <= 3, "concurrency limit exceeded");
+        ok = ok && require(semaphore.stats().inUse == 0 && semaphore.stats().waiting == 0, "permits leaked");
+    }
+
+    {
+        // 排队的协程挂起在唤醒点上，名额释放时被唤醒，不需要轮询
+        McpAsyncSemaphore semaphore(1);
+        auto holder = semaphore.acquire();
+        auto queued = semaphore.acquire();
+        std::atomic<int> resumed{0};
+        awaitPermit(queued, McpWakeSignal::create(), resumed);
+        ok = ok && require(resumed == 0, "coroutine resumed before the permit was released");
+        holder = McpAsyncSemaphore::Permit();
+        ok = ok && require(waitFor([&]() { return resumed == 1; }) && queued.ready(),
+                           "release did not resume the waiting coroutine");
+
+        // 已就绪的 Permit 登记唤醒点时立即通知
+        std::atomic<int> immediate{0};
+        queued = McpAsyncSemaphore::Permit();
+        auto free = semaphore.acquire();
+        awaitPermit(free, McpWakeSignal::create(), immediate);
+        ok = ok && require(immediate == 1, "ready permit did not complete without suspending");
+    }
+
+    {
+        // 名额在协程间逐个移交：每个等待方都在自己的执行器线程上恢复，
+        // 释放名额的 Permit 析构不会嵌套运行下一个持有者，也不会把它拉到释放方的线程上
+        constexpr int kWaiters = 200;
+        McpAsyncSemaphore semaphore(1);
+        McpThreadExecutor loop;
+        HandoffProbe probe;
+        probe.loop = loop.threadId();
+        auto holder = semaphore.acquire();
+        for (int i = 0; i < kWaiters; ++i) {
+            loop.post(holdAndRelease(semaphore, probe).handle);
+        }
+        ok = ok && require(waitFor([&]() { return semaphore.stats().waiting == kWaiters; }),
+                           "coroutines did not queue behind the holder");
+        holder = McpAsyncSemaphore::Permit();
+        ok = ok && require(waitFor([&]() { return probe.finished.load() == kWaiters; }),
+                           "permit hand-off chain stalled");
+        ok = ok && require(probe.peak.load() == 1, "released permit resumed the next waiter inside the releaser");
+        ok = ok && require(!probe.offLoop.load(), "waiter resumed off its own executor thread");
+    }
+
+    {
+        // 定时通知：到时唤醒阻塞的线程；等待方先行释放时不再通知
+        auto wake = McpWakeSignal::create();
+        const auto start = McpWakeSignal::Clock::now();
+        McpWakeSignal::notifyAt(wake, start + std::chrono::milliseconds(20));
+        McpWakeSignal::notifyAt(McpWakeSignal::create(), start + std::chrono::milliseconds(5));
+        wake->block();
+        ok = ok && require(McpWakeSignal::Clock::now() - start >= std::chrono::milliseconds(20),
+                           "timed notification fired early");
+
+        // 限时阻塞：超时返回 false，收到通知时立即返回 true
+        auto bounded = McpWakeSignal::create();
+        ok = ok && require(!bounded->blockFor(std::chrono::milliseconds(5)), "blockFor returned without a notification");
+        std::thread notifier([bounded]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            bounded->notify();
+        });
+        const auto boundedStart = McpWakeSignal::Clock::now();
+        ok = ok && require(bounded->blockFor(std::chrono::seconds(10)) &&
+                           McpWakeSignal::Clock::now() - boundedStart < std::chrono::seconds(5),
+                           "blockFor did not wake on notify");
+        notifier.join();
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T13-AsyncSemaphore PASS\n";
+    return 0;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file T14-cancellation.cc
+ * @brief 覆盖取消令牌（含取消 / 截止时间对唤醒点的通知，被唤醒的协程在自己的执行器线程上恢复）、按请求方划分的在途调用表（两个会话复用同一 id 时只取消发送方的调用），以及 McpStdioServer 工作线程模式下 notifications/cancelled、客户端超时与输入流关闭对工具调用的取消。
+ */
+
+#include "galay-mcp/common/McpCancellation.h"
+#include "galay-mcp/common/McpExecutor.h"
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+using namespace galay::mcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// 创建后挂起、投递到执行器上开始运行、结束后自行销毁的协程
+struct Spawned {
+    struct promise_type {
+        Spawned get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<> handle;
+};
+
+// 挂起等待取消，醒来后记录所在线程
+Spawned awaitCancel(McpCancellationToken token, std::thread::id& resumedOn, std::atomic<bool>& woken)
+{
+    auto wake = McpWakeSignal::create();
+    token.wakeOnCancel(wake);
+    while (!token.isCancelled()) {
+        co_await wake->wait();
+    }
+    resumedOn = std::this_thread::get_id();
+    woken.store(true, std::memory_order_release);
+}
+
+struct RawResponse {
+    int64_t id = 0;
+    int errorCode = 0;
+};
+
+// 读取下一条带 id 的响应，跳过通知
+RawResponse readResponse(McpShmChannel& channel)
+{
+    while (true) {
+        auto message = channel.readMessage();
+        if (!message) {
+            return {-1, 0};
+        }
+        auto parsed = parseJsonRpcResponse(message.value());
+        if (!parsed) {
+            continue;
+        }
+        RawResponse response;
+        response.id = parsed.value().response.id;
+        if (parsed.value().response.hasError) {
+            auto error = JsonRpcError::fromJson(parsed.value().response.error);
+            response.errorCode = error ? error.value().code : 0;
+        }
+        return response;
+    }
+}
+
+std::string spinCall(int64_t id, std::string_view meta = "")
+{
+    std::string body = R"({"jsonrpc":"2.0","id":)" + std::to_string(id) +
+                       R"(,"method":"tools/call","params":{"name":"spin","arguments":{})";
+    if (!meta.empty()) {
+        body += R"(,"_meta":)";
+        body += meta;
+    }
+    body += "}}";
+    return body;
+}
+
+std::string ping(int64_t id)
+{
+    return R"({"jsonrpc":"2.0","id":)" + std::to_string(id) + R"(,"method":"ping"})";
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        McpCancellationToken never;
+        ok = ok && require(!never.isCancelled() && !never.deadline().has_value(), "default token cancelled");
+
+        McpCancellationSource source;
+        McpCancellationToken token = source.token();
+        ok = ok && require(!token.isCancelled(), "fresh token cancelled");
+        ok = ok && require(source.cancel(McpCancelReason::ConnectionClosed), "first cancel did not take effect");
+        ok = ok && require(!source.cancel(McpCancelReason::Cancelled), "second cancel took effect");
+        ok = ok && require(token.reason() == McpCancelReason::ConnectionClosed && token == source.token(),
+                           "unexpected cancel reason");
+
+        McpCancellationSource timed(McpCancellationToken::Clock::now() + 20ms);
+        ok = ok && require(!timed.token().isCancelled() && timed.token().remaining().value() > 0ms,
+                           "deadline expired early");
+        std::this_thread::sleep_for(30ms);
+        ok = ok && require(timed.token().reason() == McpCancelReason::DeadlineExceeded &&
+                           timed.token().remaining().value() == 0ms,
+                           "deadline not observed");
+    }
+
+    {
+        // 取消与截止时间到达都会通知登记的唤醒点
+        McpCancellationSource source;
+        auto wake = McpWakeSignal::create();
+        source.token().wakeOnCancel(wake);
+        std::thread canceller([&source]() {
+            std::this_thread::sleep_for(10ms);
+            source.cancel();
+        });
+        wake->block();
+        canceller.join();
+        ok = ok && require(source.token().isCancelled(), "woken before the call was cancelled");
+
+        McpCancellationSource timed(McpCancellationToken::Clock::now() + 20ms);
+        auto timedWake = McpWakeSignal::create();
+        timed.token().wakeOnCancel(timedWake);
+        timedWake->block();
+        ok = ok && require(timed.token().reason() == McpCancelReason::DeadlineExceeded, "deadline did not wake the waiter");
+    }
+
+    {
+        // 其他线程取消与定时线程到期都只投递唤醒：被取消的协程在自己的执行器线程上恢复
+        McpThreadExecutor loop;
+        McpCancellationSource source;
+        std::thread::id cancelledOn;
+        std::atomic<bool> cancelledWoken{false};
+        loop.post(awaitCancel(source.token(), cancelledOn, cancelledWoken).handle);
+        std::thread canceller([&source]() {
+            std::this_thread::sleep_for(10ms);
+            source.cancel();
+        });
+        canceller.join();
+        ok = ok && require(waitFor([&]() { return cancelledWoken.load(std::memory_order_acquire); }),
+                           "cancel did not wake the coroutine");
+        ok = ok && require(cancelledOn == loop.threadId(), "cancelled coroutine resumed on the canceller's thread");
+
+        McpCancellationSource timed(McpCancellationToken::Clock::now() + 20ms);
+        std::thread::id expiredOn;
+        std::atomic<bool> expiredWoken{false};
+        loop.post(awaitCancel(timed.token(), expiredOn, expiredWoken).handle);
+        ok = ok && require(waitFor([&]() { return expiredWoken.load(std::memory_order_acquire); }),
+                           "deadline did not wake the coroutine");
+        ok = ok && require(expiredOn == loop.threadId(), "deadline resumed the coroutine on the timer thread");
+    }
+
+    {
+        // 两个会话使用同一个 JSON-RPC id，取消只作用于发送方自己的调用
+        McpInflightCalls inflight;
+        McpCancellationSource first;
+        McpCancellationSource second;
+        McpCancellationSource other;
+        inflight.add("session:a", 7, -1, first);
+        inflight.add("session:b", 7, -1, second);
+        inflight.add("session:b", 8, 3, other);
+        ok = ok && require(inflight.cancel("session:a", 7), "own call not found");
+        ok = ok && require(first.token().isCancelled() && !second.token().isCancelled(),
+                           "cancel reached another session's call with the same id");
+        ok = ok && require(!inflight.cancel("session:c", 8) && !other.token().isCancelled(),
+                           "cancel from an unrelated owner took effect");
+
+        inflight.cancelConnection(3);
+        ok = ok && require(other.token().reason() == McpCancelReason::ConnectionClosed && !second.token().isCancelled(),
+                           "connection close cancelled the wrong calls");
+
+        inflight.remove("session:a", 7, first);
+        inflight.remove("session:b", 7, first);
+        ok = ok && require(inflight.size() == 2, "remove matched the wrong entry");
+    }
+
+    const std::string name = "/galay-mcp-t14-" + std::to_string(::getpid());
+
+    McpStdioServer server;
+    server.setToolWorkers(2);
+
+    std::atomic<int> started{0};
+    std::atomic<int> finished{0};
+    std::atomic<McpCancelReason> lastReason{McpCancelReason::None};
+    server.addTool("spin", "Spin until cancelled", "{}",
+        [&](const JsonElement&, const McpToolContext& context) -> std::expected<JsonString, McpError> {
+            started.fetch_add(1);
+            while (!context.cancellation.isCancelled()) {
+                std::this_thread::sleep_for(1ms);
+            }
+            lastReason.store(context.cancellation.reason());
+            finished.fetch_add(1);
+            return std::unexpected(McpError::requestCancelled("spin stopped"));
+        });
+
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel")) {
+        return 1;
+    }
+    McpShmChannel& client = *clientChannel.value();
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t14","version":"1.0.0"}}})");
+    ok = ok && require(readResponse(client).id == 1, "initialize failed");
+
+    // notifications/cancelled：处理函数看到 Cancelled，服务端不再响应该请求
+    client.writeMessage(spinCall(2));
+    ok = ok && require(waitFor([&]() { return started.load() == 1; }), "spin did not start");
+    client.writeMessage(ping(3));
+    ok = ok && require(readResponse(client).id == 3, "reader thread blocked by running tool");
+    client.writeMessage(R"({"jsonrpc":"2.0","method":"notifications/cancelled","params":{"requestId":2,"reason":"user abort"}})");
+    ok = ok && require(waitFor([&]() { return finished.load() == 1; }), "spin not cancelled");
+    ok = ok && require(lastReason.load() == McpCancelReason::Cancelled, "unexpected reason for cancelled call");
+    client.writeMessage(ping(4));
+    ok = ok && require(readResponse(client).id == 4, "cancelled call still answered");
+
+    // 客户端超时：处理函数看到 DeadlineExceeded，错误照常返回
+    client.writeMessage(spinCall(5, R"({"timeoutMs":30})"));
+    const RawResponse timedOut = readResponse(client);
+    ok = ok && require(timedOut.id == 5 && timedOut.errorCode == ErrorCodes::REQUEST_CANCELLED,
+                       "timed out call not answered with REQUEST_CANCELLED");
+    ok = ok && require(lastReason.load() == McpCancelReason::DeadlineExceeded, "unexpected reason for timed out call");
+
+    // 输入流关闭：进行中的调用被取消，run() 在调用结束后返回
+    client.writeMessage(spinCall(6));
+    ok = ok && require(waitFor([&]() { return started.load() == 3; }), "third spin did not start");
+    client.close();
+    serverThread.join();
+    ok = ok && require(finished.load() == 3 && lastReason.load() == McpCancelReason::ConnectionClosed,
+                       "call not cancelled when input closed");
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T14-Cancellation PASS\n";
+    return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file T15-call_policy.cc
+ * @brief 覆盖客户端调用策略：幂等方法与可重试错误的判定、带抖动的指数退避范围、
+ *        对冲延迟使用的分位数统计、_meta.timeoutMs 的写入，以及 Unix 域套接字读超时。
+ */
+
+#include "galay-mcp/client/McpCallPolicy.h"
+#include "galay-mcp/common/McpProtocolUtils.h"
+#include "galay-mcp/common/McpUnixSocket.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+using namespace galay::mcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::optional<int64_t> ReadTimeoutMs(const JsonString& params)
+{
+    auto doc = JsonDocument::Parse(params);
+    JsonObject obj;
+    if (!doc || !JsonHelper::GetObject(doc.value().Root(), obj)) {
+        return std::nullopt;
+    }
+    auto timeout = protocol::getRequestTimeout(obj);
+    if (!timeout) {
+        return std::nullopt;
+    }
+    return timeout->count();
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        ok = ok && require(isIdempotentMethod(Methods::PING) && isIdempotentMethod(Methods::TOOLS_LIST) &&
+                           isIdempotentMethod(Methods::RESOURCES_READ) && isIdempotentMethod(Methods::PROMPTS_LIST),
+                           "read-only method not treated as idempotent");
+        ok = ok && require(!isIdempotentMethod(Methods::TOOLS_CALL) && !isIdempotentMethod(Methods::INITIALIZE),
+                           "side-effecting method treated as idempotent");
+        ok = ok && require(isRetryableError(McpError::connectionError()) &&
+                           isRetryableError(McpError::serverOverloaded()),
+                           "transient error not retryable");
+        ok = ok && require(!isRetryableError(McpError::timeout()) && !isRetryableError(McpError::toolNotFound("x")) &&
+                           !isRetryableError(McpError::requestCancelled()),
+                           "permanent error retryable");
+    }
+
+    {
+        // full jitter：第 n 次重试的等待落在 [0, min(max, initial * 2^n)]
+        McpRetryPolicy policy;
+        policy.initialBackoff = 10ms;
+        policy.maxBackoff = 100ms;
+        std::mt19937_64 rng(42);
+        bool inRange = true;
+        std::chrono::milliseconds largest{0};
+        for (int i = 0; i < 200; ++i) {
+            const auto first = retryBackoff(policy, 0, rng);
+            const auto third = retryBackoff(policy, 2, rng);
+            const auto capped = retryBackoff(policy, 20, rng);
+            inRange = inRange && first <= 10ms && third <= 40ms && capped <= 100ms && first.count() >= 0;
+            largest = std::max(largest, capped);
+        }
+        ok = ok && require(inRange, "backoff outside jitter bounds");
+        ok = ok && require(largest > 50ms, "backoff does not spread across the capped range");
+
+        policy.initialBackoff = 0ms;
+        ok = ok && require(retryBackoff(policy, 3, rng) == 0ms, "zero initial backoff produced a delay");
+    }
+
+    {
+        McpLatencyTracker tracker(100);
+        ok = ok && require(!tracker.quantile(0.95).has_value(), "quantile of empty window");
+        for (int i = 1; i <= 100; ++i) {
+            tracker.record(std::chrono::milliseconds(i));
+        }
+        ok = ok && require(tracker.quantile(0.95) == std::chrono::microseconds(95ms), "unexpected p95");
+        ok = ok && require(tracker.quantile(0.5) == std::chrono::microseconds(50ms), "unexpected p50");
+        ok = ok && require(!tracker.quantile(0.95, 101).has_value(), "quantile below minSamples");
+
+        // 窗口满后覆盖最旧样本
+        for (int i = 0; i < 100; ++i) {
+            tracker.record(1ms);
+        }
+        ok = ok && require(tracker.size() == 100 && tracker.quantile(1.0) == std::chrono::microseconds(1ms),
+                           "old samples not evicted");
+    }
+
+    {
+        ok = ok && require(ReadTimeoutMs(protocol::withRequestTimeout("{}", 250ms)) == 250, "timeout not added to {}");
+        ok = ok && require(ReadTimeoutMs(protocol::withRequestTimeout("", 7ms)) == 7, "timeout not added to empty params");
+        const JsonString params = protocol::withRequestTimeout(R"({"name":"echo","arguments":{"x":1}})", 1500ms);
+        ok = ok && require(ReadTimeoutMs(params) == 1500, "timeout not added to populated params");
+        ok = ok && require(params.find(R"("name":"echo")") != std::string::npos, "existing params lost");
+    }
+
+    {
+        const std::string path = "/tmp/galay-mcp-t15-" + std::to_string(::getpid()) + ".sock";
+        auto listener = McpUnixSocket::listen(path, 4);
+        ok = ok && require(listener.has_value(), "failed to listen on unix socket");
+        if (listener) {
+            auto client = McpUnixSocket::connect(path);
+            auto peer = listener.value().accept();
+            ok = ok && require(client.has_value() && peer.has_value(), "failed to connect unix socket");
+            if (client && peer) {
+                ok = ok && require(client.value().setReadTimeout(30ms).has_value(), "setReadTimeout failed");
+                const auto start = std::chrono::steady_clock::now();
+                auto message = client.value().readHttpMessage();
+                const auto waited = std::chrono::steady_clock::now() - start;
+                ok = ok && require(!message && message.error().code() == McpErrorCode::ConnectionTimeout,
+                                   "silent peer did not time out");
+                ok = ok && require(waited >= 25ms && waited < 1s, "read timeout not honoured");
+            }
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T15-CallPolicy PASS\n";
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file T16-progress.cc
+ * @brief 覆盖进度上报句柄的按间隔合并、progressToken 的读取，以及 McpStdioServer 在响应前发出 notifications/progress。
+ */
+
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpProgress.h"
+#include "galay-mcp/common/McpProtocolUtils.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::optional<JsonString> ReadToken(std::string_view params)
+{
+    auto doc = JsonDocument::Parse(std::string(params));
+    JsonObject obj;
+    if (!doc || !JsonHelper::GetObject(doc.value().Root(), obj)) {
+        return std::nullopt;
+    }
+    return protocol::getProgressToken(obj);
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        ok = ok && require(ReadToken(R"({"_meta":{"progressToken":"job-1"}})") == JsonString(R"("job-1")"),
+                           "string token not returned as raw JSON");
+        ok = ok && require(ReadToken(R"({"_meta":{"progressToken":42}})") == JsonString("42"),
+                           "integer token not returned as raw JSON");
+        ok = ok && require(!ReadToken(R"({"name":"x"})").has_value(), "token read from params without _meta");
+
+        McpProgressReporter idle;
+        idle.report(1.0);
+        ok = ok && require(!idle.active() && idle.reportedCount() == 0, "default reporter not inert");
+    }
+
+    {
+        std::vector<JsonString> sent;
+        McpProgressReporter reporter("7", 1h, [&](const JsonString& params) { sent.push_back(params); });
+        reporter.report(1, 10, "start");
+        for (int i = 2; i <= 9; ++i) {
+            reporter.report(i, 10);
+        }
+        // 第一次立即发出，其余在间隔内合并为最新一次
+        ok = ok && require(sent.size() == 1 && reporter.reportedCount() == 9 && reporter.sentCount() == 1,
+                           "reports inside the interval not coalesced");
+        ok = ok && require(sent.front().find(R"("progressToken":7)") != std::string::npos &&
+                           sent.front().find(R"("message":"start")") != std::string::npos,
+                           "unexpected progress params");
+
+        reporter.flushDue(McpProgressReporter::Clock::now() + 2h);
+        ok = ok && require(sent.size() == 2 && sent.back().find(R"("progress":9)") != std::string::npos,
+                           "flushDue did not send the latest coalesced report");
+        reporter.flushDue(McpProgressReporter::Clock::now() + 5h);
+        ok = ok && require(sent.size() == 2, "flushDue sent without a pending report");
+
+        McpProgressReporter copy = reporter;
+        copy.report(10, 10);
+        reporter.close();
+        reporter.flushDue(McpProgressReporter::Clock::now() + 10h);
+        copy.report(11, 10);
+        ok = ok && require(sent.size() == 2 && copy.reportedCount() == 10,
+                           "report after close was sent or counted");
+
+        std::vector<JsonString> all;
+        McpProgressReporter uncoalesced("\"u\"", 0ms, [&](const JsonString& params) { all.push_back(params); });
+        for (int i = 0; i < 5; ++i) {
+            uncoalesced.report(i);
+        }
+        ok = ok && require(all.size() == 5, "zero interval coalesced reports");
+    }
+
+    const std::string name = "/galay-mcp-t16-" + std::to_string(::getpid());
+
+    McpStdioServer server;
+    server.setProgressInterval(20ms);
+    server.addTool("count", "Report progress while counting", "{}",
+        [](const JsonElement&, const McpToolContext& context) -> std::expected<JsonString, McpError> {
+            for (int i = 1; i <= 100; ++i) {
+                context.progress.report(i, 100);
+                std::this_thread::sleep_for(1ms);
+            }
+            return JsonString(R"({"content":[]})");
+        });
+
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel")) {
+        return 1;
+    }
+    McpShmChannel& client = *clientChannel.value();
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t16","version":"1.0.0"}}})");
+    auto initialized = client.readMessage();
+    ok = ok && require(initialized.has_value(), "initialize failed");
+
+    // 带 progressToken：通知先于响应到达，且按间隔合并
+    client.writeMessage(R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"count","arguments":{},"_meta":{"progressToken":"p2"}}})");
+    int notifications = 0;
+    bool tokenEchoed = true;
+    bool answered = false;
+    while (!answered) {
+        auto message = client.readMessage();
+        if (!require(message.has_value(), "channel closed before response")) {
+            return 1;
+        }
+        if (message.value().find(R"("method":"notifications/progress")") != std::string::npos) {
+            ++notifications;
+            tokenEchoed = tokenEchoed && message.value().find(R"("progressToken":"p2")") != std::string::npos;
+            continue;
+        }
+        auto parsed = parseJsonRpcResponse(message.value());
+        answered = parsed && parsed.value().response.id == 2;
+    }
+    ok = ok && require(notifications >= 1 && notifications < 50, "progress notifications not coalesced");
+    ok = ok && require(tokenEchoed, "progressToken not echoed");
+
+    // 不带 progressToken：不发通知
+    client.writeMessage(R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"count","arguments":{}}})");
+    auto plain = client.readMessage();
+    ok = ok && require(plain.has_value() && plain.value().find("notifications/progress") == std::string::npos,
+                       "progress sent without a progressToken");
+
+    client.close();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T16-Progress PASS\n";
+    return 0;
+}
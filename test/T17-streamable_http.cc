@@ -0,0 +1,189 @@
+/**
+ * @file T17-streamable_http.cc
+ * @brief 覆盖 SSE 编码与增量解析、事件回放缓冲、请求 _meta 构造，以及 McpUnixSocket 的 chunked 读取。
+ */
+
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpProtocolUtils.h"
+#include "galay-mcp/common/McpSse.h"
+#include "galay-mcp/common/McpUnixSocket.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::optional<JsonObject> ParseParams(const JsonString& params, std::optional<JsonDocument>& holder)
+{
+    auto doc = JsonDocument::Parse(params);
+    if (!doc) {
+        return std::nullopt;
+    }
+    holder.emplace(std::move(doc.value()));
+    JsonObject obj;
+    if (!JsonHelper::GetObject(holder->Root(), obj)) {
+        return std::nullopt;
+    }
+    return obj;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        // 任意边界切分、CRLF、多行 data、注释与 retry
+        const std::string stream =
+            ": keep-alive\r\n\r\n"
+            "retry: 250\n"
+            "id: 7\r\nevent: message\r\ndata: {\"a\":1}\r\n\r\n"
+            "data: line1\ndata: line2\n\n"
+            "id: 9\n\n";
+        McpSseParser parser;
+        std::vector<McpSseEvent> events;
+        for (size_t i = 0; i < stream.size(); i += 3) {
+            parser.feed(std::string_view(stream).substr(i, 3), events);
+        }
+        ok = ok && require(events.size() == 2, "unexpected SSE event count");
+        if (events.size() == 2) {
+            ok = ok && require(events[0].id == "7" && events[0].event == "message" && events[0].data == "{\"a\":1}",
+                               "first SSE event fields wrong");
+            ok = ok && require(events[1].data == "line1\nline2" && events[1].id.empty(),
+                               "multi-line data not joined");
+        }
+        ok = ok && require(parser.retry() == 250u, "retry field not parsed");
+
+        std::string wire;
+        sse::appendEvent(wire, R"({"jsonrpc":"2.0","method":"x"})", "12");
+        std::vector<McpSseEvent> roundTrip;
+        McpSseParser second;
+        second.feed(wire, roundTrip);
+        ok = ok && require(roundTrip.size() == 1 && roundTrip.front().id == "12" &&
+                           roundTrip.front().data == R"({"jsonrpc":"2.0","method":"x"})",
+                           "appendEvent round trip failed");
+
+        std::string chunk;
+        sse::appendChunk(chunk, std::string(26, 'z'));
+        ok = ok && require(chunk.rfind("1a\r\n", 0) == 0 && chunk.size() == 4 + 26 + 2, "chunk framing wrong");
+        ok = ok && require(sse::parseEventId("42") == 42u && !sse::parseEventId("4x").has_value() &&
+                           !sse::parseEventId("").has_value(), "parseEventId accepted bad input");
+        ok = ok && require(sse::isEventStream("application/json, text/event-stream") &&
+                           !sse::isEventStream("application/json"), "isEventStream mismatch");
+    }
+
+    {
+        McpEventReplayBuffer buffer(3);
+        for (int i = 1; i <= 5; ++i) {
+            buffer.append("{\"n\":" + std::to_string(i) + "}");
+        }
+        bool gap = false;
+        auto all = buffer.since(0, &gap);
+        ok = ok && require(gap && all.size() == 3 && all.front().id == 3, "eviction not reported as a gap");
+        auto tail = buffer.since(3, &gap);
+        ok = ok && require(!gap && tail.size() == 2 && tail.front().id == 4 && tail.back().message == "{\"n\":5}",
+                           "since() did not resume after the last id");
+        ok = ok && require(buffer.since(5).empty() && buffer.lastEventId() == 5, "caught-up cursor returned events");
+    }
+
+    {
+        std::optional<JsonDocument> holder;
+        auto both = ParseParams(protocol::withRequestMeta(R"({"name":"t"})", 80ms, "job"), holder);
+        ok = ok && require(both.has_value(), "withRequestMeta produced invalid JSON");
+        if (both) {
+            ok = ok && require(protocol::getRequestTimeout(*both) == 80ms, "timeoutMs missing");
+            ok = ok && require(protocol::getProgressToken(*both) == JsonString(R"("job")"), "progressToken missing");
+            std::string name;
+            ok = ok && require(JsonHelper::GetString(*both, "name", name) && name == "t", "params fields lost");
+        }
+        auto tokenOnly = ParseParams(protocol::withRequestMeta("", std::nullopt, "p"), holder);
+        ok = ok && require(tokenOnly && !protocol::getRequestTimeout(*tokenOnly).has_value() &&
+                           protocol::getProgressToken(*tokenOnly).has_value(), "progressToken-only meta wrong");
+        ok = ok && require(protocol::withRequestMeta(R"({"x":1})", std::nullopt) == R"({"x":1})",
+                           "params rewritten without meta");
+    }
+
+    {
+        const std::string path = "/tmp/galay-mcp-t17-" + std::to_string(::getpid()) + ".sock";
+        auto listener = McpUnixSocket::listen(path, 4);
+        if (!require(listener.has_value(), "failed to listen on unix socket")) {
+            return 1;
+        }
+
+        std::thread peer([&path]() {
+            auto socket = McpUnixSocket::connect(path);
+            if (!socket) {
+                return;
+            }
+            std::string body;
+            sse::appendChunk(body, "hello ");
+            sse::appendChunk(body, "world");
+            socket.value().writeAll("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n" + body +
+                                    std::string(sse::LAST_CHUNK));
+
+            // 逐块发送：读取方应在第二块到达前拿到第一块
+            socket.value().writeAll("HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n"
+                                    "Transfer-Encoding: chunked\r\n\r\n");
+            std::string first;
+            sse::appendChunk(first, "data: 1\n\n");
+            socket.value().writeAll(first);
+            std::this_thread::sleep_for(20ms);
+            std::string second;
+            sse::appendChunk(second, "data: 2\n\n");
+            socket.value().writeAll(second + std::string(sse::LAST_CHUNK));
+        });
+
+        auto accepted = listener.value().accept();
+        if (!require(accepted.has_value(), "accept failed")) {
+            peer.join();
+            return 1;
+        }
+        McpUnixSocket& socket = accepted.value();
+
+        auto whole = socket.readHttpMessage();
+        ok = ok && require(whole.has_value() && whole.value().chunked && whole.value().body == "hello world",
+                           "chunked body not decoded");
+
+        auto head = socket.readHttpHead();
+        ok = ok && require(head.has_value() && head.value().chunked &&
+                           sse::isEventStream(head.value().header("Content-Type")), "event stream head wrong");
+        McpSseParser parser;
+        std::vector<McpSseEvent> events;
+        while (true) {
+            auto chunk = socket.readChunk();
+            if (!chunk || chunk.value().empty()) {
+                break;
+            }
+            parser.feed(chunk.value(), events);
+        }
+        ok = ok && require(events.size() == 2 && events[0].data == "1" && events[1].data == "2",
+                           "incremental chunk read lost events");
+
+        peer.join();
+        ::unlink(path.c_str());
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T17-StreamableHttp PASS\n";
+    return 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file T18-session_table.cc
+ * @brief 覆盖 McpSessionTable 的分段查找、空闲过期（分摊与全表）、并发创建 / 结束、跨线程生成的会话 ID 不重复，以及会话内的订阅、列表缓存与速率令牌桶。
+ */
+
+#include "galay-mcp/server/McpSessionTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+using namespace galay::mcp;
+using namespace std::chrono_literals;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    const auto t0 = McpSessionTable::Clock::now();
+
+    {
+        McpSessionOptions options;
+        options.shards = 40;
+        options.idleTimeout = 0ms;
+        McpSessionTable table(options);
+        ok = ok && require(table.options().shards == 64, "shard count not rounded up to a power of two");
+
+        constexpr size_t kSessions = 100000;
+        std::vector<std::string> ids;
+        ids.reserve(kSessions);
+        for (size_t i = 0; i < kSessions; ++i) {
+            ids.push_back(table.create(t0)->id());
+        }
+        std::unordered_set<std::string> unique(ids.begin(), ids.end());
+        ok = ok && require(unique.size() == kSessions && table.size() == kSessions, "session ids collided");
+        ok = ok && require(ids.front().size() == 32 &&
+                           ids.front().find_first_not_of("0123456789abcdef") == std::string::npos,
+                           "session id is not 128-bit hex");
+
+        bool allFound = true;
+        for (size_t i = 0; i < kSessions; i += 97) {
+            auto session = table.find(ids[i], t0 + 10h);
+            allFound = allFound && session && session->id() == ids[i];
+        }
+        ok = ok && require(allFound, "session lookup failed");
+        ok = ok && require(!table.find("unknown") && !table.find(""), "unknown id found");
+
+        auto closing = table.find(ids[1]);
+        ok = ok && require(table.close(ids[1]) && closing->closed() && !table.close(ids[1]),
+                           "close did not end the session");
+        ok = ok && require(table.size() == kSessions - 1 && table.stats().closed == 1, "close not counted");
+
+        size_t visited = 0;
+        table.forEach([&](McpSession&) { ++visited; });
+        ok = ok && require(visited == kSessions - 1, "forEach skipped sessions");
+
+        table.clear();
+        ok = ok && require(table.size() == 0 && !table.find(ids[2]), "clear left sessions behind");
+    }
+
+    {
+        McpSessionOptions options;
+        options.shards = 1;
+        options.idleTimeout = 100ms;
+        McpSessionTable table(options);
+
+        auto idle = table.create(t0);
+        auto active = table.create(t0);
+        const std::string idleId = idle->id();
+        ok = ok && require(table.find(active->id(), t0 + 60ms) != nullptr, "active session not found");
+        ok = ok && require(table.expireIdle(t0 + 120ms) == 1 && idle->closed() && !active->closed(),
+                           "idle expiry removed the wrong session");
+        ok = ok && require(!table.find(idleId, t0 + 120ms), "expired session still found");
+
+        // find() 就地回收过期会话
+        ok = ok && require(!table.find(active->id(), t0 + 200ms) && active->closed(), "find returned an expired session");
+
+        // create() 分摊清理一个分段（这里只有一个）
+        table.create(t0 + 1s);
+        table.create(t0 + 2s);
+        ok = ok && require(table.size() == 1 && table.stats().expired == 3, "create did not sweep idle sessions");
+    }
+
+    {
+        McpSessionTable table;
+        constexpr int kThreads = 8;
+        constexpr int kPerThread = 5000;
+        std::atomic<int> failures{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&]() {
+                std::vector<std::string> mine;
+                for (int i = 0; i < kPerThread; ++i) {
+                    mine.push_back(table.create()->id());
+                }
+                for (size_t i = 0; i < mine.size(); ++i) {
+                    if (!table.find(mine[i])) {
+                        failures.fetch_add(1);
+                    }
+                    if (i % 2 == 0 && !table.close(mine[i])) {
+                        failures.fetch_add(1);
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        ok = ok && require(failures.load() == 0, "concurrent find/close failed");
+        ok = ok && require(table.size() == kThreads * kPerThread / 2, "concurrent size accounting drifted");
+    }
+
+    {
+        // 各线程在各自的表里创建会话（表内不会替重复 ID 重试）：不同线程生成的 ID 也不重复
+        constexpr int kThreads = 8;
+        constexpr int kPerThread = 5000;
+        std::vector<std::vector<std::string>> generated(kThreads);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&generated, t]() {
+                McpSessionTable table;
+                for (int i = 0; i < kPerThread; ++i) {
+                    generated[t].push_back(table.create()->id());
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        std::unordered_set<std::string> unique;
+        for (const auto& ids : generated) {
+            unique.insert(ids.begin(), ids.end());
+        }
+        ok = ok && require(unique.size() == static_cast<size_t>(kThreads * kPerThread),
+                           "session ids repeated across threads");
+    }
+
+    {
+        McpSessionOptions options;
+        options.requestsPerSecond = 10;
+        options.burst = 2;
+        McpSession session("s", options, t0);
+        ok = ok && require(session.tryAcquire(t0) && session.tryAcquire(t0) && !session.tryAcquire(t0),
+                           "burst not enforced");
+        ok = ok && require(session.tryAcquire(t0 + 100ms) && !session.tryAcquire(t0 + 100ms),
+                           "bucket did not refill at the configured rate");
+
+        McpSession unlimited("u", McpSessionOptions{}, t0);
+        bool allowed = true;
+        for (int i = 0; i < 1000; ++i) {
+            allowed = allowed && unlimited.tryAcquire(t0);
+        }
+        ok = ok && require(allowed, "unlimited session was rate limited");
+
+        ok = ok && require(session.subscribe("file:///a") && !session.subscribe("file:///a") &&
+                           session.isSubscribed("file:///a"), "subscribe bookkeeping wrong");
+        ok = ok && require(session.unsubscribe("file:///a") && !session.isSubscribed("file:///a"),
+                           "unsubscribe bookkeeping wrong");
+
+        session.storeList("tools", 3, R"({"tools":[]})");
+        ok = ok && require(session.cachedList("tools", 3) == JsonString(R"({"tools":[]})") &&
+                           !session.cachedList("tools", 4).has_value() &&
+                           !session.cachedList("prompts", 3).has_value(), "list cache versioning wrong");
+
+        InitializeParams client;
+        client.protocolVersion = "2024-11-05";
+        client.clientInfo.name = "t18";
+        session.setClient(client);
+        ok = ok && require(session.client().clientInfo.name == "t18", "client info not stored");
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T18-SessionTable PASS\n";
+    return 0;
+}
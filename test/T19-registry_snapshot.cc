@@ -0,0 +1,245 @@
+/**
+ * @file T19-registry_snapshot.cc
+ * @brief 覆盖 McpRegistry 的快照发布、版本化 Reader 与并发读写，批量注册与列表顺序，以及 McpStdioServer 运行期间增删、批量注册工具并发送 list_changed。
+ */
+
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpRegistry.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+JsonString SerializeNumber(const int& value)
+{
+    return "{\"v\":" + std::to_string(value) + "}";
+}
+
+// 读到指定 id 的响应为止，期间收到的通知方法名依次记入 notifications
+std::optional<std::string> ReadResponse(McpShmChannel& client, int64_t id, std::vector<std::string>& notifications)
+{
+    while (true) {
+        auto message = client.readMessage();
+        if (!message) {
+            return std::nullopt;
+        }
+        auto parsed = parseJsonRpcResponse(message.value());
+        if (parsed && parsed.value().response.id == id) {
+            return message.value();
+        }
+        const size_t method = message.value().find("\"method\":\"");
+        if (method != std::string::npos) {
+            const size_t begin = method + 10;
+            notifications.push_back(message.value().substr(begin, message.value().find('"', begin) - begin));
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        McpRegistry<int> registry("items", SerializeNumber);
+        ok = ok && require(registry.version() == 0 && registry.snapshot()->listResult() == R"({"items":[]})",
+                           "empty registry snapshot wrong");
+
+        McpRegistry<int>::Reader reader(registry);
+        const McpRegistry<int>::Snapshot* before = &reader.get();
+        ok = ok && require(registry.put("a", 1) && !registry.put("a", 2), "put did not report replacement");
+        ok = ok && require(registry.version() == 2, "each put should publish a version");
+
+        const auto& current = reader.get();
+        ok = ok && require(&current != before && current.find("a") && *current.find("a") == 2 &&
+                           current.listResult() == R"({"items":[{"v":2}]})", "reader did not pick up new snapshot");
+        ok = ok && require(&reader.get() == &current, "reader reloaded without a version change");
+
+        auto held = registry.snapshot();
+        ok = ok && require(registry.remove("a") && !registry.remove("a"), "remove bookkeeping wrong");
+        ok = ok && require(held->find("a") && !registry.snapshot()->find("a"),
+                           "published snapshot changed after remove");
+
+        const uint64_t version = registry.version();
+        ok = ok && require(registry.putAll({}) == 0 && registry.version() == version,
+                           "empty batch published a version");
+    }
+
+    {
+        // 批量注册只发布一次；列表按注册顺序，追加与替换后都与条目顺序一致
+        McpRegistry<int> registry("items", SerializeNumber);
+        ok = ok && require(registry.putAll({{"b", 1}, {"a", 2}}) == 2 && registry.version() == 1 &&
+                           registry.snapshot()->listResult() == R"({"items":[{"v":1},{"v":2}]})",
+                           "batch put wrong");
+        ok = ok && require(registry.putAll({{"c", 3}, {"d", 4}}) == 2 &&
+                           registry.snapshot()->listResult() == R"({"items":[{"v":1},{"v":2},{"v":3},{"v":4}]})",
+                           "append-only batch did not extend the list");
+        ok = ok && require(registry.putAll({{"e", 5}, {"a", 6}, {"e", 7}}) == 1 && registry.version() == 3,
+                           "replacement counted as new");
+        auto snapshot = registry.snapshot();
+        ok = ok && require(snapshot->listResult() == R"({"items":[{"v":1},{"v":6},{"v":3},{"v":4},{"v":7}]})" &&
+                           snapshot->size() == 5 && *snapshot->find("e") == 7,
+                           "replacement did not keep registration order");
+        ok = ok && require(registry.remove("c") &&
+                           registry.snapshot()->listResult() == R"({"items":[{"v":1},{"v":6},{"v":4},{"v":7}]})" &&
+                           *registry.snapshot()->find("e") == 7, "remove did not reindex entries");
+    }
+
+    {
+        // 逐个注册跨越多次尾部合并：遍历顺序、查找与列表结果始终一致
+        McpRegistry<int> registry("items", SerializeNumber);
+        for (int i = 0; i < 500; ++i) {
+            registry.put("k" + std::to_string(i), i);
+        }
+        registry.remove("k0");
+        registry.remove("k499");
+        auto snapshot = registry.snapshot();
+        std::string expected = R"({"items":[)";
+        int next = 1;
+        bool ordered = true;
+        snapshot->forEach([&](const McpRegistry<int>::Entry& entry) {
+            ordered = ordered && entry.info == next && snapshot->find(entry.key) == &entry.info;
+            expected += (next > 1 ? "," : "") + SerializeNumber(entry.info);
+            ++next;
+        });
+        ok = ok && require(ordered && next == 499 && snapshot->size() == 498 && !snapshot->find("k0"),
+                           "one-by-one registration lost order");
+        ok = ok && require(snapshot->listResult() == expected + "]}", "list result diverged from entries");
+    }
+
+    {
+        // 写入方反复增删，读取方看到的每个快照的条目与列表结果都必须一致
+        McpRegistry<int> registry("items", SerializeNumber);
+        std::atomic<bool> done{false};
+        std::atomic<int> torn{0};
+        std::atomic<uint64_t> reads{0};
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 4; ++t) {
+            readers.emplace_back([&]() {
+                McpRegistry<int>::Reader reader(registry);
+                uint64_t lastVersion = 0;
+                while (!done.load(std::memory_order_relaxed)) {
+                    const auto& snapshot = reader.get();
+                    const auto items = static_cast<size_t>(
+                        std::count(snapshot.listResult().begin(), snapshot.listResult().end(), 'v'));
+                    if (items != snapshot.size() || snapshot.version < lastVersion) {
+                        torn.fetch_add(1);
+                    }
+                    lastVersion = snapshot.version;
+                    reads.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (int i = 0; i < 2000; ++i) {
+            registry.put("k" + std::to_string(i % 50), i);
+            if (i % 3 == 0) {
+                registry.remove("k" + std::to_string((i + 7) % 50));
+            }
+        }
+        done = true;
+        for (auto& thread : readers) {
+            thread.join();
+        }
+        ok = ok && require(torn.load() == 0 && reads.load() > 0, "reader observed an inconsistent snapshot");
+    }
+
+    const std::string name = "/galay-mcp-t19-" + std::to_string(::getpid());
+
+    McpStdioServer server;
+    server.addTool("echo", "Echo", "{}",
+        [](const JsonElement&) -> std::expected<JsonString, McpError> {
+            return JsonString(R"({"content":[]})");
+        });
+    // 处理函数内注册新工具：调用期间不持有注册表锁
+    server.addTool("spawn", "Register another tool", "{}",
+        [&server](const JsonElement&) -> std::expected<JsonString, McpError> {
+            server.addTool("spawned", "Spawned", "{}",
+                [](const JsonElement&) -> std::expected<JsonString, McpError> {
+                    return JsonString(R"({"content":[]})");
+                });
+            return JsonString(R"({"content":[]})");
+        });
+
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel")) {
+        return 1;
+    }
+    McpShmChannel& client = *clientChannel.value();
+    std::vector<std::string> notifications;
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t19","version":"1.0.0"}}})");
+    auto initialized = ReadResponse(client, 1, notifications);
+    ok = ok && require(initialized && initialized->find(R"("tools":{"listChanged":true})") != std::string::npos,
+                       "listChanged capability not advertised");
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"spawn","arguments":{}}})");
+    ok = ok && require(ReadResponse(client, 2, notifications).has_value(), "spawn call failed");
+    ok = ok && require(std::count(notifications.begin(), notifications.end(), "notifications/tools/list_changed") == 1,
+                       "list_changed not sent for a runtime registration");
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":3,"method":"tools/list"})");
+    auto listed = ReadResponse(client, 3, notifications);
+    ok = ok && require(listed && listed->find(R"("name":"spawned")") != std::string::npos,
+                       "tools/list missing the runtime tool");
+
+    notifications.clear();
+    ok = ok && require(server.removeTool("echo") && !server.removeTool("echo"), "removeTool bookkeeping wrong");
+    client.writeMessage(R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"echo","arguments":{}}})");
+    auto removed = ReadResponse(client, 4, notifications);
+    ok = ok && require(removed && removed->find("Tool not found") != std::string::npos, "removed tool still callable");
+    ok = ok && require(notifications.size() == 1 && notifications.front() == "notifications/tools/list_changed",
+                       "list_changed not sent for removal");
+
+    // 批量注册一次发布：只发送一条 list_changed
+    notifications.clear();
+    std::vector<McpStdioServer::ToolDefinition> batch;
+    for (int i = 0; i < 100; ++i) {
+        batch.push_back({"bulk-" + std::to_string(i), "Bulk", "{}",
+            [](const JsonElement&, const McpToolContext&) -> std::expected<JsonString, McpError> {
+                return JsonString(R"({"content":[]})");
+            }});
+    }
+    ok = ok && require(server.registerTools(std::move(batch)) == 100, "registerTools count wrong");
+    client.writeMessage(R"({"jsonrpc":"2.0","id":5,"method":"tools/call","params":{"name":"bulk-99","arguments":{}}})");
+    auto bulk = ReadResponse(client, 5, notifications);
+    ok = ok && require(bulk && bulk->find("\"error\"") == std::string::npos, "bulk tool not callable");
+    ok = ok && require(notifications.size() == 1 && notifications.front() == "notifications/tools/list_changed",
+                       "registerTools should send a single list_changed");
+
+    client.close();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T19-RegistrySnapshot PASS\n";
+    return 0;
+}
@@ -1,7 +1,10 @@
 #include "galay-mcp/server/McpStdioServer.h"
 #include "galay-mcp/common/McpSchemaBuilder.h"
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <unistd.h>
 
 using namespace galay::mcp;
 
@@ -67,6 +70,29 @@ int main() {
         }
     );
 
+    // 模拟崩溃：先在 T2_CRASH_LOG 指向的文件中记一行（用于统计执行次数），再直接退出
+    server.addTool("crash", "Record the call and exit without responding", "{}",
+        [](const JsonElement&) -> std::expected<JsonString, McpError> {
+            if (const char* path = std::getenv("T2_CRASH_LOG")) {
+                std::ofstream(path, std::ios::app) << "crash\n";
+            }
+            ::_exit(1);
+        }
+    );
+
+    // 返回指定环境变量的值（未设置时返回空字符串），用于检查托管进程的环境
+    server.addTool("getenv", "Read an environment variable", SchemaBuilder().addString("name", "Variable name", true).build(),
+        [](const JsonElement& args) -> std::expected<JsonString, McpError> {
+            JsonObject obj;
+            std::string name;
+            if (!JsonHelper::GetObject(args, obj) || !JsonHelper::GetString(obj, "name", name)) {
+                return std::unexpected(McpError::toolExecutionFailed("Missing name"));
+            }
+            const char* value = std::getenv(name.c_str());
+            return JsonString(value != nullptr ? value : "");
+        }
+    );
+
     // 添加一个简单的资源
     server.addResource("file:///test.txt", "test.txt", "Test file", "text/plain",
         [](const std::string& uri) -> std::expected<std::string, McpError> {
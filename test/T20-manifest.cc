@@ -0,0 +1,177 @@
+/**
+ * @file T20-manifest.cc
+ * @brief 覆盖 McpManifest 的映射解析、视图与单行压缩、错误路径，以及 McpStdioServer::loadManifest 的绑定与直接由清单字节拼接的 tools/list。
+ */
+
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpManifest.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <unordered_map>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+void WriteFile(const std::string& path, std::string_view content)
+{
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << content;
+}
+
+bool Inside(std::string_view view, std::string_view bytes)
+{
+    return view.data() >= bytes.data() && view.data() + view.size() <= bytes.data() + bytes.size();
+}
+
+McpStdioServer::ContextToolHandler Reply(std::string text)
+{
+    return [text = std::move(text)](const JsonElement&, const McpToolContext&) -> std::expected<JsonString, McpError> {
+        return JsonString(R"({"content":[{"type":"text","text":")" + text + R"("}]})");
+    };
+}
+
+// 跳过通知，读到指定 id 的响应
+std::optional<std::string> ReadResponse(McpShmChannel& client, int64_t id)
+{
+    while (true) {
+        auto message = client.readMessage();
+        if (!message) {
+            return std::nullopt;
+        }
+        auto parsed = parseJsonRpcResponse(message.value());
+        if (parsed && parsed.value().response.id == id) {
+            return message.value();
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    const std::string path = "/tmp/galay-mcp-t20-" + std::to_string(::getpid()) + ".json";
+
+    // 工具单行书写；资源跨行书写，加载时压缩
+    WriteFile(path,
+        R"({"version":1,"tools":[{"name":"echo","description":"Echo \"text\"","inputSchema":{"type":"object","properties":{"text":{"type":"string"}}},"annotations":{"readOnlyHint":true}},)"
+        R"({"name":"sum","inputSchema":{"type":"object"}}],)"
+        "\n\"resources\":[{\n  \"uri\": \"file:///readme\",\n  \"name\": \"readme\",\n  \"mimeType\": \"text/plain\"\n}]}\n");
+
+    auto loaded = McpManifest::load(path);
+    if (!require(loaded.has_value(), "manifest failed to load")) {
+        return 1;
+    }
+    std::shared_ptr<const McpManifest> manifest = loaded.value();
+    ok = ok && require(manifest->tools().size() == 2 && manifest->resources().size() == 1, "entry count wrong");
+
+    const McpManifestTool& echo = manifest->tools().front();
+    ok = ok && require(echo.name == "echo" && echo.description == "Echo \"text\"", "strings not unescaped");
+    ok = ok && require(echo.inputSchema == R"({"type":"object","properties":{"text":{"type":"string"}}})" &&
+                       Inside(echo.inputSchema, manifest->bytes()) && Inside(echo.json, manifest->bytes()),
+                       "single-line entry should be a view into the mapping");
+    ok = ok && require(echo.json.front() == '{' && echo.json.back() == '}' &&
+                       echo.json.find(R"("annotations":{"readOnlyHint":true})") != std::string_view::npos,
+                       "raw tool object wrong");
+
+    const McpManifestResource& readme = manifest->resources().front();
+    ok = ok && require(readme.uri == "file:///readme" && readme.mimeType == "text/plain" &&
+                       readme.json == R"({"uri":"file:///readme","name":"readme","mimeType":"text/plain"})",
+                       "multi-line entry not compacted");
+
+    {
+        const std::string bad = path + ".bad";
+        auto missing = McpManifest::load(path + ".missing");
+        ok = ok && require(!missing && missing.error().code() == McpErrorCode::ReadError, "missing file not a read error");
+        WriteFile(bad, R"({"tools":[{"name":"x","inputSchema":{}})");
+        auto truncated = McpManifest::load(bad);
+        ok = ok && require(!truncated && truncated.error().code() == McpErrorCode::ParseError, "truncated JSON accepted");
+        WriteFile(bad, R"({"tools":[{"name":"x"}]})");
+        auto noSchema = McpManifest::load(bad);
+        ok = ok && require(!noSchema && noSchema.error().details().find("tools[0]") != std::string::npos,
+                           "tool without inputSchema accepted");
+        std::remove(bad.c_str());
+    }
+
+    McpStdioServer server;
+    std::unordered_map<std::string, McpStdioServer::ContextToolHandler> handlers;
+    handlers.emplace("echo", Reply("echo"));
+    auto bindTool = [&handlers](const McpManifestTool& tool) -> McpStdioServer::ContextToolHandler {
+        auto it = handlers.find(tool.name);
+        return it == handlers.end() ? nullptr : it->second;
+    };
+    auto bindResource = [](const McpManifestResource&) -> McpStdioServer::ResourceReader {
+        return [](const std::string& uri) -> std::expected<std::string, McpError> { return "contents of " + uri; };
+    };
+
+    auto unbound = server.loadManifest(manifest, bindTool, bindResource);
+    ok = ok && require(!unbound && unbound.error().code() == McpErrorCode::InvalidParams &&
+                       server.localListTools().empty(), "unbound tool should fail without registering");
+
+    handlers.emplace("sum", Reply("sum"));
+    auto bound = server.loadManifest(manifest, bindTool, bindResource);
+    ok = ok && require(bound && bound.value() == 3, "loadManifest count wrong");
+    manifest.reset();  // 注册表中的条目持有清单
+
+    auto tools = server.localListTools();
+    ok = ok && require(tools.size() == 2 && tools[0].name == "echo" &&
+                       tools[0].inputSchema == R"({"type":"object","properties":{"text":{"type":"string"}}})",
+                       "local tool listing lost the schema");
+    auto called = server.localCallTool("sum", JsonHelper::EmptyObject());
+    ok = ok && require(called && called->find("sum") != std::string::npos, "bound handler not called");
+    auto read = server.localReadResource("file:///readme");
+    ok = ok && require(read && read.value() == "contents of file:///readme", "bound reader not called");
+
+    const std::string name = "/galay-mcp-t20-" + std::to_string(::getpid());
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel")) {
+        return 1;
+    }
+    McpShmChannel& client = *clientChannel.value();
+    client.writeMessage(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t20","version":"1.0.0"}}})");
+    ok = ok && require(ReadResponse(client, 1).has_value(), "initialize failed");
+    client.writeMessage(R"({"jsonrpc":"2.0","id":2,"method":"tools/list"})");
+    auto listed = ReadResponse(client, 2);
+    ok = ok && require(listed && listed->find(R"("tools":[{"name":"echo","description":"Echo \"text\"")") != std::string::npos &&
+                       listed->find(R"("annotations":{"readOnlyHint":true})") != std::string::npos,
+                       "tools/list not assembled from manifest bytes");
+    client.writeMessage(R"({"jsonrpc":"2.0","id":3,"method":"resources/list"})");
+    auto resources = ReadResponse(client, 3);
+    ok = ok && require(resources && resources->find(R"({"resources":[{"uri":"file:///readme","name":"readme","mimeType":"text/plain"}],"_meta":{"listVersion":")") != std::string::npos,
+                       "resources/list wrong");
+
+    client.close();
+    serverThread.join();
+    std::remove(path.c_str());
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T20-Manifest PASS\n";
+    return 0;
+}
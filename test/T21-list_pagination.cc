@@ -0,0 +1,143 @@
+/**
+ * @file T21-list_pagination.cc
+ * @brief 覆盖 list 结果的 cursor 分页：页内容与 nextCursor、跨快照沿用的分页缓存、非法 cursor，
+ *        以及 McpStdioClient 逐页获取与自动取完所有页。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpRegistry.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+JsonString SerializeNumber(const int& value)
+{
+    return std::to_string(value);
+}
+
+std::string Page(const McpRegistry<int>& registry, std::string_view cursor)
+{
+    const JsonString* page = registry.snapshot()->listPage(cursor);
+    return page ? *page : "<invalid>";
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    McpRegistry<int> registry("items", SerializeNumber);
+    registry.setPageSize(2);
+    ok = ok && require(Page(registry, "") == R"({"items":[]})", "empty registry page wrong");
+
+    for (int i = 1; i <= 5; ++i) {
+        registry.put("k" + std::to_string(i), i);
+    }
+    ok = ok && require(Page(registry, "") == R"({"items":[1,2],"nextCursor":"2"})", "first page wrong");
+    ok = ok && require(Page(registry, "2") == R"({"items":[3,4],"nextCursor":"4"})", "middle page wrong");
+    ok = ok && require(Page(registry, "4") == R"({"items":[5]})", "last page should have no nextCursor");
+    ok = ok && require(Page(registry, "3") == "<invalid>" && Page(registry, "6") == "<invalid>" &&
+                       Page(registry, "x") == "<invalid>" && Page(registry, "-2") == "<invalid>",
+                       "invalid cursors accepted");
+
+    {
+        // 追加：完整且不在末尾的页沿用旧快照的缓存，最后一页重建
+        auto before = registry.snapshot();
+        const JsonString* first = before->listPage("");
+        const JsonString* middle = before->listPage("2");
+        const JsonString* last = before->listPage("4");
+        registry.put("k6", 6);
+        auto after = registry.snapshot();
+        ok = ok && require(after->listPage("") == first && after->listPage("2") == middle, "pages before the append rebuilt");
+        ok = ok && require(after->listPage("4") != last && *after->listPage("4") == R"({"items":[5,6]})",
+                           "appended page not rebuilt");
+
+        // 替换：只重建所在的页
+        first = after->listPage("");
+        last = after->listPage("4");
+        registry.put("k3", 30);
+        auto replaced = registry.snapshot();
+        ok = ok && require(replaced->listPage("") == first && replaced->listPage("4") == last,
+                           "replace rebuilt pages it did not touch");
+        ok = ok && require(*replaced->listPage("2") == R"({"items":[30,4],"nextCursor":"4"})", "replaced page wrong");
+
+        // 删除：之后的条目前移，所在页及其后重建
+        registry.remove("k4");
+        ok = ok && require(registry.snapshot()->listPage("") == first, "page before the removal rebuilt");
+        ok = ok && require(Page(registry, "2") == R"({"items":[30,5],"nextCursor":"4"})" &&
+                           Page(registry, "4") == R"({"items":[6]})", "pages after removal wrong");
+    }
+
+    registry.setPageSize(0);
+    ok = ok && require(Page(registry, "") == R"({"items":[1,2,30,5,6]})" && Page(registry, "4") == Page(registry, ""),
+                       "unpaged registry should ignore the cursor");
+
+    const std::string name = "/galay-mcp-t21-" + std::to_string(::getpid());
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+
+    McpStdioServer server;
+    std::vector<McpStdioServer::ToolDefinition> tools;
+    for (int i = 0; i < 25; ++i) {
+        tools.push_back({"tool-" + std::to_string(i), "Paged tool", "{}",
+            [](const JsonElement&, const McpToolContext&) -> std::expected<JsonString, McpError> {
+                return JsonString(R"({"content":[]})");
+            }});
+    }
+    server.registerTools(std::move(tools));
+    server.setListPageSize(10);
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    McpStdioClient client;
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel") ||
+        !require(client.attach(std::move(clientChannel.value())).has_value(), "attach failed")) {
+        return 1;
+    }
+    ok = ok && require(client.initialize("t21-client", "1.0.0").has_value(), "initialize failed");
+
+    auto first = client.listToolsPage();
+    ok = ok && require(first && first->items.size() == 10 && first->items.front().name == "tool-0" &&
+                       first->nextCursor == "10", "first tools page wrong");
+    auto last = client.listToolsPage("20");
+    ok = ok && require(last && last->items.size() == 5 && last->items.back().name == "tool-24" &&
+                       last->nextCursor.empty(), "last tools page wrong");
+    ok = ok && require(!client.listToolsPage("15").has_value(), "misaligned cursor accepted");
+
+    auto all = client.listTools();
+    ok = ok && require(all && all->size() == 25 && all->at(10).name == "tool-10", "listTools did not follow nextCursor");
+    auto resources = client.listResourcesPage();
+    ok = ok && require(resources && resources->items.empty() && resources->nextCursor.empty(), "empty resources page wrong");
+
+    client.disconnect();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T21-ListPagination PASS\n";
+    return 0;
+}
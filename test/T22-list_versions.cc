@@ -0,0 +1,184 @@
+/**
+ * @file T22-list_versions.cc
+ * @brief 覆盖带版本的 list 结果：_meta.listVersion、ifChangedSince 的 notModified / 增量 / 回退完整结果，
+ *        服务端实例纪元与变更记录上限，以及客户端 McpListCache。
+ */
+
+#include "galay-mcp/client/McpListCache.h"
+#include "galay-mcp/common/McpJsonParser.h"
+#include "galay-mcp/common/McpRegistry.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+JsonString SerializeNumber(const int& value)
+{
+    return std::to_string(value);
+}
+
+std::string Respond(const McpRegistry<int>& registry, std::string_view since, std::string_view cursor = "")
+{
+    auto result = registry.listResponse(*registry.snapshot(), cursor, since);
+    return result ? result.value() : "<invalid>";
+}
+
+std::string Tag(const McpRegistry<int>& registry)
+{
+    return registry.versionTag(registry.version());
+}
+
+// 跳过通知，读到指定 id 的响应
+std::optional<std::string> ReadResponse(McpShmChannel& client, int64_t id)
+{
+    while (true) {
+        auto message = client.readMessage();
+        if (!message) {
+            return std::nullopt;
+        }
+        auto parsed = parseJsonRpcResponse(message.value());
+        if (parsed && parsed.value().response.id == id) {
+            return message.value();
+        }
+    }
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    McpRegistry<int> registry("items", SerializeNumber);
+    registry.put("a", 1);
+    registry.put("b", 2);
+    registry.put("c", 3);
+    const std::string v3 = Tag(registry);
+
+    ok = ok && require(Respond(registry, "") == R"({"items":[1,2,3],"_meta":{"listVersion":")" + v3 + R"("}})",
+                       "full result should carry listVersion");
+    ok = ok && require(Respond(registry, v3) == R"({"_meta":{"listVersion":")" + v3 + R"(","notModified":true}})",
+                       "unchanged list should be notModified");
+
+    registry.put("b", 20);
+    registry.remove("c");
+    registry.put("d", 4);
+    registry.put("c", 30);  // 删除后重新加入，按新增处理
+    const std::string v7 = Tag(registry);
+    ok = ok && require(Respond(registry, v3) ==
+                       R"({"items":[20,30,4],"_meta":{"listVersion":")" + v7 + R"(","delta":true,"removed":[]}})",
+                       "delta wrong");
+    registry.remove("a");
+    ok = ok && require(Respond(registry, v7).find(R"("items":[],"_meta":{"listVersion":")") != std::string::npos &&
+                       Respond(registry, v7).find(R"("delta":true,"removed":["a"]})") != std::string::npos,
+                       "removal delta wrong");
+
+    // 其他实例（服务端重启）的标签、未来的版本、格式错误的标签都回退到完整结果
+    McpRegistry<int> restarted("items", SerializeNumber);
+    restarted.put("a", 1);
+    const std::string full = Respond(registry, "");
+    ok = ok && require(Respond(registry, Tag(restarted)) == full && Respond(registry, v3 + "0") == full &&
+                       Respond(registry, "garbage") == full, "foreign tags should get the full list");
+
+    // 只有第一页请求按 ifChangedSince 处理；增量超过一页时回退到第一页
+    registry.setPageSize(1);
+    ok = ok && require(Respond(registry, v7, "1").find(R"("delta")") == std::string::npos &&
+                       Respond(registry, v7, "1").find(R"("listVersion")") != std::string::npos,
+                       "later pages should ignore ifChangedSince");
+    ok = ok && require(Respond(registry, v3).find(R"("delta")") == std::string::npos &&
+                       Respond(registry, v3).find(R"("nextCursor":"1")") != std::string::npos,
+                       "oversized delta should fall back to the first page");
+    registry.setPageSize(0);
+
+    // 超过变更记录上限的批量注册之后，之前的版本只能拿到完整结果
+    {
+        const std::string before = Tag(registry);
+        std::vector<std::pair<std::string, int>> bulk;
+        for (int i = 0; i < 5000; ++i) {
+            bulk.emplace_back("bulk-" + std::to_string(i), i);
+        }
+        registry.putAll(std::move(bulk));
+        const std::string afterBulk = Tag(registry);
+        ok = ok && require(Respond(registry, before).find(R"("delta")") == std::string::npos, "bulk change should reset the log");
+        registry.put("e", 5);
+        ok = ok && require(Respond(registry, afterBulk).find(R"({"items":[5],)") == 0, "delta after bulk change wrong");
+    }
+
+    {
+        McpListCache cache;
+        cache.store<Tool>("http://a/mcp", McpCachedList<Tool>{"x-1", {Tool{"t", "", "{}"}}});
+        auto hit = cache.find<Tool>("http://a/mcp");
+        ok = ok && require(hit && hit->version == "x-1" && hit->items.size() == 1, "cache lookup failed");
+        ok = ok && require(!cache.find<Tool>("http://b/mcp") && !cache.find<Prompt>("http://a/mcp"),
+                           "cache should be keyed by server and kind");
+        cache.clear();
+        ok = ok && require(!cache.find<Tool>("http://a/mcp"), "cache clear failed");
+    }
+
+    const std::string name = "/galay-mcp-t22-" + std::to_string(::getpid());
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+    McpStdioServer server;
+    auto handler = [](const JsonElement&, const McpToolContext&) -> std::expected<JsonString, McpError> {
+        return JsonString(R"({"content":[]})");
+    };
+    server.addTool("first", "First tool", "{}", handler);
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel")) {
+        return 1;
+    }
+    McpShmChannel& client = *clientChannel.value();
+    client.writeMessage(R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t22","version":"1.0.0"}}})");
+    ok = ok && require(ReadResponse(client, 1).has_value(), "initialize failed");
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":2,"method":"tools/list"})");
+    auto listed = ReadResponse(client, 2);
+    const size_t at = listed ? listed->find(R"("listVersion":")") : std::string::npos;
+    ok = ok && require(at != std::string::npos, "tools/list without listVersion");
+    const std::string version = at == std::string::npos ? "" : listed->substr(at + 15, listed->find('"', at + 15) - at - 15);
+
+    client.writeMessage(R"({"jsonrpc":"2.0","id":3,"method":"tools/list","params":{"_meta":{"ifChangedSince":")" + version + R"("}}})");
+    auto unchanged = ReadResponse(client, 3);
+    ok = ok && require(unchanged && unchanged->find(R"("notModified":true)") != std::string::npos &&
+                       unchanged->find(R"("tools")") == std::string::npos, "warm list should be notModified");
+
+    server.addTool("second", "Second tool", "{}", handler);
+    client.writeMessage(R"({"jsonrpc":"2.0","id":4,"method":"tools/list","params":{"_meta":{"ifChangedSince":")" + version + R"("}}})");
+    auto delta = ReadResponse(client, 4);
+    ok = ok && require(delta && delta->find(R"("tools":[{"name":"second")") != std::string::npos &&
+                       delta->find(R"("delta":true,"removed":[])") != std::string::npos &&
+                       delta->find(R"("name":"first")") == std::string::npos, "delta should only carry the new tool");
+
+    client.close();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T22-ListVersions PASS\n";
+    return 0;
+}
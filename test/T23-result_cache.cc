@@ -0,0 +1,158 @@
+/**
+ * @file T23-result_cache.cc
+ * @brief 覆盖工具结果缓存：参数规范化、分段 LRU 内存预算淘汰、TTL 过期、注册代次隔离，
+ *        以及 McpStdioServer 对可缓存工具的命中路径与计数。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpResultCache.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+McpResultCacheKey Key(std::string_view tool, uint64_t scope, std::string_view arguments)
+{
+    auto document = JsonDocument::Parse(arguments);
+    return McpResultCache::makeKey(tool, scope, document.value().Root());
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    using namespace std::chrono_literals;
+
+    // 键顺序与空白不同的等价参数得到同一个键；值、工具或代次不同则不同
+    {
+        const auto a = Key("sum", 1, R"({"b":[1,{"y":2,"x":1}],"a":"s"})");
+        const auto b = Key("sum", 1, R"( { "a" : "s", "b" : [ 1, { "x":1, "y":2 } ] } )");
+        ok = ok && require(a.hash == b.hash && a.text == b.text, "equivalent arguments should share a key");
+        ok = ok && require(Key("sum", 1, R"({"a":"t","b":[1,{"x":1,"y":2}]})").text != a.text &&
+                           Key("sum", 2, R"({"a":"s","b":[1,{"x":1,"y":2}]})").text != a.text &&
+                           Key("mul", 1, R"({"a":"s","b":[1,{"x":1,"y":2}]})").text != a.text,
+                           "different arguments, scope or tool should not share a key");
+    }
+
+    // 单个分段、约三个条目的预算：超出时淘汰最久未使用的条目
+    {
+        McpResultCache cache(McpResultCacheOptions{1, 1000});
+        const JsonString value(200, 'x');
+        const auto now = McpResultCache::Clock::now();
+        const auto k0 = Key("t", 1, R"({"i":0})");
+        const auto k1 = Key("t", 1, R"({"i":1})");
+        const auto k2 = Key("t", 1, R"({"i":2})");
+        const auto k3 = Key("t", 1, R"({"i":3})");
+        cache.store(k0, value, 1min, now);
+        cache.store(k1, value, 1min, now);
+        cache.store(k2, value, 1min, now);
+        ok = ok && require(cache.find(k0, now) == value, "stored entry missing");
+        cache.store(k3, value, 1min, now);
+        ok = ok && require(!cache.find(k1, now) && cache.find(k0, now) && cache.find(k2, now) && cache.find(k3, now),
+                           "LRU eviction picked the wrong entry");
+        const auto stats = cache.stats();
+        ok = ok && require(stats.entries == 3 && stats.evictions == 1 && stats.inserts == 4 &&
+                           stats.hits == 4 && stats.misses == 1 && stats.bytes <= 1000, "LRU stats wrong");
+
+        cache.store(Key("t", 1, R"({"i":4})"), JsonString(2000, 'x'), 1min, now);
+        ok = ok && require(cache.stats().inserts == 4, "oversized entry should not be cached");
+    }
+
+    // TTL：到期后查找视为未命中并删除条目
+    {
+        McpResultCache cache;
+        const auto now = McpResultCache::Clock::now();
+        const auto key = Key("t", 1, "{}");
+        cache.store(key, R"({"content":[]})", 100ms, now);
+        ok = ok && require(cache.find(key, now + 50ms).has_value(), "entry expired early");
+        ok = ok && require(!cache.find(key, now + 150ms).has_value(), "entry outlived its ttl");
+        const auto stats = cache.stats();
+        ok = ok && require(stats.expirations == 1 && stats.entries == 0 && stats.bytes == 0, "expiry stats wrong");
+    }
+
+    const std::string name = "/galay-mcp-t23-" + std::to_string(::getpid());
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+
+    std::atomic<int> cachedCalls{0};
+    std::atomic<int> plainCalls{0};
+    McpStdioServer server;
+    server.addTool("sum", "Cached sum", "{}",
+        [&cachedCalls](const JsonElement& arguments) -> std::expected<JsonString, McpError> {
+            ++cachedCalls;
+            JsonObject object;
+            int64_t a = 0;
+            int64_t b = 0;
+            JsonHelper::GetObject(arguments, object);
+            JsonHelper::GetInt64(object, "a", a);
+            JsonHelper::GetInt64(object, "b", b);
+            return std::to_string(a + b);
+        },
+        std::chrono::minutes(1));
+    server.addTool("plain", "Uncached tool", "{}",
+        [&plainCalls](const JsonElement&) -> std::expected<JsonString, McpError> {
+            return std::to_string(++plainCalls);
+        });
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    McpStdioClient client;
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel") ||
+        !require(client.attach(std::move(clientChannel.value())).has_value(), "attach failed")) {
+        return 1;
+    }
+    ok = ok && require(client.initialize("t23-client", "1.0.0").has_value(), "initialize failed");
+
+    auto first = client.callTool("sum", R"({"a":1,"b":2})");
+    auto second = client.callTool("sum", R"({ "b" : 2, "a" : 1 })");
+    ok = ok && require(first && second && first.value() == "3" && second.value() == "3", "cached result differs");
+    ok = ok && require(cachedCalls == 1, "equivalent call should not run the handler again");
+    ok = ok && require(client.callTool("sum", R"({"a":2,"b":2})").has_value() && cachedCalls == 2,
+                       "different arguments should run the handler");
+
+    // 重新注册后旧实现的结果不再命中
+    server.addTool("sum", "Replaced sum", "{}",
+        [](const JsonElement&) -> std::expected<JsonString, McpError> { return JsonString("replaced"); },
+        std::chrono::minutes(1));
+    auto replaced = client.callTool("sum", R"({"a":1,"b":2})");
+    ok = ok && require(replaced && replaced.value() == "replaced", "replaced tool served a stale result");
+
+    client.callTool("plain", "{}");
+    client.callTool("plain", "{}");
+    ok = ok && require(plainCalls == 2, "tools without cacheTtl should not be cached");
+
+    const auto stats = server.resultCacheStats();
+    ok = ok && require(stats.hits == 1 && stats.misses == 3 && stats.entries == 3, "server cache stats wrong");
+
+    client.disconnect();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T23-ResultCache PASS\n";
+    return 0;
+}
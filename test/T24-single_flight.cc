@@ -0,0 +1,216 @@
+/**
+ * @file T24-single_flight.cc
+ * @brief 覆盖 McpSingleFlight：并发相同键只执行一次、等待方共享结果、完成后重新执行、
+ *        不同键互不合并、执行方放弃时等待方收到错误、完成时唤醒等待方（等待协程各自回到自己的执行器上，
+ *        执行方不等它们写完），以及执行 / 合并计数。
+ */
+
+#include "galay-mcp/server/McpSingleFlight.h"
+#include "galay-mcp/common/McpExecutor.h"
+
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+// 创建后挂起、投递到执行器上开始运行、结束后自行销毁的协程
+struct Spawned {
+    struct promise_type {
+        Spawned get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+    std::coroutine_handle<> handle;
+};
+
+// 模拟合并请求的连接协程：等待执行方完成，醒来后花一段时间“写出响应”并记录所在线程
+Spawned follow(const McpSingleFlight::Call& call,
+               std::atomic<bool>& registered,
+               std::thread::id& respondedOn,
+               std::atomic<bool>& responded)
+{
+    auto wake = McpWakeSignal::create();
+    call.wakeOnReady(wake);
+    registered.store(true, std::memory_order_release);
+    while (!call.ready()) {
+        co_await wake->wait();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    respondedOn = std::this_thread::get_id();
+    responded.store(true, std::memory_order_release);
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    {
+        McpSingleFlight flights;
+        auto leader = flights.join("read:file:///a");
+        auto follower = flights.join("read:file:///a");
+        auto other = flights.join("read:file:///b");
+        ok = ok && require(leader.leader() && !follower.leader() && other.leader(), "wrong leaders");
+        ok = ok && require(!follower.ready() && flights.stats().inFlight == 2, "follower ready before completion");
+
+        leader.complete(std::string("content-a"));
+        ok = ok && require(follower.ready() && follower.result() == "content-a", "follower did not share the result");
+
+        // 完成之后到达的调用重新执行
+        auto late = flights.join("read:file:///a");
+        ok = ok && require(late.leader(), "completed flight reused");
+        late.complete(std::string("again"));
+        other.complete(std::unexpected(McpError::resourceNotFound("file:///b")));
+
+        const McpSingleFlightStats stats = flights.stats();
+        ok = ok && require(stats.inFlight == 0 && stats.leaders == 3 && stats.coalesced == 1, "unexpected counters");
+    }
+
+    // 执行方未完成就析构：等待方收到错误而不是一直等待
+    {
+        McpSingleFlight flights;
+        McpSingleFlight::Call follower;
+        {
+            auto leader = flights.join("tool");
+            follower = flights.join("tool");
+        }
+        ok = ok && require(follower.ready() && !follower.result() &&
+                           follower.result().error().code() == McpErrorCode::InternalError,
+                           "abandoned flight left the follower waiting");
+        ok = ok && require(flights.join("tool").leader(), "abandoned flight still registered");
+    }
+
+    // 完成（包括放弃）时唤醒登记的等待方；已完成后登记立即通知
+    {
+        McpSingleFlight flights;
+        auto leader = flights.join("wake");
+        auto follower = flights.join("wake");
+        auto wake = McpWakeSignal::create();
+        follower.wakeOnReady(wake);
+        std::thread completer([&leader]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            leader.complete(std::string("done"));
+        });
+        wake->block();
+        completer.join();
+        ok = ok && require(follower.ready() && follower.result() == "done", "woken before completion");
+
+        auto late = McpWakeSignal::create();
+        follower.wakeOnReady(late);
+        late->block();
+
+        McpSingleFlight::Call abandonedFollower;
+        auto abandonedWake = McpWakeSignal::create();
+        {
+            auto abandoned = flights.join("abandoned");
+            abandonedFollower = flights.join("abandoned");
+            abandonedFollower.wakeOnReady(abandonedWake);
+        }
+        abandonedWake->block();
+        ok = ok && require(abandonedFollower.ready() && !abandonedFollower.result(), "abandoned flight did not wake");
+    }
+
+    // 执行方完成时只投递唤醒：每个等待协程回到自己的执行器线程上写出，complete() 不等它们
+    {
+        McpSingleFlight flights;
+        auto leader = flights.join("posted");
+        auto first = flights.join("posted");
+        auto second = flights.join("posted");
+        McpThreadExecutor firstLoop;
+        McpThreadExecutor secondLoop;
+        std::atomic<bool> firstRegistered{false};
+        std::atomic<bool> secondRegistered{false};
+        std::atomic<bool> firstResponded{false};
+        std::atomic<bool> secondResponded{false};
+        std::thread::id firstOn;
+        std::thread::id secondOn;
+        firstLoop.post(follow(first, firstRegistered, firstOn, firstResponded).handle);
+        secondLoop.post(follow(second, secondRegistered, secondOn, secondResponded).handle);
+        ok = ok && require(waitFor([&]() { return firstRegistered.load() && secondRegistered.load(); }),
+                           "followers did not register");
+        const auto completeStart = std::chrono::steady_clock::now();
+        leader.complete(std::string("posted"));
+        const auto completeTook = std::chrono::steady_clock::now() - completeStart;
+        ok = ok && require(completeTook < std::chrono::milliseconds(50), "leader waited for followers to respond");
+        ok = ok && require(waitFor([&]() { return firstResponded.load() && secondResponded.load(); }),
+                           "followers were not resumed");
+        ok = ok && require(firstOn == firstLoop.threadId() && secondOn == secondLoop.threadId(),
+                           "follower resumed off its own executor thread");
+    }
+
+    // 多线程同时请求同一键：只执行一次，全部拿到同一结果，等待方在完成时被唤醒
+    {
+        McpSingleFlight flights;
+        std::atomic<int> executions{0};
+        std::atomic<int> matched{0};
+        std::atomic<bool> start{false};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 16; ++i) {
+            threads.emplace_back([&]() {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                auto call = flights.join("expensive");
+                if (call.leader()) {
+                    ++executions;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    call.complete(std::string("shared"));
+                }
+                auto wake = McpWakeSignal::create();
+                call.wakeOnReady(wake);
+                wake->block();
+                if (call.result() && call.result().value() == "shared") {
+                    ++matched;
+                }
+            });
+        }
+        start.store(true);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        // 个别线程可能在第一次执行完成后才到达并重新执行
+        const McpSingleFlightStats stats = flights.stats();
+        ok = ok && require(matched == 16 && executions >= 1 && executions < 16, "concurrent calls not coalesced");
+        ok = ok && require(stats.leaders == static_cast<uint64_t>(executions.load()) &&
+                           stats.leaders + stats.coalesced == 16, "concurrent counters wrong");
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T24-SingleFlight PASS\n";
+    return 0;
+}
@@ -0,0 +1,229 @@
+/**
+ * @file T25-result_store.cc
+ * @brief 覆盖持久化结果存储 McpResultStore：命中原样返回、过期、重新打开后条目与代次仍在、
+ *        目录独占、尾部残缺记录截断与索引重建、手动与后台压缩、压缩后索引替换失败时仍与新日志一致，
+ *        以及 McpResultCache 持久层跨"重启"命中与替换工具后的代次推进。
+ */
+
+#include "galay-mcp/server/McpResultCache.h"
+#include "galay-mcp/server/McpResultStore.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+McpResultCacheKey Key(std::string_view tool, uint64_t scope, std::string_view arguments)
+{
+    auto document = JsonDocument::Parse(arguments);
+    return McpResultCache::makeKey(tool, scope, document.value().Root());
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    using namespace std::chrono_literals;
+    namespace fs = std::filesystem;
+
+    const fs::path directory = fs::temp_directory_path() / ("galay-mcp-t25-" + std::to_string(::getpid()));
+    fs::remove_all(directory);
+    const auto later = McpResultStore::Clock::now() + 1h;
+    const std::string key = Key("index", 0, R"({"path":"src"})").text;
+    const std::string value = R"({"content":[{"type":"text","text":"42 symbols"}]})";
+
+    // 命中返回写入时的字节；未知键与过期条目未命中；代次默认 0
+    {
+        auto store = McpResultStore::open(directory.string());
+        if (!require(store.has_value(), "open failed")) {
+            return 1;
+        }
+        ok = ok && require((*store)->store(key, value, later), "store failed");
+        auto hit = (*store)->find(key);
+        ok = ok && require(hit && hit->result == value, "stored entry not returned verbatim");
+        ok = ok && require(!(*store)->find("missing"), "unknown key hit");
+        (*store)->store("short", "{}", McpResultStore::Clock::now() - 1s);
+        ok = ok && require(!(*store)->find("short"), "expired entry hit");
+        ok = ok && require((*store)->generation("index") == 0, "default generation should be 0");
+        (*store)->setGeneration("index", 3);
+
+        // 同一目录不能被第二个实例打开
+        ok = ok && require(!McpResultStore::open(directory.string()).has_value(), "directory opened twice");
+    }
+
+    // 重新打开：条目与代次仍在，不扫描日志即可查找
+    {
+        auto store = McpResultStore::open(directory.string());
+        ok = ok && require(store.has_value(), "reopen failed");
+        if (store) {
+            auto hit = (*store)->find(key);
+            ok = ok && require(hit && hit->result == value, "entry lost across reopen");
+            ok = ok && require((*store)->generation("index") == 3, "generation lost across reopen");
+        }
+    }
+
+    // 尾部写了一半的记录被截掉；索引丢失时从日志重建
+    {
+        const fs::path log = directory / "results.log";
+        const auto size = fs::file_size(log);
+        {
+            std::ofstream tail(log, std::ios::binary | std::ios::app);
+            tail << "partial-record";
+        }
+        fs::remove(directory / "results.idx");
+        auto store = McpResultStore::open(directory.string());
+        ok = ok && require(store.has_value(), "open after crash failed");
+        if (store) {
+            auto hit = (*store)->find(key);
+            ok = ok && require(hit && hit->result == value, "entry lost after index rebuild");
+            ok = ok && require((*store)->generation("index") == 3, "generation lost after index rebuild");
+            ok = ok && require(fs::file_size(log) == size, "partial tail not truncated");
+        }
+    }
+
+    // 压缩：覆盖写入、过期与旧代次的记录被丢弃，有效条目保留
+    {
+        auto store = McpResultStore::open(directory.string());
+        if (!require(store.has_value(), "open for compaction failed")) {
+            return 1;
+        }
+        (*store)->clear();
+        const std::string current = Key("index", 1, R"({"path":"src"})").text;
+        const std::string stale = Key("index", 0, R"({"path":"src"})").text;
+        (*store)->store(stale, value, later);
+        for (int i = 0; i < 100; ++i) {
+            (*store)->store(current, "version-" + std::to_string(i), later);
+        }
+        (*store)->store("expiring", value, McpResultStore::Clock::now() + 50ms);
+        (*store)->setGeneration("index", 1);
+        std::this_thread::sleep_for(100ms);
+
+        const auto before = (*store)->stats();
+        ok = ok && require((*store)->compact().has_value(), "compaction failed");
+        const auto after = (*store)->stats();
+        ok = ok && require(after.logBytes < before.logBytes / 4 && after.logBytes - after.liveBytes < 64,
+                           "compaction did not reclaim dead records");
+        ok = ok && require(after.entries == 1 && after.compactions == 1, "compaction kept dead entries");
+        auto hit = (*store)->find(current);
+        ok = ok && require(hit && hit->result == "version-99", "compaction lost the latest value");
+        ok = ok && require(!(*store)->find(stale) && (*store)->generation("index") == 1,
+                           "stale generation survived compaction");
+    }
+    {
+        auto store = McpResultStore::open(directory.string());
+        auto hit = store ? (*store)->find(Key("index", 1, R"({"path":"src"})").text) : std::nullopt;
+        ok = ok && require(hit && hit->result == "version-99", "compacted store did not reopen");
+    }
+
+    // 后台压缩：失效记录过半且日志超过阈值时自动进行
+    {
+        McpResultStoreOptions options;
+        options.compactMinBytes = 4096;
+        auto store = McpResultStore::open(directory.string(), options);
+        if (!require(store.has_value(), "open for background compaction failed")) {
+            return 1;
+        }
+        const std::string payload(256, 'x');
+        for (int i = 0; i < 200; ++i) {
+            (*store)->store("hot", payload + std::to_string(i), later);
+        }
+        for (int i = 0; i < 200 && (*store)->stats().compactions == 0; ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        ok = ok && require((*store)->stats().compactions > 0, "background compaction did not run");
+        auto hit = (*store)->find("hot");
+        ok = ok && require(hit && hit->result == payload + "199", "background compaction lost the latest value");
+    }
+
+    // 压缩替换日志后索引无法替换（results.idx 被非空目录占据）：返回错误，但查找与写入仍对应新日志，重新打开后从日志重建
+    {
+        auto store = McpResultStore::open(directory.string());
+        if (!require(store.has_value(), "open for failed compaction failed")) {
+            return 1;
+        }
+        (*store)->clear();
+        for (int i = 0; i < 50; ++i) {
+            (*store)->store("hot", "version-" + std::to_string(i), later);
+        }
+        (*store)->setGeneration("index", 2);
+        const fs::path index = directory / "results.idx";
+        fs::remove(index);
+        fs::create_directory(index);
+        std::ofstream(index / "occupied") << "x";
+
+        ok = ok && require(!(*store)->compact().has_value(), "compaction should report the index failure");
+        auto hit = (*store)->find("hot");
+        ok = ok && require(hit && hit->result == "version-49", "entry lost after failed index install");
+        ok = ok && require((*store)->store("after", value, later), "store failed after failed index install");
+        hit = (*store)->find("after");
+        ok = ok && require(hit && hit->result == value, "entry written after failed index install missing");
+        ok = ok && require((*store)->generation("index") == 2 && (*store)->stats().entries == 2,
+                           "index does not match the compacted log");
+        store->reset();
+        fs::remove_all(index);
+    }
+    {
+        auto store = McpResultStore::open(directory.string());
+        auto hit = store ? (*store)->find("after") : std::nullopt;
+        ok = ok && require(hit && hit->result == value, "entry written after failed index install lost on reopen");
+        hit = store ? (*store)->find("hot") : std::nullopt;
+        ok = ok && require(hit && hit->result == "version-49" && (*store)->generation("index") == 2,
+                           "compacted log not rebuilt on reopen");
+    }
+
+    // McpResultCache：持久层在新实例中命中并放回内存；进程内替换工具推进代次
+    fs::remove_all(directory);
+    McpResultCacheOptions options;
+    options.persistentPath = directory.string();
+    {
+        McpResultCache cache;
+        ok = ok && require(cache.setOptions(options).has_value(), "cache failed to open its store");
+        const auto cacheKey = Key("index", cache.newScope("index"), R"({"path":"src"})");
+        cache.store(cacheKey, value, 1h);
+    }
+    {
+        McpResultCache cache;
+        ok = ok && require(cache.setOptions(options).has_value(), "cache failed to reopen its store");
+        const uint64_t scope = cache.newScope("index");
+        ok = ok && require(cache.find(Key("index", scope, R"({ "path" : "src" })")) == value,
+                           "persisted result not served after restart");
+        ok = ok && require(cache.find(Key("index", scope, R"({"path":"src"})")) == value, "promoted entry missing");
+        auto stats = cache.stats();
+        ok = ok && require(stats.hits == 2 && stats.persistentHits == 1 && stats.entries == 1,
+                           "persistent hit not promoted to memory");
+
+        const uint64_t replaced = cache.newScope("index");
+        ok = ok && require(replaced == scope + 1 && !cache.find(Key("index", replaced, R"({"path":"src"})")),
+                           "replaced tool served a persisted result");
+    }
+    {
+        McpResultCache cache;
+        ok = ok && require(cache.setOptions(options).has_value() && cache.newScope("index") == 1,
+                           "replacement generation not persisted");
+    }
+
+    fs::remove_all(directory);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T25-ResultStore PASS\n";
+    return 0;
+}
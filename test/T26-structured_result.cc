@@ -0,0 +1,128 @@
+/**
+ * @file T26-structured_result.cc
+ * @brief 覆盖结构化工具结果：outputSchema 出现在 tools/list 中，处理函数返回的 JSON 对象原样作为
+ *        structuredContent 写出（不转义为文本，多行输出被压成单行），callToolStructured 直接取得
+ *        解析后的元素，非对象输出返回错误，未声明 outputSchema 的工具仍返回文本内容。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+
+    // 序列化：structuredContent 原样嵌入，其中的引号与反斜杠不再被转义
+    {
+        ToolCallResult result;
+        result.structuredContent = R"({"path":"C:\\src","quote":"\"x\""})";
+        ok = ok && require(result.toJson() == R"({"content":[],"structuredContent":{"path":"C:\\src","quote":"\"x\""}})",
+                           "structuredContent was not embedded verbatim");
+    }
+
+    const std::string name = "/galay-mcp-t26-" + std::to_string(::getpid());
+    auto serverChannel = McpShmChannel::create(name);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+
+    const JsonString outputSchema = R"({"type":"object","properties":{"count":{"type":"integer"}}})";
+    McpStdioServer server;
+    server.addStructuredTool("symbols", "List symbols", "{}", outputSchema,
+        [](const JsonElement&) -> std::expected<JsonString, McpError> {
+            // 多行输出：按行分帧时服务端压成单行
+            return JsonString("{\n  \"count\": 2,\n  \"names\": [\"main\", \"a\\\"b\"]\n}");
+        });
+    server.addStructuredTool("broken", "Returns a non-object", "{}", outputSchema,
+        [](const JsonElement&) -> std::expected<JsonString, McpError> { return JsonString("[1,2]"); });
+    server.addTool("plain", "Text tool", "{}",
+        [](const JsonElement&) -> std::expected<JsonString, McpError> { return JsonString("{\"as\":\"text\"}"); });
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    McpStdioClient client;
+    auto clientChannel = McpShmChannel::open(name);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel") ||
+        !require(client.attach(std::move(clientChannel.value())).has_value(), "attach failed")) {
+        return 1;
+    }
+    ok = ok && require(client.initialize("t26-client", "1.0.0").has_value(), "initialize failed");
+
+    auto tools = client.listTools();
+    bool declared = false;
+    bool undeclared = false;
+    if (tools) {
+        for (const auto& tool : tools.value()) {
+            if (tool.name == "symbols") {
+                declared = tool.outputSchema == outputSchema;
+            } else if (tool.name == "plain") {
+                undeclared = tool.outputSchema.empty();
+            }
+        }
+    }
+    ok = ok && require(declared && undeclared, "outputSchema not listed as registered");
+
+    auto structured = client.callToolStructured("symbols", "{}");
+    ok = ok && require(structured.has_value(), "structured call failed");
+    if (structured) {
+        JsonObject object;
+        JsonArray names;
+        int64_t count = 0;
+        ok = ok && require(JsonHelper::GetObject(structured->structuredContent, object) &&
+                           JsonHelper::GetInt64(object, "count", count) && count == 2 &&
+                           JsonHelper::GetArray(object, "names", names), "structuredContent not an object");
+        std::string second;
+        size_t index = 0;
+        for (auto item : names) {
+            if (index++ == 1) {
+                second = std::string(item.get_string().value_unsafe());
+            }
+        }
+        ok = ok && require(second == "a\"b", "string inside structuredContent altered");
+    }
+
+    // 文本接口返回 structuredContent 的 JSON 文本
+    auto text = client.callTool("symbols", "{}");
+    ok = ok && require(text && text->find("\"count\"") != std::string::npos && text->find('\n') == std::string::npos,
+                       "callTool did not return the structured JSON");
+
+    auto broken = client.callToolStructured("broken", "{}");
+    ok = ok && require(!broken && broken.error().code() == McpErrorCode::InternalError,
+                       "non-object structured output should fail");
+
+    auto plain = client.callToolStructured("plain", "{}");
+    ok = ok && require(!plain, "text tool should not yield structuredContent");
+    auto plainText = client.callTool("plain", "{}");
+    ok = ok && require(plainText && plainText.value() == "{\"as\":\"text\"}", "text tool result changed");
+
+    client.disconnect();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T26-StructuredResult PASS\n";
+    return 0;
+}
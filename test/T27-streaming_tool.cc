@@ -0,0 +1,365 @@
+/**
+ * @file T27-streaming_tool.cc
+ * @brief 覆盖流式工具输出：McpContentWriter 按任意边界切分写入时编码结果不变、输出函数拒绝后停止写入；
+ *        按行分帧的 stdio 服务端把处理函数的输出直接写进响应（大于一个刷出块、含需转义字符），
+ *        中途失败时以 isError 结束已开始的响应（未刷出的缓冲内容丢弃），写出前失败时返回 JSON-RPC 错误；
+ *        流式响应写出期间读取线程继续处理 ping 与其他调用，它们的响应排在该响应之后；处理函数在写出后抛出
+ *        非 std::exception 异常时响应以 isError 结束并释放输出行；进程内调用收集原始文本。
+ */
+
+#include "galay-mcp/common/McpContentWriter.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+// 含引号、反斜杠、换行与控制字符，覆盖分块边界落在转义序列上的情况
+std::string makeText(size_t size)
+{
+    const std::string_view pattern = "line \"q\" \\ tab\t\x01 end\n";
+    std::string text;
+    while (text.size() < size) {
+        text += pattern;
+    }
+    text.resize(size);
+    return text;
+}
+
+std::expected<void, McpError> writeInPieces(McpContentWriter& writer, const std::string& text, size_t piece)
+{
+    for (size_t offset = 0; offset < text.size(); offset += piece) {
+        if (!writer.write(std::string_view(text).substr(offset, piece))) {
+            return std::unexpected(McpError::requestCancelled("writer refused"));
+        }
+    }
+    return {};
+}
+
+struct Response {
+    int64_t id = 0;
+    bool hasError = false;
+    bool isError = false;
+    std::vector<std::string> texts;
+};
+
+bool parseResponse(const std::string& line, Response& out)
+{
+    auto document = JsonDocument::Parse(line);
+    if (!document) {
+        return false;
+    }
+    JsonObject root;
+    if (!JsonHelper::GetObject(document->Root(), root) || !JsonHelper::GetInt64(root, "id", out.id)) {
+        return false;
+    }
+    JsonObject error;
+    if (JsonHelper::GetObject(root, "error", error)) {
+        out.hasError = true;
+        return true;
+    }
+    JsonObject result;
+    JsonArray content;
+    if (!JsonHelper::GetObject(root, "result", result)) {
+        return false;
+    }
+    if (!JsonHelper::GetArray(result, "content", content)) {
+        return true; // initialize 等非工具结果
+    }
+    JsonHelper::GetBool(result, "isError", out.isError);
+    for (auto item : content) {
+        JsonObject object;
+        std::string text;
+        if (!JsonHelper::GetObject(item, object) || !JsonHelper::GetString(object, "text", text)) {
+            return false;
+        }
+        out.texts.push_back(std::move(text));
+    }
+    return true;
+}
+
+// 读取方在没有数据时阻塞，close() 之后返回 EOF；模拟保持打开的 stdin
+class BlockingInput : public std::streambuf {
+public:
+    void feed(const std::string& bytes) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending += bytes;
+        }
+        m_changed.notify_all();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_changed.notify_all();
+    }
+
+protected:
+    int_type underflow() override {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this]() { return m_closed || !m_pending.empty(); });
+        if (m_pending.empty()) {
+            return traits_type::eof();
+        }
+        m_current.swap(m_pending);
+        m_pending.clear();
+        setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+        return traits_type::to_int_type(m_current[0]);
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::string m_pending;
+    std::string m_current;
+    bool m_closed = false;
+};
+
+std::vector<Response> parseLines(const std::string& output, bool& ok)
+{
+    std::vector<Response> responses;
+    std::istringstream lines(output);
+    std::string line;
+    while (std::getline(lines, line)) {
+        if (line.find("\"method\"") != std::string::npos && line.find("\"id\"") == std::string::npos) {
+            continue; // 通知
+        }
+        Response response;
+        ok = ok && require(parseResponse(line, response), "response line is not valid JSON-RPC");
+        responses.push_back(std::move(response));
+    }
+    return responses;
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    const std::string text = makeText(200 * 1024 + 17);
+
+    // 编码：小刷出块、不同写入粒度下拼接结果都等于整体转义
+    {
+        std::string expected;
+        JsonWriter::AppendEscaped(expected, text);
+        for (size_t piece : {size_t(1), size_t(7), size_t(4096), text.size()}) {
+            std::string encoded;
+            size_t chunks = 0;
+            McpContentWriter writer(McpContentEncoding::JsonString, [&](std::string_view chunk) {
+                encoded.append(chunk);
+                ++chunks;
+                return true;
+            }, 1000);
+            ok = ok && require(writeInPieces(writer, text, piece).has_value() && writer.flush(), "writer failed");
+            ok = ok && require(encoded == expected && chunks > 1, "chunked encoding differs from escaping the whole");
+            ok = ok && require(writer.bytesWritten() == text.size(), "bytesWritten mismatch");
+        }
+    }
+
+    // 输出函数拒绝后停止写入
+    {
+        size_t calls = 0;
+        McpContentWriter writer(McpContentEncoding::Raw, [&](std::string_view) { return ++calls < 2; }, 16);
+        ok = ok && require(!writeInPieces(writer, text, 100).has_value() && writer.failed() && calls == 2,
+                           "writer kept writing after the output refused");
+    }
+
+    McpStdioServer server;
+    server.addStreamingTool("dump", "Dump text", "{}",
+        [&text](const JsonElement&, const McpToolContext&, McpContentWriter& writer) {
+            return writeInPieces(writer, text, 3000);
+        });
+    server.addStreamingTool("partial", "Fails after writing", "{}",
+        [&text](const JsonElement&, const McpToolContext&, McpContentWriter& writer) -> std::expected<void, McpError> {
+            auto written = writeInPieces(writer, text, 8192);
+            if (!written) {
+                return written;
+            }
+            return std::unexpected(McpError::internalError("disk gone"));
+        });
+    server.addStreamingTool("early", "Fails before writing", "{}",
+        [](const JsonElement&, const McpToolContext&, McpContentWriter& writer) -> std::expected<void, McpError> {
+            writer.write("short");
+            return std::unexpected(McpError::internalError("bad input"));
+        });
+
+    // 进程内调用：原始文本，不经过 JSON 转义
+    auto local = server.localCallTool("dump", JsonElement());
+    ok = ok && require(local && local.value() == text, "in-process call did not collect the raw text");
+
+    std::istringstream input(
+        R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t27","version":"1.0.0"}}})" "\n"
+        R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"dump","arguments":{}}})" "\n"
+        R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"partial","arguments":{}}})" "\n"
+        R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"early","arguments":{}}})" "\n");
+    std::ostringstream output;
+    std::streambuf* savedIn = std::cin.rdbuf(input.rdbuf());
+    std::streambuf* savedOut = std::cout.rdbuf(output.rdbuf());
+    server.run();
+    std::cin.rdbuf(savedIn);
+    std::cout.rdbuf(savedOut);
+
+    std::vector<Response> responses = parseLines(output.str(), ok);
+    ok = ok && require(responses.size() == 4, "expected one response line per request");
+    if (responses.size() == 4) {
+        const Response& dump = responses[1];
+        ok = ok && require(dump.id == 2 && !dump.isError && dump.texts.size() == 1 && dump.texts[0] == text,
+                           "streamed text differs from the handler output");
+        const Response& partial = responses[2];
+        ok = ok && require(partial.id == 3 && partial.isError && partial.texts.size() == 2 &&
+                           !partial.texts[0].empty() && text.starts_with(partial.texts[0]) &&
+                           partial.texts[1].find("disk gone") != std::string::npos,
+                           "mid-stream failure did not end the response with isError");
+        const Response& early = responses[3];
+        ok = ok && require(early.id == 4 && early.hasError, "failure before the first block should be a JSON-RPC error");
+    }
+
+    // 流式响应写出期间：读取线程继续读取并回应 ping，工作线程上的其他调用照常执行，
+    // 它们的响应排队到流式响应结束后写出，不插入响应行中
+    {
+        McpStdioServer concurrent;
+        concurrent.setToolWorkers(2);
+        std::mutex markMutex;
+        std::condition_variable markChanged;
+        bool marked = false;
+        std::atomic<bool> started{false};
+        std::atomic<bool> streamed{false};
+        concurrent.addStreamingTool("slow", "Waits for mark mid-stream", "{}",
+            [&](const JsonElement&, const McpToolContext&, McpContentWriter& writer) -> std::expected<void, McpError> {
+                // 先写满一块，让响应开始写出并占用输出行
+                auto first = writeInPieces(writer, text.substr(0, 100 * 1024), 4096);
+                if (!first) {
+                    return first;
+                }
+                started.store(true);
+                bool seen = false;
+                {
+                    std::unique_lock<std::mutex> lock(markMutex);
+                    seen = markChanged.wait_for(lock, std::chrono::seconds(5), [&]() { return marked; });
+                }
+                if (!seen) {
+                    streamed.store(true);
+                    return std::unexpected(McpError::internalError("mark never ran while streaming"));
+                }
+                auto rest = writeInPieces(writer, text.substr(100 * 1024), 4096);
+                // 全部内容写出后才允许测试关闭输入，之后只剩不受取消影响的响应结尾
+                writer.flush();
+                streamed.store(true);
+                return rest;
+            });
+        concurrent.addTool("mark", "Releases slow", "{}",
+            [&](const JsonElement&) -> std::expected<JsonString, McpError> {
+                {
+                    std::lock_guard<std::mutex> lock(markMutex);
+                    marked = true;
+                }
+                markChanged.notify_all();
+                return JsonString("marked");
+            });
+
+        BlockingInput blocking;
+        std::ostringstream concurrentOutput;
+        std::streambuf* inBefore = std::cin.rdbuf(&blocking);
+        std::streambuf* outBefore = std::cout.rdbuf(concurrentOutput.rdbuf());
+        std::thread reader([&concurrent]() { concurrent.run(); });
+        blocking.feed(
+            R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t27","version":"1.0.0"}}})" "\n"
+            R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"slow","arguments":{}}})" "\n");
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!started.load() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        blocking.feed(
+            R"({"jsonrpc":"2.0","id":3,"method":"ping"})" "\n"
+            R"({"jsonrpc":"2.0","id":4,"method":"tools/call","params":{"name":"mark","arguments":{}}})" "\n");
+        while (!streamed.load() && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // 输入 EOF 会取消进行中的调用，等 slow 写完再关闭
+        blocking.close();
+        reader.join();
+        std::cin.rdbuf(inBefore);
+        std::cout.rdbuf(outBefore);
+
+        std::vector<Response> ordered = parseLines(concurrentOutput.str(), ok);
+        ok = ok && require(ordered.size() == 4, "expected one response line per concurrent request");
+        if (ordered.size() == 4) {
+            ok = ok && require(ordered[1].id == 2 && !ordered[1].isError && ordered[1].texts.size() == 1 &&
+                               ordered[1].texts[0] == text,
+                               "ping or mark was blocked behind the streamed response");
+            ok = ok && require((ordered[2].id == 3 && ordered[3].id == 4) || (ordered[2].id == 4 && ordered[3].id == 3),
+                               "queued responses were not written after the streamed response");
+        }
+    }
+
+    // 写出一块后抛出非 std::exception 的异常：响应以 isError 结束，输出行被释放，
+    // 之后的流式响应与 ping 照常写出
+    {
+        McpStdioServer throwing;
+        throwing.addStreamingTool("throws", "Throws a non-std exception mid-stream", "{}",
+            [&text](const JsonElement&, const McpToolContext&, McpContentWriter& writer) -> std::expected<void, McpError> {
+                auto written = writeInPieces(writer, text.substr(0, 100 * 1024), 4096);
+                if (!written) {
+                    return written;
+                }
+                throw 42;
+            });
+        throwing.addStreamingTool("dump", "Dump text", "{}",
+            [&text](const JsonElement&, const McpToolContext&, McpContentWriter& writer) {
+                return writeInPieces(writer, text, 3000);
+            });
+
+        std::istringstream throwingInput(
+            R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t27","version":"1.0.0"}}})" "\n"
+            R"({"jsonrpc":"2.0","id":2,"method":"tools/call","params":{"name":"throws","arguments":{}}})" "\n"
+            R"({"jsonrpc":"2.0","id":3,"method":"tools/call","params":{"name":"dump","arguments":{}}})" "\n"
+            R"({"jsonrpc":"2.0","id":4,"method":"ping"})" "\n");
+        std::ostringstream throwingOutput;
+        std::streambuf* inBefore = std::cin.rdbuf(throwingInput.rdbuf());
+        std::streambuf* outBefore = std::cout.rdbuf(throwingOutput.rdbuf());
+        throwing.run();
+        std::cin.rdbuf(inBefore);
+        std::cout.rdbuf(outBefore);
+
+        std::vector<Response> lines = parseLines(throwingOutput.str(), ok);
+        ok = ok && require(lines.size() == 4, "expected one response line per request after a throwing stream");
+        if (lines.size() == 4) {
+            ok = ok && require(lines[1].id == 2 && lines[1].isError && lines[1].texts.size() == 2 &&
+                               lines[1].texts[1].find("Unknown exception") != std::string::npos,
+                               "non-std exception did not end the streamed response with isError");
+            ok = ok && require(lines[2].id == 3 && !lines[2].isError && lines[2].texts.size() == 1 &&
+                               lines[2].texts[0] == text,
+                               "stream after a throwing handler did not complete");
+            ok = ok && require(lines[3].id == 4 && !lines[3].hasError, "ping after a throwing stream was lost");
+        }
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T27-StreamingTool PASS\n";
+    return 0;
+}
@@ -0,0 +1,230 @@
+/**
+ * @file T28-streaming_resource.cc
+ * @brief 覆盖分块读取的资源：McpContentWriter 的 base64 编码与写入切分无关；按行分帧的 stdio 服务端
+ *        把文本资源边转义边写出、二进制资源边编码边写为 blob，部分写出后失败时 result 带 isError；
+ *        经共享内存通道（收集后写出）读取时客户端取得原始文本与解码后的字节；进程内读取返回原始字节。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpContentWriter.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+// 全部 256 个字节值，长度不是 3 的倍数
+std::string makeBytes(size_t size)
+{
+    std::string bytes(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<char>((i * 131 + 7) & 0xff);
+    }
+    return bytes;
+}
+
+std::string makeText(size_t size)
+{
+    const std::string_view pattern = "log \"entry\" C:\\path\n";
+    std::string text;
+    while (text.size() < size) {
+        text += pattern;
+    }
+    text.resize(size);
+    return text;
+}
+
+std::expected<void, McpError> writeInPieces(McpContentWriter& writer, const std::string& data, size_t piece)
+{
+    for (size_t offset = 0; offset < data.size(); offset += piece) {
+        if (!writer.write(std::string_view(data).substr(offset, piece))) {
+            return std::unexpected(McpError::requestCancelled("writer refused"));
+        }
+    }
+    return {};
+}
+
+struct ReadResponse {
+    int64_t id = 0;
+    bool hasError = false;
+    bool isError = false;
+    std::string metaError;
+    std::string uri;
+    std::string text;
+    std::string blob;
+};
+
+bool parseReadResponse(const std::string& line, ReadResponse& out)
+{
+    auto document = JsonDocument::Parse(line);
+    JsonObject root;
+    if (!document || !JsonHelper::GetObject(document->Root(), root) || !JsonHelper::GetInt64(root, "id", out.id)) {
+        return false;
+    }
+    JsonObject error;
+    if (JsonHelper::GetObject(root, "error", error)) {
+        out.hasError = true;
+        return true;
+    }
+    JsonObject result;
+    if (!JsonHelper::GetObject(root, "result", result)) {
+        return false;
+    }
+    JsonHelper::GetBool(result, "isError", out.isError);
+    JsonObject meta;
+    if (JsonHelper::GetObject(result, "_meta", meta)) {
+        JsonHelper::GetString(meta, "error", out.metaError);
+    }
+    JsonArray contents;
+    if (!JsonHelper::GetArray(result, "contents", contents)) {
+        return true; // initialize 等非资源结果
+    }
+    for (auto item : contents) {
+        JsonObject object;
+        if (!JsonHelper::GetObject(item, object) || !JsonHelper::GetString(object, "uri", out.uri)) {
+            return false;
+        }
+        JsonHelper::GetString(object, "text", out.text);
+        JsonHelper::GetString(object, "blob", out.blob);
+    }
+    return true;
+}
+
+void registerResources(McpStdioServer& server, const std::string& text, const std::string& bytes)
+{
+    server.addStreamingResource("file:///app.log", "app.log", "Log", "text/plain",
+        [&text](const std::string&, McpContentWriter& writer) { return writeInPieces(writer, text, 5000); });
+    server.addStreamingResource("file:///image.bin", "image.bin", "Binary", "application/octet-stream",
+        [&bytes](const std::string&, McpContentWriter& writer) { return writeInPieces(writer, bytes, 4001); },
+        true);
+    server.addStreamingResource("file:///broken.log", "broken.log", "Fails midway", "text/plain",
+        [&text](const std::string&, McpContentWriter& writer) -> std::expected<void, McpError> {
+            auto written = writeInPieces(writer, text, 8192);
+            if (!written) {
+                return written;
+            }
+            return std::unexpected(McpError::internalError("disk gone"));
+        });
+}
+
+} // namespace
+
+int main()
+{
+    bool ok = true;
+    const std::string text = makeText(300 * 1024 + 5);
+    const std::string bytes = makeBytes(200 * 1024 + 2);
+
+    // base64：小刷出块、不同写入粒度下拼接结果都等于整体编码，flush() 补齐填充
+    {
+        const std::string expected = encoding::base64Encode(bytes);
+        for (size_t piece : {size_t(1), size_t(2), size_t(5), size_t(4096), bytes.size()}) {
+            std::string encoded;
+            McpContentWriter writer(McpContentEncoding::Base64, [&](std::string_view chunk) {
+                encoded.append(chunk);
+                return true;
+            }, 1000);
+            ok = ok && require(writeInPieces(writer, bytes, piece).has_value() && writer.flush(), "writer failed");
+            ok = ok && require(encoded == expected, "chunked base64 differs from encoding the whole");
+        }
+    }
+
+    // 按行分帧：直接写出
+    {
+        McpStdioServer server;
+        registerResources(server, text, bytes);
+
+        auto local = server.localReadResource("file:///image.bin");
+        ok = ok && require(local && local.value() == bytes, "in-process read did not return the raw bytes");
+
+        std::istringstream input(
+            R"({"jsonrpc":"2.0","id":1,"method":"initialize","params":{"protocolVersion":"2024-11-05","capabilities":{},"clientInfo":{"name":"t28","version":"1.0.0"}}})" "\n"
+            R"({"jsonrpc":"2.0","id":2,"method":"resources/read","params":{"uri":"file:///app.log"}})" "\n"
+            R"({"jsonrpc":"2.0","id":3,"method":"resources/read","params":{"uri":"file:///image.bin"}})" "\n"
+            R"({"jsonrpc":"2.0","id":4,"method":"resources/read","params":{"uri":"file:///broken.log"}})" "\n");
+        std::ostringstream output;
+        std::streambuf* savedIn = std::cin.rdbuf(input.rdbuf());
+        std::streambuf* savedOut = std::cout.rdbuf(output.rdbuf());
+        server.run();
+        std::cin.rdbuf(savedIn);
+        std::cout.rdbuf(savedOut);
+
+        std::vector<ReadResponse> responses;
+        std::istringstream lines(output.str());
+        std::string line;
+        while (std::getline(lines, line)) {
+            if (line.find("\"method\"") != std::string::npos && line.find("\"id\"") == std::string::npos) {
+                continue; // 通知
+            }
+            ReadResponse response;
+            ok = ok && require(parseReadResponse(line, response), "response line is not valid JSON-RPC");
+            responses.push_back(std::move(response));
+        }
+        ok = ok && require(responses.size() == 4, "expected one response line per request");
+        if (responses.size() == 4) {
+            ok = ok && require(responses[1].id == 2 && responses[1].uri == "file:///app.log" &&
+                               responses[1].text == text, "streamed text resource differs");
+            auto decoded = encoding::base64Decode(responses[2].blob);
+            ok = ok && require(responses[2].id == 3 && responses[2].text.empty() && decoded && decoded.value() == bytes,
+                               "streamed blob differs from the resource bytes");
+            ok = ok && require(responses[3].id == 4 && responses[3].isError &&
+                               responses[3].metaError.find("disk gone") != std::string::npos,
+                               "mid-stream failure did not mark the result with isError");
+        }
+    }
+
+    // 共享内存通道：收集后写出，客户端解码 blob
+    {
+        const std::string name = "/galay-mcp-t28-" + std::to_string(::getpid());
+        auto serverChannel = McpShmChannel::create(name);
+        if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+            return 1;
+        }
+        McpStdioServer server;
+        registerResources(server, text, bytes);
+        server.setChannel(std::move(serverChannel.value()));
+        std::thread serverThread([&server]() { server.run(); });
+
+        McpStdioClient client;
+        auto clientChannel = McpShmChannel::open(name);
+        if (!require(clientChannel.has_value(), "failed to open shared memory channel") ||
+            !require(client.attach(std::move(clientChannel.value())).has_value(), "attach failed")) {
+            return 1;
+        }
+        ok = ok && require(client.initialize("t28-client", "1.0.0").has_value(), "initialize failed");
+
+        auto log = client.readResource("file:///app.log");
+        ok = ok && require(log && log.value() == text, "collected text resource differs");
+        auto image = client.readResource("file:///image.bin");
+        ok = ok && require(image && image.value() == bytes, "client did not decode the blob");
+        auto broken = client.readResource("file:///broken.log");
+        ok = ok && require(!broken, "failed read should return an error");
+
+        client.disconnect();
+        serverThread.join();
+    }
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T28-StreamingResource PASS\n";
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file T29-process_recovery.cc
+ * @brief 托管 T2-stdio_server 子进程并让其在 tools/call 中崩溃：客户端重启子进程但不重放该调用
+ *        （返回 ConnectionClosed，工具只执行一次），后续幂等请求正常；声明为 replayableTools 的工具重放一次；
+ *        options.env 覆盖同名的继承变量、追加新变量。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+size_t countLines(const std::string& path)
+{
+    std::ifstream file(path);
+    size_t lines = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        ++lines;
+    }
+    return lines;
+}
+
+McpStdioProcessOptions makeOptions(const char* executable, const std::string& crashLog)
+{
+    McpStdioProcessOptions options;
+    options.executable = executable;
+    options.env.push_back("T2_CRASH_LOG=" + crashLog);
+    options.stderrHandler = [](std::string_view) {};
+    return options;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <path-to-T2-stdio_server>\n";
+        return 1;
+    }
+
+    bool ok = true;
+    const std::string crashLog = "/tmp/galay-mcp-t29-" + std::to_string(::getpid()) + ".log";
+
+    // 默认：tools/call 不重放
+    {
+        std::remove(crashLog.c_str());
+        McpStdioClient client;
+        if (!require(client.spawn(makeOptions(argv[1], crashLog)).has_value(), "spawn failed")) {
+            return 1;
+        }
+        ok = ok && require(client.initialize("t29-client", "1.0.0").has_value(), "initialize failed");
+
+        auto crashed = client.callTool("crash", "{}");
+        ok = ok && require(!crashed && crashed.error().code() == McpErrorCode::ConnectionClosed,
+                           "crashed call should fail with ConnectionClosed");
+        ok = ok && require(countLines(crashLog) == 1, "non-idempotent tools/call was replayed after restart");
+
+        auto tools = client.listTools();
+        ok = ok && require(tools.has_value() && !tools.value().empty(), "tools/list after restart failed");
+        ok = ok && require(client.ping().has_value(), "ping after restart failed");
+        client.disconnect();
+    }
+
+    // 调用方声明为可重放的工具：重启后重试一次
+    {
+        std::remove(crashLog.c_str());
+        auto options = makeOptions(argv[1], crashLog);
+        options.replayableTools.push_back("crash");
+        McpStdioClient client;
+        if (!require(client.spawn(std::move(options)).has_value(), "spawn failed")) {
+            return 1;
+        }
+        ok = ok && require(client.initialize("t29-client", "1.0.0").has_value(), "initialize failed");
+
+        auto crashed = client.callTool("crash", "{}");
+        ok = ok && require(!crashed, "crashing tool should still fail after one replay");
+        ok = ok && require(countLines(crashLog) == 2, "replayable tool was not retried exactly once");
+        client.disconnect();
+    }
+
+    // 环境变量：同名的继承变量被覆盖，新变量追加，其余照常继承
+    {
+        ::setenv("T29_OVERRIDDEN", "inherited", 1);
+        ::setenv("T29_INHERITED", "kept", 1);
+        auto options = makeOptions(argv[1], crashLog);
+        options.env.push_back("T29_OVERRIDDEN=custom");
+        McpStdioClient client;
+        if (!require(client.spawn(std::move(options)).has_value(), "spawn failed")) {
+            return 1;
+        }
+        ok = ok && require(client.initialize("t29-client", "1.0.0").has_value(), "initialize failed");
+        auto overridden = client.callTool("getenv", R"({"name":"T29_OVERRIDDEN"})");
+        ok = ok && require(overridden && overridden.value() == "custom", "options.env did not override the inherited variable");
+        auto inherited = client.callTool("getenv", R"({"name":"T29_INHERITED"})");
+        ok = ok && require(inherited && inherited.value() == "kept", "inherited variable was dropped");
+        auto added = client.callTool("getenv", R"({"name":"T2_CRASH_LOG"})");
+        ok = ok && require(added && added.value() == crashLog, "new variable was not added");
+        client.disconnect();
+    }
+
+    std::remove(crashLog.c_str());
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T29-ProcessRecovery PASS\n";
+    return 0;
+}
@@ -38,11 +38,20 @@ Coroutine runTest(McpHttpClient& client,
 
     // 连接到服务器
     std::cout << "Connecting to server...\n";
-    auto connectResult = co_await client.connect(url);
-    if (!connectResult) {
-        std::cerr << "Connect error: " << connectResult.error().message() << "\n";
-        finish(1);
-        co_return;
+    if (McpUnixSocket::isUnixAddress(url)) {
+        auto connectResult = client.connectUnix(url);
+        if (!connectResult) {
+            std::cerr << "Connect error: " << connectResult.error().toString() << "\n";
+            finish(1);
+            co_return;
+        }
+    } else {
+        auto connectResult = co_await client.connect(url);
+        if (!connectResult) {
+            std::cerr << "Connect error: " << connectResult.error().message() << "\n";
+            finish(1);
+            co_return;
+        }
     }
     std::cout << "Connected successfully\n\n";
 
@@ -123,6 +132,25 @@ Coroutine runTest(McpHttpClient& client,
     }
     std::cout << "\n";
 
+    // 调用checksum工具（服务端在计算线程池上执行）
+    printSeparator();
+    std::cout << "Calling checksum tool...\n";
+    JsonWriter checksumArgsWriter;
+    checksumArgsWriter.StartObject();
+    checksumArgsWriter.Key("data");
+    checksumArgsWriter.String("galay-mcp");
+    checksumArgsWriter.Key("rounds");
+    checksumArgsWriter.Number(static_cast<int64_t>(100000));
+    checksumArgsWriter.EndObject();
+    std::expected<JsonString, McpError> checksumResult;
+    co_await client.callTool("checksum", checksumArgsWriter.TakeString(), checksumResult);
+    if (checksumResult) {
+        std::cout << "Checksum result: " << checksumResult.value() << "\n";
+    } else {
+        printError(checksumResult.error());
+    }
+    std::cout << "\n";
+
     // 列出资源
     printSeparator();
     std::cout << "Listing resources...\n";
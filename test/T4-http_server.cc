@@ -88,6 +88,34 @@ Coroutine addTool(const JsonElement& arguments, std::expected<JsonString, McpErr
     co_return;
 }
 
+// 校验和工具（同步，CPU 密集，投递到计算线程池执行）
+std::expected<JsonString, McpError> checksumTool(const JsonElement& arguments) {
+    JsonObject obj;
+    std::string data;
+    if (!JsonHelper::GetObject(arguments, obj) || !JsonHelper::GetString(obj, "data", data)) {
+        return std::unexpected(McpError::invalidParams("Missing parameter 'data'"));
+    }
+
+    int64_t rounds = 1000;
+    JsonHelper::GetInt64(obj, "rounds", rounds);
+
+    // FNV-1a，重复多轮模拟 CPU 密集计算
+    uint64_t hash = 14695981039346656037ULL;
+    for (int64_t round = 0; round < rounds; ++round) {
+        for (unsigned char c : data) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+    }
+
+    JsonWriter writer;
+    writer.StartObject();
+    writer.Key("checksum");
+    writer.Number(hash);
+    writer.EndObject();
+    return writer.TakeString();
+}
+
 // 资源读取器（协程）
 Coroutine readExampleResource(const std::string& uri, std::expected<std::string, McpError>& result) {
     if (uri == "example://hello") {
@@ -149,8 +177,13 @@ int main(int argc, char* argv[]) {
     std::cout << "========================================\n";
     std::cout << "HTTP MCP Server Test\n";
     std::cout << "========================================\n";
-    std::cout << "Server will listen on " << host << ":" << port << "\n";
-    std::cout << "MCP endpoint: http://" << host << ":" << port << "/mcp\n";
+    if (McpUnixSocket::isUnixAddress(host)) {
+        std::cout << "Server will listen on " << host << "\n";
+        std::cout << "MCP endpoint: " << host << " (POST /mcp)\n";
+    } else {
+        std::cout << "Server will listen on " << host << ":" << port << "\n";
+        std::cout << "MCP endpoint: http://" << host << ":" << port << "/mcp\n";
+    }
     std::cout << "========================================\n\n";
 
     try {
@@ -176,6 +209,15 @@ int main(int argc, char* argv[]) {
             .build();
         server.addTool("add", "Add two numbers", addSchema, addTool);
 
+        auto checksumSchema = SchemaBuilder()
+            .addString("data", "Data to hash", true)
+            .addNumber("rounds", "Hash rounds", false)
+            .build();
+        McpToolOptions checksumOptions;
+        checksumOptions.execution = McpToolExecution::Compute;
+        checksumOptions.maxConcurrency = 2;
+        server.addTool("checksum", "CPU-bound FNV-1a checksum", checksumSchema, checksumTool, checksumOptions);
+
         server.addResource("example://hello", "Hello Resource",
                           "A simple hello message", "text/plain",
                           readExampleResource);
@@ -192,7 +234,7 @@ int main(int argc, char* argv[]) {
 
         std::cout << "Server configured with:\n";
         std::cout << "  - IO schedulers: " << io_schedulers << "\n";
-        std::cout << "  - Tools: echo, add\n";
+        std::cout << "  - Tools: echo, add, checksum (compute pool, max 2 concurrent)\n";
         std::cout << "  - Resources: example://hello, example://info\n";
         std::cout << "  - Prompts: greeting\n";
         std::cout << "========================================\n";
@@ -0,0 +1,93 @@
+/**
+ * @file T7-shm_channel.cc
+ * @brief 通过共享内存通道驱动 McpStdioServer，覆盖环回绕、超过环容量的大消息与关闭语义。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpShmChannel.h"
+#include "galay-mcp/server/McpStdioServer.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unistd.h>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main()
+{
+    const std::string name = "/galay-mcp-t7-" + std::to_string(::getpid());
+
+    McpShmChannelOptions options;
+    options.capacity = 4096;
+    options.spinIterations = 64;
+
+    auto serverChannel = McpShmChannel::create(name, options);
+    if (!require(serverChannel.has_value(), "failed to create shared memory channel")) {
+        return 1;
+    }
+
+    McpStdioServer server;
+    server.setServerInfo("t7-shm-server", "1.0.0");
+    server.addTool("echo", "Echo the message argument", "{}",
+        [](const JsonElement& args) -> std::expected<JsonString, McpError> {
+            JsonObject obj;
+            std::string message;
+            if (!JsonHelper::GetObject(args, obj) || !JsonHelper::GetString(obj, "message", message)) {
+                return std::unexpected(McpError::invalidParams("Missing message"));
+            }
+            return message;
+        });
+    server.setChannel(std::move(serverChannel.value()));
+    std::thread serverThread([&server]() { server.run(); });
+
+    McpStdioClient client;
+    auto clientChannel = McpShmChannel::open(name, options);
+    if (!require(clientChannel.has_value(), "failed to open shared memory channel") ||
+        !require(client.attach(std::move(clientChannel.value())).has_value(), "attach failed")) {
+        return 1;
+    }
+
+    bool ok = true;
+    ok = ok && require(client.initialize("t7-shm-client", "1.0.0").has_value(), "initialize failed");
+    ok = ok && require(client.getServerInfo().name == "t7-shm-server", "unexpected server name");
+
+    // 多次往返让读写位置反复越过 4KiB 环边界
+    for (int i = 0; ok && i < 200; ++i) {
+        ok = require(client.ping().has_value(), "ping failed");
+    }
+
+    // 单条消息远大于环容量，必须分段流式传递
+    const std::string large(256 * 1024, 'x');
+    JsonWriter args;
+    args.StartObject();
+    args.Key("message");
+    args.String(large);
+    args.EndObject();
+    auto echoed = client.callTool("echo", args.TakeString());
+    ok = ok && require(echoed.has_value() && echoed.value() == large, "large echo mismatch");
+
+    // 客户端断开后服务端读到 ConnectionClosed 并退出 run()
+    client.disconnect();
+    serverThread.join();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T7-ShmChannel PASS\n";
+    return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file T8-stdio_framing.cc
+ * @brief 托管 T2-stdio_server 子进程，协商 Content-Length 分帧并传输多 MB 的工具参数与结果。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <path-to-T2-stdio_server>\n";
+        return 1;
+    }
+
+    McpStdioProcessOptions options;
+    options.executable = argv[1];
+    options.stderrHandler = [](std::string_view) {};
+
+    McpStdioClient client(McpStdioFraming::ContentLength);
+    if (!require(client.spawn(std::move(options)).has_value(), "spawn failed")) {
+        return 1;
+    }
+
+    bool ok = true;
+    ok = ok && require(client.initialize("t8-framing-client", "1.0.0").has_value(), "initialize failed");
+    ok = ok && require(client.framing() == McpStdioFraming::ContentLength,
+                       "server did not acknowledge content-length framing");
+    ok = ok && require(client.ping().has_value(), "ping failed");
+
+    // 请求与响应都是多 MB 的单条消息，按长度一次性读取
+    const std::string str1(3 * 1024 * 1024, 'a');
+    const std::string str2(2 * 1024 * 1024, 'b');
+    JsonWriter args;
+    args.StartObject();
+    args.Key("str1");
+    args.String(str1);
+    args.Key("str2");
+    args.String(str2);
+    args.EndObject();
+    auto result = client.callTool("concat", args.TakeString());
+    ok = ok && require(result.has_value(), "large concat failed");
+    if (ok) {
+        auto docExp = JsonDocument::Parse(result.value());
+        JsonObject obj;
+        std::string joined;
+        ok = require(docExp.has_value() &&
+                     JsonHelper::GetObject(docExp.value().Root(), obj) &&
+                     JsonHelper::GetString(obj, "result", joined) &&
+                     joined.size() == str1.size() + str2.size() &&
+                     joined.front() == 'a' && joined.back() == 'b',
+                     "large concat result mismatch");
+    }
+
+    // 大消息之后分帧仍然对齐
+    ok = ok && require(client.ping().has_value(), "ping after large message failed");
+    ok = ok && require(client.listTools().has_value(), "tools/list failed");
+
+    client.disconnect();
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T8-StdioFraming PASS\n";
+    return 0;
+}
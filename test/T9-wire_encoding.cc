@@ -0,0 +1,152 @@
+/**
+ * @file T9-wire_encoding.cc
+ * @brief 覆盖 MessagePack 编解码往返、base64 数据以 bin 传输，以及与 T2-stdio_server 子进程协商 MessagePack。
+ */
+
+#include "galay-mcp/client/McpStdioClient.h"
+#include "galay-mcp/common/McpEncoding.h"
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+using namespace galay::mcp;
+
+namespace {
+
+bool require(bool condition, std::string_view message)
+{
+    if (!condition) {
+        std::cerr << message << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::string minify(std::string_view json)
+{
+    auto doc = JsonDocument::Parse(json);
+    std::string raw;
+    if (!doc || !JsonHelper::GetRawJson(doc.value().Root(), raw)) {
+        return "<invalid>";
+    }
+    return raw;
+}
+
+bool testCodec()
+{
+    bool ok = true;
+
+    const std::string json =
+        R"({"jsonrpc":"2.0","id":42,"result":{"n":[0,-1,-33,-129,-40000,-5000000000,255,65536,)"
+        R"(5000000000,18446744073709551615],"s":"line\nquote\"tab\té","f":-2.5,"b":[true,false,null],)"
+        R"("empty":{},"none":[]}})";
+    McpMsgPackEncoder encoder;
+    encoder.Raw(json);
+    const std::string packed = encoder.TakeString();
+    ok = ok && require(encoding::isMsgPack(packed) && !encoding::isMsgPack(json), "isMsgPack detection failed");
+    auto back = encoding::msgPackToJson(packed);
+    ok = ok && require(back.has_value() && minify(back.value()) == minify(json), "raw JSON round trip mismatch");
+
+    // 截断数据与非字符串键都应报错
+    ok = ok && require(!encoding::msgPackToJson(std::string_view(packed).substr(0, packed.size() - 1)).has_value(),
+                       "truncated MessagePack accepted");
+    ok = ok && require(!encoding::msgPackToJson(std::string("\x81\x01\x02", 3)).has_value(),
+                       "integer map key accepted");
+
+    // 图片数据在 JSON 中是 base64 字符串，在 MessagePack 中以原始字节传输
+    Content image;
+    image.type = ContentType::Image;
+    image.data = encoding::base64Encode(std::string(3000, '\xab'));
+    image.mimeType = "image/png";
+    ToolCallResult result;
+    result.content.push_back(image);
+
+    const std::string asJson = encoding::encodeResultResponse(7, result, McpWireEncoding::Json);
+    const std::string asMsgPack = encoding::encodeResultResponse(7, result, McpWireEncoding::MsgPack);
+    ok = ok && require(asMsgPack.size() < 3100 && asJson.size() > 4000, "image data not sent as raw bytes");
+    auto imageBack = encoding::msgPackToJson(asMsgPack);
+    ok = ok && require(imageBack.has_value() && minify(imageBack.value()) == minify(asJson),
+                       "image content round trip mismatch");
+
+    auto decoded = encoding::base64Decode(image.data);
+    ok = ok && require(decoded.has_value() && decoded.value() == std::string(3000, '\xab'), "base64 round trip failed");
+    ok = ok && require(!encoding::base64Decode("Zh==").has_value(), "non-canonical base64 accepted");
+    return ok;
+}
+
+bool testNegotiation(const std::string& serverPath)
+{
+    McpStdioProcessOptions options;
+    options.executable = serverPath;
+    options.stderrHandler = [](std::string_view) {};
+
+    McpStdioClient client(McpStdioFraming::ContentLength, McpWireEncoding::MsgPack);
+    bool ok = require(client.spawn(std::move(options)).has_value(), "spawn failed");
+    ok = ok && require(client.initialize("t9-encoding-client", "1.0.0").has_value(), "initialize failed");
+    ok = ok && require(client.wireEncoding() == McpWireEncoding::MsgPack, "server did not acknowledge msgpack");
+    ok = ok && require(client.ping().has_value(), "ping failed");
+
+    const std::string str1 = std::string(512 * 1024, 'a') + "\"\n\\\xc3\xa9";
+    const std::string str2(256 * 1024, 'b');
+    JsonWriter args;
+    args.StartObject();
+    args.Key("str1");
+    args.String(str1);
+    args.Key("str2");
+    args.String(str2);
+    args.EndObject();
+    auto result = client.callTool("concat", args.TakeString());
+    ok = ok && require(result.has_value(), "concat over msgpack failed");
+    if (ok) {
+        auto doc = JsonDocument::Parse(result.value());
+        JsonObject obj;
+        std::string joined;
+        ok = require(doc.has_value() && JsonHelper::GetObject(doc.value().Root(), obj) &&
+                     JsonHelper::GetString(obj, "result", joined) && joined == str1 + str2,
+                     "concat result mismatch over msgpack");
+    }
+
+    auto tools = client.listTools();
+    ok = ok && require(tools.has_value() && !tools.value().empty(), "tools/list over msgpack failed");
+    auto missing = client.callTool("no-such-tool", "{}");
+    ok = ok && require(!missing.has_value(), "error response over msgpack not surfaced");
+    client.disconnect();
+    return ok;
+}
+
+bool testNewlineFallback(const std::string& serverPath)
+{
+    McpStdioProcessOptions options;
+    options.executable = serverPath;
+    options.stderrHandler = [](std::string_view) {};
+
+    // 换行分帧无法承载二进制，客户端不会请求 MessagePack
+    McpStdioClient client(McpStdioFraming::Newline, McpWireEncoding::MsgPack);
+    bool ok = require(client.spawn(std::move(options)).has_value(), "spawn failed");
+    ok = ok && require(client.initialize("t9-fallback-client", "1.0.0").has_value(), "initialize failed");
+    ok = ok && require(client.wireEncoding() == McpWireEncoding::Json, "msgpack enabled on newline framing");
+    ok = ok && require(client.ping().has_value(), "ping failed");
+    client.disconnect();
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <path-to-T2-stdio_server>\n";
+        return 1;
+    }
+
+    bool ok = testCodec();
+    ok = testNegotiation(argv[1]) && ok;
+    ok = testNewlineFallback(argv[1]) && ok;
+
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "T9-WireEncoding PASS\n";
+    return 0;
+}